@@ -20,14 +20,18 @@
 
 #include "sysdep.h"
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include "bfd.h"
+#include "elf/common.h"
 #include "libbfd.h"
 #include "safe-ctype.h"
 
 #define MAX_COMPRESSION_HEADER_SIZE 24
 
 static bfd_boolean
-decompress_contents (bfd_byte *compressed_buffer,
+decompress_contents (bfd_boolean is_zstd, bfd_byte *compressed_buffer,
 		     bfd_size_type compressed_size,
 		     bfd_byte *uncompressed_buffer,
 		     bfd_size_type uncompressed_size)
@@ -35,6 +39,18 @@ decompress_contents (bfd_byte *compressed_buffer,
   z_stream strm;
   int rc;
 
+  if (is_zstd)
+    {
+#ifdef HAVE_ZSTD
+      /* ZSTD_decompress handles several concatenated frames.  */
+      size_t ret = ZSTD_decompress (uncompressed_buffer, uncompressed_size,
+				    compressed_buffer, compressed_size);
+      return !ZSTD_isError (ret) && ret == uncompressed_size;
+#else
+      return FALSE;
+#endif
+    }
+
   /* It is possible the section consists of several compressed
      buffers concatenated together, so we uncompress in a loop.  */
   /* PR 18313: The state field in the z_stream structure is supposed
@@ -65,9 +81,10 @@ decompress_contents (bfd_byte *compressed_buffer,
 }
 
 /* Compress data of the size specified in @var{uncompressed_size}
-   and pointed to by @var{uncompressed_buffer} using zlib and store
-   as the contents field.  This function assumes the contents
-   field was allocated using bfd_malloc() or equivalent.
+   and pointed to by @var{uncompressed_buffer} using zlib, or zstd if
+   BFD_COMPRESS_ZSTD is set, and store as the contents field.  This
+   function assumes the contents field was allocated using bfd_malloc()
+   or equivalent.
 
    Return the uncompressed size if the full section contents is
    compressed successfully.  Otherwise return 0.  */
@@ -84,16 +101,52 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec,
   int zlib_size = 0;
   int orig_compression_header_size;
   bfd_size_type orig_uncompressed_size;
+  unsigned int orig_ch_type;
   int header_size = bfd_get_compression_header_size (abfd, NULL);
   bfd_boolean compressed
     = bfd_is_section_compressed_with_header (abfd, sec,
 					     &orig_compression_header_size,
-					     &orig_uncompressed_size);
+					     &orig_uncompressed_size,
+					     &orig_ch_type);
+  bfd_boolean use_zstd = FALSE;
+  bfd_boolean recompress = FALSE;
 
   /* Either ELF compression header or the 12-byte, "ZLIB" + 8-byte size,
-     overhead in .zdebug* section.  */
+     overhead in .zdebug* section.  Only the ELF compression header
+     can describe zstd compressed contents.  */
   if (!header_size)
      header_size = 12;
+  else
+    use_zstd = (abfd->flags & BFD_COMPRESS_ZSTD) != 0;
+
+  if (compressed
+      && orig_compression_header_size >= 0
+      && (orig_ch_type == ELFCOMPRESS_ZSTD) != use_zstd)
+    {
+      /* Different compression algorithms.  Decompress the section
+	 contents and compress them again.  */
+      int orig_header_size = (orig_compression_header_size
+			      ? orig_compression_header_size : 12);
+      bfd_byte *orig_buffer
+	= (bfd_byte *) bfd_malloc (orig_uncompressed_size);
+      if (orig_buffer == NULL)
+	return 0;
+      if (!decompress_contents (orig_ch_type == ELFCOMPRESS_ZSTD,
+				uncompressed_buffer + orig_header_size,
+				uncompressed_size - orig_header_size,
+				orig_buffer, orig_uncompressed_size))
+	{
+	  bfd_set_error (bfd_error_bad_value);
+	  free (orig_buffer);
+	  return 0;
+	}
+      free (uncompressed_buffer);
+      uncompressed_buffer = orig_buffer;
+      uncompressed_size = orig_uncompressed_size;
+      sec->size = orig_uncompressed_size;
+      compressed = FALSE;
+      recompress = TRUE;
+    }
 
   if (compressed)
     {
@@ -121,6 +174,15 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec,
       /* Add the header size.  */
       compressed_size = zlib_size + header_size;
     }
+  else if (use_zstd)
+    {
+#ifdef HAVE_ZSTD
+      compressed_size = ZSTD_compressBound (uncompressed_size) + header_size;
+#else
+      bfd_set_error (bfd_error_wrong_format);
+      return 0;
+#endif
+    }
   else
     compressed_size = compressBound (uncompressed_size) + header_size;
 
@@ -144,7 +206,8 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec,
       sec->size = orig_uncompressed_size;
       if (decompress)
 	{
-	  if (!decompress_contents (uncompressed_buffer
+	  if (!decompress_contents (use_zstd,
+				    uncompressed_buffer
 				    + orig_compression_header_size,
 				    zlib_size, buffer, buffer_size))
 	    {
@@ -167,10 +230,30 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec,
     }
   else
     {
-      if (compress ((Bytef*) buffer + header_size,
-		    &compressed_size,
-		    (const Bytef*) uncompressed_buffer,
-		    uncompressed_size) != Z_OK)
+      bfd_boolean ok;
+
+      if (use_zstd)
+	{
+#ifdef HAVE_ZSTD
+	  size_t size = ZSTD_compress (buffer + header_size,
+				       compressed_size - header_size,
+				       uncompressed_buffer, uncompressed_size,
+				       ZSTD_CLEVEL_DEFAULT);
+	  ok = !ZSTD_isError (size);
+	  compressed_size = size;
+#else
+	  ok = FALSE;
+#endif
+	}
+      else
+	{
+	  compressed_size -= header_size;
+	  ok = compress ((Bytef*) buffer + header_size,
+			 &compressed_size,
+			 (const Bytef*) uncompressed_buffer,
+			 uncompressed_size) == Z_OK;
+	}
+      if (!ok)
 	{
 	  bfd_release (abfd, buffer);
 	  bfd_set_error (bfd_error_bad_value);
@@ -179,8 +262,10 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec,
 
       compressed_size += header_size;
       /* PR binutils/18087: If compression didn't make the section smaller,
-	 just keep it uncompressed.  */
-      if (compressed_size < uncompressed_size)
+	 just keep it uncompressed.  A section which was compressed with
+	 a different algorithm is kept compressed, since its input
+	 contents are not the uncompressed contents.  */
+      if (compressed_size < uncompressed_size || recompress)
 	bfd_update_compression_header (abfd, buffer, sec);
       else
 	{
@@ -227,6 +312,7 @@ bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
   bfd_boolean ret;
   bfd_size_type save_size;
   bfd_size_type save_rawsize;
+  unsigned int save_status;
   bfd_byte *compressed_buffer;
   unsigned int compression_header_size;
 
@@ -268,12 +354,14 @@ bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
       return TRUE;
 
     case DECOMPRESS_SECTION_SIZED:
+    case DECOMPRESS_SECTION_ZSTD:
       /* Read in the full compressed section contents.  */
       compressed_buffer = (bfd_byte *) bfd_malloc (sec->compressed_size);
       if (compressed_buffer == NULL)
 	return FALSE;
       save_rawsize = sec->rawsize;
       save_size = sec->size;
+      save_status = sec->compress_status;
       /* Clear rawsize, set size to compressed size and set compress_status
 	 to COMPRESS_SECTION_NONE.  If the compressed size is bigger than
 	 the uncompressed size, bfd_get_section_contents will fail.  */
@@ -285,7 +373,7 @@ bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
       /* Restore rawsize and size.  */
       sec->rawsize = save_rawsize;
       sec->size = save_size;
-      sec->compress_status = DECOMPRESS_SECTION_SIZED;
+      sec->compress_status = save_status;
       if (!ret)
 	goto fail_compressed;
 
@@ -299,7 +387,8 @@ bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
 	/* Set header size to the zlib header size if it is a
 	   SHF_COMPRESSED section.  */
 	compression_header_size = 12;
-      if (!decompress_contents (compressed_buffer + compression_header_size,
+      if (!decompress_contents (save_status == DECOMPRESS_SECTION_ZSTD,
+				compressed_buffer + compression_header_size,
 				sec->compressed_size - compression_header_size, p, sz))
 	{
 	  bfd_set_error (bfd_error_bad_value);
@@ -350,7 +439,8 @@ DESCRIPTION
 void
 bfd_cache_section_contents (asection *sec, void *contents)
 {
-  if (sec->compress_status == DECOMPRESS_SECTION_SIZED)
+  if (sec->compress_status == DECOMPRESS_SECTION_SIZED
+      || sec->compress_status == DECOMPRESS_SECTION_ZSTD)
     sec->compress_status = COMPRESS_SECTION_DONE;
   sec->contents = contents;
   sec->flags |= SEC_IN_MEMORY;
@@ -364,20 +454,24 @@ SYNOPSIS
 	bfd_boolean bfd_is_section_compressed_with_header
 	  (bfd *abfd, asection *section,
 	  int *compression_header_size_p,
-	  bfd_size_type *uncompressed_size_p);
+	  bfd_size_type *uncompressed_size_p,
+	  unsigned int *ch_type);
 
 DESCRIPTION
 	Return @code{TRUE} if @var{section} is compressed.  Compression
-	header size is returned in @var{compression_header_size_p} and
-	uncompressed size is returned in @var{uncompressed_size_p}.  If
-	compression is unsupported, compression header size is returned
-	with -1 and uncompressed size is returned with 0.
+	header size is returned in @var{compression_header_size_p},
+	uncompressed size is returned in @var{uncompressed_size_p} and
+	the compression type, ELFCOMPRESS_ZLIB for a .zdebug* section,
+	is returned in @var{ch_type}.  If compression is unsupported,
+	compression header size is returned with -1 and uncompressed
+	size is returned with 0.
 */
 
 bfd_boolean
 bfd_is_section_compressed_with_header (bfd *abfd, sec_ptr sec,
 				       int *compression_header_size_p,
-				       bfd_size_type *uncompressed_size_p)
+				       bfd_size_type *uncompressed_size_p,
+				       unsigned int *ch_type)
 {
   bfd_byte header[MAX_COMPRESSION_HEADER_SIZE];
   int compression_header_size;
@@ -407,11 +501,12 @@ bfd_is_section_compressed_with_header (bfd *abfd, sec_ptr sec,
     compressed = FALSE;
 
   *uncompressed_size_p = sec->size;
+  *ch_type = ELFCOMPRESS_ZLIB;
   if (compressed)
     {
       if (compression_header_size != 0)
 	{
-	  if (!bfd_check_compression_header (abfd, header, sec,
+	  if (!bfd_check_compression_header (abfd, header, sec, ch_type,
 					     uncompressed_size_p))
 	    compression_header_size = -1;
 	}
@@ -449,9 +544,11 @@ bfd_is_section_compressed (bfd *abfd, sec_ptr sec)
 {
   int compression_header_size;
   bfd_size_type uncompressed_size;
+  unsigned int ch_type;
   return (bfd_is_section_compressed_with_header (abfd, sec,
 						 &compression_header_size,
-						 &uncompressed_size)
+						 &uncompressed_size,
+						 &ch_type)
 	  && compression_header_size >= 0
 	  && uncompressed_size > 0);
 }
@@ -467,7 +564,8 @@ SYNOPSIS
 DESCRIPTION
 	Record compressed section size, update section size with
 	decompressed size and set compress_status to
-	DECOMPRESS_SECTION_SIZED.
+	DECOMPRESS_SECTION_SIZED, or DECOMPRESS_SECTION_ZSTD if the
+	section is compressed with zstd.
 
 	Return @code{FALSE} if the section is not a valid compressed
 	section.  Otherwise, return @code{TRUE}.
@@ -480,6 +578,7 @@ bfd_init_section_decompress_status (bfd *abfd, sec_ptr sec)
   int compression_header_size;
   int header_size;
   bfd_size_type uncompressed_size;
+  unsigned int ch_type = ELFCOMPRESS_ZLIB;
 
   compression_header_size = bfd_get_compression_header_size (abfd, sec);
   if (compression_header_size > MAX_COMPRESSION_HEADER_SIZE)
@@ -507,7 +606,7 @@ bfd_init_section_decompress_status (bfd *abfd, sec_ptr sec)
 	}
       uncompressed_size = bfd_getb64 (header + 4);
     }
-  else if (!bfd_check_compression_header (abfd, header, sec,
+  else if (!bfd_check_compression_header (abfd, header, sec, &ch_type,
 					 &uncompressed_size))
     {
       bfd_set_error (bfd_error_wrong_format);
@@ -516,7 +615,9 @@ bfd_init_section_decompress_status (bfd *abfd, sec_ptr sec)
 
   sec->compressed_size = sec->size;
   sec->size = uncompressed_size;
-  sec->compress_status = DECOMPRESS_SECTION_SIZED;
+  sec->compress_status = (ch_type == ELFCOMPRESS_ZSTD
+			  ? DECOMPRESS_SECTION_ZSTD
+			  : DECOMPRESS_SECTION_SIZED);
 
   return TRUE;
 }
@@ -376,10 +376,11 @@ CODE_FRAGMENT
 .  unsigned int gc_mark : 1;
 .
 .  {* Section compression status.  *}
-.  unsigned int compress_status : 2;
+.  unsigned int compress_status : 3;
 .#define COMPRESS_SECTION_NONE    0
 .#define COMPRESS_SECTION_DONE    1
 .#define DECOMPRESS_SECTION_SIZED 2
+.#define DECOMPRESS_SECTION_ZSTD  3
 .
 .  {* The following flags are used by the ELF linker. *}
 .
@@ -44,6 +44,9 @@
 #include <assert.h>
 #include <time.h>
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #ifdef HAVE_WCHAR_H
 #include <wchar.h>
 #endif
@@ -6563,6 +6566,8 @@ process_section_headers (Filedata * filedata)
 
 		  if (chdr.ch_type == ELFCOMPRESS_ZLIB)
 		    printf ("       ZLIB, ");
+		  else if (chdr.ch_type == ELFCOMPRESS_ZSTD)
+		    printf ("       ZSTD, ");
 		  else
 		    printf (_("       [<unknown>: 0x%x], "),
 			    chdr.ch_type);
@@ -13159,10 +13164,27 @@ get_section_contents (Elf_Internal_Shdr * section, Filedata * filedata)
                              _("section contents"));
 }
 
-/* Uncompresses a section that was compressed using zlib, in place.  */
+/* Returns TRUE if sections compressed with CH_TYPE can be
+   uncompressed.  */
 
 static bfd_boolean
-uncompress_section_contents (unsigned char **   buffer,
+supported_compress_type (unsigned int ch_type)
+{
+  if (ch_type == ELFCOMPRESS_ZLIB)
+    return TRUE;
+#ifdef HAVE_ZSTD
+  if (ch_type == ELFCOMPRESS_ZSTD)
+    return TRUE;
+#endif
+  return FALSE;
+}
+
+/* Uncompresses a section that was compressed using zlib, or zstd if
+   IS_ZSTD is true, in place.  */
+
+static bfd_boolean
+uncompress_section_contents (bfd_boolean        is_zstd,
+			     unsigned char **   buffer,
 			     dwarf_size_type    uncompressed_size,
 			     dwarf_size_type *  size)
 {
@@ -13172,6 +13194,28 @@ uncompress_section_contents (unsigned char **   buffer,
   z_stream strm;
   int rc;
 
+#ifdef HAVE_ZSTD
+  if (is_zstd)
+    {
+      size_t ret;
+
+      uncompressed_buffer = (unsigned char *) xmalloc (uncompressed_size);
+      ret = ZSTD_decompress (uncompressed_buffer, uncompressed_size,
+			     compressed_buffer, compressed_size);
+      if (ZSTD_isError (ret) || ret != uncompressed_size)
+	goto fail;
+      *buffer = uncompressed_buffer;
+      *size = uncompressed_size;
+      return TRUE;
+    }
+#else
+  if (is_zstd)
+    {
+      *buffer = NULL;
+      return FALSE;
+    }
+#endif
+
   /* It is possible the section consists of several compressed
      buffers concatenated together, so we uncompress in a loop.  */
   /* PR 18313: The state field in the z_stream structure is supposed
@@ -13237,6 +13281,7 @@ dump_section_as_strings (Elf_Internal_Shdr * section, Filedata * filedata)
     {
       dwarf_size_type new_size = num_bytes;
       dwarf_size_type uncompressed_size = 0;
+      bfd_boolean is_zstd = FALSE;
 
       if ((section->sh_flags & SHF_COMPRESSED) != 0)
 	{
@@ -13245,7 +13290,7 @@ dump_section_as_strings (Elf_Internal_Shdr * section, Filedata * filedata)
 	    = get_compression_header (& chdr, (unsigned char *) start,
 				      num_bytes);
 
-	  if (chdr.ch_type != ELFCOMPRESS_ZLIB)
+	  if (!supported_compress_type (chdr.ch_type))
 	    {
 	      warn (_("section '%s' has unsupported compress type: %d\n"),
 		    printable_section_name (filedata, section), chdr.ch_type);
@@ -13257,6 +13302,7 @@ dump_section_as_strings (Elf_Internal_Shdr * section, Filedata * filedata)
 		    printable_section_name (filedata, section));
 	      return FALSE;
 	    }
+	  is_zstd = chdr.ch_type == ELFCOMPRESS_ZSTD;
 	  uncompressed_size = chdr.ch_size;
 	  start += compression_header_size;
 	  new_size -= compression_header_size;
@@ -13280,7 +13326,7 @@ dump_section_as_strings (Elf_Internal_Shdr * section, Filedata * filedata)
 
       if (uncompressed_size)
 	{
-	  if (uncompress_section_contents (& start,
+	  if (uncompress_section_contents (is_zstd, & start,
 					   uncompressed_size, & new_size))
 	    num_bytes = new_size;
 	  else
@@ -13385,6 +13431,7 @@ dump_section_as_bytes (Elf_Internal_Shdr *  section,
     {
       dwarf_size_type new_size = section_size;
       dwarf_size_type uncompressed_size = 0;
+      bfd_boolean is_zstd = FALSE;
 
       if ((section->sh_flags & SHF_COMPRESSED) != 0)
 	{
@@ -13392,7 +13439,7 @@ dump_section_as_bytes (Elf_Internal_Shdr *  section,
 	  unsigned int compression_header_size
 	    = get_compression_header (& chdr, start, section_size);
 
-	  if (chdr.ch_type != ELFCOMPRESS_ZLIB)
+	  if (!supported_compress_type (chdr.ch_type))
 	    {
 	      warn (_("section '%s' has unsupported compress type: %d\n"),
 		    printable_section_name (filedata, section), chdr.ch_type);
@@ -13404,6 +13451,7 @@ dump_section_as_bytes (Elf_Internal_Shdr *  section,
 		    printable_section_name (filedata, section));
 	      return FALSE;
 	    }
+	  is_zstd = chdr.ch_type == ELFCOMPRESS_ZSTD;
 	  uncompressed_size = chdr.ch_size;
 	  start += compression_header_size;
 	  new_size -= compression_header_size;
@@ -13427,7 +13475,7 @@ dump_section_as_bytes (Elf_Internal_Shdr *  section,
 
       if (uncompressed_size)
 	{
-	  if (uncompress_section_contents (& start, uncompressed_size,
+	  if (uncompress_section_contents (is_zstd, & start, uncompressed_size,
 					   & new_size))
 	    {
 	      section_size = new_size;
@@ -13550,6 +13598,7 @@ load_specific_debug_section (enum dwarf_section_display_enum  debug,
       unsigned char *start = section->start;
       dwarf_size_type size = sec->sh_size;
       dwarf_size_type uncompressed_size = 0;
+      bfd_boolean is_zstd = FALSE;
 
       if ((sec->sh_flags & SHF_COMPRESSED) != 0)
 	{
@@ -13567,7 +13616,7 @@ load_specific_debug_section (enum dwarf_section_display_enum  debug,
 
 	  compression_header_size = get_compression_header (&chdr, start, size);
 
-	  if (chdr.ch_type != ELFCOMPRESS_ZLIB)
+	  if (!supported_compress_type (chdr.ch_type))
 	    {
 	      warn (_("section '%s' has unsupported compress type: %d\n"),
 		    section->name, chdr.ch_type);
@@ -13579,6 +13628,7 @@ load_specific_debug_section (enum dwarf_section_display_enum  debug,
 		    section->name);
 	      return FALSE;
 	    }
+	  is_zstd = chdr.ch_type == ELFCOMPRESS_ZSTD;
 	  uncompressed_size = chdr.ch_size;
 	  start += compression_header_size;
 	  size -= compression_header_size;
@@ -13602,7 +13652,7 @@ load_specific_debug_section (enum dwarf_section_display_enum  debug,
 
       if (uncompressed_size)
 	{
-	  if (uncompress_section_contents (&start, uncompressed_size,
+	  if (uncompress_section_contents (is_zstd, &start, uncompressed_size,
 					   &size))
 	    {
 	      /* Free the compressed buffer, update the section buffer
@@ -0,0 +1,26 @@
+dnl A function to check whether zstd can be used to compress and
+dnl decompress debug sections.  zstd is used if it is found, unless
+dnl configured with --without-zstd; with --with-zstd it is an error if
+dnl it is not found.
+
+AC_DEFUN([AM_ZSTD],
+[
+  AC_ARG_WITH(zstd,
+  [AS_HELP_STRING([--with-zstd], [support zstd compressed debug sections (default=auto)])],
+  [], [with_zstd=auto])
+  if test x$with_zstd != xno; then
+    AC_CACHE_CHECK([for zstd], am_cv_zstd,
+      [am_save_LIBS=$LIBS
+       LIBS="-lzstd $LIBS"
+       AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <zstd.h>]],
+         [[return ZSTD_isError (ZSTD_compressBound (1));]])],
+         [am_cv_zstd=yes], [am_cv_zstd=no])
+       LIBS=$am_save_LIBS])
+    if test x$am_cv_zstd = xyes; then
+      LIBS="-lzstd $LIBS"
+      AC_DEFINE(HAVE_ZSTD, 1, [Define to 1 if zstd is available.])
+    elif test x$with_zstd = xyes; then
+      AC_MSG_ERROR([--with-zstd was given, but zstd was not found])
+    fi
+  fi
+])
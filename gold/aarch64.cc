@@ -36,9 +36,11 @@
 #include "layout.h"
 #include "output.h"
 #include "copy-relocs.h"
+#include "workqueue.h"
 #include "target.h"
 #include "target-reloc.h"
 #include "target-select.h"
+#include "stub-scan.h"
 #include "tls.h"
 #include "freebsd.h"
 #include "nacl.h"
@@ -1192,6 +1194,11 @@ class Reloc_stub : public Stub_base<size, big_endian>
   stub_type_for_reloc(unsigned int r_type, AArch64_address address,
 		      AArch64_address target);
 
+  // Return how far the offset of a branch from LOCATION to DEST may
+  // change before the stub type for it may change.
+  static uint64_t
+  stub_type_slack(AArch64_address location, AArch64_address dest);
+
   Reloc_stub(int type)
     : Stub_base<size, big_endian>(type)
   { }
@@ -1369,6 +1376,30 @@ Reloc_stub<size, big_endian>::stub_type_for_reloc(
   return ST_LONG_BRANCH_ABS;
 }
 
+
+// Return how far the offset of a branch from LOCATION to DEST may change
+// before stub_type_for_reloc may return a different type.
+
+template<int size, bool big_endian>
+uint64_t
+Reloc_stub<size, big_endian>::stub_type_slack(AArch64_address location,
+					      AArch64_address dest)
+{
+  int64_t branch_offset = dest - location;
+  const int64_t branch_limits[] = { MIN_BRANCH_OFFSET, MAX_BRANCH_OFFSET };
+  uint64_t slack = Stub_scan_sections<size>::slack(branch_offset,
+						   branch_limits, 2);
+
+  // The adrp immediate is a difference of pages, which is within two
+  // pages of the difference of the addresses.
+  const int64_t adrp_limits[] = { static_cast<int64_t>(MIN_ADRP_IMM) * 4096,
+				  static_cast<int64_t>(MAX_ADRP_IMM) * 4096 };
+  uint64_t adrp_slack = Stub_scan_sections<size>::slack(branch_offset,
+							adrp_limits, 2);
+  adrp_slack = adrp_slack > 2 * 4096 ? adrp_slack - 2 * 4096 : 0;
+  return std::min(slack, adrp_slack);
+}
+
 // A class to hold stubs for the ARM target. This contains 2 different types of
 // stubs - reloc stubs and erratum stubs.
 
@@ -1763,13 +1794,41 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
   typedef Erratum_stub<size, big_endian> The_erratum_stub;
   typedef typename The_stub_table::Erratum_stub_set_iter Erratum_stub_set_iter;
   typedef std::vector<The_stub_table*> Stub_table_list;
+  typedef typename elfcpp::Swap<32, big_endian>::Valtype Insntype;
   static const AArch64_address invalid_address =
       static_cast<AArch64_address>(-1);
 
+  // A relocation stub found while scanning in parallel.
+  struct Reloc_stub_request
+  {
+    The_stub_table* stub_table;
+    int stub_type;
+    const Symbol* gsym;
+    unsigned int r_sym;
+    int32_t addend;
+    AArch64_address destination;
+  };
+
+  // An erratum stub found while scanning in parallel.
+  struct Erratum_stub_request
+  {
+    unsigned int shndx;
+    section_size_type erratum_insn_offset;
+    AArch64_address erratum_address;
+    Insntype erratum_insn;
+    int erratum_type;
+    unsigned int e843419_adrp_offset;
+  };
+
+  typedef std::vector<Reloc_stub_request> Reloc_stub_requests;
+  typedef std::vector<Erratum_stub_request> Erratum_stub_requests;
+
   AArch64_relobj(const std::string& name, Input_file* input_file, off_t offset,
 		 const typename elfcpp::Ehdr<size, big_endian>& ehdr)
     : Sized_relobj_file<size, big_endian>(name, input_file, offset, ehdr),
-      stub_tables_()
+      stub_tables_(), stub_scan_(), errata_scan_list_(), reloc_scan_list_(),
+      defer_stubs_(false), needs_serial_stub_scan_(false),
+      reloc_stub_requests_(), erratum_stub_requests_()
   { }
 
   ~AArch64_relobj()
@@ -1798,10 +1857,71 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
 	      Output_section*, const Symbol_table*,
 	      The_target_aarch64*);
 
-  // Scan all relocation sections for stub generation.
+  // Choose the sections to scan in PASS, and scan them for stub
+  // generation.
   void
   scan_sections_for_stubs(The_target_aarch64*, const Symbol_table*,
-			  const Layout*);
+			  const Layout*, const Stub_scan_pass<size>*);
+
+  // Scan the sections chosen by scan_sections_for_stubs.  This is
+  // also used to scan them again serially.
+  void
+  rescan_sections_for_stubs(The_target_aarch64*, const Symbol_table*,
+			    const Layout*, const Stub_scan_pass<size>*);
+
+  // Return the state of the sections for stub scanning.
+  Stub_scan_sections<size>*
+  stub_scan()
+  { return &this->stub_scan_; }
+
+  // Whether the stubs found are recorded as requests instead of being
+  // added to the stub tables.  This is set while objects are scanned
+  // in parallel, since the stub tables are shared by the objects.
+  bool
+  defers_stubs() const
+  { return this->defer_stubs_; }
+
+  void
+  set_defers_stubs(bool defer)
+  { this->defer_stubs_ = defer; }
+
+  // Whether scanning in parallel found a branch to a symbol whose
+  // value may only be computed when no other object is being scanned.
+  // The requests are then discarded and the object is scanned again.
+  bool
+  needs_serial_stub_scan() const
+  { return this->needs_serial_stub_scan_; }
+
+  void
+  set_needs_serial_stub_scan(bool needs)
+  { this->needs_serial_stub_scan_ = needs; }
+
+  // Record a request for a relocation stub.
+  void
+  add_reloc_stub_request(const Reloc_stub_request& request)
+  { this->reloc_stub_requests_.push_back(request); }
+
+  // Record a request for an erratum stub.
+  void
+  add_erratum_stub_request(const Erratum_stub_request& request)
+  { this->erratum_stub_requests_.push_back(request); }
+
+  // Return the requests.
+  const Reloc_stub_requests&
+  reloc_stub_requests() const
+  { return this->reloc_stub_requests_; }
+
+  const Erratum_stub_requests&
+  erratum_stub_requests() const
+  { return this->erratum_stub_requests_; }
+
+  // Discard the requests.
+  void
+  clear_stub_requests()
+  {
+    this->reloc_stub_requests_.clear();
+    this->erratum_stub_requests_.clear();
+  }
 
   // Whether a section is a scannable text section.
   bool
@@ -1890,6 +2010,24 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
 
   // Mapping symbol information sorted by (section index, section_offset).
   Mapping_symbol_info mapping_symbol_info_;
+
+  // The state of the sections for stub scanning.
+  Stub_scan_sections<size> stub_scan_;
+
+  // The sections to scan for errata, and the relocation sections to
+  // scan for relocation stubs, in this pass.
+  std::vector<unsigned int> errata_scan_list_;
+  std::vector<unsigned int> reloc_scan_list_;
+
+  // Whether stubs are recorded as requests.
+  bool defer_stubs_;
+
+  // Whether the object must be scanned again serially.
+  bool needs_serial_stub_scan_;
+
+  // The stubs found while scanning in parallel, in the order found.
+  Reloc_stub_requests reloc_stub_requests_;
+  Erratum_stub_requests erratum_stub_requests_;
 };  // End of AArch64_relobj
 
 
@@ -2371,15 +2509,64 @@ AArch64_relobj<size, big_endian>::scan_errata(
 }
 
 
-// Scan relocations for stub generation.
+// Choose the sections to scan for stub generation in PASS, and scan
+// them.  A section is scanned for errata if it moved, since the errata
+// only depend on the addresses of the instructions.  A relocation
+// section is scanned if its branches may need different stubs.
 
 template<int size, bool big_endian>
 void
 AArch64_relobj<size, big_endian>::scan_sections_for_stubs(
     The_target_aarch64* target,
     const Symbol_table* symtab,
-    const Layout* layout)
+    const Layout* layout,
+    const Stub_scan_pass<size>* pass)
+{
+  unsigned int shnum = this->shnum();
+  const unsigned int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+
+  // Read the section headers.
+  const unsigned char* pshdrs = this->get_view(this->elf_file()->shoff(),
+					       shnum * shdr_size,
+					       true, true);
+
+  const Relobj::Output_sections& out_sections(this->output_sections());
+
+  this->errata_scan_list_.clear();
+  this->reloc_scan_list_.clear();
+  const unsigned char* p = pshdrs + shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
+    {
+      const elfcpp::Shdr<size, big_endian> shdr(p);
+      if ((parameters->options().fix_cortex_a53_843419()
+	   || parameters->options().fix_cortex_a53_835769())
+	  && !pass->refresh()
+	  && this->stub_scan_.moved(i))
+	this->errata_scan_list_.push_back(i);
+      if (this->section_needs_reloc_stub_scanning(shdr, out_sections, symtab,
+						  pshdrs)
+	  && this->stub_scan_.needs_scan(this->adjust_shndx(shdr.get_sh_info()),
+					 pass))
+	this->reloc_scan_list_.push_back(i);
+    }
+
+  this->rescan_sections_for_stubs(target, symtab, layout, pass);
+}
+
+// Scan the sections chosen by scan_sections_for_stubs for stub
+// generation.
+
+template<int size, bool big_endian>
+void
+AArch64_relobj<size, big_endian>::rescan_sections_for_stubs(
+    The_target_aarch64* target,
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const Stub_scan_pass<size>* pass)
 {
+  if (this->errata_scan_list_.empty() && this->reloc_scan_list_.empty())
+    return;
+
   unsigned int shnum = this->shnum();
   const unsigned int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
 
@@ -2399,59 +2586,69 @@ AArch64_relobj<size, big_endian>::scan_sections_for_stubs(
   relinfo.layout = layout;
   relinfo.object = this;
 
+  // Do errata scanning.
+  for (std::vector<unsigned int>::const_iterator pi =
+	 this->errata_scan_list_.begin();
+       pi != this->errata_scan_list_.end();
+       ++pi)
+    {
+      unsigned int i = *pi;
+      const elfcpp::Shdr<size, big_endian> shdr(pshdrs + i * shdr_size);
+      scan_errata(i, shdr, out_sections[i], symtab, target);
+    }
+
   // Do relocation stubs scanning.
-  const unsigned char* p = pshdrs + shdr_size;
-  for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
+  for (std::vector<unsigned int>::const_iterator pi =
+	 this->reloc_scan_list_.begin();
+       pi != this->reloc_scan_list_.end();
+       ++pi)
     {
-      const elfcpp::Shdr<size, big_endian> shdr(p);
-      if (parameters->options().fix_cortex_a53_843419()
-	  || parameters->options().fix_cortex_a53_835769())
-	scan_errata(i, shdr, out_sections[i], symtab, target);
-      if (this->section_needs_reloc_stub_scanning(shdr, out_sections, symtab,
-						  pshdrs))
+      unsigned int i = *pi;
+      const elfcpp::Shdr<size, big_endian> shdr(pshdrs + i * shdr_size);
+      unsigned int index = this->adjust_shndx(shdr.get_sh_info());
+      AArch64_address output_offset =
+	  this->get_output_section_offset(index);
+      AArch64_address output_address;
+      if (output_offset != invalid_address)
 	{
-	  unsigned int index = this->adjust_shndx(shdr.get_sh_info());
-	  AArch64_address output_offset =
-	      this->get_output_section_offset(index);
-	  AArch64_address output_address;
-	  if (output_offset != invalid_address)
-	    {
-	      output_address = out_sections[index]->address() + output_offset;
-	    }
-	  else
-	    {
-	      // Currently this only happens for a relaxed section.
-	      const Output_relaxed_input_section* poris =
-		  out_sections[index]->find_relaxed_input_section(this, index);
-	      gold_assert(poris != NULL);
-	      output_address = poris->address();
-	    }
-
-	  // Get the relocations.
-	  const unsigned char* prelocs = this->get_view(shdr.get_sh_offset(),
-							shdr.get_sh_size(),
-							true, false);
-
-	  // Get the section contents.
-	  section_size_type input_view_size = 0;
-	  const unsigned char* input_view =
-	      this->section_contents(index, &input_view_size, false);
-
-	  relinfo.reloc_shndx = i;
-	  relinfo.data_shndx = index;
-	  unsigned int sh_type = shdr.get_sh_type();
-	  unsigned int reloc_size;
-	  gold_assert (sh_type == elfcpp::SHT_RELA);
-	  reloc_size = elfcpp::Elf_sizes<size>::rela_size;
-
-	  Output_section* os = out_sections[index];
-	  target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
-					 shdr.get_sh_size() / reloc_size,
-					 os,
-					 output_offset == invalid_address,
-					 input_view, output_address,
-					 input_view_size);
+	  output_address = out_sections[index]->address() + output_offset;
 	}
+      else
+	{
+	  // Currently this only happens for a relaxed section.
+	  const Output_relaxed_input_section* poris =
+	      out_sections[index]->find_relaxed_input_section(this, index);
+	  gold_assert(poris != NULL);
+	  output_address = poris->address();
+	}
+
+      // Get the relocations.
+      const unsigned char* prelocs = this->get_view(shdr.get_sh_offset(),
+						    shdr.get_sh_size(),
+						    true, false);
+
+      // Get the section contents.
+      section_size_type input_view_size = 0;
+      const unsigned char* input_view =
+	  this->section_contents(index, &input_view_size, false);
+
+      relinfo.reloc_shndx = i;
+      relinfo.data_shndx = index;
+      unsigned int sh_type = shdr.get_sh_type();
+      unsigned int reloc_size;
+      gold_assert (sh_type == elfcpp::SHT_RELA);
+      reloc_size = elfcpp::Elf_sizes<size>::rela_size;
+
+      this->stub_scan_.start_scan(index, pass);
+      Output_section* os = out_sections[index];
+      target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
+				     shdr.get_sh_size() / reloc_size,
+				     os,
+				     output_offset == invalid_address,
+				     input_view, output_address,
+				     input_view_size);
+      if (this->needs_serial_stub_scan_)
+	break;
     }
 }
 
@@ -2923,7 +3120,8 @@ class Target_aarch64 : public Sized_target<size, big_endian>
       rela_irelative_(NULL), copy_relocs_(elfcpp::R_AARCH64_COPY),
       got_mod_index_offset_(-1U),
       tlsdesc_reloc_info_(), tls_base_symbol_defined_(false),
-      stub_tables_(), stub_group_size_(0), aarch64_input_section_map_()
+      stub_tables_(), stub_group_size_(0), aarch64_input_section_map_(),
+      stub_scan_pass_(), stub_scan_groups_()
   { }
 
   // Scan the relocations to determine unreferenced sections for
@@ -3190,7 +3388,13 @@ class Target_aarch64 : public Sized_target<size, big_endian>
 
   // Relaxation hook.  This is where we do stub generation.
   virtual bool
-  do_relax(int, const Input_objects*, Symbol_table*, Layout*, const Task*);
+  do_relax(int, const Input_objects*, Symbol_table*, Layout*, Workqueue*,
+	   const Task*);
+
+  // Print statistics about relaxation.
+  virtual void
+  do_print_stats() const
+  { this->stub_scan_pass_.print_stats(); }
 
   void
   group_sections(Layout* layout,
@@ -3422,6 +3626,24 @@ class Target_aarch64 : public Sized_target<size, big_endian>
     return this->plt_;
   }
 
+  // Add a relocation stub to a stub table, unless it has one already.
+  void
+  add_reloc_stub(The_stub_table*, int, const Symbol*, const Relobj*,
+		 unsigned int, int32_t, Address);
+
+  // Add the stubs requested while scanning an object in parallel.
+  void
+  add_requested_stubs(The_aarch64_relobj*);
+
+  // Scan all the objects for stubs in the current relaxation pass.
+  void
+  scan_for_stubs(const Input_objects*, const Symbol_table*, const Layout*,
+		 Workqueue*, const Task*);
+
+  // Return whether any stub table changed size in this pass.
+  bool
+  stub_tables_changed();
+
   // Helper method to create erratum stubs for ST_E_843419 and ST_E_835769. For
   // ST_E_843419, we need an additional field for adrp offset.
   void create_erratum_stub(
@@ -3536,6 +3758,10 @@ class Target_aarch64 : public Sized_target<size, big_endian>
   // Actual stub group size
   section_size_type stub_group_size_;
   AArch64_input_section_map aarch64_input_section_map_;
+  // The state of the current relaxation pass.
+  Stub_scan_pass<size> stub_scan_pass_;
+  // The groups of objects which are scanned for stubs in parallel.
+  std::vector<std::vector<Relobj*> > stub_scan_groups_;
 };  // End of Target_aarch64
 
 
@@ -3848,8 +4074,8 @@ Target_aarch64<size, big_endian>::scan_reloc_for_stub(
     typename elfcpp::Elf_types<size>::Elf_Swxword addend,
     Address address)
 {
-  const AArch64_relobj<size, big_endian>* aarch64_relobj =
-      static_cast<AArch64_relobj<size, big_endian>*>(relinfo->object);
+  The_aarch64_relobj* aarch64_relobj =
+      static_cast<The_aarch64_relobj*>(relinfo->object);
 
   Symbol_value<size> symval;
   if (gsym != NULL)
@@ -3891,13 +4117,49 @@ Target_aarch64<size, big_endian>::scan_reloc_for_stub(
 
   int stub_type = The_reloc_stub::
       stub_type_for_reloc(r_type, address, destination);
+  aarch64_relobj->stub_scan()->add_branch(
+      relinfo->data_shndx,
+      The_reloc_stub::stub_type_slack(address, destination),
+      stub_type != ST_NONE);
   if (stub_type == ST_NONE)
     return;
 
   The_stub_table* stub_table = aarch64_relobj->stub_table(relinfo->data_shndx);
   gold_assert(stub_table != NULL);
 
-  The_reloc_stub_key key(stub_type, gsym, aarch64_relobj, r_sym, addend);
+  if (aarch64_relobj->defers_stubs())
+    {
+      typename The_aarch64_relobj::Reloc_stub_request request;
+      request.stub_table = stub_table;
+      request.stub_type = stub_type;
+      request.gsym = gsym;
+      request.r_sym = r_sym;
+      request.addend = addend;
+      request.destination = destination;
+      aarch64_relobj->add_reloc_stub_request(request);
+      return;
+    }
+
+  this->add_reloc_stub(stub_table, stub_type, gsym, aarch64_relobj, r_sym,
+		       addend, destination);
+}  // End of Target_aarch64::scan_reloc_for_stub
+
+
+// Add a relocation stub to STUB_TABLE, unless it already has one with the
+// same key, and set its destination.
+
+template<int size, bool big_endian>
+void
+Target_aarch64<size, big_endian>::add_reloc_stub(
+    The_stub_table* stub_table,
+    int stub_type,
+    const Symbol* gsym,
+    const Relobj* relobj,
+    unsigned int r_sym,
+    int32_t addend,
+    Address destination)
+{
+  The_reloc_stub_key key(stub_type, gsym, relobj, r_sym, addend);
   The_reloc_stub* stub = stub_table->find_reloc_stub(key);
   if (stub == NULL)
     {
@@ -3905,7 +4167,40 @@ Target_aarch64<size, big_endian>::scan_reloc_for_stub(
       stub_table->add_reloc_stub(stub, key);
     }
   stub->set_destination_address(destination);
-}  // End of Target_aarch64::scan_reloc_for_stub
+}
+
+
+// Add the stubs requested while scanning RELOBJ in parallel, in the order
+// they were found.
+
+template<int size, bool big_endian>
+void
+Target_aarch64<size, big_endian>::add_requested_stubs(
+    The_aarch64_relobj* relobj)
+{
+  relobj->set_defers_stubs(false);
+
+  const typename The_aarch64_relobj::Reloc_stub_requests& reloc_requests(
+      relobj->reloc_stub_requests());
+  for (typename The_aarch64_relobj::Reloc_stub_requests::const_iterator p =
+	 reloc_requests.begin();
+       p != reloc_requests.end();
+       ++p)
+    this->add_reloc_stub(p->stub_table, p->stub_type, p->gsym, relobj,
+			 p->r_sym, p->addend, p->destination);
+
+  const typename The_aarch64_relobj::Erratum_stub_requests& erratum_requests(
+      relobj->erratum_stub_requests());
+  for (typename The_aarch64_relobj::Erratum_stub_requests::const_iterator p =
+	 erratum_requests.begin();
+       p != erratum_requests.end();
+       ++p)
+    this->create_erratum_stub(relobj, p->shndx, p->erratum_insn_offset,
+			      p->erratum_address, p->erratum_insn,
+			      p->erratum_type, p->e843419_adrp_offset);
+
+  relobj->clear_stub_requests();
+}
 
 
 // This function scans a relocation section for stub generation.
@@ -3973,6 +4268,8 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
       bool is_defined_in_discarded_section;
       unsigned int shndx;
       const Symbol* gsym = NULL;
+      // Whether we track how far the destination moves.
+      bool is_tracked;
       if (r_sym < local_count)
 	{
 	  sym = NULL;
@@ -3990,6 +4287,12 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
 	     && shndx != elfcpp::SHN_UNDEF
 	     && !object->is_section_included(shndx)
 	     && !relinfo->symtab->is_section_folded(object, shndx));
+	  is_tracked =
+	    (!is_ordinary
+	     || shndx == elfcpp::SHN_UNDEF
+	     || (!is_defined_in_discarded_section
+		 && (Stub_scan_sections<size>::section_address(object, shndx)
+		     != Stub_scan_sections<size>::invalid_address)));
 
 	  // We need to compute the would-be final value of this local
 	  // symbol.
@@ -4030,6 +4333,18 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
 	  if (gsym->is_forwarder())
 	    gsym = relinfo->symtab->resolve_forwards(gsym);
 
+	  // The value of a symbol in a merge section of another object
+	  // can not be computed while that object is scanned in another
+	  // thread.
+	  bool serial;
+	  is_tracked = Stub_scan_sections<size>::symbol_is_tracked(gsym,
+								   &serial);
+	  if (serial && object->defers_stubs())
+	    {
+	      object->set_needs_serial_stub_scan(true);
+	      return;
+	    }
+
 	  sym = static_cast<const Sized_symbol<size>*>(gsym);
 	  if (sym->has_symtab_index() && sym->symtab_index() != -1U)
 	    symval.set_output_symtab_index(sym->symtab_index());
@@ -4059,9 +4374,14 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
 	  is_defined_in_discarded_section =
 	      (gsym->is_defined_in_discarded_section()
 	       && gsym->is_undefined());
+	  if (is_defined_in_discarded_section)
+	    is_tracked = false;
 	  shndx = 0;
 	}
 
+      if (!is_tracked)
+	object->stub_scan()->add_untracked_branch(relinfo->data_shndx);
+
       Symbol_value<size> symval2;
       if (is_defined_in_discarded_section)
 	{
@@ -5631,6 +5951,134 @@ Target_aarch64<size, big_endian>::new_aarch64_input_section(
 }
 
 
+// Scan the objects for stubs in parallel.  Each item is a group of
+// objects which share an input file.  The objects first record the
+// addresses of their sections, then they are scanned.
+
+template<int size, bool big_endian>
+class AArch64_stub_scan_runner : public Task_parallel_runner
+{
+ public:
+  typedef AArch64_relobj<size, big_endian> The_aarch64_relobj;
+
+  AArch64_stub_scan_runner(Target_aarch64<size, big_endian>* target,
+			   const std::vector<std::vector<Relobj*> >& groups,
+			   const Symbol_table* symtab, const Layout* layout,
+			   const Stub_scan_pass<size>* pass, const Task* task,
+			   bool update_addresses)
+    : target_(target), groups_(groups), symtab_(symtab), layout_(layout),
+      pass_(pass), task_(task), update_addresses_(update_addresses)
+  { }
+
+  void
+  run(unsigned int i);
+
+ private:
+  Target_aarch64<size, big_endian>* target_;
+  const std::vector<std::vector<Relobj*> >& groups_;
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+  const Stub_scan_pass<size>* pass_;
+  const Task* task_;
+  bool update_addresses_;
+};
+
+template<int size, bool big_endian>
+void
+AArch64_stub_scan_runner<size, big_endian>::run(unsigned int i)
+{
+  const std::vector<Relobj*>& group(this->groups_[i]);
+  for (std::vector<Relobj*>::const_iterator p = group.begin();
+       p != group.end();
+       ++p)
+    {
+      The_aarch64_relobj* aarch64_relobj =
+	  static_cast<The_aarch64_relobj*>(*p);
+      if (this->update_addresses_)
+	{
+	  aarch64_relobj->stub_scan()->update_addresses(aarch64_relobj);
+	  continue;
+	}
+
+      // Lock the object so we can read from it.  No other thread uses
+      // an object in this group.
+      Task_lock_obj<Object> tl(this->task_, aarch64_relobj);
+      aarch64_relobj->set_defers_stubs(true);
+      aarch64_relobj->scan_sections_for_stubs(this->target_, this->symtab_,
+					      this->layout_, this->pass_);
+    }
+}
+
+
+// Scan all the objects for stubs in the current relaxation pass.  The
+// objects are scanned in parallel, and the stubs they find are added to
+// the stub tables afterwards, in the order of the objects, so that the
+// stubs are laid out the same way as when scanning serially.
+
+template<int size, bool big_endian>
+void
+Target_aarch64<size, big_endian>::scan_for_stubs(
+    const Input_objects* input_objects,
+    const Symbol_table* symtab,
+    const Layout* layout,
+    Workqueue* workqueue,
+    const Task* task)
+{
+  AArch64_stub_scan_runner<size, big_endian> runner(this,
+						     this->stub_scan_groups_,
+						     symtab, layout,
+						     &this->stub_scan_pass_,
+						     task, false);
+  workqueue->run_parallel(&runner, this->stub_scan_groups_.size());
+
+  for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
+       op != input_objects->relobj_end();
+       ++op)
+    {
+      The_aarch64_relobj* aarch64_relobj =
+	  static_cast<The_aarch64_relobj*>(*op);
+      if (aarch64_relobj->needs_serial_stub_scan())
+	{
+	  aarch64_relobj->clear_stub_requests();
+	  aarch64_relobj->set_defers_stubs(false);
+	  aarch64_relobj->set_needs_serial_stub_scan(false);
+	  // This is only called single-threaded from Layout::finalize, so
+	  // it is OK to lock.
+	  Task_lock_obj<Object> tl(task, aarch64_relobj);
+	  aarch64_relobj->rescan_sections_for_stubs(this, symtab, layout,
+						    &this->stub_scan_pass_);
+	}
+      else
+	this->add_requested_stubs(aarch64_relobj);
+    }
+}
+
+
+// Return whether any stub table changed size in this pass.  If one did,
+// update the size of its owner.
+
+template<int size, bool big_endian>
+bool
+Target_aarch64<size, big_endian>::stub_tables_changed()
+{
+  for (Stub_table_iterator siter = this->stub_tables_.begin();
+       siter != this->stub_tables_.end(); ++siter)
+    {
+      The_stub_table* stub_table = *siter;
+      if (stub_table->update_data_size_changed_p())
+	{
+	  The_aarch64_input_section* owner = stub_table->owner();
+	  uint64_t address = owner->address();
+	  off_t offset = owner->offset();
+	  owner->reset_address_and_file_offset();
+	  owner->set_address_and_file_offset(address, offset);
+	  return true;
+	}
+    }
+  return false;
+}
+
+
 // Relaxation hook.  This is where we do stub generation.
 
 template<int size, bool big_endian>
@@ -5639,7 +6087,8 @@ Target_aarch64<size, big_endian>::do_relax(
     int pass,
     const Input_objects* input_objects,
     Symbol_table* symtab,
-    Layout* layout ,
+    Layout* layout,
+    Workqueue* workqueue,
     const Task* task)
 {
   gold_assert(!parameters->options().relocatable());
@@ -5656,6 +6105,7 @@ Target_aarch64<size, big_endian>::do_relax(
 				   4096 * 4;
 	}
       group_sections(layout, this->stub_group_size_, true, task);
+      stub_scan_groups(input_objects, &this->stub_scan_groups_);
     }
   else
     {
@@ -5673,35 +6123,46 @@ Target_aarch64<size, big_endian>::do_relax(
 	}
     }
 
-  // Scan relocs for relocation stubs
+  // Find how far the sections moved since the previous pass.
+  Stub_scan_pass<size>* scan_pass = &this->stub_scan_pass_;
+  scan_pass->start(layout, pass == 1);
+  AArch64_stub_scan_runner<size, big_endian> runner(this,
+						     this->stub_scan_groups_,
+						     symtab, layout, scan_pass,
+						     task, true);
+  workqueue->run_parallel(&runner, this->stub_scan_groups_.size());
   for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
        op != input_objects->relobj_end();
        ++op)
+    static_cast<The_aarch64_relobj*>(*op)->stub_scan()->add_shifts_to(
+	scan_pass);
+  scan_pass->finish_shifts();
+
+  // Scan relocs for relocation stubs
+  this->scan_for_stubs(input_objects, symtab, layout, workqueue, task);
+  bool any_stub_table_changed = this->stub_tables_changed();
+
+  // If this is the last pass, scan the sections which were skipped and
+  // which use stubs, to update the destinations of their stubs.
+  if (!any_stub_table_changed && !scan_pass->scan_all())
     {
-      The_aarch64_relobj* aarch64_relobj =
-	  static_cast<The_aarch64_relobj*>(*op);
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from Layout::finalize, so it is OK to lock.
-      Task_lock_obj<Object> tl(task, aarch64_relobj);
-      aarch64_relobj->scan_sections_for_stubs(this, symtab, layout);
+      scan_pass->start_refresh();
+      this->scan_for_stubs(input_objects, symtab, layout, workqueue, task);
+      any_stub_table_changed = this->stub_tables_changed();
     }
 
-  bool any_stub_table_changed = false;
-  for (Stub_table_iterator siter = this->stub_tables_.begin();
-       siter != this->stub_tables_.end() && !any_stub_table_changed; ++siter)
+  size_t scanned = 0;
+  size_t skipped = 0;
+  for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
+       op != input_objects->relobj_end();
+       ++op)
     {
-      The_stub_table* stub_table = *siter;
-      if (stub_table->update_data_size_changed_p())
-	{
-	  The_aarch64_input_section* owner = stub_table->owner();
-	  uint64_t address = owner->address();
-	  off_t offset = owner->offset();
-	  owner->reset_address_and_file_offset();
-	  owner->set_address_and_file_offset(address, offset);
-
-	  any_stub_table_changed = true;
-	}
+      const Stub_scan_sections<size>* stub_scan =
+	static_cast<The_aarch64_relobj*>(*op)->stub_scan();
+      scanned += stub_scan->scanned_count();
+      skipped += stub_scan->skipped_count();
     }
+  scan_pass->finish(scanned, skipped);
 
   // Do not continue relaxation.
   bool continue_relaxation = any_stub_table_changed;
@@ -8377,6 +8838,29 @@ Target_aarch64<size, big_endian>::create_erratum_stub(
     unsigned int e843419_adrp_offset)
 {
   gold_assert(erratum_type == ST_E_843419 || erratum_type == ST_E_835769);
+  if (relobj->defers_stubs())
+    {
+      typename The_aarch64_relobj::Erratum_stub_request request;
+      request.shndx = shndx;
+      request.erratum_insn_offset = erratum_insn_offset;
+      request.erratum_address = erratum_address;
+      request.erratum_insn = erratum_insn;
+      request.erratum_type = erratum_type;
+      request.e843419_adrp_offset = e843419_adrp_offset;
+      relobj->add_erratum_stub_request(request);
+      return;
+    }
+
+  if (erratum_type == ST_E_835769)
+    {
+      // ERRATUM_INSN_OFFSET is the offset of the second insn.
+      const int BPI = AArch64_insn_utilities<big_endian>::BYTES_PER_INSN;
+      gold_info(_("Erratum 835769 found and fixed at \"%s\", "
+		  "section %d, offset 0x%08x."),
+		relobj->name().c_str(), shndx,
+		(unsigned int)(erratum_insn_offset - BPI));
+    }
+
   The_stub_table* stub_table = relobj->stub_table(shndx);
   gold_assert(stub_table != NULL);
   if (stub_table->find_erratum_stub(relobj,
@@ -8441,11 +8925,6 @@ Target_aarch64<size, big_endian>::scan_erratum_835769_span(
 	  // "span_start + offset + BPI".
 	  section_size_type erratum_insn_offset = span_start + offset + BPI;
 	  Address erratum_address = output_address + offset + BPI;
-	  gold_info(_("Erratum 835769 found and fixed at \"%s\", "
-			 "section %d, offset 0x%08x."),
-		       relobj->name().c_str(), shndx,
-		       (unsigned int)(span_start + offset));
-
 	  this->create_erratum_stub(relobj, shndx,
 				    erratum_insn_offset, erratum_address,
 				    erratum_insn, ST_E_835769);
@@ -26,6 +26,14 @@
 #include <cstring>
 #include <climits>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 #include "libiberty.h"
 #include "filenames.h"
 
@@ -178,6 +186,8 @@ struct Archive::Archive_header
 unsigned int Archive::total_archives;
 unsigned int Archive::total_members;
 unsigned int Archive::total_members_loaded;
+unsigned int Archive::total_armap_cache_hits;
+unsigned int Archive::total_armap_cache_misses;
 
 // Archive methods.
 
@@ -197,8 +207,11 @@ const char Archive::sym64name[7] = { '/', 'S', 'Y', 'M', '6', '4', '/' };
 
 Archive::Archive(const std::string& name, Input_file* input_file,
                  bool is_thin_archive, Dirsearch* dirpath, Task* task)
-  : Library_base(task), name_(name), input_file_(input_file), armap_(),
-    armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
+  : Library_base(task), name_(name), input_file_(input_file), armap_(NULL),
+    armap_size_(0), armap_names_(NULL), armap_names_size_(0),
+    armap_entries_(), armap_strings_(), armap_cache_view_(NULL),
+    armap_cache_view_size_(0), armap_cache_status_(ARMAP_CACHE_UNUSED),
+    extended_names_(), armap_checked_(), seen_offsets_(),
     members_(), is_thin_archive_(is_thin_archive), included_member_(false),
     nested_archives_(), dirpath_(dirpath), num_members_(0),
     included_all_members_(false)
@@ -207,6 +220,52 @@ Archive::Archive(const std::string& name, Input_file* input_file,
     parameters->options().check_excluded_libs(input_file->found_name());
 }
 
+Archive::~Archive()
+{
+#ifdef HAVE_MMAP
+  if (this->armap_cache_view_ != NULL)
+    ::munmap(this->armap_cache_view_, this->armap_cache_view_size_);
+#endif
+}
+
+// The header of an --archive-cache file.  The file holds the archive
+// map of one archive in the form in which the Archive class uses it,
+// so that it can be mapped and used in place.  The header is followed
+// by SYMBOL_COUNT Armap_entry structures, and then by the
+// null-terminated symbol names.  Everything is in host byte order.
+
+struct Archive::Armap_cache_header
+{
+  // The magic string, armap_cache_magic.
+  char magic[8];
+  // The format version, which also checks the byte order.
+  uint32_t version;
+  // The size of off_t, which determines the size of Armap_entry.
+  uint32_t off_t_size;
+  // The device, inode, size and modification time of the archive.
+  uint64_t device;
+  uint64_t inode;
+  uint64_t archive_size;
+  int64_t mtime_seconds;
+  int64_t mtime_nanoseconds;
+  // The number of entries in the archive map.
+  uint64_t symbol_count;
+  // The number of archive members.
+  uint64_t member_count;
+  // The size of the symbol names.
+  uint64_t names_size;
+  // The member header of the archive map in the archive, which holds
+  // its size and the time at which it was written.
+  char armap_header[sizeof(Archive_header)];
+};
+
+static const char armap_cache_magic[8] =
+{
+  'G', 'O', 'L', 'D', 'A', 'R', 'M', 'P'
+};
+
+static const uint32_t armap_cache_version = 2;
+
 // Set up the archive: read the symbol map and the extended name
 // table.
 
@@ -225,15 +284,36 @@ Archive::setup()
 
   section_size_type armap_size = convert_to_section_size_type(header_size);
   off_t off = sarmag;
-  if (armap_name.empty())
+  if (armap_name.empty() || armap_name == "/SYM64/")
     {
-      this->read_armap<32>(sarmag + sizeof(Archive_header), armap_size);
-      off = sarmag + sizeof(Archive_header) + armap_size;
-    }
-  else if (armap_name == "/SYM64/")
-    {
-      this->read_armap<64>(sarmag + sizeof(Archive_header), armap_size);
-      off = sarmag + sizeof(Archive_header) + armap_size;
+      off_t armap_start = sarmag + sizeof(Archive_header);
+
+      // With --archive-cache, use the archive map from the cache if
+      // it was written for this archive; otherwise read it and write
+      // the cache.  The archive map itself is only read on a miss.
+      bool use_cache = false;
+      Armap_cache_header key;
+#ifdef HAVE_MMAP
+      use_cache = (parameters->options().archive_cache() != NULL
+		   && armap_size > 0
+		   && this->armap_cache_key(&key));
+#endif
+      if (use_cache && this->read_armap_cache(key))
+	this->armap_cache_status_ = ARMAP_CACHE_HIT;
+      else
+	{
+	  if (armap_name.empty())
+	    this->read_armap<32>(armap_start, armap_size);
+	  else
+	    this->read_armap<64>(armap_start, armap_size);
+	  if (use_cache)
+	    {
+	      this->write_armap_cache(key);
+	      this->armap_cache_status_ = ARMAP_CACHE_MISS;
+	    }
+	}
+
+      off = armap_start + armap_size;
     }
   else if (!this->input_file_->options().whole_archive())
     gold_error(_("%s: no archive symbol table (run ranlib)"),
@@ -308,21 +388,21 @@ Archive::read_armap(off_t start, section_size_type size)
   const char* pnames = reinterpret_cast<const char*>(pword + nsyms);
   section_size_type names_size =
     reinterpret_cast<const char*>(p) + size - pnames;
-  this->armap_names_.assign(pnames, names_size);
+  this->armap_strings_.assign(pnames, names_size);
 
-  this->armap_.resize(nsyms);
+  this->armap_entries_.resize(nsyms);
 
   section_offset_type name_offset = 0;
   for (unsigned long i = 0; i < nsyms; ++i)
     {
-      this->armap_[i].name_offset = name_offset;
-      this->armap_[i].file_offset = convert_types<off_t, Entry_type>(
+      this->armap_entries_[i].name_offset = name_offset;
+      this->armap_entries_[i].file_offset = convert_types<off_t, Entry_type>(
         elfcpp::Swap<mapsize, true>::readval(pword));
       name_offset += strlen(pnames + name_offset) + 1;
       ++pword;
-      if (this->armap_[i].file_offset != last_seen_offset)
+      if (this->armap_entries_[i].file_offset != last_seen_offset)
         {
-          last_seen_offset = this->armap_[i].file_offset;
+          last_seen_offset = this->armap_entries_[i].file_offset;
           ++this->num_members_;
         }
     }
@@ -331,11 +411,208 @@ Archive::read_armap(off_t start, section_size_type size)
     gold_error(_("%s: bad archive symbol table names"),
 	       this->name().c_str());
 
+  this->armap_ = nsyms == 0 ? NULL : &this->armap_entries_[0];
+  this->armap_size_ = nsyms;
+  this->armap_names_ = this->armap_strings_.data();
+  this->armap_names_size_ = names_size;
+
   // This array keeps track of which symbols are for archive elements
   // which we have already included in the link.
   this->armap_checked_.resize(nsyms);
 }
 
+// Return the name of the --archive-cache file for this archive.  The
+// name includes a checksum of the full path name of the archive, so
+// that archives with the same name in different directories do not
+// share a file.
+
+std::string
+Archive::armap_cache_name() const
+{
+  char* real = lrealpath(this->filename().c_str());
+  std::string path(real);
+  free(real);
+
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(path.data());
+  char buf[40];
+  snprintf(buf, sizeof buf, "-%08x%08x.armap",
+	   static_cast<unsigned int>(xcrc32(p, path.length(), 0xffffffff)),
+	   static_cast<unsigned int>(xcrc32(p, path.length(), 0)));
+
+  std::string ret(parameters->options().archive_cache());
+  if (!ret.empty() && !IS_DIR_SEPARATOR(ret[ret.length() - 1]))
+    ret += '/';
+  ret += lbasename(path.c_str());
+  ret += buf;
+  return ret;
+}
+
+// Set the fields of *HDR which identify the archive.  The archive map
+// header includes the size of the archive map and the time at which
+// ar or ranlib wrote it, so it catches an archive which was rewritten
+// in place within the resolution of the modification time.
+
+bool
+Archive::armap_cache_key(Armap_cache_header* hdr)
+{
+  struct stat st;
+  if (::fstat(this->file().descriptor(), &st) < 0)
+    return false;
+
+  Timespec mtime = this->file().get_mtime();
+  memset(hdr, 0, sizeof *hdr);
+  memcpy(hdr->magic, armap_cache_magic, sizeof armap_cache_magic);
+  hdr->version = armap_cache_version;
+  hdr->off_t_size = sizeof(off_t);
+  hdr->device = st.st_dev;
+  hdr->inode = st.st_ino;
+  hdr->archive_size = this->file().filesize();
+  hdr->mtime_seconds = mtime.seconds;
+  hdr->mtime_nanoseconds = mtime.nanoseconds;
+  const unsigned char* p = this->get_view(sarmag, sizeof(Archive_header),
+					  true, false);
+  memcpy(hdr->armap_header, p, sizeof(Archive_header));
+  return true;
+}
+
+// Read the archive map from the --archive-cache file, if it was
+// written for the archive identified by KEY: the archive must have
+// the same device, inode, size and modification time, and the same
+// archive map header, as when the cache file was written.
+
+bool
+Archive::read_armap_cache(const Armap_cache_header& key)
+{
+#ifdef HAVE_MMAP
+  std::string cache_name = this->armap_cache_name();
+  int fd = ::open(cache_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (::fstat(fd, &st) < 0
+      || st.st_size < static_cast<off_t>(sizeof(Armap_cache_header)))
+    {
+      ::close(fd);
+      return false;
+    }
+
+  size_t view_size = st.st_size;
+  void* view = ::mmap(NULL, view_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED)
+    return false;
+
+  const Armap_cache_header* hdr =
+    static_cast<const Armap_cache_header*>(view);
+  const uint64_t max_symbols = ((view_size - sizeof(Armap_cache_header))
+				/ sizeof(Armap_entry));
+  bool ok = (memcmp(hdr->magic, key.magic, sizeof key.magic) == 0
+	     && hdr->version == key.version
+	     && hdr->off_t_size == key.off_t_size
+	     && hdr->device == key.device
+	     && hdr->inode == key.inode
+	     && hdr->archive_size == key.archive_size
+	     && hdr->mtime_seconds == key.mtime_seconds
+	     && hdr->mtime_nanoseconds == key.mtime_nanoseconds
+	     && memcmp(hdr->armap_header, key.armap_header,
+		       sizeof key.armap_header) == 0
+	     && hdr->symbol_count <= max_symbols
+	     && (sizeof(Armap_cache_header)
+		 + hdr->symbol_count * sizeof(Armap_entry)
+		 + hdr->names_size) == view_size);
+
+  const unsigned char* pview = static_cast<const unsigned char*>(view);
+  const Armap_entry* entries =
+    reinterpret_cast<const Armap_entry*>(pview + sizeof(Armap_cache_header));
+  const char* names =
+    reinterpret_cast<const char*>(entries + (ok ? hdr->symbol_count : 0));
+  if (ok && hdr->symbol_count > 0)
+    ok = hdr->names_size > 0 && names[hdr->names_size - 1] == '\0';
+  for (uint64_t i = 0; ok && i < hdr->symbol_count; ++i)
+    ok = (entries[i].name_offset >= 0
+	  && static_cast<uint64_t>(entries[i].name_offset) < hdr->names_size
+	  && entries[i].file_offset > 0
+	  && entries[i].file_offset < this->file().filesize());
+
+  if (!ok)
+    {
+      ::munmap(view, view_size);
+      return false;
+    }
+
+  this->armap_cache_view_ = view;
+  this->armap_cache_view_size_ = view_size;
+  this->armap_ = hdr->symbol_count == 0 ? NULL : entries;
+  this->armap_size_ = hdr->symbol_count;
+  this->armap_names_ = names;
+  this->armap_names_size_ = hdr->names_size;
+  this->num_members_ = hdr->member_count;
+  this->armap_checked_.resize(this->armap_size_);
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Write the archive map to the --archive-cache file for the archive
+// identified by KEY.  We write a temporary file and rename it, so that
+// links running at the same time never see a partial file.
+
+void
+Archive::write_armap_cache(const Armap_cache_header& key)
+{
+  Armap_cache_header hdr = key;
+  hdr.symbol_count = this->armap_size_;
+  hdr.member_count = this->num_members_;
+  hdr.names_size = this->armap_names_size_;
+
+  std::string cache_name = this->armap_cache_name();
+  char pid[30];
+  snprintf(pid, sizeof pid, ".%ld", static_cast<long>(getpid()));
+  std::string tmp_name = cache_name + pid;
+
+  int fd = ::open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      gold_warning(_("cannot write archive cache %s: %s"),
+		   tmp_name.c_str(), strerror(errno));
+      return;
+    }
+
+  const void* pieces[3] = { &hdr, this->armap_, this->armap_names_ };
+  size_t sizes[3] = { sizeof hdr, this->armap_size_ * sizeof(Armap_entry),
+		      this->armap_names_size_ };
+  bool ok = true;
+  for (int i = 0; ok && i < 3; ++i)
+    {
+      const char* p = static_cast<const char*>(pieces[i]);
+      size_t len = sizes[i];
+      while (ok && len > 0)
+	{
+	  ssize_t written = ::write(fd, p, len);
+	  if (written <= 0)
+	    ok = false;
+	  else
+	    {
+	      p += written;
+	      len -= written;
+	    }
+	}
+    }
+
+  if (::close(fd) < 0)
+    ok = false;
+  if (ok && ::rename(tmp_name.c_str(), cache_name.c_str()) < 0)
+    ok = false;
+  if (!ok)
+    {
+      gold_warning(_("cannot write archive cache %s: %s"),
+		   cache_name.c_str(), strerror(errno));
+      ::unlink(tmp_name.c_str());
+    }
+}
+
 // Read the header of an archive member at OFF.  Fail if something
 // goes wrong.  Return the size of the member.  Set *PNAME to the name
 // of the member.
@@ -772,6 +1049,10 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 		     Input_objects* input_objects, Mapfile* mapfile)
 {
   ++Archive::total_archives;
+  if (this->armap_cache_status_ == ARMAP_CACHE_HIT)
+    ++Archive::total_armap_cache_hits;
+  else if (this->armap_cache_status_ == ARMAP_CACHE_MISS)
+    ++Archive::total_armap_cache_misses;
 
   if (this->input_file_->options().whole_archive())
     return this->include_all_members(symtab, layout, input_objects,
@@ -781,7 +1062,7 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 
   input_objects->archive_start(this);
 
-  const size_t armap_size = this->armap_.size();
+  const size_t armap_size = this->armap_size_;
 
   // This is a quick optimization, since we usually see many symbols
   // in a row with the same offset.  last_seen_offset holds the last
@@ -814,7 +1095,7 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 	      continue;
 	    }
 
-	  const char* sym_name = (this->armap_names_.data()
+	  const char* sym_name = (this->armap_names_
 				  + this->armap_[i].name_offset);
 
           Symbol* sym;
@@ -864,12 +1145,12 @@ Archive::defines_symbol(Symbol* sym) const
 {
   const char* symname = sym->name();
   size_t symname_len = strlen(symname);
-  size_t armap_size = this->armap_.size();
+  size_t armap_size = this->armap_size_;
   for (size_t i = 0; i < armap_size; ++i)
     {
       if (this->armap_checked_[i])
 	continue;
-      const char* archive_symname = (this->armap_names_.data()
+      const char* archive_symname = (this->armap_names_
 				     + this->armap_[i].name_offset);
       if (strncmp(archive_symname, symname, symname_len) != 0)
 	continue;
@@ -1066,13 +1347,12 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
 void
 Archive::do_for_all_unused_symbols(Symbol_visitor_base* v) const
 {
-  for (std::vector<Armap_entry>::const_iterator p = this->armap_.begin();
-       p != this->armap_.end();
-       ++p)
+  for (size_t i = 0; i < this->armap_size_; ++i)
     {
+      const Armap_entry* p = &this->armap_[i];
       if (this->seen_offsets_.find(p->file_offset)
           == this->seen_offsets_.end())
-        v->visit(this->armap_names_.data() + p->name_offset);
+        v->visit(this->armap_names_ + p->name_offset);
     }
 }
 
@@ -1087,6 +1367,10 @@ Archive::print_stats()
           program_name, Archive::total_members);
   fprintf(stderr, _("%s: loaded archive members: %u\n"),
           program_name, Archive::total_members_loaded);
+  if (parameters->options().archive_cache() != NULL)
+    fprintf(stderr, _("%s: archive cache hits: %u misses: %u\n"),
+	    program_name, Archive::total_armap_cache_hits,
+	    Archive::total_armap_cache_misses);
 }
 
 // Add_archive_symbols methods.
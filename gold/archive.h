@@ -165,6 +165,8 @@ class Archive : public Library_base
   Archive(const std::string& name, Input_file* input_file,
           bool is_thin_archive, Dirsearch* dirpath, Task* task);
 
+  ~Archive();
+
   // The length of the magic string at the start of an archive.
   static const int sarmag = 8;
 
@@ -279,6 +281,20 @@ class Archive : public Library_base
   { return this->file().get_mtime(); }
 
   struct Archive_header;
+  struct Armap_cache_header;
+
+  // Whether the archive map was found in the --archive-cache
+  // directory.
+  enum Armap_cache_status
+  {
+    // --archive-cache was not used.
+    ARMAP_CACHE_UNUSED,
+    // The archive map was read from the cache.
+    ARMAP_CACHE_HIT,
+    // The archive map was read from the archive, and written to the
+    // cache.
+    ARMAP_CACHE_MISS
+  };
 
   // Total number of archives seen.
   static unsigned int total_archives;
@@ -286,6 +302,9 @@ class Archive : public Library_base
   static unsigned int total_members;
   // Number of archive members loaded.
   static unsigned int total_members_loaded;
+  // Number of archive maps read from and written to the cache.
+  static unsigned int total_armap_cache_hits;
+  static unsigned int total_armap_cache_misses;
 
   // Get a view into the underlying file.
   const unsigned char*
@@ -297,6 +316,27 @@ class Archive : public Library_base
   void
   read_armap(off_t start, section_size_type size);
 
+  // Return the name of the file in the --archive-cache directory for
+  // this archive.
+  std::string
+  armap_cache_name() const;
+
+  // Set the fields of *HDR which identify this archive: its device,
+  // inode, size and modification time, and the header of its archive
+  // map.  Return false if the archive can not be identified.
+  bool
+  armap_cache_key(Armap_cache_header* hdr);
+
+  // Read the archive symbol map from the cache, if the cache was
+  // written for the archive identified by KEY.  Return true if it was
+  // read.
+  bool
+  read_armap_cache(const Armap_cache_header& key);
+
+  // Write the archive symbol map to the cache, identified by KEY.
+  void
+  write_armap_cache(const Armap_cache_header& key);
+
   // Read an archive member header at OFF.  CACHE is whether to cache
   // the file view.  Return the size of the member, and set *PNAME to
   // the name.
@@ -384,10 +424,24 @@ class Archive : public Library_base
   std::string name_;
   // For reading the file.
   Input_file* input_file_;
-  // The archive map.
-  std::vector<Armap_entry> armap_;
-  // The names in the archive map.
-  std::string armap_names_;
+  // The archive map.  This points either into armap_entries_ or
+  // into the cache file.
+  const Armap_entry* armap_;
+  // The number of entries in the archive map.
+  size_t armap_size_;
+  // The names in the archive map.  This points either into
+  // armap_strings_ or into the cache file.
+  const char* armap_names_;
+  // The size of the names.
+  section_size_type armap_names_size_;
+  // The archive map and names, when read from the archive.
+  std::vector<Armap_entry> armap_entries_;
+  std::string armap_strings_;
+  // The mapped cache file, if the archive map came from the cache.
+  void* armap_cache_view_;
+  size_t armap_cache_view_size_;
+  // Whether the archive map came from the cache.
+  Armap_cache_status armap_cache_status_;
   // The extended name table.
   std::string extended_names_;
   // Track which symbols in the archive map are for elements which are
@@ -43,9 +43,11 @@
 #include "layout.h"
 #include "output.h"
 #include "copy-relocs.h"
+#include "workqueue.h"
 #include "target.h"
 #include "target-reloc.h"
 #include "target-select.h"
+#include "stub-scan.h"
 #include "tls.h"
 #include "defstd.h"
 #include "gc.h"
@@ -502,6 +504,11 @@ class Reloc_stub : public Stub
   stub_type_for_reloc(unsigned int r_type, Arm_address branch_address,
 		      Arm_address branch_target, bool target_is_thumb);
 
+  // Return how far the offset of a branch from BRANCH_ADDRESS to
+  // BRANCH_TARGET may change before the stub type for it may change.
+  static uint64_t
+  stub_type_slack(Arm_address branch_address, Arm_address branch_target);
+
   // Reloc_stub key.  A key is logically a triplet of a stub type, a symbol
   // and an addend.  Since we treat global and local symbol differently, we
   // use a Symbol object for a global symbol and a object-index pair for
@@ -1491,6 +1498,27 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
  public:
   static const Arm_address invalid_address = static_cast<Arm_address>(-1);
 
+  // A relocation stub found while scanning in parallel.
+  struct Reloc_stub_request
+  {
+    Stub_table<big_endian>* stub_table;
+    Stub_type stub_type;
+    const Symbol* gsym;
+    unsigned int r_sym;
+    int32_t addend;
+    Arm_address destination;
+  };
+
+  // An ARM V4BX stub found while scanning in parallel.
+  struct Arm_v4bx_stub_request
+  {
+    Stub_table<big_endian>* stub_table;
+    uint32_t reg;
+  };
+
+  typedef std::vector<Reloc_stub_request> Reloc_stub_requests;
+  typedef std::vector<Arm_v4bx_stub_request> Arm_v4bx_stub_requests;
+
   Arm_relobj(const std::string& name, Input_file* input_file, off_t offset,
 	     const typename elfcpp::Ehdr<32, big_endian>& ehdr)
     : Sized_relobj_file<32, big_endian>(name, input_file, offset, ehdr),
@@ -1498,7 +1526,9 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
       attributes_section_data_(NULL), mapping_symbols_info_(),
       section_has_cortex_a8_workaround_(NULL), exidx_section_map_(),
       output_local_symbol_count_needs_update_(false),
-      merge_flags_and_attributes_(true)
+      merge_flags_and_attributes_(true), stub_scan_(), reloc_scan_list_(),
+      defer_stubs_(false), needs_serial_stub_scan_(false),
+      reloc_stub_requests_(), arm_v4bx_stub_requests_()
   { }
 
   ~Arm_relobj()
@@ -1529,10 +1559,71 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
     return this->local_symbol_is_thumb_function_[r_sym];
   }
 
-  // Scan all relocation sections for stub generation.
+  // Choose the sections to scan in PASS, and scan them for stub
+  // generation.
   void
   scan_sections_for_stubs(Target_arm<big_endian>*, const Symbol_table*,
-			  const Layout*);
+			  const Layout*, const Stub_scan_pass<32>*);
+
+  // Scan the sections chosen by scan_sections_for_stubs.  This is
+  // also used to scan them again serially.
+  void
+  rescan_sections_for_stubs(Target_arm<big_endian>*, const Symbol_table*,
+			    const Layout*, const Stub_scan_pass<32>*);
+
+  // Return the state of the sections for stub scanning.
+  Stub_scan_sections<32>*
+  stub_scan()
+  { return &this->stub_scan_; }
+
+  // Whether the stubs found are recorded as requests instead of being
+  // added to the stub tables.  This is set while objects are scanned
+  // in parallel, since the stub tables are shared by the objects.
+  bool
+  defers_stubs() const
+  { return this->defer_stubs_; }
+
+  void
+  set_defers_stubs(bool defer)
+  { this->defer_stubs_ = defer; }
+
+  // Whether scanning in parallel found a branch to a symbol whose
+  // value may only be computed when no other object is being scanned.
+  // The requests are then discarded and the object is scanned again.
+  bool
+  needs_serial_stub_scan() const
+  { return this->needs_serial_stub_scan_; }
+
+  void
+  set_needs_serial_stub_scan(bool needs)
+  { this->needs_serial_stub_scan_ = needs; }
+
+  // Record a request for a relocation stub.
+  void
+  add_reloc_stub_request(const Reloc_stub_request& request)
+  { this->reloc_stub_requests_.push_back(request); }
+
+  // Record a request for an ARM V4BX stub.
+  void
+  add_arm_v4bx_stub_request(const Arm_v4bx_stub_request& request)
+  { this->arm_v4bx_stub_requests_.push_back(request); }
+
+  // Return the requests.
+  const Reloc_stub_requests&
+  reloc_stub_requests() const
+  { return this->reloc_stub_requests_; }
+
+  const Arm_v4bx_stub_requests&
+  arm_v4bx_stub_requests() const
+  { return this->arm_v4bx_stub_requests_; }
+
+  // Discard the requests.
+  void
+  clear_stub_requests()
+  {
+    this->reloc_stub_requests_.clear();
+    this->arm_v4bx_stub_requests_.clear();
+  }
 
   // Convert regular input section with index SHNDX to a relaxed section.
   void
@@ -1763,6 +1854,17 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
   // Whether we merge processor flags and attributes of this object to
   // output.
   bool merge_flags_and_attributes_;
+  // The state of the sections for stub scanning.
+  Stub_scan_sections<32> stub_scan_;
+  // The relocation sections to scan for stubs in this pass.
+  std::vector<unsigned int> reloc_scan_list_;
+  // Whether stubs are recorded as requests.
+  bool defer_stubs_;
+  // Whether the object must be scanned again serially.
+  bool needs_serial_stub_scan_;
+  // The stubs found while scanning in parallel, in the order found.
+  Reloc_stub_requests reloc_stub_requests_;
+  Arm_v4bx_stub_requests arm_v4bx_stub_requests_;
 };
 
 // Arm_dynobj class.
@@ -2131,7 +2233,8 @@ class Target_arm : public Sized_target<32, big_endian>
       fix_cortex_a8_(false), cortex_a8_relocs_info_(),
       target1_reloc_(elfcpp::R_ARM_ABS32),
       // This can be any reloc type but usually is R_ARM_GOT_PREL.
-      target2_reloc_(elfcpp::R_ARM_GOT_PREL)
+      target2_reloc_(elfcpp::R_ARM_GOT_PREL),
+      stub_scan_pass_(), stub_scan_groups_()
   { }
 
   // Whether we force PCI branch veneers.
@@ -2526,7 +2629,13 @@ class Target_arm : public Sized_target<32, big_endian>
   { return !parameters->options().relocatable(); }
 
   bool
-  do_relax(int, const Input_objects*, Symbol_table*, Layout*, const Task*);
+  do_relax(int, const Input_objects*, Symbol_table*, Layout*, Workqueue*,
+	   const Task*);
+
+  // Print statistics about relaxation.
+  void
+  do_print_stats() const
+  { this->stub_scan_pass_.print_stats(); }
 
   // Determine whether an object attribute tag takes an integer, a
   // string or both.
@@ -2954,6 +3063,28 @@ class Target_arm : public Sized_target<32, big_endian>
       elfcpp::Elf_types<32>::Elf_Addr view_address,
       section_size_type);
 
+  // Add a relocation stub to a stub table, unless it has one already.
+  Reloc_stub*
+  add_reloc_stub(Stub_table<big_endian>*, Stub_type, const Symbol*,
+		 const Relobj*, unsigned int, int32_t, Arm_address);
+
+  // Add an ARM V4BX stub to a stub table, unless it has one already.
+  void
+  add_arm_v4bx_stub(Stub_table<big_endian>*, uint32_t);
+
+  // Add the stubs requested while scanning an object in parallel.
+  void
+  add_requested_stubs(Arm_relobj<big_endian>*);
+
+  // Scan all the objects for stubs in the current relaxation pass.
+  void
+  scan_for_stubs(const Input_objects*, const Symbol_table*, const Layout*,
+		 Workqueue*, const Task*);
+
+  // Return whether any stub table changed size in this pass.
+  bool
+  stub_tables_changed(const Layout*);
+
   // Fix .ARM.exidx section coverage.
   void
   fix_exidx_coverage(Layout*, const Input_objects*,
@@ -3034,6 +3165,10 @@ class Target_arm : public Sized_target<32, big_endian>
   // What R_ARM_TARGET2 maps to. It should be one of R_ARM_REL32, R_ARM_ABS32
   // and R_ARM_GOT_PREL.
   unsigned int target2_reloc_;
+  // The state of the current relaxation pass.
+  Stub_scan_pass<32> stub_scan_pass_;
+  // The groups of objects which are scanned for stubs in parallel.
+  std::vector<std::vector<Relobj*> > stub_scan_groups_;
 };
 
 template<bool big_endian>
@@ -4786,6 +4921,29 @@ Reloc_stub::stub_type_for_reloc(
   return stub_type;
 }
 
+// Return how far the offset of a branch from LOCATION to DESTINATION may
+// change before stub_type_for_reloc may return a different type.
+
+uint64_t
+Reloc_stub::stub_type_slack(Arm_address location, Arm_address destination)
+{
+  int64_t branch_offset = static_cast<int64_t>(destination) - location;
+  const int64_t limits[] =
+  {
+    ARM_MAX_FWD_BRANCH_OFFSET + 2, ARM_MAX_FWD_BRANCH_OFFSET,
+    ARM_MAX_BWD_BRANCH_OFFSET,
+    THM_MAX_FWD_BRANCH_OFFSET, THM_MAX_BWD_BRANCH_OFFSET,
+    THM2_MAX_FWD_BRANCH_OFFSET, THM2_MAX_BWD_BRANCH_OFFSET
+  };
+  uint64_t slack =
+    Stub_scan_sections<32>::slack(branch_offset, limits,
+				  sizeof(limits) / sizeof(limits[0]));
+
+  // A THUMB BLX takes bit 1 of the destination from the location, which
+  // changes the offset by up to two bytes.
+  return slack > 4 ? slack - 4 : 0;
+}
+
 // Cortex_a8_stub methods.
 
 // Return the instruction for a THUMB16_SPECIAL_TYPE instruction template.
@@ -6390,15 +6548,57 @@ Arm_relobj<big_endian>::scan_section_for_cortex_a8_erratum(
     }
 }
 
-// Scan relocations for stub generation.
+// Choose the relocation sections to scan for stub generation in PASS,
+// and scan them.  A relocation section is scanned if its branches may
+// need different stubs.
 
 template<bool big_endian>
 void
 Arm_relobj<big_endian>::scan_sections_for_stubs(
     Target_arm<big_endian>* arm_target,
     const Symbol_table* symtab,
-    const Layout* layout)
+    const Layout* layout,
+    const Stub_scan_pass<32>* pass)
+{
+  unsigned int shnum = this->shnum();
+  const unsigned int shdr_size = elfcpp::Elf_sizes<32>::shdr_size;
+
+  // Read the section headers.
+  const unsigned char* pshdrs = this->get_view(this->elf_file()->shoff(),
+					       shnum * shdr_size,
+					       true, true);
+
+  const Relobj::Output_sections& out_sections(this->output_sections());
+
+  this->reloc_scan_list_.clear();
+  const unsigned char* p = pshdrs + shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
+    {
+      const elfcpp::Shdr<32, big_endian> shdr(p);
+      if (this->section_needs_reloc_stub_scanning(shdr, out_sections, symtab,
+						  pshdrs)
+	  && this->stub_scan_.needs_scan(this->adjust_shndx(shdr.get_sh_info()),
+					 pass))
+	this->reloc_scan_list_.push_back(i);
+    }
+
+  this->rescan_sections_for_stubs(arm_target, symtab, layout, pass);
+}
+
+// Scan the relocation sections chosen by scan_sections_for_stubs for
+// stub generation, and scan for the Cortex-A8 erratum.
+
+template<bool big_endian>
+void
+Arm_relobj<big_endian>::rescan_sections_for_stubs(
+    Target_arm<big_endian>* arm_target,
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const Stub_scan_pass<32>* pass)
 {
+  if (this->reloc_scan_list_.empty() && !arm_target->fix_cortex_a8())
+    return;
+
   unsigned int shnum = this->shnum();
   const unsigned int shdr_size = elfcpp::Elf_sizes<32>::shdr_size;
 
@@ -6419,65 +6619,69 @@ Arm_relobj<big_endian>::scan_sections_for_stubs(
   relinfo.object = this;
 
   // Do relocation stubs scanning.
-  const unsigned char* p = pshdrs + shdr_size;
-  for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
-    {
-      const elfcpp::Shdr<32, big_endian> shdr(p);
-      if (this->section_needs_reloc_stub_scanning(shdr, out_sections, symtab,
-						  pshdrs))
+  for (std::vector<unsigned int>::const_iterator pi =
+	 this->reloc_scan_list_.begin();
+       pi != this->reloc_scan_list_.end();
+       ++pi)
+    {
+      unsigned int i = *pi;
+      const elfcpp::Shdr<32, big_endian> shdr(pshdrs + i * shdr_size);
+      unsigned int index = this->adjust_shndx(shdr.get_sh_info());
+      Arm_address output_offset = this->get_output_section_offset(index);
+      Arm_address output_address;
+      if (output_offset != invalid_address)
+	output_address = out_sections[index]->address() + output_offset;
+      else
 	{
-	  unsigned int index = this->adjust_shndx(shdr.get_sh_info());
-	  Arm_address output_offset = this->get_output_section_offset(index);
-	  Arm_address output_address;
-	  if (output_offset != invalid_address)
-	    output_address = out_sections[index]->address() + output_offset;
-	  else
-	    {
-	      // Currently this only happens for a relaxed section.
-	      const Output_relaxed_input_section* poris =
-	      out_sections[index]->find_relaxed_input_section(this, index);
-	      gold_assert(poris != NULL);
-	      output_address = poris->address();
-	    }
-
-	  // Get the relocations.
-	  const unsigned char* prelocs = this->get_view(shdr.get_sh_offset(),
-							shdr.get_sh_size(),
-							true, false);
-
-	  // Get the section contents.  This does work for the case in which
-	  // we modify the contents of an input section.  We need to pass the
-	  // output view under such circumstances.
-	  section_size_type input_view_size = 0;
-	  const unsigned char* input_view =
-	    this->section_contents(index, &input_view_size, false);
-
-	  relinfo.reloc_shndx = i;
-	  relinfo.data_shndx = index;
-	  unsigned int sh_type = shdr.get_sh_type();
-	  unsigned int reloc_size;
-	  if (sh_type == elfcpp::SHT_REL)
-	    reloc_size = elfcpp::Elf_sizes<32>::rel_size;
-	  else
-	    reloc_size = elfcpp::Elf_sizes<32>::rela_size;
-
-	  Output_section* os = out_sections[index];
-	  arm_target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
-					     shdr.get_sh_size() / reloc_size,
-					     os,
-					     output_offset == invalid_address,
-					     input_view, output_address,
-					     input_view_size);
+	  // Currently this only happens for a relaxed section.
+	  const Output_relaxed_input_section* poris =
+	  out_sections[index]->find_relaxed_input_section(this, index);
+	  gold_assert(poris != NULL);
+	  output_address = poris->address();
 	}
+
+      // Get the relocations.
+      const unsigned char* prelocs = this->get_view(shdr.get_sh_offset(),
+						    shdr.get_sh_size(),
+						    true, false);
+
+      // Get the section contents.  This does work for the case in which
+      // we modify the contents of an input section.  We need to pass the
+      // output view under such circumstances.
+      section_size_type input_view_size = 0;
+      const unsigned char* input_view =
+	this->section_contents(index, &input_view_size, false);
+
+      relinfo.reloc_shndx = i;
+      relinfo.data_shndx = index;
+      unsigned int sh_type = shdr.get_sh_type();
+      unsigned int reloc_size;
+      if (sh_type == elfcpp::SHT_REL)
+	reloc_size = elfcpp::Elf_sizes<32>::rel_size;
+      else
+	reloc_size = elfcpp::Elf_sizes<32>::rela_size;
+
+      this->stub_scan_.start_scan(index, pass);
+      Output_section* os = out_sections[index];
+      arm_target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
+					 shdr.get_sh_size() / reloc_size,
+					 os,
+					 output_offset == invalid_address,
+					 input_view, output_address,
+					 input_view_size);
+      if (this->needs_serial_stub_scan_)
+	break;
     }
 
   // Do Cortex-A8 erratum stubs scanning.  This has to be done for a section
   // after its relocation section, if there is one, is processed for
   // relocation stubs.  Merging this loop with the one above would have been
   // complicated since we would have had to make sure that relocation stub
-  // scanning is done first.
+  // scanning is done first.  The objects are always scanned serially when
+  // fixing the Cortex-A8 erratum.
   if (arm_target->fix_cortex_a8())
     {
+      gold_assert(!this->defer_stubs_);
       const unsigned char* p = pshdrs + shdr_size;
       for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
 	{
@@ -11903,7 +12107,7 @@ Target_arm<big_endian>::scan_reloc_for_stub(
     elfcpp::Elf_types<32>::Elf_Swxword addend,
     Arm_address address)
 {
-  const Arm_relobj<big_endian>* arm_relobj =
+  Arm_relobj<big_endian>* arm_relobj =
     Arm_relobj<big_endian>::as_arm_relobj(relinfo->object);
 
   bool target_is_thumb;
@@ -11980,28 +12184,31 @@ Target_arm<big_endian>::scan_reloc_for_stub(
   Stub_type stub_type =
     Reloc_stub::stub_type_for_reloc(r_type, address, destination,
 				    target_is_thumb);
+  arm_relobj->stub_scan()->add_branch(
+      relinfo->data_shndx,
+      Reloc_stub::stub_type_slack(address, destination),
+      stub_type != arm_stub_none);
   if (stub_type != arm_stub_none)
     {
-      // Try looking up an existing stub from a stub table.
       Stub_table<big_endian>* stub_table =
 	arm_relobj->stub_table(relinfo->data_shndx);
       gold_assert(stub_table != NULL);
 
-      // Locate stub by destination.
-      Reloc_stub::Key stub_key(stub_type, gsym, arm_relobj, r_sym, addend);
-
-      // Create a stub if there is not one already
-      stub = stub_table->find_reloc_stub(stub_key);
-      if (stub == NULL)
+      if (arm_relobj->defers_stubs())
 	{
-	  // create a new stub and add it to stub table.
-	  stub = this->stub_factory().make_reloc_stub(stub_type);
-	  stub_table->add_reloc_stub(stub, stub_key);
+	  typename Arm_relobj<big_endian>::Reloc_stub_request request;
+	  request.stub_table = stub_table;
+	  request.stub_type = stub_type;
+	  request.gsym = gsym;
+	  request.r_sym = r_sym;
+	  request.addend = addend;
+	  request.destination = destination | (target_is_thumb ? 1 : 0);
+	  arm_relobj->add_reloc_stub_request(request);
 	}
-
-      // Record the destination address.
-      stub->set_destination_address(destination
-				    | (target_is_thumb ? 1 : 0));
+      else
+	stub = this->add_reloc_stub(stub_table, stub_type, gsym, arm_relobj,
+				    r_sym, addend,
+				    destination | (target_is_thumb ? 1 : 0));
     }
 
   // For Cortex-A8, we need to record a relocation at 4K page boundary.
@@ -12021,6 +12228,84 @@ Target_arm<big_endian>::scan_reloc_for_stub(
     }
 }
 
+// Add a relocation stub of STUB_TYPE to STUB_TABLE, unless it already has
+// one with the same key, and set its destination to DESTINATION.  Return
+// the stub.
+
+template<bool big_endian>
+Reloc_stub*
+Target_arm<big_endian>::add_reloc_stub(
+    Stub_table<big_endian>* stub_table,
+    Stub_type stub_type,
+    const Symbol* gsym,
+    const Relobj* relobj,
+    unsigned int r_sym,
+    int32_t addend,
+    Arm_address destination)
+{
+  // Locate stub by destination.
+  Reloc_stub::Key stub_key(stub_type, gsym, relobj, r_sym, addend);
+
+  // Create a stub if there is not one already
+  Reloc_stub* stub = stub_table->find_reloc_stub(stub_key);
+  if (stub == NULL)
+    {
+      // create a new stub and add it to stub table.
+      stub = this->stub_factory().make_reloc_stub(stub_type);
+      stub_table->add_reloc_stub(stub, stub_key);
+    }
+
+  // Record the destination address.
+  stub->set_destination_address(destination);
+  return stub;
+}
+
+// Add an ARM V4BX stub for register REG to STUB_TABLE, unless it already
+// has one.
+
+template<bool big_endian>
+void
+Target_arm<big_endian>::add_arm_v4bx_stub(Stub_table<big_endian>* stub_table,
+					  uint32_t reg)
+{
+  if (stub_table->find_arm_v4bx_stub(reg) == NULL)
+    {
+      // create a new stub and add it to stub table.
+      Arm_v4bx_stub* stub = this->stub_factory().make_arm_v4bx_stub(reg);
+      gold_assert(stub != NULL);
+      stub_table->add_arm_v4bx_stub(stub);
+    }
+}
+
+// Add the stubs requested while scanning RELOBJ in parallel, in the order
+// they were found.
+
+template<bool big_endian>
+void
+Target_arm<big_endian>::add_requested_stubs(Arm_relobj<big_endian>* relobj)
+{
+  relobj->set_defers_stubs(false);
+
+  const typename Arm_relobj<big_endian>::Reloc_stub_requests&
+    reloc_requests(relobj->reloc_stub_requests());
+  for (typename Arm_relobj<big_endian>::Reloc_stub_requests::const_iterator p =
+	 reloc_requests.begin();
+       p != reloc_requests.end();
+       ++p)
+    this->add_reloc_stub(p->stub_table, p->stub_type, p->gsym, relobj,
+			 p->r_sym, p->addend, p->destination);
+
+  const typename Arm_relobj<big_endian>::Arm_v4bx_stub_requests&
+    v4bx_requests(relobj->arm_v4bx_stub_requests());
+  for (typename Arm_relobj<big_endian>::Arm_v4bx_stub_requests::const_iterator
+	 p = v4bx_requests.begin();
+       p != v4bx_requests.end();
+       ++p)
+    this->add_arm_v4bx_stub(p->stub_table, p->reg);
+
+  relobj->clear_stub_requests();
+}
+
 // This function scans a relocation sections for stub generation.
 // The template parameter Relocate must be a class type which provides
 // a single function, relocate(), which implements the machine
@@ -12111,19 +12396,20 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
 
 	      if (reg < 0xf)
 		{
-		  // Try looking up an existing stub from a stub table.
 		  Stub_table<big_endian>* stub_table =
 		    arm_object->stub_table(relinfo->data_shndx);
 		  gold_assert(stub_table != NULL);
 
-		  if (stub_table->find_arm_v4bx_stub(reg) == NULL)
+		  if (arm_object->defers_stubs())
 		    {
-		      // create a new stub and add it to stub table.
-		      Arm_v4bx_stub* stub =
-			this->stub_factory().make_arm_v4bx_stub(reg);
-		      gold_assert(stub != NULL);
-		      stub_table->add_arm_v4bx_stub(stub);
+		      typename Arm_relobj<big_endian>::Arm_v4bx_stub_request
+			request;
+		      request.stub_table = stub_table;
+		      request.reg = reg;
+		      arm_object->add_arm_v4bx_stub_request(request);
 		    }
+		  else
+		    this->add_arm_v4bx_stub(stub_table, reg);
 		}
 	    }
 	  continue;
@@ -12141,6 +12427,8 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
       bool is_defined_in_discarded_section;
       unsigned int shndx;
       const Symbol* gsym = NULL;
+      // Whether we track how far the destination moves.
+      bool is_tracked;
       if (r_sym < local_count)
 	{
 	  sym = NULL;
@@ -12158,6 +12446,12 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
 	     && shndx != elfcpp::SHN_UNDEF
 	     && !arm_object->is_section_included(shndx)
 	     && !relinfo->symtab->is_section_folded(arm_object, shndx));
+	  is_tracked =
+	    (!is_ordinary
+	     || shndx == elfcpp::SHN_UNDEF
+	     || (!is_defined_in_discarded_section
+		 && (Stub_scan_sections<32>::section_address(arm_object, shndx)
+		     != Stub_scan_sections<32>::invalid_address)));
 
 	  // We need to compute the would-be final value of this local
 	  // symbol.
@@ -12198,6 +12492,17 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
 	  if (gsym->is_forwarder())
 	    gsym = relinfo->symtab->resolve_forwards(gsym);
 
+	  // The value of a symbol in a merge section of another object
+	  // can not be computed while that object is scanned in another
+	  // thread.
+	  bool serial;
+	  is_tracked = Stub_scan_sections<32>::symbol_is_tracked(gsym, &serial);
+	  if (serial && arm_object->defers_stubs())
+	    {
+	      arm_object->set_needs_serial_stub_scan(true);
+	      return;
+	    }
+
 	  sym = static_cast<const Sized_symbol<32>*>(gsym);
 	  if (sym->has_symtab_index() && sym->symtab_index() != -1U)
 	    symval.set_output_symtab_index(sym->symtab_index());
@@ -12227,9 +12532,14 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
 	  is_defined_in_discarded_section =
 	    (gsym->is_defined_in_discarded_section()
 	     && gsym->is_undefined());
+	  if (is_defined_in_discarded_section)
+	    is_tracked = false;
 	  shndx = 0;
 	}
 
+      if (!is_tracked)
+	arm_object->stub_scan()->add_untracked_branch(relinfo->data_shndx);
+
       Symbol_value<32> symval2;
       if (is_defined_in_discarded_section)
 	{
@@ -12346,6 +12656,158 @@ Target_arm<big_endian>::group_sections(
     }
 }
 
+// Scan the objects for stubs in parallel.  Each item is a group of
+// objects which share an input file.  The objects first record the
+// addresses of their sections, then they are scanned.
+
+template<bool big_endian>
+class Arm_stub_scan_runner : public Task_parallel_runner
+{
+ public:
+  Arm_stub_scan_runner(Target_arm<big_endian>* target,
+		       const std::vector<std::vector<Relobj*> >& groups,
+		       const Symbol_table* symtab, const Layout* layout,
+		       const Stub_scan_pass<32>* pass, const Task* task,
+		       bool update_addresses)
+    : target_(target), groups_(groups), symtab_(symtab), layout_(layout),
+      pass_(pass), task_(task), update_addresses_(update_addresses)
+  { }
+
+  void
+  run(unsigned int i);
+
+ private:
+  Target_arm<big_endian>* target_;
+  const std::vector<std::vector<Relobj*> >& groups_;
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+  const Stub_scan_pass<32>* pass_;
+  const Task* task_;
+  bool update_addresses_;
+};
+
+template<bool big_endian>
+void
+Arm_stub_scan_runner<big_endian>::run(unsigned int i)
+{
+  const std::vector<Relobj*>& group(this->groups_[i]);
+  for (std::vector<Relobj*>::const_iterator p = group.begin();
+       p != group.end();
+       ++p)
+    {
+      Arm_relobj<big_endian>* arm_relobj =
+	Arm_relobj<big_endian>::as_arm_relobj(*p);
+      if (this->update_addresses_)
+	{
+	  arm_relobj->stub_scan()->update_addresses(arm_relobj);
+	  continue;
+	}
+
+      // Lock the object so we can read from it.  No other thread uses
+      // an object in this group.
+      Task_lock_obj<Object> tl(this->task_, arm_relobj);
+      arm_relobj->set_defers_stubs(true);
+      arm_relobj->scan_sections_for_stubs(this->target_, this->symtab_,
+					  this->layout_, this->pass_);
+    }
+}
+
+// Scan all the objects for stubs in the current relaxation pass.  The
+// objects are scanned in parallel, and the stubs they find are added to
+// the stub tables afterwards, in the order of the objects, so that the
+// stubs are laid out the same way as when scanning serially.  The
+// Cortex-A8 workaround needs the relocation stubs as soon as they are
+// found, so we scan serially when it is enabled.
+
+template<bool big_endian>
+void
+Target_arm<big_endian>::scan_for_stubs(
+    const Input_objects* input_objects,
+    const Symbol_table* symtab,
+    const Layout* layout,
+    Workqueue* workqueue,
+    const Task* task)
+{
+  if (!this->fix_cortex_a8_)
+    {
+      Arm_stub_scan_runner<big_endian> runner(this, this->stub_scan_groups_,
+					      symtab, layout,
+					      &this->stub_scan_pass_, task,
+					      false);
+      workqueue->run_parallel(&runner, this->stub_scan_groups_.size());
+    }
+
+  for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
+       op != input_objects->relobj_end();
+       ++op)
+    {
+      Arm_relobj<big_endian>* arm_relobj =
+	Arm_relobj<big_endian>::as_arm_relobj(*op);
+      if (this->fix_cortex_a8_ || arm_relobj->needs_serial_stub_scan())
+	{
+	  arm_relobj->clear_stub_requests();
+	  arm_relobj->set_defers_stubs(false);
+	  arm_relobj->set_needs_serial_stub_scan(false);
+	  // Lock the object so we can read from it.  This is only called
+	  // single-threaded from Layout::finalize, so it is OK to lock.
+	  Task_lock_obj<Object> tl(task, arm_relobj);
+	  if (this->fix_cortex_a8_)
+	    arm_relobj->scan_sections_for_stubs(this, symtab, layout,
+						&this->stub_scan_pass_);
+	  else
+	    arm_relobj->rescan_sections_for_stubs(this, symtab, layout,
+						  &this->stub_scan_pass_);
+	}
+      else
+	this->add_requested_stubs(arm_relobj);
+    }
+}
+
+// Check all stub tables to see if any of them have their data sizes
+// or addresses alignments changed.  These are the only things that
+// matter.  Return whether one did.
+
+template<bool big_endian>
+bool
+Target_arm<big_endian>::stub_tables_changed(const Layout* layout)
+{
+  typedef typename Stub_table_list::iterator Stub_table_iterator;
+  bool any_stub_table_changed = false;
+  Unordered_set<const Output_section*> sections_needing_adjustment;
+  for (Stub_table_iterator sp = this->stub_tables_.begin();
+       (sp != this->stub_tables_.end()) && !any_stub_table_changed;
+       ++sp)
+    {
+      if ((*sp)->update_data_size_and_addralign())
+	{
+	  // Update data size of stub table owner.
+	  Arm_input_section<big_endian>* owner = (*sp)->owner();
+	  uint64_t address = owner->address();
+	  off_t offset = owner->offset();
+	  owner->reset_address_and_file_offset();
+	  owner->set_address_and_file_offset(address, offset);
+
+	  sections_needing_adjustment.insert(owner->output_section());
+	  any_stub_table_changed = true;
+	}
+    }
+
+  // Output_section_data::output_section() returns a const pointer but we
+  // need to update output sections, so we record all output sections needing
+  // update above and scan the sections here to find out what sections need
+  // to be updated.
+  for (Layout::Section_list::const_iterator p = layout->section_list().begin();
+      p != layout->section_list().end();
+      ++p)
+    {
+      if (sections_needing_adjustment.find(*p)
+	  != sections_needing_adjustment.end())
+	(*p)->set_section_offsets_need_adjustment();
+    }
+
+  return any_stub_table_changed;
+}
+
 // Relaxation hook.  This is where we do stub generation.
 
 template<bool big_endian>
@@ -12355,6 +12817,7 @@ Target_arm<big_endian>::do_relax(
     const Input_objects* input_objects,
     Symbol_table* symtab,
     Layout* layout,
+    Workqueue* workqueue,
     const Task* task)
 {
   // No need to generate stubs if this is a relocatable link.
@@ -12405,6 +12868,7 @@ Target_arm<big_endian>::do_relax(
 	}
 
       group_sections(layout, stub_group_size, stubs_always_after_branch, task);
+      stub_scan_groups(input_objects, &this->stub_scan_groups_);
 
       // Also fix .ARM.exidx section coverage.
       Arm_output_section<big_endian>* exidx_output_section = NULL;
@@ -12470,54 +12934,47 @@ Target_arm<big_endian>::do_relax(
 	(*sp)->remove_all_cortex_a8_stubs();
     }
 
-  // Scan relocs for relocation stubs
+  // Find how far the sections moved since the previous pass.  All the
+  // Cortex-A8 stubs were removed above, so every section is scanned
+  // again when fixing the erratum.
+  Stub_scan_pass<32>* scan_pass = &this->stub_scan_pass_;
+  scan_pass->start(layout, pass == 1 || this->fix_cortex_a8_);
+  Arm_stub_scan_runner<big_endian> runner(this, this->stub_scan_groups_,
+					  symtab, layout, scan_pass, task,
+					  true);
+  workqueue->run_parallel(&runner, this->stub_scan_groups_.size());
   for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
        op != input_objects->relobj_end();
        ++op)
-    {
-      Arm_relobj<big_endian>* arm_relobj =
-	Arm_relobj<big_endian>::as_arm_relobj(*op);
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from Layout::finalize, so it is OK to lock.
-      Task_lock_obj<Object> tl(task, arm_relobj);
-      arm_relobj->scan_sections_for_stubs(this, symtab, layout);
-    }
+    Arm_relobj<big_endian>::as_arm_relobj(*op)->stub_scan()->add_shifts_to(
+	scan_pass);
+  scan_pass->finish_shifts();
 
-  // Check all stub tables to see if any of them have their data sizes
-  // or addresses alignments changed.  These are the only things that
-  // matter.
-  bool any_stub_table_changed = false;
-  Unordered_set<const Output_section*> sections_needing_adjustment;
-  for (Stub_table_iterator sp = this->stub_tables_.begin();
-       (sp != this->stub_tables_.end()) && !any_stub_table_changed;
-       ++sp)
-    {
-      if ((*sp)->update_data_size_and_addralign())
-	{
-	  // Update data size of stub table owner.
-	  Arm_input_section<big_endian>* owner = (*sp)->owner();
-	  uint64_t address = owner->address();
-	  off_t offset = owner->offset();
-	  owner->reset_address_and_file_offset();
-	  owner->set_address_and_file_offset(address, offset);
+  // Scan relocs for relocation stubs
+  this->scan_for_stubs(input_objects, symtab, layout, workqueue, task);
+  bool any_stub_table_changed = this->stub_tables_changed(layout);
 
-	  sections_needing_adjustment.insert(owner->output_section());
-	  any_stub_table_changed = true;
-	}
+  // If this is the last pass, scan the sections which were skipped and
+  // which use stubs, to update the destinations of their stubs.
+  if (!any_stub_table_changed && !scan_pass->scan_all())
+    {
+      scan_pass->start_refresh();
+      this->scan_for_stubs(input_objects, symtab, layout, workqueue, task);
+      any_stub_table_changed = this->stub_tables_changed(layout);
     }
 
-  // Output_section_data::output_section() returns a const pointer but we
-  // need to update output sections, so we record all output sections needing
-  // update above and scan the sections here to find out what sections need
-  // to be updated.
-  for (Layout::Section_list::const_iterator p = layout->section_list().begin();
-      p != layout->section_list().end();
-      ++p)
+  size_t scanned = 0;
+  size_t skipped = 0;
+  for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
+       op != input_objects->relobj_end();
+       ++op)
     {
-      if (sections_needing_adjustment.find(*p)
-	  != sections_needing_adjustment.end())
-	(*p)->set_section_offsets_need_adjustment();
+      const Stub_scan_sections<32>* stub_scan =
+	Arm_relobj<big_endian>::as_arm_relobj(*op)->stub_scan();
+      scanned += stub_scan->scanned_count();
+      skipped += stub_scan->skipped_count();
     }
+  scan_pass->finish(scanned, skipped);
 
   // Stop relaxation if no EXIDX fix-up and no stub table change.
   bool continue_relaxation = done_exidx_fixup || any_stub_table_changed;
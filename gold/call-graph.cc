@@ -0,0 +1,326 @@
+// call-graph.cc -- order functions using a call graph profile
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "symtab.h"
+#include "object.h"
+#include "output.h"
+#include "call-graph.h"
+
+namespace gold
+{
+
+// A cluster is not grown beyond this many bytes, so that a few very
+// hot functions are not dragged apart by large callers.
+const uint64_t call_graph_max_cluster_size = 1024 * 1024;
+
+// Clusters are not merged if that would make the density of the
+// merged cluster less than the density of the caller cluster divided
+// by this.
+const double call_graph_max_density_degradation = 8.0;
+
+// Read the call graph from FILENAME.  Blank lines and lines starting
+// with '#' are ignored.
+
+void
+Call_graph::read(const char* filename)
+{
+  std::ifstream in;
+  std::string line;
+
+  in.open(filename);
+  if (!in)
+    gold_fatal(_("unable to open --call-graph-ordering-file file %s: %s"),
+	       filename, strerror(errno));
+
+  unsigned int lineno = 0;
+  while (std::getline(in, line))
+    {
+      ++lineno;
+      if (!line.empty() && line[line.length() - 1] == '\r')   // Windows
+	line.resize(line.length() - 1);
+      if (line.empty() || line[0] == '#')
+	continue;
+
+      std::istringstream fields(line);
+      std::string caller;
+      std::string callee;
+      std::string count;
+      std::string extra;
+      char* end;
+      if (!(fields >> caller >> callee >> count)
+	  || (fields >> extra))
+	{
+	  gold_error(_("%s:%u: expected caller, callee and count"),
+		     filename, lineno);
+	  continue;
+	}
+      uint64_t c = strtoull(count.c_str(), &end, 10);
+      if (*end != '\0' || count[0] == '-')
+	{
+	  gold_error(_("%s:%u: invalid call count %s"),
+		     filename, lineno, count.c_str());
+	  continue;
+	}
+      if (c != 0)
+	this->edges_.push_back(Edge(caller, callee, c));
+    }
+}
+
+// Find the input section defining the function NAME.  Set *ID to the
+// section and *OS to the output section it was assigned to.  Return
+// false if NAME is not defined in a section of a regular object, or
+// if the section was discarded.
+
+bool
+Call_graph::find_section(const Symbol_table* symtab, const std::string& name,
+			 Section_id* id, const Output_section** os) const
+{
+  Symbol* sym = symtab->lookup(name.c_str());
+  if (sym == NULL)
+    return false;
+  if (sym->is_forwarder())
+    sym = symtab->resolve_forwards(sym);
+  if (sym->source() != Symbol::FROM_OBJECT
+      || !sym->is_defined()
+      || sym->object()->is_dynamic()
+      || sym->object()->pluginobj() != NULL)
+    return false;
+
+  bool is_ordinary;
+  unsigned int shndx = sym->shndx(&is_ordinary);
+  if (!is_ordinary)
+    return false;
+
+  Relobj* relobj = static_cast<Relobj*>(sym->object());
+  Output_section* out = relobj->output_section(shndx);
+  if (out == NULL)
+    return false;
+
+  *id = Section_id(relobj, shndx);
+  *os = out;
+  return true;
+}
+
+// Compute the order of the sections in the call graph.
+
+void
+Call_graph::compute_order(const Task* task, const Symbol_table* symtab,
+			  Section_order* order_map)
+{
+  // Build the nodes, and sum the weights of the edges between them.
+  // Calls between sections in different output sections are ignored,
+  // since we can't move those sections closer together.
+  std::vector<Node> nodes;
+  Unordered_map<Section_id, unsigned int, Section_id_hash> node_index;
+  typedef std::map<std::pair<unsigned int, unsigned int>, uint64_t>
+    Edge_weights;
+  Edge_weights weights;
+  for (std::vector<Edge>::const_iterator p = this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    {
+      Section_id from_id;
+      Section_id to_id;
+      const Output_section* from_os;
+      const Output_section* to_os;
+      if (!this->find_section(symtab, p->caller, &from_id, &from_os)
+	  || !this->find_section(symtab, p->callee, &to_id, &to_os)
+	  || from_os != to_os)
+	continue;
+
+      std::pair<Unordered_map<Section_id, unsigned int,
+			      Section_id_hash>::iterator, bool> ins;
+      ins = node_index.insert(std::make_pair(from_id, nodes.size()));
+      if (ins.second)
+	nodes.push_back(Node(from_id));
+      unsigned int from = ins.first->second;
+      ins = node_index.insert(std::make_pair(to_id, nodes.size()));
+      if (ins.second)
+	nodes.push_back(Node(to_id));
+      unsigned int to = ins.first->second;
+
+      weights[std::make_pair(from, to)] += p->count;
+    }
+
+  if (nodes.empty())
+    return;
+
+  // Each node starts out in its own cluster.  The weight of a node is
+  // the number of calls into it, and its best predecessor is the node
+  // which calls it the most often.
+  for (Edge_weights::const_iterator p = weights.begin();
+       p != weights.end();
+       ++p)
+    {
+      unsigned int from = p->first.first;
+      unsigned int to = p->first.second;
+      Node* to_node = &nodes[to];
+      to_node->weight += p->second;
+      if (from == to)
+	continue;
+      if (to_node->best_pred == -1U || to_node->best_pred_weight < p->second)
+	{
+	  to_node->best_pred = from;
+	  to_node->best_pred_weight = p->second;
+	}
+    }
+
+  // Get the section sizes.  Sort the nodes by object so that we lock
+  // each object only once.
+  std::vector<unsigned int> by_object(nodes.size());
+  for (unsigned int i = 0; i < nodes.size(); ++i)
+    by_object[i] = i;
+  std::sort(by_object.begin(), by_object.end(), Node_object_compare(nodes));
+  for (unsigned int i = 0; i < by_object.size(); )
+    {
+      Relobj* relobj = nodes[by_object[i]].id.first;
+      Task_lock_obj<Object> tl(task, relobj);
+      for (; i < by_object.size(); ++i)
+	{
+	  Node* node = &nodes[by_object[i]];
+	  if (node->id.first != relobj)
+	    break;
+	  node->size = relobj->section_size(node->id.second);
+	}
+    }
+
+  std::vector<Cluster> clusters(nodes.size());
+  std::vector<unsigned int> leaders(nodes.size());
+  std::vector<unsigned int> sorted(nodes.size());
+  for (unsigned int i = 0; i < nodes.size(); ++i)
+    {
+      clusters[i].sections.push_back(i);
+      clusters[i].size = nodes[i].size;
+      clusters[i].weight = nodes[i].weight;
+      leaders[i] = i;
+      sorted[i] = i;
+    }
+
+  // Visit the clusters from the hottest to the coldest, and append
+  // each one to the cluster holding its best predecessor, unless that
+  // makes the cluster too big or much less dense.
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   Cluster_density_compare(clusters));
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      unsigned int c = *p;
+      const Node& node(nodes[c]);
+
+      // Ignore a predecessor which accounts for only a small fraction
+      // of the calls into this node.
+      if (node.best_pred == -1U
+	  || node.best_pred_weight * 10 <= node.weight)
+	continue;
+
+      unsigned int pred = node.best_pred;
+      while (leaders[pred] != pred)
+	{
+	  leaders[pred] = leaders[leaders[pred]];
+	  pred = leaders[pred];
+	}
+      if (pred == c)
+	continue;
+
+      Cluster* pred_cluster = &clusters[pred];
+      Cluster* cluster = &clusters[c];
+      if (pred_cluster->size + cluster->size > call_graph_max_cluster_size)
+	continue;
+      uint64_t merged_size = std::max(pred_cluster->size + cluster->size,
+				      static_cast<uint64_t>(1));
+      double merged_density = (static_cast<double>(pred_cluster->weight
+						   + cluster->weight)
+			       / merged_size);
+      if (merged_density
+	  < pred_cluster->density() / call_graph_max_density_degradation)
+	continue;
+
+      leaders[c] = pred;
+      pred_cluster->sections.insert(pred_cluster->sections.end(),
+				    cluster->sections.begin(),
+				    cluster->sections.end());
+      pred_cluster->size += cluster->size;
+      pred_cluster->weight += cluster->weight;
+      cluster->sections.clear();
+    }
+
+  // Lay out the remaining clusters from the densest to the sparsest.
+  sorted.clear();
+  for (unsigned int i = 0; i < clusters.size(); ++i)
+    if (leaders[i] == i)
+      sorted.push_back(i);
+  std::stable_sort(sorted.begin(), sorted.end(),
+		   Cluster_density_compare(clusters));
+
+  unsigned int position = 1;
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      const Cluster& cluster(clusters[*p]);
+      for (std::vector<unsigned int>::const_iterator q =
+	     cluster.sections.begin();
+	   q != cluster.sections.end();
+	   ++q)
+	(*order_map)[nodes[*q].id] = position++;
+    }
+
+  this->sections_ordered_ = position - 1;
+  this->clusters_ = sorted.size();
+}
+
+// Add the names of the functions in the call graph to NAMES.  Each
+// function which makes or receives a call is a hot function.
+
+void
+Call_graph::add_function_names(std::vector<std::string>* names) const
+{
+  for (std::vector<Edge>::const_iterator p = this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    {
+      names->push_back(p->caller);
+      names->push_back(p->callee);
+    }
+}
+
+// Print statistics.
+
+void
+Call_graph::print_stats() const
+{
+  fprintf(stderr, _("%s: call graph edges: %zu\n"),
+	  program_name, this->edges_.size());
+  fprintf(stderr, _("%s: call graph sections ordered: %u in %u clusters\n"),
+	  program_name, this->sections_ordered_, this->clusters_);
+}
+
+} // End namespace gold.
@@ -0,0 +1,186 @@
+// call-graph.h -- order functions using a call graph profile  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_CALL_GRAPH_H
+#define GOLD_CALL_GRAPH_H
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+namespace gold
+{
+
+class Task;
+class Symbol_table;
+
+// A weighted call graph, read from the file named by
+// --call-graph-ordering-file.  Each line of the file holds the name
+// of a caller, the name of a callee, and the number of calls.  After
+// the input sections have been laid out, the call graph is used to
+// compute an order for the input sections which hold the functions,
+// such that functions which call each other often are placed close
+// together.  When the functions are in separate sections, as with
+// -ffunction-sections, this reduces instruction cache and TLB misses.
+
+// The sections are clustered using the C3 heuristic described in
+// "Optimizing Function Placement for Large-Scale Data-Center
+// Applications" by Ottoni and Maher, which is a variant of the
+// Pettis-Hansen algorithm.
+
+class Call_graph
+{
+ public:
+  // Map from an input section to its position in the output section.
+  typedef std::map<Section_id, unsigned int> Section_order;
+
+  Call_graph()
+    : edges_(), sections_ordered_(0), clusters_(0)
+  { }
+
+  // Read the call graph from FILENAME.
+  void
+  read(const char* filename);
+
+  // Compute the order of the input sections holding the functions in
+  // the call graph, and store it in ORDER_MAP.  Positions start at 1.
+  // TASK is used to lock the objects.
+  void
+  compute_order(const Task* task, const Symbol_table* symtab,
+		Section_order* order_map);
+
+  // Add the names of the functions in the call graph to NAMES.
+  void
+  add_function_names(std::vector<std::string>* names) const;
+
+  // Print statistics to stderr.
+  void
+  print_stats() const;
+
+ private:
+  // An edge in the call graph as read from the file.
+  struct Edge
+  {
+    Edge(const std::string& caller_arg, const std::string& callee_arg,
+	 uint64_t count_arg)
+      : caller(caller_arg), callee(callee_arg), count(count_arg)
+    { }
+
+    std::string caller;
+    std::string callee;
+    uint64_t count;
+  };
+
+  // A node in the call graph, which is an input section.
+  struct Node
+  {
+    Node(const Section_id& id_arg)
+      : id(id_arg), size(0), weight(0), best_pred(-1U),
+	best_pred_weight(0)
+    { }
+
+    // The input section.
+    Section_id id;
+    // The size of the input section.
+    uint64_t size;
+    // The total number of calls into the section.
+    uint64_t weight;
+    // The node which calls this one the most often, or -1U.
+    unsigned int best_pred;
+    // The number of calls from BEST_PRED.
+    uint64_t best_pred_weight;
+  };
+
+  // A cluster of sections to be placed together.
+  struct Cluster
+  {
+    Cluster()
+      : sections(), size(0), weight(0)
+    { }
+
+    // The density of the cluster, which is the number of calls into
+    // the cluster per byte.
+    double
+    density() const
+    {
+      uint64_t size = std::max(this->size, static_cast<uint64_t>(1));
+      return static_cast<double>(this->weight) / size;
+    }
+
+    // The nodes in the cluster, in order.
+    std::vector<unsigned int> sections;
+    // The total size of the sections.
+    uint64_t size;
+    // The total weight of the sections.
+    uint64_t weight;
+  };
+
+  // Sort node indexes by object.
+  class Node_object_compare
+  {
+   public:
+    Node_object_compare(const std::vector<Node>& nodes)
+      : nodes_(nodes)
+    { }
+
+    bool
+    operator()(unsigned int n1, unsigned int n2) const
+    { return this->nodes_[n1].id.first < this->nodes_[n2].id.first; }
+
+   private:
+    const std::vector<Node>& nodes_;
+  };
+
+  // Sort cluster indexes by decreasing density.
+  class Cluster_density_compare
+  {
+   public:
+    Cluster_density_compare(const std::vector<Cluster>& clusters)
+      : clusters_(clusters)
+    { }
+
+    bool
+    operator()(unsigned int c1, unsigned int c2) const
+    { return this->clusters_[c1].density() > this->clusters_[c2].density(); }
+
+   private:
+    const std::vector<Cluster>& clusters_;
+  };
+
+  // Find the input section defining the function NAME.
+  bool
+  find_section(const Symbol_table* symtab, const std::string& name,
+	       Section_id* id, const Output_section** os) const;
+
+  // The edges read from the file.
+  std::vector<Edge> edges_;
+  // The number of sections which were given a position.
+  unsigned int sections_ordered_;
+  // The number of clusters those sections were placed in.
+  unsigned int clusters_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_CALL_GRAPH_H)
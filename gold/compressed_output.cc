@@ -22,13 +22,28 @@
 
 #include "gold.h"
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
+// Return the zlib compression level to use.
+
+static int
+zlib_compress_level()
+{
+  if (parameters->options().optimize() >= 1)
+    return 9;
+  else
+    return 1;
+}
+
 // Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
 // if it successfully compressed, false if it failed for any reason
 // (including not having zlib support in the library).  If it returns
@@ -48,17 +63,11 @@ zlib_compress(int header_size,
   *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
   *compressed_data = new unsigned char[*compressed_size + header_size];
 
-  int compress_level;
-  if (parameters->options().optimize() >= 1)
-    compress_level = 9;
-  else
-    compress_level = 1;
-
   int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
                      compressed_size,
                      reinterpret_cast<const Bytef*>(uncompressed_data),
                      uncompressed_size,
-                     compress_level);
+                     zlib_compress_level());
   if (rc == Z_OK)
     {
       *compressed_size += header_size;
@@ -72,6 +81,105 @@ zlib_compress(int header_size,
     }
 }
 
+// Compress one block of a section which is compressed in parallel, as
+// raw deflate data with no zlib header or trailer.  Unless LAST is
+// true, the block ends with a full flush, so that the data is byte
+// aligned and does not refer back to the previous blocks; the
+// compressed blocks can then be concatenated into a single zlib
+// stream.  Returns true if it succeeded, and sets *COMPRESSED_DATA,
+// allocated with new, and *COMPRESSED_SIZE.
+
+static bool
+zlib_compress_block(const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    bool last,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  z_stream strm;
+  strm.zalloc = NULL;
+  strm.zfree = NULL;
+  strm.opaque = NULL;
+
+  // Use the same memory level and strategy as compress2.
+  if (deflateInit2(&strm, zlib_compress_level(), Z_DEFLATED, -MAX_WBITS, 8,
+		   Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      *compressed_data = NULL;
+      return false;
+    }
+
+  // Leave room for the empty stored block written by the flush.
+  unsigned long buffer_size = deflateBound(&strm, uncompressed_size) + 16;
+  *compressed_data = new unsigned char[buffer_size];
+
+  strm.next_in = const_cast<Bytef*>(uncompressed_data);
+  strm.avail_in = uncompressed_size;
+  strm.next_out = reinterpret_cast<Bytef*>(*compressed_data);
+  strm.avail_out = buffer_size;
+  int rc = deflate(&strm, last ? Z_FINISH : Z_FULL_FLUSH);
+  bool ok = (strm.avail_in == 0
+	     && (last
+		 ? rc == Z_STREAM_END
+		 : rc == Z_OK && strm.avail_out > 0));
+  *compressed_size = buffer_size - strm.avail_out;
+  deflateEnd(&strm);
+
+  if (!ok)
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+    }
+  return ok;
+}
+
+#ifdef HAVE_ZSTD
+
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE as a single
+// zstd frame, leaving HEADER_SIZE bytes before it for the compression
+// header.  Returns true if it succeeded, and sets *COMPRESSED_DATA,
+// allocated with new, and *COMPRESSED_SIZE, which includes the
+// header.
+
+static bool
+zstd_compress(int header_size,
+	      const unsigned char* uncompressed_data,
+	      unsigned long uncompressed_size,
+	      unsigned char** compressed_data,
+	      unsigned long* compressed_size)
+{
+  size_t bound = ZSTD_compressBound(uncompressed_size);
+  *compressed_data = new unsigned char[bound + header_size];
+
+  size_t size = ZSTD_compress(*compressed_data + header_size, bound,
+			      uncompressed_data, uncompressed_size,
+			      ZSTD_CLEVEL_DEFAULT);
+  if (ZSTD_isError(size))
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+      return false;
+    }
+  *compressed_size = size + header_size;
+  return true;
+}
+
+// Decompress zstd data, which may be several concatenated frames.
+// The arguments are as for zlib_decompress.
+
+static bool
+zstd_decompress(const unsigned char* compressed_data,
+		unsigned long compressed_size,
+		unsigned char* uncompressed_data,
+		unsigned long uncompressed_size)
+{
+  size_t size = ZSTD_decompress(uncompressed_data, uncompressed_size,
+				compressed_data, compressed_size);
+  return !ZSTD_isError(size) && size == uncompressed_size;
+}
+
+#endif // defined(HAVE_ZSTD)
+
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
 // UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns TRUE if it
 // decompressed successfully, false if it failed.  The buffer, of
@@ -148,45 +256,39 @@ decompress_input_section(const unsigned char* compressed_data,
   if ((sh_flags & elfcpp::SHF_COMPRESSED) != 0)
     {
       unsigned int compression_header_size;
+      elfcpp::Elf_Word ch_type;
       if (size == 32)
 	{
 	  compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
 	  if (big_endian)
-	    {
-	      elfcpp::Chdr<32, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<32, true>(compressed_data).get_ch_type();
 	  else
-	    {
-	      elfcpp::Chdr<32, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<32, false>(compressed_data).get_ch_type();
 	}
       else if (size == 64)
 	{
 	  compression_header_size = elfcpp::Elf_sizes<64>::chdr_size;
 	  if (big_endian)
-	    {
-	      elfcpp::Chdr<64, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<64, true>(compressed_data).get_ch_type();
 	  else
-	    {
-	      elfcpp::Chdr<64, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
-	    }
+	    ch_type = elfcpp::Chdr<64, false>(compressed_data).get_ch_type();
 	}
       else
 	gold_unreachable();
 
-      return zlib_decompress(compressed_data + compression_header_size,
-			     compressed_size - compression_header_size,
-			     uncompressed_data,
-			     uncompressed_size);
+      if (ch_type == elfcpp::ELFCOMPRESS_ZLIB)
+	return zlib_decompress(compressed_data + compression_header_size,
+			       compressed_size - compression_header_size,
+			       uncompressed_data,
+			       uncompressed_size);
+#ifdef HAVE_ZSTD
+      if (ch_type == elfcpp::ELFCOMPRESS_ZSTD)
+	return zstd_decompress(compressed_data + compression_header_size,
+			       compressed_size - compression_header_size,
+			       uncompressed_data,
+			       uncompressed_size);
+#endif
+      return false;
     }
 
   const unsigned int zlib_header_size = 12;
@@ -209,54 +311,320 @@ decompress_input_section(const unsigned char* compressed_data,
   return false;
 }
 
+// Compress_section_task and Compress_block_task compress the
+// contents of an Output_compressed_section.  Large sections are split
+// into blocks of --compress-debug-sections-block-size bytes which are
+// compressed in parallel, and different sections are compressed in
+// parallel.
+
+// Compress_block_task compresses one block of a section.
+
+class Compress_block_task : public Task
+{
+ public:
+  Compress_block_task(Output_compressed_section* os, unsigned int block,
+		      Task_token* next_blocker)
+    : os_(os), block_(block), next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_block(this->block_); }
+
+  std::string
+  get_name() const
+  { return "Compress_block_task " + std::string(this->os_->name()); }
+
+ private:
+  Output_compressed_section* os_;
+  unsigned int block_;
+  Task_token* next_blocker_;
+};
+
+// Compress_section_task waits until the input sections have been
+// written to the postprocessing buffer of a section, finishes the
+// buffer, and queues a Compress_block_task for each block.
+
+class Compress_section_task : public Task
+{
+ public:
+  Compress_section_task(Output_compressed_section* os,
+			Task_token* this_blocker, Task_token* next_blocker)
+    : os_(os), this_blocker_(this_blocker), next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    this->os_->prepare_to_compress();
+    for (unsigned int i = 0; i < this->os_->block_count(); ++i)
+      workqueue->queue(new Compress_block_task(this->os_, i,
+					       this->next_blocker_));
+  }
+
+  std::string
+  get_name() const
+  { return "Compress_section_task " + std::string(this->os_->name()); }
+
+ private:
+  Output_compressed_section* os_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // Class Output_compressed_section.
 
-// Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// Return the number of blocks into which to split the section
+// contents for compression.  A section is always at least one block.
+
+unsigned int
+Output_compressed_section::compute_block_count() const
+{
+  uint64_t uncompressed_size = this->postprocessing_buffer_size();
+  uint64_t block_size = this->options_->compress_debug_sections_block_size();
+  if (block_size == 0 || uncompressed_size <= block_size)
+    return 1;
+  return (uncompressed_size + block_size - 1) / block_size;
+}
+
+// Return the size of the compression header which precedes the
+// compressed data: the ELF compression header for zlib-gabi and zstd,
+// or "ZLIB" and the size for zlib-gnu.
+
+int
+Output_compressed_section::compression_header_size() const
+{
+  if (strcmp(this->options_->compress_debug_sections(), "zlib-gnu") == 0)
+    return 12;
+  const int size = parameters->target().get_size();
+  if (size == 32)
+    return elfcpp::Elf_sizes<32>::chdr_size;
+  else if (size == 64)
+    return elfcpp::Elf_sizes<64>::chdr_size;
+  else
+    gold_unreachable();
+}
+
+// Return whether this section is compressed with zstd rather than
+// zlib.
+
+bool
+Output_compressed_section::is_zstd() const
+{
+  return strcmp(this->options_->compress_debug_sections(), "zstd") == 0;
+}
+
+// Queue the tasks which compress this section.
 
 void
-Output_compressed_section::set_final_data_size()
+Output_compressed_section::queue_compress_tasks(Workqueue* workqueue,
+						Task_token* this_blocker,
+						Task_token* next_blocker)
 {
-  off_t uncompressed_size = this->postprocessing_buffer_size();
+  workqueue->queue(new Compress_section_task(this, this_blocker,
+					     next_blocker));
+}
 
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+// Get ready to compress the section.
 
+void
+Output_compressed_section::prepare_to_compress()
+{
   // At this point the contents of all regular input sections will
   // have been copied into the postprocessing buffer, and relocations
   // will have been applied.  Now we need to copy in the contents of
   // anything other than a regular input section.
   this->write_to_postprocessing_buffer();
 
+  this->blocks_.resize(this->compute_block_count());
+}
+
+// Compress block I of the section.
+
+void
+Output_compressed_section::compress_block(unsigned int i)
+{
+  Compressed_block* b = &this->blocks_[i];
+  const unsigned long uncompressed_size = this->postprocessing_buffer_size();
+  const unsigned int count = this->blocks_.size();
+  const unsigned char* p = this->postprocessing_buffer();
+
+  if (count == 1)
+    b->uncompressed_size = uncompressed_size;
+  else
+    {
+      const unsigned long block_size =
+	this->options_->compress_debug_sections_block_size();
+      p += i * block_size;
+      b->uncompressed_size = std::min(block_size,
+				      uncompressed_size - i * block_size);
+    }
+
+  if (this->is_zstd())
+    {
+#ifdef HAVE_ZSTD
+      b->ok = zstd_compress(count == 1 ? this->compression_header_size() : 0,
+			    p, b->uncompressed_size, &b->data, &b->size);
+#endif
+      return;
+    }
+
+  if (count == 1)
+    {
+      b->ok = zlib_compress(this->compression_header_size(), p,
+			    uncompressed_size, &b->data, &b->size);
+      return;
+    }
+
+  b->adler = adler32(adler32(0, NULL, 0), p, b->uncompressed_size);
+  b->ok = zlib_compress_block(p, b->uncompressed_size, i + 1 == count,
+			      &b->data, &b->size);
+}
+
+// Combine the compressed blocks into a single zlib stream, or a
+// sequence of zstd frames, in data_, leaving space for the compression
+// header.  Set *COMPRESSED_SIZE to
+// the size including the header.  Return false if any block could not
+// be compressed.
+
+bool
+Output_compressed_section::combine_blocks(unsigned long* compressed_size)
+{
+  bool ok = true;
+  for (std::vector<Compressed_block>::const_iterator p = this->blocks_.begin();
+       p != this->blocks_.end();
+       ++p)
+    if (!p->ok)
+      ok = false;
+
+  if (ok && this->blocks_.size() == 1)
+    {
+      this->data_ = this->blocks_[0].data;
+      *compressed_size = this->blocks_[0].size;
+      this->blocks_.clear();
+      return true;
+    }
+
+  if (ok)
+    {
+      const int header_size = this->compression_header_size();
+      const bool zstd = this->is_zstd();
+
+      // A zlib stream is a two byte header, the deflate data, and the
+      // Adler-32 checksum of the uncompressed data in big-endian
+      // order.  The header uses the same compression level flags as
+      // compress2.  Concatenated zstd frames need no framing.
+      unsigned long size = header_size + (zstd ? 0 : 2 + 4);
+      for (std::vector<Compressed_block>::const_iterator p =
+	     this->blocks_.begin();
+	   p != this->blocks_.end();
+	   ++p)
+	size += p->size;
+
+      this->data_ = new unsigned char[size];
+      unsigned char* pov = this->data_ + header_size;
+      if (!zstd)
+	{
+	  unsigned int cmf = 0x78;
+	  unsigned int flg = zlib_compress_level() >= 9 ? 3 << 6 : 0;
+	  flg += 31 - ((cmf << 8) + flg) % 31;
+	  *pov++ = cmf;
+	  *pov++ = flg;
+	}
+
+      unsigned long adler = adler32(0, NULL, 0);
+      for (std::vector<Compressed_block>::const_iterator p =
+	     this->blocks_.begin();
+	   p != this->blocks_.end();
+	   ++p)
+	{
+	  memcpy(pov, p->data, p->size);
+	  pov += p->size;
+	  if (!zstd)
+	    adler = adler32_combine(adler, p->adler, p->uncompressed_size);
+	}
+      if (!zstd)
+	{
+	  elfcpp::Swap_unaligned<32, true>::writeval(pov, adler);
+	  pov += 4;
+	}
+      gold_assert(static_cast<unsigned long>(pov - this->data_) == size);
+      *compressed_size = size;
+    }
+
+  for (std::vector<Compressed_block>::const_iterator p = this->blocks_.begin();
+       p != this->blocks_.end();
+       ++p)
+    delete[] p->data;
+  this->blocks_.clear();
+
+  return ok;
+}
+
+// Set the final data size of a compressed section.  The data has
+// normally been compressed by the Compress_block_tasks; if not, we
+// compress it here.
+
+void
+Output_compressed_section::set_final_data_size()
+{
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+
+  if (this->blocks_.empty())
+    {
+      this->prepare_to_compress();
+      for (unsigned int i = 0; i < this->blocks_.size(); ++i)
+	this->compress_block(i);
+    }
+
   bool success = false;
-  enum { none, gnu_zlib, gabi_zlib } compress;
-  int compression_header_size = 12;
+  enum { none, gnu_zlib, gabi_zlib, gabi_zstd } compress;
   const int size = parameters->target().get_size();
   if (strcmp(this->options_->compress_debug_sections(), "zlib-gnu") == 0)
     compress = gnu_zlib;
   else if (strcmp(this->options_->compress_debug_sections(), "zlib-gabi") == 0
 	   || strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
-    {
-      compress = gabi_zlib;
-      if (size == 32)
-	compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
-      else if (size == 64)
-	compression_header_size = elfcpp::Elf_sizes<64>::chdr_size;
-      else
-	gold_unreachable();
-    }
+    compress = gabi_zlib;
+  else if (this->is_zstd())
+    compress = gabi_zstd;
   else
     compress = none;
+  unsigned long compressed_size;
   if (compress != none)
-    success = zlib_compress(compression_header_size, uncompressed_data,
-			    uncompressed_size, &this->data_,
-			    &compressed_size);
+    success = this->combine_blocks(&compressed_size);
   if (success)
     {
       elfcpp::Elf_Xword flags = this->flags();
-      if (compress == gabi_zlib)
+      if (compress == gabi_zlib || compress == gabi_zstd)
 	{
+	  const elfcpp::Elf_Word ch_type = (compress == gabi_zstd
+					    ? elfcpp::ELFCOMPRESS_ZSTD
+					    : elfcpp::ELFCOMPRESS_ZLIB);
+
 	  // Set the SHF_COMPRESSED bit.
 	  flags |= elfcpp::SHF_COMPRESSED;
 	  const bool is_big_endian = parameters->target().is_big_endian();
@@ -266,14 +634,14 @@ Output_compressed_section::set_final_data_size()
 	      if (is_big_endian)
 		{
 		  elfcpp::Chdr_write<32, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
 	      else
 		{
 		  elfcpp::Chdr_write<32, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
@@ -283,7 +651,7 @@ Output_compressed_section::set_final_data_size()
 	      if (is_big_endian)
 		{
 		  elfcpp::Chdr_write<64, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -292,7 +660,7 @@ Output_compressed_section::set_final_data_size()
 	      else
 		{
 		  elfcpp::Chdr_write<64, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -317,7 +685,8 @@ Output_compressed_section::set_final_data_size()
     }
   else
     {
-      gold_warning(_("not compressing section data: zlib error"));
+      gold_warning(_("not compressing section data: %s error"),
+		   compress == gabi_zstd ? "zstd" : "zlib");
       gold_assert(this->data_ == NULL);
       this->set_data_size(uncompressed_size);
     }
@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Workqueue;
+class Task_token;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -60,9 +63,37 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), blocks_()
   { this->set_requires_postprocessing(); }
 
+  // Return the number of blocks into which to split the contents.
+  unsigned int
+  compute_block_count() const;
+
+  // Queue the tasks which compress the contents of this section.
+  // They run after THIS_BLOCKER is unblocked, when the postprocessing
+  // buffer is complete.  Each block which is compressed releases a
+  // blocker of NEXT_BLOCKER.  The caller must already have added
+  // compute_block_count() blockers to NEXT_BLOCKER.
+  void
+  queue_compress_tasks(Workqueue*, Task_token* this_blocker,
+		       Task_token* next_blocker);
+
+  // Finish filling in the postprocessing buffer, and set up the
+  // blocks to compress.  This is called before compress_block.
+  void
+  prepare_to_compress();
+
+  // Return the number of blocks to compress.
+  unsigned int
+  block_count() const
+  { return this->blocks_.size(); }
+
+  // Compress block I.  This may be called in parallel for different
+  // blocks.
+  void
+  compress_block(unsigned int i);
+
  protected:
   // Set the final data size.
   void
@@ -73,12 +104,52 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // A block of the section contents, compressed separately.  If
+  // there is more than one block, each is raw deflate data; the
+  // blocks are concatenated into a zlib stream.  With zstd, each
+  // block is a complete zstd frame, and the frames are simply
+  // concatenated.  If there is just one block, it is a complete zlib
+  // stream or zstd frame preceded by space for the compression
+  // header.
+  struct Compressed_block
+  {
+    Compressed_block()
+      : data(NULL), size(0), uncompressed_size(0), adler(0), ok(false)
+    { }
+
+    // The compressed data.
+    unsigned char* data;
+    // The size of the compressed data.
+    unsigned long size;
+    // The size of the uncompressed data.
+    unsigned long uncompressed_size;
+    // The Adler-32 checksum of the uncompressed data.
+    unsigned long adler;
+    // Whether the block was compressed successfully.
+    bool ok;
+  };
+
+  // Return the size of the compression header.
+  int
+  compression_header_size() const;
+
+  // Return whether the section is compressed with zstd.
+  bool
+  is_zstd() const;
+
+  // Combine the compressed blocks into data_.  Return false if any of
+  // them failed.
+  bool
+  combine_blocks(unsigned long* compressed_size);
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
   // The new section name if we do compress.
   std::string new_section_name_;
+  // The compressed blocks.
+  std::vector<Compressed_block> blocks_;
 };
 
 } // End namespace gold.
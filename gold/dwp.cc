@@ -28,6 +28,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <sys/stat.h>
 
 #include <vector>
 #include <algorithm>
@@ -45,6 +46,7 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -108,9 +110,14 @@ class Dwo_file
 {
  public:
   Dwo_file(const char* name)
-    : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+    : name_(name), obj_(NULL), input_file_(NULL), machine_(0), osabi_(0),
+      abiversion_(0), is_compressed_(), sect_offsets_(), debug_types_(),
+      debug_str_(0), debug_cu_index_(0), debug_tu_index_(0), str_keys_(),
+      str_offset_map_()
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -119,9 +126,17 @@ class Dwo_file
   void
   read_executable(File_list* files);
 
-  // Read the input file and send its contents to OUTPUT_FILE.
+  // Open the input file, find its debug sections, and add its strings
+  // to the string pool of OUTPUT_FILE.  This may be called for several
+  // files at once.
+  void
+  scan(Dwp_output_file* output_file);
+
+  // Send the contents of the input file to OUTPUT_FILE.  The files
+  // must be added one at a time, after they have been scanned, in the
+  // order in which they appear on the command line.
   void
-  read(Dwp_output_file* output_file);
+  add(Dwp_output_file* output_file);
 
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
@@ -135,6 +150,12 @@ class Dwo_file
       Str_offset_map_entry;
   typedef std::vector<Str_offset_map_entry> Str_offset_map;
 
+  // Types for recording the key in the output string pool of each
+  // input string, until the output offsets are assigned.
+  typedef std::pair<section_offset_type, Concurrent_stringpool::Key>
+      Str_key_entry;
+  typedef std::vector<Str_key_entry> Str_key_list;
+
   // A less-than comparison routine for Str_offset_map.
   struct Offset_compare
   {
@@ -145,15 +166,14 @@ class Dwo_file
   };
 
   // Create a Sized_relobj_dwo of the given size and endianness,
-  // and record the target info.  P is a pointer to the ELF header
+  // and save the target info.  P is a pointer to the ELF header
   // in memory.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object();
 
   template <int size, bool big_endian>
   Relobj*
-  sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+  sized_make_object(const unsigned char* p, Input_file* input_file);
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -198,9 +218,19 @@ class Dwo_file
   bool
   sized_verify_dwo_list(unsigned int, const File_list& files);
 
-  // Merge the input string table section into the output file.
+  // Read the contents of a section, so that the I/O is done while
+  // scanning the file.
+  void
+  prefetch_section(unsigned int shndx);
+
+  // Add the strings in the input string table section to the string
+  // pool of the output file.
+  void
+  hash_strings(Dwp_output_file*, unsigned int);
+
+  // Assign output offsets to the strings of the input string table.
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  add_strings(Dwp_output_file*);
 
   // Copy a section from the input file to the output file.
   Section_bounds
@@ -232,10 +262,25 @@ class Dwo_file
   Relobj* obj_;
   // The Input_file object.
   Input_file* input_file_;
+  // ELF header values, passed to the output file.
+  int machine_;
+  int osabi_;
+  int abiversion_;
   // Flags indicating which sections are compressed.
   std::vector<bool> is_compressed_;
   // Map input section index onto output section offset and size.
   std::vector<Section_bounds> sect_offsets_;
+  // The debug sections found by scan, indexed by DW_SECT.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // The .debug_types.dwo sections.
+  std::vector<unsigned int> debug_types_;
+  // The .debug_str.dwo section.
+  unsigned int debug_str_;
+  // The .debug_cu_index and .debug_tu_index sections of a .dwp file.
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // Input string offsets and their keys in the output string pool.
+  Str_key_list str_keys_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
 };
@@ -452,7 +497,7 @@ class Dwp_output_file
       abiversion_(0), fd_(NULL), next_file_offset_(0), shnum_(1), sections_(),
       section_id_map_(), shoff_(0), shstrndx_(0), have_strings_(false),
       stringpool_(), shstrtab_(), cu_index_(), tu_index_(), last_type_sig_(0),
-      last_tu_slot_(0)
+      last_tu_slot_(0), memory_limit_(0), buffered_size_(0)
   {
     this->section_id_map_.resize(elfcpp::DW_SECT_MAX + 1);
     this->stringpool_.set_no_zero_null();
@@ -463,10 +508,23 @@ class Dwp_output_file
   record_target_info(const char* name, int machine, int size, bool big_endian,
 		     int osabi, int abiversion);
 
-  // Add a string to the debug strings section.
-  section_offset_type
+  // Set the number of bytes of section contents to hold in memory
+  // before writing them to temporary files.  0 means no limit.
+  void
+  set_memory_limit(uint64_t memory_limit)
+  { this->memory_limit_ = memory_limit; }
+
+  // Add a string to the debug strings section, and return its key.
+  // This may be called from several threads at once.
+  Concurrent_stringpool::Key
   add_string(const char* str, size_t len);
 
+  // Return the offset of the string with key K in the debug strings
+  // section.  Strings are laid out in the order in which this is
+  // first called for them.
+  section_offset_type
+  string_offset(Concurrent_stringpool::Key k);
+
   // Add a section to the output file, and return the new section offset.
   section_offset_type
   add_contribution(elfcpp::DW_SECT section_id, const unsigned char* contents,
@@ -498,7 +556,9 @@ class Dwp_output_file
     const unsigned char* contents;
   };
 
-  // Sections in the output file.
+  // Sections in the output file.  When the contributions use more
+  // memory than the limit, they are moved to a temporary file, at
+  // their offsets within the section.
   struct Section
   {
     const char* name;
@@ -506,9 +566,12 @@ class Dwp_output_file
     section_size_type size;
     int align;
     std::vector<Contribution> contributions;
+    FILE* spill_file;
+    section_size_type spill_size;
 
     Section(const char* n, int a)
-      : name(n), offset(0), size(0), align(a), contributions()
+      : name(n), offset(0), size(0), align(a), contributions(),
+	spill_file(NULL), spill_size(0)
     { }
   };
 
@@ -632,9 +695,13 @@ class Dwp_output_file
 		   unsigned int link, unsigned int info,
 		   unsigned int align, unsigned int ent_size);
 
+  // Move the contributions held in memory to temporary files.
+  void
+  spill_contributions();
+
   // Write the contributions to an output section.
   void
-  write_contributions(const Section& sect);
+  write_contributions(Section& sect);
 
   // Write a CU or TU index section.
   template<bool big_endian>
@@ -666,7 +733,7 @@ class Dwp_output_file
   // TRUE if we have added any strings to the string pool.
   bool have_strings_;
   // String pool for the output .debug_str.dwo section.
-  Stringpool stringpool_;
+  Concurrent_stringpool stringpool_;
   // String pool for the .shstrtab section.
   Stringpool shstrtab_;
   // The compilation unit index.
@@ -677,6 +744,10 @@ class Dwp_output_file
   uint64_t last_type_sig_;
   // Cache of the slot index for the last type signature.
   unsigned int last_tu_slot_;
+  // The number of bytes of contributions to hold in memory, or 0.
+  uint64_t memory_limit_;
+  // The number of bytes of contributions held in memory.
+  uint64_t buffered_size_;
 };
 
 // A specialization of Dwarf_info_reader, for reading dwo_names from
@@ -840,7 +911,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -880,26 +951,19 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Open the input file, find its debug sections, and add its strings
+// to the string pool of OUTPUT_FILE.  This is run in parallel for
+// different files, so it must not change OUTPUT_FILE otherwise.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::scan(Dwp_output_file* output_file)
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
 
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
-
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
   for (unsigned int i = 1; i < shnum; i++)
@@ -918,39 +982,61 @@ Dwo_file::read(Dwp_output_file* output_file)
       else
 	continue;
       if (strcmp(suffix, "info.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_INFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LINE] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LINE] = i;
       else if (strcmp(suffix, "loc.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LOC] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACINFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACINFO] = i;
       else if (strcmp(suffix, "macro.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
+      else
+	continue;
+      this->prefetch_section(i);
     }
 
+  // Add the input strings to the output string pool.  They get their
+  // output offsets when the file is added.
+  this->hash_strings(output_file, this->debug_str_);
+}
+
+// Send the contents of the input file to OUTPUT_FILE.
+
+void
+Dwo_file::add(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_,
+				  this->obj_->elfsize(),
+				  this->obj_->is_big_endian(),
+				  this->osabi_, this->abiversion_);
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file);
+
+  unsigned int* debug_shndx = this->debug_shndx_;
+  const std::vector<unsigned int>& debug_types = this->debug_types_;
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
 	  if (debug_types.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
@@ -959,7 +1045,8 @@ Dwo_file::read(Dwp_output_file* output_file)
             debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx,
+				output_file, true);
 	}
       return;
     }
@@ -969,7 +1056,7 @@ Dwo_file::read(Dwp_output_file* output_file)
     this->add_unit_set(output_file, debug_shndx, false);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
+  for (std::vector<unsigned int>::const_iterator tp = debug_types.begin();
        tp != debug_types.end();
        ++tp)
     {
@@ -985,7 +1072,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1021,10 +1108,10 @@ Dwo_file::verify(const File_list& files)
 }
 
 // Create a Sized_relobj_dwo of the given size and endianness,
-// and record the target info.
+// and save the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object()
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1045,8 +1132,8 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_fatal(_("%s: not an ELF object file"), this->name_);
   
   // Get the size, endianness, machine, etc. info from the header,
-  // make an appropriately-sized Relobj, and pass the target info
-  // to the output object.
+  // make an appropriately-sized Relobj, and save the target info
+  // for the output object.
   int size;
   bool big_endian;
   std::string error;
@@ -1058,15 +1145,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
-	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<32, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
-	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<32, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1075,15 +1160,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
-	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<64, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
-	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<64, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1092,23 +1175,20 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_unreachable();
 }
 
-// Function template to create a Sized_relobj_dwo and record the target info.
+// Function template to create a Sized_relobj_dwo and save the target info.
 // P is a pointer to the ELF header in memory.
 
 template <int size, bool big_endian>
 Relobj*
-Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+  this->machine_ = ehdr.get_e_machine();
+  this->osabi_ = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->abiversion_ = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   return obj;
 }
 
@@ -1360,10 +1440,31 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
   return nmissing == 0;
 }
 
-// Merge the input string table section into the output file.
+// Touch each page of the contents of section SHNDX, so that the input
+// file is read by the parallel scan rather than while the file is
+// being added.  Compressed sections are left alone; they are
+// decompressed when they are copied.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::prefetch_section(unsigned int shndx)
+{
+  section_size_type len;
+  if (this->obj_->section_is_compressed(shndx, &len))
+    return;
+  bool is_new;
+  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  gold_assert(!is_new);
+  const volatile unsigned char* p = contents;
+  for (section_size_type i = 0; i < len; i += 4096)
+    (void) p[i];
+}
+
+// Add the strings in the input string table section to the string pool
+// of the output file.  Record the key of each string, so that
+// add_strings can assign the output offsets later.
+
+void
+Dwo_file::hash_strings(Dwp_output_file* output_file, unsigned int debug_str)
 {
   section_size_type len;
   bool is_new;
@@ -1378,30 +1479,47 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
 	       this->name_,
 	       this->section_name(debug_str).c_str());
 
-  // Count the number of strings in the section, and size the map.
+  // Count the number of strings in the section, and size the list.
   size_t count = 0;
   for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
     ++count;
-  this->str_offset_map_.reserve(count + 1);
+  this->str_keys_.reserve(count + 1);
 
-  // Add the strings to the output string table, and record the new offsets
-  // in the map.
+  // Add the strings to the output string pool, and record their keys.
+  // The last entry marks the end of the section.
   section_offset_type i = 0;
-  section_offset_type new_offset;
   while (p < pend)
     {
       size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
-      this->str_offset_map_.push_back(std::make_pair(i, new_offset));
+      Concurrent_stringpool::Key key = output_file->add_string(p, len);
+      this->str_keys_.push_back(std::make_pair(i, key));
       p += len + 1;
       i += len + 1;
     }
-  new_offset = 0;
-  this->str_offset_map_.push_back(std::make_pair(i, new_offset));
+  this->str_keys_.push_back(std::make_pair(i, Concurrent_stringpool::Key()));
   if (is_new)
     delete[] pdata;
 }
 
+// Assign output offsets to the strings of the input string table, in
+// the order in which they appear, and record the new offsets in the map.
+
+void
+Dwo_file::add_strings(Dwp_output_file* output_file)
+{
+  this->str_offset_map_.reserve(this->str_keys_.size());
+  for (Str_key_list::const_iterator p = this->str_keys_.begin();
+       p != this->str_keys_.end();
+       ++p)
+    {
+      section_offset_type new_offset = 0;
+      if (p->second != NULL)
+	new_offset = output_file->string_offset(p->second);
+      this->str_offset_map_.push_back(std::make_pair(p->first, new_offset));
+    }
+  Str_key_list().swap(this->str_keys_);
+}
+
 // Copy a section from the input file to the output file.
 // Return the offset and length of this input section's contribution
 // in the output section.  If copying .debug_str_offsets.dwo, remap
@@ -1579,18 +1697,26 @@ Dwp_output_file::record_target_info(const char*, int machine,
     gold_fatal(_("%s: %s"), this->name_, strerror(errno));
 }
 
-// Add a string to the debug strings section.
+// Add a string to the debug strings section, and return its key.
 
-section_offset_type
+Concurrent_stringpool::Key
 Dwp_output_file::add_string(const char* str, size_t len)
 {
-  Stringpool::Key key;
-  this->stringpool_.add_with_length(str, len, true, &key);
+  Concurrent_stringpool::Key key;
+  this->stringpool_.add_with_length(str, len, true, 0, &key);
+  return key;
+}
+
+// Return the offset of a string in the debug strings section.  The
+// offsets are handed out in the same order as when the strings were
+// added one file at a time, so the string table does not depend on
+// the order in which the files were scanned.
+
+section_offset_type
+Dwp_output_file::string_offset(Concurrent_stringpool::Key k)
+{
   this->have_strings_ = true;
-  // We aren't supposed to call get_offset() until after
-  // calling set_string_offsets(), but the offsets will
-  // not change unless optimizing the string pool.
-  return this->stringpool_.get_offset_from_key(key);
+  return this->stringpool_.assign_offset(k);
 }
 
 // Align the file offset to the given boundary.
@@ -1616,7 +1742,8 @@ Dwp_output_file::add_output_section(const char* section_name, int align)
 // is expected to be the largest one, so we will write the contents of this
 // section directly to the output file as we receive contributions, allowing
 // us to free that memory as soon as possible. We will save the remaining
-// contributions until we finalize the layout of the output file.
+// contributions until we finalize the layout of the output file, moving
+// them to temporary files if they use more memory than the limit.
 
 section_offset_type
 Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
@@ -1683,11 +1810,48 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
       section.size = section_offset + len;
       Contribution contrib = { section_offset, len, contents };
       section.contributions.push_back(contrib);
+      this->buffered_size_ += len;
+      if (this->memory_limit_ != 0
+	  && this->buffered_size_ > this->memory_limit_)
+	this->spill_contributions();
     }
 
   return section_offset;
 }
 
+// Move the contributions held in memory to a temporary file for each
+// section.  The contributions are written at their offsets within the
+// section, so that write_contributions can copy the file as a whole.
+
+void
+Dwp_output_file::spill_contributions()
+{
+  for (unsigned int i = 0; i < this->sections_.size(); ++i)
+    {
+      Section& sect = this->sections_[i];
+      if (sect.contributions.empty())
+	continue;
+      if (sect.spill_file == NULL)
+	{
+	  sect.spill_file = ::tmpfile();
+	  if (sect.spill_file == NULL)
+	    gold_fatal(_("cannot create temporary file: %s"), strerror(errno));
+	}
+      for (unsigned int j = 0; j < sect.contributions.size(); ++j)
+	{
+	  const Contribution& c = sect.contributions[j];
+	  ::fseek(sect.spill_file, c.output_offset, SEEK_SET);
+	  if (::fwrite(c.contents, 1, c.size, sect.spill_file) < c.size)
+	    gold_fatal(_("error writing temporary file for section '%s': %s"),
+		       sect.name, strerror(errno));
+	  delete[] c.contents;
+	  sect.spill_size = c.output_offset + c.size;
+	}
+      std::vector<Contribution>().swap(sect.contributions);
+    }
+  this->buffered_size_ = 0;
+}
+
 // Add a set of .debug_info and related sections to the output file.
 
 void
@@ -1930,8 +2094,31 @@ Dwp_output_file::finalize()
 // Write the contributions to an output section.
 
 void
-Dwp_output_file::write_contributions(const Section& sect)
+Dwp_output_file::write_contributions(Section& sect)
 {
+  // Copy the contributions moved to a temporary file.
+  if (sect.spill_file != NULL)
+    {
+      unsigned char buf[65536];
+      ::rewind(sect.spill_file);
+      ::fseek(this->fd_, sect.offset, SEEK_SET);
+      section_size_type remaining = sect.spill_size;
+      while (remaining > 0)
+	{
+	  size_t len = std::min(remaining,
+				static_cast<section_size_type>(sizeof buf));
+	  if (::fread(buf, 1, len, sect.spill_file) < len)
+	    gold_fatal(_("error reading temporary file for section '%s'"),
+		       sect.name);
+	  if (::fwrite(buf, 1, len, this->fd_) < len)
+	    gold_fatal(_("%s: error writing section '%s'"), this->name_,
+		       sect.name);
+	  remaining -= len;
+	}
+      ::fclose(sect.spill_file);
+      sect.spill_file = NULL;
+    }
+
   for (unsigned int i = 0; i < sect.contributions.size(); ++i)
     {
       const Contribution& c = sect.contributions[i];
@@ -2284,6 +2471,207 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
   this->output_file_->add_tu_set(unit_set);
 }
 
+// Class Dwp_input_queue.
+
+// This class queues the tasks which read the input files and add them
+// to the output file.  Each file is scanned by a Dwo_scan_task, which
+// may run in parallel with the others, and is then added by a
+// Dwo_add_task.  The Dwo_add_tasks run one at a time, in the order of
+// the input files, so the output file is the same however many jobs
+// are used.  Files are only scanned ahead while the input files being
+// held stay within the memory limit.
+
+class Dwp_input_queue
+{
+ public:
+  Dwp_input_queue(Dwp_output_file* output_file, const File_list& files,
+		  int jobs, uint64_t memory_limit, bool verbose)
+    : output_file_(output_file), files_(files), jobs_(jobs),
+      memory_limit_(memory_limit), verbose_(verbose), next_file_(0),
+      files_in_flight_(0), bytes_in_flight_(0), next_blocker_(NULL)
+  { }
+
+  // Queue tasks for the next input files, as many as the limits allow.
+  // This is called before the workqueue is started, and then by each
+  // Dwo_add_task.
+  void
+  queue_files(Workqueue*);
+
+  // Add DWO_FILE, read from NAME, whose size is SIZE bytes, to the
+  // output file, and delete it.
+  void
+  add_file(Workqueue*, Dwo_file* dwo_file, const char* name, off_t size);
+
+ private:
+  // The output file.
+  Dwp_output_file* output_file_;
+  // The input files.
+  const File_list& files_;
+  // The number of jobs to run at once.
+  int jobs_;
+  // The number of bytes of input files to hold at once, or 0.
+  uint64_t memory_limit_;
+  // Whether to print the name of each file.
+  bool verbose_;
+  // The index of the next file to queue.
+  size_t next_file_;
+  // The number of files queued but not yet added.
+  int files_in_flight_;
+  // The total size of those files.
+  uint64_t bytes_in_flight_;
+  // The blocker for the next Dwo_add_task.
+  Task_token* next_blocker_;
+};
+
+// Scan an input file.  This releases READ_BLOCKER when it is done.
+
+class Dwo_scan_task : public Task
+{
+ public:
+  Dwo_scan_task(Dwo_file* dwo_file, const char* name,
+		Dwp_output_file* output_file, Task_token* read_blocker)
+    : dwo_file_(dwo_file), name_(name), output_file_(output_file),
+      read_blocker_(read_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->read_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->scan(this->output_file_); }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_scan_task ") + this->name_; }
+
+ private:
+  Dwo_file* dwo_file_;
+  const char* name_;
+  Dwp_output_file* output_file_;
+  Task_token* read_blocker_;
+};
+
+// Add an input file to the output file, once it has been scanned
+// (READ_BLOCKER) and the previous file has been added (THIS_BLOCKER).
+// This releases NEXT_BLOCKER when it is done.
+
+class Dwo_add_task : public Task
+{
+ public:
+  Dwo_add_task(Dwp_input_queue* input_queue, Dwo_file* dwo_file,
+	       const char* name, off_t size, Task_token* read_blocker,
+	       Task_token* this_blocker, Task_token* next_blocker)
+    : input_queue_(input_queue), dwo_file_(dwo_file), name_(name),
+      size_(size), read_blocker_(read_blocker), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Dwo_add_task()
+  {
+    delete this->read_blocker_;
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+    // next_blocker_ is deleted by the task for the next input file.
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->read_blocker_->is_blocked())
+      return this->read_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    this->input_queue_->add_file(workqueue, this->dwo_file_, this->name_,
+				 this->size_);
+  }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_add_task ") + this->name_; }
+
+ private:
+  Dwp_input_queue* input_queue_;
+  Dwo_file* dwo_file_;
+  const char* name_;
+  off_t size_;
+  Task_token* read_blocker_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Queue tasks for the next input files.  We keep up to two files per
+// job in flight, so that the threads have something to scan while
+// the previous files are being added, and stay within the memory
+// limit.  We always queue at least one file.
+
+void
+Dwp_input_queue::queue_files(Workqueue* workqueue)
+{
+  while (this->next_file_ < this->files_.size()
+	 && this->files_in_flight_ < 2 * this->jobs_)
+    {
+      const char* name = this->files_[this->next_file_].dwo_name.c_str();
+
+      struct stat st;
+      off_t size = ::stat(name, &st) == 0 ? st.st_size : 0;
+      if (this->files_in_flight_ > 0
+	  && this->memory_limit_ != 0
+	  && this->bytes_in_flight_ + size > this->memory_limit_)
+	break;
+
+      ++this->next_file_;
+      ++this->files_in_flight_;
+      this->bytes_in_flight_ += size;
+
+      Dwo_file* dwo_file = new Dwo_file(name);
+
+      Task_token* read_blocker = new Task_token(true);
+      workqueue->add_blocker(read_blocker);
+      Task_token* this_blocker = this->next_blocker_;
+      this->next_blocker_ = new Task_token(true);
+      workqueue->add_blocker(this->next_blocker_);
+
+      workqueue->queue(new Dwo_scan_task(dwo_file, name, this->output_file_,
+					 read_blocker));
+      workqueue->queue(new Dwo_add_task(this, dwo_file, name, size,
+					read_blocker, this_blocker,
+					this->next_blocker_));
+    }
+}
+
+// Add an input file to the output file, and queue more files now that
+// it no longer counts against the limits.
+
+void
+Dwp_input_queue::add_file(Workqueue* workqueue, Dwo_file* dwo_file,
+			  const char* name, off_t size)
+{
+  if (this->verbose_)
+    fprintf(stderr, "%s\n", name);
+  dwo_file->add(this->output_file_);
+  delete dwo_file;
+
+  --this->files_in_flight_;
+  this->bytes_in_flight_ -= size;
+  this->queue_files(workqueue);
+}
+
 }; // End namespace gold
 
 using namespace gold;
@@ -2292,12 +2680,15 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  MEMORY_LIMIT = 0x102,
 };
 
 struct option dwp_options[] =
   {
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
+    { "jobs", required_argument, NULL, 'j' },
+    { "memory-limit", required_argument, NULL, MEMORY_LIMIT },
     { "output", required_argument, NULL, 'o' },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
@@ -2314,6 +2705,10 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -h, --help               Print this help message\n"));
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
+  fprintf(fd, _("  -j N, --jobs N           Read N input files in parallel\n"));
+  fprintf(fd, _("  --memory-limit SIZE      Limit the data held in memory to"
+					   " about SIZE bytes\n"
+		"                           (SIZE may end in K, M or G)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
@@ -2327,6 +2722,34 @@ usage(FILE* fd, int exit_status)
   exit(exit_status);
 }
 
+// Parse the argument of --memory-limit, a number of bytes with an
+// optional K, M or G suffix.
+
+static uint64_t
+parse_memory_limit(const char* arg)
+{
+  char* end;
+  uint64_t val = strtoull(arg, &end, 0);
+  switch (*end)
+    {
+    case 'G': case 'g':
+      val <<= 10;
+      // Fall through.
+    case 'M': case 'm':
+      val <<= 10;
+      // Fall through.
+    case 'K': case 'k':
+      val <<= 10;
+      ++end;
+      break;
+    default:
+      break;
+    }
+  if (end == arg || *end != '\0')
+    gold_fatal(_("invalid memory limit: %s"), arg);
+  return val;
+}
+
 // Report version information.
 
 static void
@@ -2363,12 +2786,6 @@ main(int argc, char** argv)
   Errors errors(program_name);
   set_parameters_errors(&errors);
 
-  // Initialize gold's global options.  We don't use these in
-  // this program, but they need to be initialized so that
-  // functions we call from libgold work properly.
-  General_options options;
-  set_parameters_options(&options);
-
   // In libiberty; expands @filename to the args in "filename".
   expandargv(&argc, &argv);
 
@@ -2378,8 +2795,10 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  int jobs = 1;
+  uint64_t memory_limit = 0;
   int c;
-  while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
+  while ((c = getopt_long(argc, argv, "e:hj:o:vV", dwp_options, NULL)) != -1)
     {
       switch (c)
         {
@@ -2388,6 +2807,14 @@ main(int argc, char** argv)
 	  case 'e':
 	    exe_filename = optarg;
 	    break;
+	  case 'j':
+	    jobs = atoi(optarg);
+	    if (jobs <= 0)
+	      gold_fatal(_("invalid number of jobs: %s"), optarg);
+	    break;
+	  case MEMORY_LIMIT:
+	    memory_limit = parse_memory_limit(optarg);
+	    break;
 	  case 'o':
 	    output_filename.assign(optarg);
 	    break;
@@ -2405,6 +2832,23 @@ main(int argc, char** argv)
 	}
     }
 
+  // Initialize gold's global options.  We only use these to turn on
+  // threads, but they need to be initialized so that functions we
+  // call from libgold work properly.
+  Command_line command_line;
+  if (jobs > 1)
+    {
+#ifdef ENABLE_THREADS
+      const char* threads_argv[] = { program_name, "--threads" };
+      bool no_more_options = false;
+      command_line.process_one_option(2, threads_argv, 1, &no_more_options);
+#else
+      gold_warning(_("ignoring --jobs: threads not supported"));
+      jobs = 1;
+#endif
+    }
+  set_parameters_options(&command_line.options());
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2438,14 +2882,16 @@ main(int argc, char** argv)
 
   // Process each file, adding its contents to the output file.
   Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
-    {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
-    }
+  output_file.set_memory_limit(memory_limit);
+  Workqueue workqueue(command_line.options());
+  workqueue.set_thread_count(jobs);
+  Dwp_input_queue input_queue(&output_file, files, jobs, memory_limit,
+			      verbose);
+  input_queue.queue_files(&workqueue);
+  workqueue.process(0);
   output_file.finalize();
 
-  return EXIT_SUCCESS;
+  // Exit without running the destructors, as gold does.  The workqueue
+  // threads may still be exiting, so the workqueue may not be deleted.
+  gold_exit(GOLD_OK);
 }
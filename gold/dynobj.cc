@@ -30,6 +30,7 @@
 #include "script.h"
 #include "symtab.h"
 #include "dynobj.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -914,6 +915,88 @@ Dynobj::elf_hash(const char* name)
   return h;
 }
 
+// The number of dynamic symbols in each part when computing the hash
+// tables in parallel, and the maximum number of parts.  The GNU hash
+// table needs a bucket array and a bloom filter for each part.
+
+static const unsigned int dynsym_hash_part_size = 16384;
+static const unsigned int dynsym_hash_max_parts = 16;
+
+// Return the number of parts into which to split COUNT dynamic
+// symbols.
+
+unsigned int
+Dynobj::hash_part_count(unsigned int count)
+{
+  if (!parameters->options().threads())
+    return 1;
+  unsigned int parts = count / dynsym_hash_part_size;
+  if (parts < 1)
+    parts = 1;
+  else if (parts > dynsym_hash_max_parts)
+    parts = dynsym_hash_max_parts;
+  return parts;
+}
+
+// Return the index of the first symbol in part I of PARTS parts of
+// COUNT symbols.
+
+static inline unsigned int
+dynsym_hash_part_start(unsigned int count, unsigned int parts,
+		       unsigned int i)
+{
+  return static_cast<uint64_t>(count) * i / parts;
+}
+
+// Compute the hash codes of one part of the dynamic symbols.  For the
+// GNU hash table, this also records which symbols go into the table;
+// only those get a hash code.
+
+class Dynobj::Dynsym_hash_runner : public Task_parallel_runner
+{
+ public:
+  Dynsym_hash_runner(const std::vector<Symbol*>& dynsyms, unsigned int parts,
+		     std::vector<uint32_t>* hashvals,
+		     std::vector<unsigned char>* is_hashed)
+    : dynsyms_(dynsyms), parts_(parts), hashvals_(hashvals),
+      is_hashed_(is_hashed)
+  { }
+
+  void
+  run(unsigned int i);
+
+ private:
+  const std::vector<Symbol*>& dynsyms_;
+  unsigned int parts_;
+  std::vector<uint32_t>* hashvals_;
+  // This is NULL for the ELF hash table.
+  std::vector<unsigned char>* is_hashed_;
+};
+
+void
+Dynobj::Dynsym_hash_runner::run(unsigned int i)
+{
+  const unsigned int count = this->dynsyms_.size();
+  const unsigned int start = dynsym_hash_part_start(count, this->parts_, i);
+  const unsigned int end = dynsym_hash_part_start(count, this->parts_, i + 1);
+  for (unsigned int j = start; j < end; ++j)
+    {
+      Symbol* sym = this->dynsyms_[j];
+      if (this->is_hashed_ == NULL)
+	(*this->hashvals_)[j] = Dynobj::elf_hash(sym->name());
+      else if (!sym->needs_dynsym_value()
+	       && (sym->is_undefined()
+		   || sym->is_from_dynobj()
+		   || sym->is_forced_local()))
+	(*this->is_hashed_)[j] = 0;
+      else
+	{
+	  (*this->is_hashed_)[j] = 1;
+	  (*this->hashvals_)[j] = Dynobj::gnu_hash(sym->name());
+	}
+    }
+}
+
 // Create a standard ELF hash table, setting *PPHASH and *PHASHLEN.
 // DYNSYMS is a vector with all the global dynamic symbols.
 // LOCAL_DYNSYM_COUNT is the number of local symbols in the dynamic
@@ -922,6 +1005,7 @@ Dynobj::elf_hash(const char* name)
 void
 Dynobj::create_elf_hash_table(const std::vector<Symbol*>& dynsyms,
 			      unsigned int local_dynsym_count,
+			      Workqueue* workqueue,
 			      unsigned char** pphash,
 			      unsigned int* phashlen)
 {
@@ -929,8 +1013,9 @@ Dynobj::create_elf_hash_table(const std::vector<Symbol*>& dynsyms,
 
   // Get the hash values for all the symbols.
   std::vector<uint32_t> dynsym_hashvals(dynsym_count);
-  for (unsigned int i = 0; i < dynsym_count; ++i)
-    dynsym_hashvals[i] = Dynobj::elf_hash(dynsyms[i]->name());
+  unsigned int parts = Dynobj::hash_part_count(dynsym_count);
+  Dynsym_hash_runner runner(dynsyms, parts, &dynsym_hashvals, NULL);
+  workqueue->run_parallel(&runner, parts);
 
   const unsigned int bucketcount =
     Dynobj::compute_bucket_count(dynsym_hashvals, false);
@@ -1063,11 +1148,20 @@ Dynobj::gnu_hash(const char* name)
 void
 Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 			      unsigned int local_dynsym_count,
+			      Workqueue* workqueue,
 			      unsigned char** pphash,
 			      unsigned int* phashlen)
 {
   const unsigned int count = dynsyms.size();
 
+  // Compute the hash codes in parallel, noting which symbols we do not
+  // want to put into the hash table.
+  std::vector<uint32_t> hashvals(count);
+  std::vector<unsigned char> is_hashed(count);
+  unsigned int parts = Dynobj::hash_part_count(count);
+  Dynsym_hash_runner runner(dynsyms, parts, &hashvals, &is_hashed);
+  workqueue->run_parallel(&runner, parts);
+
   // Sort the dynamic symbols into two vectors.  Symbols which we do
   // not want to put into the hash table we store into
   // UNHASHED_DYNSYMS.  Symbols which we do want to store we put into
@@ -1087,15 +1181,12 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
     {
       Symbol* sym = dynsyms[i];
 
-      if (!sym->needs_dynsym_value()
-	  && (sym->is_undefined()
-	      || sym->is_from_dynobj()
-	      || sym->is_forced_local()))
+      if (!is_hashed[i])
 	unhashed_dynsyms.push_back(sym);
       else
 	{
 	  hashed_dynsyms.push_back(sym);
-	  dynsym_hashvals.push_back(Dynobj::gnu_hash(sym->name()));
+	  dynsym_hashvals.push_back(hashvals[i]);
 	}
     }
 
@@ -1121,6 +1212,7 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	  Dynobj::sized_create_gnu_hash_table<32, true>(hashed_dynsyms,
 							dynsym_hashvals,
 							unhashed_dynsym_index,
+							workqueue,
 							pphash,
 							phashlen);
 #else
@@ -1133,6 +1225,7 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	  Dynobj::sized_create_gnu_hash_table<32, false>(hashed_dynsyms,
 							 dynsym_hashvals,
 							 unhashed_dynsym_index,
+							 workqueue,
 							 pphash,
 							 phashlen);
 #else
@@ -1148,6 +1241,7 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	  Dynobj::sized_create_gnu_hash_table<64, true>(hashed_dynsyms,
 							dynsym_hashvals,
 							unhashed_dynsym_index,
+							workqueue,
 							pphash,
 							phashlen);
 #else
@@ -1160,6 +1254,7 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	  Dynobj::sized_create_gnu_hash_table<64, false>(hashed_dynsyms,
 							 dynsym_hashvals,
 							 unhashed_dynsym_index,
+							 workqueue,
 							 pphash,
 							 phashlen);
 #else
@@ -1171,8 +1266,123 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
     gold_unreachable();
 }
 
-// Create the actual data for a GNU hash table.  This is just a copy
-// of the code from the old GNU linker.
+// Count the uses of each hash bucket, and set the bloom filter bits,
+// for one part of the hashed dynamic symbols.  Each part has its own
+// bucket counts and bloom filter, which are combined later.
+
+template<int size, bool big_endian>
+class Dynobj::Gnu_hash_count_runner : public Task_parallel_runner
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_WXword Word;
+
+  Gnu_hash_count_runner(const std::vector<uint32_t>& dynsym_hashvals,
+			unsigned int parts, unsigned int bucketcount,
+			uint32_t maskwords, uint32_t shift1, uint32_t shift2,
+			std::vector<uint32_t>* part_counts,
+			std::vector<Word>* part_bitmasks)
+    : dynsym_hashvals_(dynsym_hashvals), parts_(parts),
+      bucketcount_(bucketcount), maskwords_(maskwords), shift1_(shift1),
+      shift2_(shift2), part_counts_(part_counts),
+      part_bitmasks_(part_bitmasks)
+  { }
+
+  void
+  run(unsigned int i)
+  {
+    const unsigned int nsyms = this->dynsym_hashvals_.size();
+    const unsigned int start = dynsym_hash_part_start(nsyms, this->parts_, i);
+    const unsigned int end = dynsym_hash_part_start(nsyms, this->parts_,
+						    i + 1);
+    uint32_t* counts = &(*this->part_counts_)[0] + i * this->bucketcount_;
+    Word* bitmask = &(*this->part_bitmasks_)[0] + i * this->maskwords_;
+    const uint32_t mask = (1U << this->shift1_) - 1U;
+    for (unsigned int j = start; j < end; ++j)
+      {
+	uint32_t hashval = this->dynsym_hashvals_[j];
+	++counts[hashval % this->bucketcount_];
+	unsigned int val = ((hashval >> this->shift1_)
+			    & (this->maskwords_ - 1));
+	bitmask[val] |= (static_cast<Word>(1U)) << (hashval & mask);
+	bitmask[val] |= ((static_cast<Word>(1U))
+			 << ((hashval >> this->shift2_) & mask));
+      }
+  }
+
+ private:
+  const std::vector<uint32_t>& dynsym_hashvals_;
+  unsigned int parts_;
+  unsigned int bucketcount_;
+  uint32_t maskwords_;
+  uint32_t shift1_;
+  uint32_t shift2_;
+  std::vector<uint32_t>* part_counts_;
+  std::vector<Word>* part_bitmasks_;
+};
+
+// Fill in the hash values, and set the dynamic symbol indexes, for
+// one part of the hashed dynamic symbols.  PART_STARTS holds the
+// index of the next symbol in each bucket for each part.  The
+// symbols in a bucket are in the same order as in HASHED_DYNSYMS.
+
+template<int size, bool big_endian>
+class Dynobj::Gnu_hash_fill_runner : public Task_parallel_runner
+{
+ public:
+  Gnu_hash_fill_runner(const std::vector<Symbol*>& hashed_dynsyms,
+		       const std::vector<uint32_t>& dynsym_hashvals,
+		       unsigned int parts, unsigned int bucketcount,
+		       uint32_t symindx, const std::vector<uint32_t>& ends,
+		       std::vector<uint32_t>* part_starts,
+		       unsigned char* pvals)
+    : hashed_dynsyms_(hashed_dynsyms), dynsym_hashvals_(dynsym_hashvals),
+      parts_(parts), bucketcount_(bucketcount), symindx_(symindx),
+      ends_(ends), part_starts_(part_starts), pvals_(pvals)
+  { }
+
+  void
+  run(unsigned int i)
+  {
+    const unsigned int nsyms = this->dynsym_hashvals_.size();
+    const unsigned int start = dynsym_hash_part_start(nsyms, this->parts_, i);
+    const unsigned int end = dynsym_hash_part_start(nsyms, this->parts_,
+						    i + 1);
+    uint32_t* indx = &(*this->part_starts_)[0] + i * this->bucketcount_;
+    for (unsigned int j = start; j < end; ++j)
+      {
+	uint32_t hashval = this->dynsym_hashvals_[j];
+	unsigned int bucket = hashval % this->bucketcount_;
+	unsigned int index = indx[bucket];
+	++indx[bucket];
+
+	uint32_t val = hashval & ~ 1U;
+	if (index + 1 == this->ends_[bucket])
+	  {
+	    // Last element terminates the chain.
+	    val |= 1;
+	  }
+	elfcpp::Swap<32, big_endian>::writeval(this->pvals_
+					       + (index - this->symindx_) * 4,
+					       val);
+
+	this->hashed_dynsyms_[j]->set_dynsym_index(index);
+      }
+  }
+
+ private:
+  const std::vector<Symbol*>& hashed_dynsyms_;
+  const std::vector<uint32_t>& dynsym_hashvals_;
+  unsigned int parts_;
+  unsigned int bucketcount_;
+  uint32_t symindx_;
+  const std::vector<uint32_t>& ends_;
+  std::vector<uint32_t>* part_starts_;
+  unsigned char* pvals_;
+};
+
+// Create the actual data for a GNU hash table.  The layout is the same
+// as that of the old GNU linker.  The symbols are put into the buckets
+// with a counting sort, done in parallel parts.
 
 template<int size, bool big_endian>
 void
@@ -1180,6 +1390,7 @@ Dynobj::sized_create_gnu_hash_table(
     const std::vector<Symbol*>& hashed_dynsyms,
     const std::vector<uint32_t>& dynsym_hashvals,
     unsigned int unhashed_dynsym_count,
+    Workqueue* workqueue,
     unsigned char** pphash,
     unsigned int* phashlen)
 {
@@ -1235,26 +1446,58 @@ Dynobj::sized_create_gnu_hash_table(
 	maskbitslog2 = 6;
       shift1 = 6;
     }
-  uint32_t mask = (1U << shift1) - 1U;
+
+  // The size of the bloom filter may be set by the user.  A larger
+  // filter lets the dynamic linker reject more symbols without
+  // looking at the buckets.
+  uint32_t hash_bloom_words = parameters->options().hash_bloom_words();
+  if (hash_bloom_words != 0)
+    {
+      maskbitslog2 = shift1;
+      while ((1U << (maskbitslog2 - shift1)) < hash_bloom_words)
+	++maskbitslog2;
+      gold_assert(maskbitslog2 <= 31);
+    }
+
   uint32_t shift2 = maskbitslog2;
+  if (parameters->options().hash_bloom_shift() != 0)
+    shift2 = parameters->options().hash_bloom_shift();
   uint32_t maskbits = 1U << maskbitslog2;
   uint32_t maskwords = 1U << (maskbitslog2 - shift1);
 
   typedef typename elfcpp::Elf_types<size>::Elf_WXword Word;
-  std::vector<Word> bitmask(maskwords);
-  std::vector<uint32_t> counts(bucketcount);
-  std::vector<uint32_t> indx(bucketcount);
   uint32_t symindx = unhashed_dynsym_count;
 
-  // Count the number of times each hash bucket is used.
-  for (unsigned int i = 0; i < nsyms; ++i)
-    ++counts[dynsym_hashvals[i] % bucketcount];
-
+  // Count the number of times each hash bucket is used by each part,
+  // and build the bloom filter for each part.
+  unsigned int parts = Dynobj::hash_part_count(nsyms);
+  std::vector<uint32_t> part_counts(parts * bucketcount);
+  std::vector<Word> part_bitmasks(parts * maskwords);
+  Gnu_hash_count_runner<size, big_endian> count_runner(dynsym_hashvals,
+						       parts, bucketcount,
+						       maskwords, shift1,
+						       shift2, &part_counts,
+						       &part_bitmasks);
+  workqueue->run_parallel(&count_runner, parts);
+
+  // Compute the first index of each bucket, and the first index of
+  // each part within each bucket.  Replace the counts of each part
+  // with its first index.
+  std::vector<uint32_t> counts(bucketcount);
+  std::vector<uint32_t> indx(bucketcount);
+  std::vector<uint32_t> ends(bucketcount);
   unsigned int cnt = symindx;
   for (unsigned int i = 0; i < bucketcount; ++i)
     {
       indx[i] = cnt;
-      cnt += counts[i];
+      for (unsigned int j = 0; j < parts; ++j)
+	{
+	  uint32_t c = part_counts[j * bucketcount + i];
+	  part_counts[j * bucketcount + i] = cnt;
+	  cnt += c;
+	}
+      counts[i] = cnt - indx[i];
+      ends[i] = cnt;
     }
 
   unsigned int hashlen = (4 + bucketcount + nsyms) * 4;
@@ -1276,34 +1519,19 @@ Dynobj::sized_create_gnu_hash_table(
       p += 4;
     }
 
-  for (unsigned int i = 0; i < nsyms; ++i)
-    {
-      Symbol* sym = hashed_dynsyms[i];
-      uint32_t hashval = dynsym_hashvals[i];
-
-      unsigned int bucket = hashval % bucketcount;
-      unsigned int val = ((hashval >> shift1)
-			  & ((maskbits >> shift1) - 1));
-      bitmask[val] |= (static_cast<Word>(1U)) << (hashval & mask);
-      bitmask[val] |= (static_cast<Word>(1U)) << ((hashval >> shift2) & mask);
-      val = hashval & ~ 1U;
-      if (counts[bucket] == 1)
-	{
-	  // Last element terminates the chain.
-	  val |= 1;
-	}
-      elfcpp::Swap<32, big_endian>::writeval(p + (indx[bucket] - symindx) * 4,
-					     val);
-      --counts[bucket];
-
-      sym->set_dynsym_index(indx[bucket]);
-      ++indx[bucket];
-    }
+  Gnu_hash_fill_runner<size, big_endian> fill_runner(hashed_dynsyms,
+						     dynsym_hashvals, parts,
+						     bucketcount, symindx,
+						     ends, &part_counts, p);
+  workqueue->run_parallel(&fill_runner, parts);
 
   p = phash + 16;
   for (unsigned int i = 0; i < maskwords; ++i)
     {
-      elfcpp::Swap<size, big_endian>::writeval(p, bitmask[i]);
+      Word w = part_bitmasks[i];
+      for (unsigned int j = 1; j < parts; ++j)
+	w |= part_bitmasks[j * maskwords + i];
+      elfcpp::Swap<size, big_endian>::writeval(p, w);
       p += size / 8;
     }
 
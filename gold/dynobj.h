@@ -32,6 +32,7 @@ namespace gold
 {
 
 class Version_script_info;
+class Workqueue;
 
 // A dynamic object (ET_DYN).  This is an abstract base class itself.
 // The implementations is the template class Sized_dynobj.
@@ -89,20 +90,24 @@ class Dynobj : public Object
   // Create a standard ELF hash table, setting *PPHASH and *PHASHLEN.
   // DYNSYMS is the global dynamic symbols.  LOCAL_DYNSYM_COUNT is the
   // number of local dynamic symbols, which is the index of the first
-  // dynamic gobal symbol.
+  // dynamic gobal symbol.  The hash codes are computed in parallel
+  // using WORKQUEUE.
   static void
   create_elf_hash_table(const std::vector<Symbol*>& dynsyms,
 			unsigned int local_dynsym_count,
+			Workqueue* workqueue,
 			unsigned char** pphash,
 			unsigned int* phashlen);
 
   // Create a GNU hash table, setting *PPHASH and *PHASHLEN.  DYNSYMS
   // is the global dynamic symbols.  LOCAL_DYNSYM_COUNT is the number
   // of local dynamic symbols, which is the index of the first dynamic
-  // gobal symbol.
+  // gobal symbol.  The hash codes and buckets are computed in parallel
+  // using WORKQUEUE.
   static void
   create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 			unsigned int local_dynsym_count,
+			Workqueue* workqueue,
 			unsigned char** pphash, unsigned int* phashlen);
 
  protected:
@@ -126,6 +131,19 @@ class Dynobj : public Object
   static uint32_t
   gnu_hash(const char*);
 
+  // Tasks used to compute the hash codes of the dynamic symbols, and
+  // to fill in the GNU hash table, in parallel.
+  class Dynsym_hash_runner;
+  template<int size, bool big_endian>
+  class Gnu_hash_count_runner;
+  template<int size, bool big_endian>
+  class Gnu_hash_fill_runner;
+
+  // Return the number of parts into which to split COUNT symbols for
+  // processing in parallel.
+  static unsigned int
+  hash_part_count(unsigned int count);
+
   // Compute the number of hash buckets to use.
   static unsigned int
   compute_bucket_count(const std::vector<uint32_t>& hashcodes,
@@ -145,6 +163,7 @@ class Dynobj : public Object
   sized_create_gnu_hash_table(const std::vector<Symbol*>& hashed_dynsyms,
 			      const std::vector<uint32_t>& dynsym_hashvals,
 			      unsigned int unhashed_dynsym_count,
+			      Workqueue* workqueue,
 			      unsigned char** pphash,
 			      unsigned int* phashlen);
 
@@ -24,11 +24,13 @@
 
 #include <cstring>
 #include <algorithm>
+#include <functional>
 
 #include "elfcpp.h"
 #include "dwarf.h"
 #include "symtab.h"
 #include "reloc.h"
+#include "workqueue.h"
 #include "ehframe.h"
 
 namespace gold
@@ -76,6 +78,55 @@ namespace gold
 
 const int eh_frame_hdr_size = 4;
 
+// With threads, the lookup table is sorted in parts of at least this
+// many FDEs, and in at most eh_frame_hdr_max_sort_parts parts.
+
+const unsigned int eh_frame_hdr_sort_part_size = 16384;
+const unsigned int eh_frame_hdr_max_sort_parts = 64;
+
+// Eh_frame_hdr_sort_task reads the PCs of one part of the FDEs from
+// the output file and sorts them.
+
+class Eh_frame_hdr_sort_task : public Task
+{
+ public:
+  Eh_frame_hdr_sort_task(Eh_frame_hdr* hdr, Output_file* of,
+			 unsigned int part, Task_token* this_blocker,
+			 Task_token* next_blocker)
+    : hdr_(hdr), of_(of), part_(part), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->hdr_->sort_part(this->of_, this->part_); }
+
+  std::string
+  get_name() const
+  { return "Eh_frame_hdr_sort_task"; }
+
+ private:
+  Eh_frame_hdr* hdr_;
+  Output_file* of_;
+  unsigned int part_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // Construct the exception frame header.
 
 Eh_frame_hdr::Eh_frame_hdr(Output_section* eh_frame_section,
@@ -84,10 +135,73 @@ Eh_frame_hdr::Eh_frame_hdr(Output_section* eh_frame_section,
     eh_frame_section_(eh_frame_section),
     eh_frame_data_(eh_frame_data),
     fde_offsets_(),
+    sorted_parts_(),
     any_unrecognized_eh_frame_sections_(false)
 {
 }
 
+// Return the number of parts into which to split the lookup table
+// for sorting.
+
+unsigned int
+Eh_frame_hdr::sort_part_count() const
+{
+  if (this->any_unrecognized_eh_frame_sections_
+      || !parameters->options().threads())
+    return 1;
+  unsigned int fde_count = this->eh_frame_data_->fde_count();
+  unsigned int parts = fde_count / eh_frame_hdr_sort_part_size;
+  if (parts == 0)
+    return 1;
+  return std::min(parts, eh_frame_hdr_max_sort_parts);
+}
+
+// Queue the tasks which sort the lookup table.
+
+void
+Eh_frame_hdr::queue_sort_tasks(Workqueue* workqueue, Output_file* of,
+			       Task_token* this_blocker,
+			       Task_token* next_blocker)
+{
+  unsigned int parts = this->sort_part_count();
+  this->sorted_parts_.resize(parts);
+  for (unsigned int i = 0; i < parts; ++i)
+    workqueue->queue(new Eh_frame_hdr_sort_task(this, of, i, this_blocker,
+						next_blocker));
+}
+
+// Read and sort part I of the lookup table.
+
+void
+Eh_frame_hdr::sort_part(Output_file* of, unsigned int i)
+{
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      this->sized_sort_part<32, false>(of, i);
+      break;
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      this->sized_sort_part<32, true>(of, i);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      this->sized_sort_part<64, false>(of, i);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      this->sized_sort_part<64, true>(of, i);
+      break;
+#endif
+    default:
+      gold_unreachable();
+    }
+}
+
 // Set the size of the exception frame header.
 
 void
@@ -182,23 +296,48 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       // relocations which are, of course, target specific.  This code
       // is run after all those relocations have been applied to the
       // output file.  Here we read the output file again to find the
-      // PC values.  Then we sort the list and write it out.
+      // PC values, and sort them.  With threads, Eh_frame_hdr_sort_task
+      // has already done this for each part of the list.  Then we
+      // merge the sorted parts and write out the list.
 
-      Fde_addresses<size> fde_addresses(this->fde_offsets_.size());
-      this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
-						&fde_addresses);
-
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
+      if (this->sorted_parts_.empty())
+	{
+	  this->sorted_parts_.resize(1);
+	  this->sized_sort_part<size, big_endian>(of, 0);
+	}
 
       typename elfcpp::Elf_types<size>::Elf_Addr output_address;
       output_address = this->address();
 
+      // Merge the parts using a heap of the next PC of each part.  A
+      // PC found in more than one part is taken from the earlier part
+      // first, so that FDEs with the same PC stay in .eh_frame order.
+      const unsigned int parts = this->sorted_parts_.size();
+      std::vector<size_t> next(parts, 0);
+      typedef std::pair<uint64_t, unsigned int> Heap_entry;
+      std::vector<Heap_entry> heap;
+      heap.reserve(parts);
+      for (unsigned int i = 0; i < parts; ++i)
+	if (!this->sorted_parts_[i].empty())
+	  heap.push_back(std::make_pair(this->sorted_parts_[i][0].first, i));
+      std::make_heap(heap.begin(), heap.end(), std::greater<Heap_entry>());
+
       unsigned char* pfde = oview + 12;
-      for (typename Fde_addresses<size>::iterator p = fde_addresses.begin();
-	   p != fde_addresses.end();
-	   ++p)
+      while (!heap.empty())
 	{
+	  std::pop_heap(heap.begin(), heap.end(), std::greater<Heap_entry>());
+	  unsigned int i = heap.back().second;
+	  const Fde_address* p = &this->sorted_parts_[i][next[i]];
+	  ++next[i];
+	  if (next[i] < this->sorted_parts_[i].size())
+	    {
+	      heap.back().first = this->sorted_parts_[i][next[i]].first;
+	      std::push_heap(heap.begin(), heap.end(),
+			     std::greater<Heap_entry>());
+	    }
+	  else
+	    heap.pop_back();
+
 	  elfcpp::Swap<32, big_endian>::writeval(pfde,
 						 p->first - output_address);
 	  elfcpp::Swap<32, big_endian>::writeval(pfde + 4,
@@ -206,6 +345,8 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
 	  pfde += 8;
 	}
 
+      this->sorted_parts_.clear();
+
       gold_assert(pfde - oview == oview_size);
     }
 
@@ -290,18 +431,21 @@ Eh_frame_hdr::get_fde_pc(
   return pc;
 }
 
-// Given an array of FDE offsets in the .eh_frame section, return an
-// array of offsets from the exception frame header to the FDE's
-// output PC and to the output address of the FDE itself.  We get the
-// FDE's PC by actually looking in the .eh_frame section we just wrote
-// to the output file.
+// Convert part I of the FDE offsets in the .eh_frame section into
+// FDE addresses: the output address of the FDE's PC and of the FDE
+// itself.  We get the FDE's PC by actually looking in the .eh_frame
+// section we just wrote to the output file.  Then sort the part by
+// PC.
 
 template<int size, bool big_endian>
 void
-Eh_frame_hdr::get_fde_addresses(Output_file* of,
-				const Fde_offsets* fde_offsets,
-				Fde_addresses<size>* fde_addresses)
+Eh_frame_hdr::sized_sort_part(Output_file* of, unsigned int i)
 {
+  const size_t count = this->fde_offsets_.size();
+  const size_t parts = this->sorted_parts_.size();
+  const size_t begin = count * i / parts;
+  const size_t end = count * (i + 1) / parts;
+
   typename elfcpp::Elf_types<size>::Elf_Addr eh_frame_address;
   eh_frame_address = this->eh_frame_section_->address();
   off_t eh_frame_offset = this->eh_frame_section_->offset();
@@ -309,18 +453,85 @@ Eh_frame_hdr::get_fde_addresses(Output_file* of,
   const unsigned char* eh_frame_contents = of->get_input_view(eh_frame_offset,
 							      eh_frame_size);
 
-  for (Fde_offsets::const_iterator p = fde_offsets->begin();
-       p != fde_offsets->end();
-       ++p)
+  Fde_address_list* fde_addresses = &this->sorted_parts_[i];
+  fde_addresses->reserve(end - begin);
+  for (size_t j = begin; j < end; ++j)
     {
+      const Fde_offset& fde_offset(this->fde_offsets_[j]);
       typename elfcpp::Elf_types<size>::Elf_Addr fde_pc;
       fde_pc = this->get_fde_pc<size, big_endian>(eh_frame_address,
 						  eh_frame_contents,
-						  p->first, p->second);
-      fde_addresses->push_back(fde_pc, eh_frame_address + p->first);
+						  fde_offset.first,
+						  fde_offset.second);
+      typename elfcpp::Elf_types<size>::Elf_Addr fde_address;
+      fde_address = eh_frame_address + fde_offset.first;
+      fde_addresses->push_back(std::make_pair(fde_pc, fde_address));
     }
 
   of->free_input_view(eh_frame_offset, eh_frame_size, eh_frame_contents);
+
+  radix_sort(fde_addresses);
+}
+
+// Sort FDE_ADDRESSES by PC, using a least significant digit first
+// radix sort on the offset of the PC from the lowest PC.  The sort
+// is stable, so FDEs with the same PC stay in .eh_frame order.  The
+// FDEs are often already in order, since the .eh_frame sections are
+// in input order, and in that case we don't need to do anything.
+
+void
+Eh_frame_hdr::radix_sort(Fde_address_list* fde_addresses)
+{
+  const size_t count = fde_addresses->size();
+  if (count < 2)
+    return;
+
+  uint64_t min_pc = (*fde_addresses)[0].first;
+  uint64_t max_pc = min_pc;
+  bool is_sorted = true;
+  for (size_t i = 1; i < count; ++i)
+    {
+      uint64_t pc = (*fde_addresses)[i].first;
+      if (pc < (*fde_addresses)[i - 1].first)
+	is_sorted = false;
+      min_pc = std::min(min_pc, pc);
+      max_pc = std::max(max_pc, pc);
+    }
+  if (is_sorted)
+    return;
+
+  const int radix_bits = 11;
+  const size_t radix = static_cast<size_t>(1) << radix_bits;
+  std::vector<size_t> counts(radix);
+  Fde_address_list buffer(count);
+  Fde_address_list* from = fde_addresses;
+  Fde_address_list* to = &buffer;
+  const uint64_t range = max_pc - min_pc;
+  for (int shift = 0; shift < 64 && (range >> shift) != 0; shift += radix_bits)
+    {
+      std::fill(counts.begin(), counts.end(), 0);
+      for (size_t i = 0; i < count; ++i)
+	++counts[(((*from)[i].first - min_pc) >> shift) & (radix - 1)];
+
+      size_t pos = 0;
+      for (size_t d = 0; d < radix; ++d)
+	{
+	  size_t c = counts[d];
+	  counts[d] = pos;
+	  pos += c;
+	}
+
+      for (size_t i = 0; i < count; ++i)
+	{
+	  size_t d = (((*from)[i].first - min_pc) >> shift) & (radix - 1);
+	  (*to)[counts[d]++] = (*from)[i];
+	}
+
+      std::swap(from, to);
+    }
+
+  if (from != fde_addresses)
+    fde_addresses->swap(buffer);
 }
 
 // Class Fde.
@@ -586,9 +797,10 @@ Eh_frame::skip_leb128(const unsigned char** pp, const unsigned char* pend)
 // section applying to SHNDX, or 0 if none, or -1U if more than one.
 // RELOC_TYPE is the type of the reloc section if there is one, either
 // SHT_REL or SHT_RELA.  We try to parse the input exception frame
-// data into our data structures.  If we can't do it, we return false
-// to mean that the section should be handled as a normal input
-// section.
+// data into our data structures.  If we can't do it, we return
+// EH_UNRECOGNIZED_SECTION to mean that the section should be handled
+// as a normal input section.  The object may already have read the
+// section while reading its symbols.
 
 template<int size, bool big_endian>
 Eh_frame::Eh_frame_section_disposition
@@ -602,60 +814,177 @@ Eh_frame::add_ehframe_input_section(
     unsigned int reloc_shndx,
     unsigned int reloc_type)
 {
+  Eh_frame_input_section* input = object->release_eh_frame_input();
+  if (input != NULL && !input->is_for(shndx, reloc_shndx, reloc_type))
+    {
+      delete input;
+      input = NULL;
+    }
+  if (input == NULL)
+    input = read_input_section(object, symbols, symbols_size, symbol_names,
+			       symbol_names_size, shndx, reloc_shndx,
+			       reloc_type);
+
+  Eh_frame_section_disposition disposition = input->disposition_;
+  if (disposition == EH_UNRECOGNIZED_SECTION)
+    {
+      if (this->eh_frame_hdr_ != NULL)
+	this->eh_frame_hdr_->found_unrecognized_eh_frame_section();
+    }
+  else if (disposition == EH_OPTIMIZABLE_SECTION)
+    this->add_input_section(object, input);
+
+  delete input;
+  return disposition;
+}
+
+// Read the CIEs and FDEs of input section SHNDX in OBJECT, without
+// looking at or changing the Eh_frame.
+
+template<int size, bool big_endian>
+Eh_frame_input_section*
+Eh_frame::read_input_section(
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type)
+{
+  Eh_frame_input_section* input = new Eh_frame_input_section(shndx,
+							     reloc_shndx,
+							     reloc_type);
+
   // Get the section contents.
   section_size_type contents_len;
   const unsigned char* pcontents = object->section_contents(shndx,
 							    &contents_len,
 							    false);
   if (contents_len == 0)
-    return EH_EMPTY_SECTION;
+    input->disposition_ = EH_EMPTY_SECTION;
 
   // If this is the marker section for the end of the data, then
   // return false to force it to be handled as an ordinary input
   // section.  If we don't do this, we won't correctly handle the case
   // of unrecognized .eh_frame sections.
-  if (contents_len == 4
-      && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0)
-    return EH_END_MARKER_SECTION;
-
-  New_cies new_cies;
-  if (!this->do_add_ehframe_input_section(object, symbols, symbols_size,
-					  symbol_names, symbol_names_size,
-					  shndx, reloc_shndx,
-					  reloc_type, pcontents,
-					  contents_len, &new_cies))
+  else if (contents_len == 4
+	   && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0)
+    input->disposition_ = EH_END_MARKER_SECTION;
+
+  else if (do_read_input_section(object, symbols, symbols_size,
+				 symbol_names, symbol_names_size,
+				 shndx, reloc_shndx, reloc_type, pcontents,
+				 contents_len, input))
+    input->disposition_ = EH_OPTIMIZABLE_SECTION;
+
+  else
     {
-      if (this->eh_frame_hdr_ != NULL)
-	this->eh_frame_hdr_->found_unrecognized_eh_frame_section();
+      input->clear();
+      input->disposition_ = EH_UNRECOGNIZED_SECTION;
+    }
+
+  return input;
+}
 
-      for (New_cies::iterator p = new_cies.begin();
-	   p != new_cies.end();
-	   ++p)
-	delete p->first;
+// Add the CIEs and FDEs read from an input section of OBJECT.
 
-      return EH_UNRECOGNIZED_SECTION;
+template<int size, bool big_endian>
+void
+Eh_frame::add_input_section(Sized_relobj_file<size, big_endian>* object,
+			    Eh_frame_input_section* input)
+{
+  // Use the CIEs we have already seen in other sections where we can,
+  // and record the new ones.
+  const size_t cie_count = input->cies_.size();
+  std::vector<Cie*> cies(cie_count);
+  std::vector<bool> merged(cie_count, false);
+  for (size_t i = 0; i < cie_count; ++i)
+    {
+      Cie* cie = input->cies_[i].first;
+      bool mergeable = input->cies_[i].second;
+      input->cies_[i].first = NULL;
+      if (mergeable)
+	{
+	  Cie_offsets::iterator find_cie = this->cie_offsets_.find(cie);
+	  if (find_cie != this->cie_offsets_.end())
+	    {
+	      cies[i] = *find_cie;
+	      merged[i] = true;
+	      delete cie;
+	      continue;
+	    }
+	  this->cie_offsets_.insert(cie);
+	}
+      else
+	this->unmergeable_cie_offsets_.push_back(cie);
+      cies[i] = cie;
     }
 
-  // Now that we know we are using this section, record any new CIEs
-  // that we found.
-  for (New_cies::const_iterator p = new_cies.begin();
-       p != new_cies.end();
+  const unsigned int shndx = input->shndx_;
+  for (std::vector<Eh_frame_input_section::Entry>::iterator p =
+	 input->entries_.begin();
+       p != input->entries_.end();
        ++p)
     {
-      if (p->second)
-	this->cie_offsets_.insert(p->first);
+      bool is_discarded;
+      if (p->is_cie)
+	is_discarded = p->is_duplicate || merged[p->cie_index];
+      else if (p->fde == NULL)
+	is_discarded = true;
       else
-	this->unmergeable_cie_offsets_.push_back(p->first);
+	{
+	  // Find the section index for code that this FDE describes.
+	  // If we have discarded the section, we can also discard the
+	  // FDE.
+	  bool is_ordinary;
+	  unsigned int fde_shndx = object->adjust_sym_shndx(p->symndx,
+							    p->st_shndx,
+							    &is_ordinary);
+	  is_discarded = (is_ordinary
+			  && fde_shndx != elfcpp::SHN_UNDEF
+			  && fde_shndx < object->shnum()
+			  && !object->is_section_included(fde_shndx));
+	  if (!is_discarded)
+	    {
+	      cies[p->cie_index]->add_fde(p->fde);
+	      p->fde = NULL;
+	    }
+	}
+
+      if (is_discarded)
+	{
+	  // We are deleting this CIE or FDE.  Record that in our
+	  // mapping from input sections to the output section.
+	  object->add_merge_mapping(this, shndx, p->input_offset, p->length,
+				    -1);
+	}
     }
+}
+
+// Delete the CIEs and FDEs which were not added to the output.
 
-  return EH_OPTIMIZABLE_SECTION;
+void
+Eh_frame_input_section::clear()
+{
+  for (std::vector<std::pair<Cie*, bool> >::iterator p = this->cies_.begin();
+       p != this->cies_.end();
+       ++p)
+    delete p->first;
+  this->cies_.clear();
+  for (std::vector<Entry>::iterator p = this->entries_.begin();
+       p != this->entries_.end();
+       ++p)
+    delete p->fde;
+  this->entries_.clear();
 }
 
-// The bulk of the implementation of add_ehframe_input_section.
+// The bulk of the implementation of read_input_section.
 
 template<int size, bool big_endian>
 bool
-Eh_frame::do_add_ehframe_input_section(
+Eh_frame::do_read_input_section(
     Sized_relobj_file<size, big_endian>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -666,7 +995,7 @@ Eh_frame::do_add_ehframe_input_section(
     unsigned int reloc_type,
     const unsigned char* pcontents,
     section_size_type contents_len,
-    New_cies* new_cies)
+    Eh_frame_input_section* input)
 {
   Track_relocs<size, big_endian> relocs;
 
@@ -718,17 +1047,16 @@ Eh_frame::do_add_ehframe_input_section(
       if (id == 0)
 	{
 	  // CIE.
-	  if (!this->read_cie(object, shndx, symbols, symbols_size,
-			      symbol_names, symbol_names_size,
-			      pcontents, p, pentend, &relocs, &cies,
-			      new_cies))
+	  if (!read_cie(object, shndx, symbols, symbols_size,
+			symbol_names, symbol_names_size,
+			pcontents, p, pentend, &relocs, &cies, input))
 	    return false;
 	}
       else
 	{
 	  // FDE.
-	  if (!this->read_fde(object, shndx, symbols, symbols_size,
-			      pcontents, id, p, pentend, &relocs, &cies))
+	  if (!read_fde(object, shndx, symbols, symbols_size,
+			pcontents, id, p, pentend, &relocs, &cies, input))
 	    return false;
 	}
 
@@ -753,7 +1081,7 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pcieend,
 		   Track_relocs<size, big_endian>* relocs,
 		   Offsets_to_cie* cies,
-		   New_cies* new_cies)
+		   Eh_frame_input_section* input)
 {
   bool mergeable = true;
 
@@ -948,46 +1276,38 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 
   Cie cie(object, shndx, (pcie - 8) - pcontents, fde_encoding, 
 	  personality_name, pcie, pcieend - pcie);
-  Cie* cie_pointer = NULL;
+
+  // See if we already saw this CIE in this section.  Whether we saw
+  // it in other sections is decided when the section is added to the
+  // output.
+  Eh_frame_input_section::Entry entry;
+  entry.input_offset = (pcie - 8) - pcontents;
+  entry.length = pcieend - (pcie - 8);
+  entry.cie_index = input->cies_.size();
+  entry.fde = NULL;
+  entry.symndx = 0;
+  entry.st_shndx = 0;
+  entry.is_cie = true;
+  entry.is_duplicate = false;
   if (mergeable)
     {
-      Cie_offsets::iterator find_cie = this->cie_offsets_.find(&cie);
-      if (find_cie != this->cie_offsets_.end())
-	cie_pointer = *find_cie;
-      else
+      for (size_t i = 0; i < input->cies_.size(); ++i)
 	{
-	  // See if we already saw this CIE in this object file.
-	  for (New_cies::const_iterator pc = new_cies->begin();
-	       pc != new_cies->end();
-	       ++pc)
+	  if (*input->cies_[i].first == cie)
 	    {
-	      if (*(pc->first) == cie)
-		{
-		  cie_pointer = pc->first;
-		  break;
-		}
+	      entry.cie_index = i;
+	      entry.is_duplicate = true;
+	      break;
 	    }
 	}
     }
 
-  if (cie_pointer == NULL)
-    {
-      cie_pointer = new Cie(cie);
-      new_cies->push_back(std::make_pair(cie_pointer, mergeable));
-    }
-  else
-    {
-      // We are deleting this CIE.  Record that in our mapping from
-      // input sections to the output section.  At this point we don't
-      // know for sure that we are doing a special mapping for this
-      // input section, but that's OK--if we don't do a special
-      // mapping, nobody will ever ask for the mapping we add here.
-      object->add_merge_mapping(this, shndx, (pcie - 8) - pcontents,
-                                pcieend - (pcie - 8), -1);
-    }
+  if (!entry.is_duplicate)
+    input->cies_.push_back(std::make_pair(new Cie(cie), mergeable));
+  input->entries_.push_back(entry);
 
   // Record this CIE plus the offset in the input section.
-  cies->insert(std::make_pair(pcie - pcontents, cie_pointer));
+  cies->insert(std::make_pair(pcie - pcontents, entry.cie_index));
 
   return true;
 }
@@ -1005,7 +1325,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pfde,
 		   const unsigned char* pfdeend,
 		   Track_relocs<size, big_endian>* relocs,
-		   Offsets_to_cie* cies)
+		   Offsets_to_cie* cies,
+		   Eh_frame_input_section* input)
 {
   // OFFSET is the distance between the 4 bytes before PFDE to the
   // start of the CIE.  The offset we recorded for the CIE is 8 bytes
@@ -1014,7 +1335,17 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   Offsets_to_cie::const_iterator pcie = cies->find(cie_offset);
   if (pcie == cies->end())
     return false;
-  Cie* cie = pcie->second;
+  const Cie* cie = input->cies_[pcie->second].first;
+
+  Eh_frame_input_section::Entry entry;
+  entry.input_offset = (pfde - 8) - pcontents;
+  entry.length = pfdeend - (pfde - 8);
+  entry.cie_index = pcie->second;
+  entry.fde = NULL;
+  entry.symndx = 0;
+  entry.st_shndx = 0;
+  entry.is_cie = false;
+  entry.is_duplicate = false;
 
   int pc_size = 0;
   switch (cie->fde_encoding() & 7)
@@ -1070,8 +1401,7 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 	{
 	  // This FDE applies to a discarded function.  We
 	  // can discard this FDE.
-	  object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-				    pfdeend - (pfde - 8), -1);
+	  input->entries_.push_back(entry);
 	  return true;
 	}
 
@@ -1089,20 +1419,15 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   // pointer to a PC relative offset when generating a shared library.
   relocs->advance(pfdeend - pcontents);
 
-  // Find the section index for code that this FDE describes.
-  // If we have discarded the section, we can also discard the FDE.
-  unsigned int fde_shndx;
+  // Record the symbol for the code that this FDE describes.  If the
+  // section is discarded, we can also discard the FDE; that is
+  // decided when the section is added to the output.
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
   if (symndx >= symbols_size / sym_size)
     return false;
   elfcpp::Sym<size, big_endian> sym(symbols + symndx * sym_size);
-  bool is_ordinary;
-  fde_shndx = object->adjust_sym_shndx(symndx, sym.get_st_shndx(),
-				       &is_ordinary);
-  bool is_discarded = (is_ordinary
-		       && fde_shndx != elfcpp::SHN_UNDEF
-		       && fde_shndx < object->shnum()
-		       && !object->is_section_included(fde_shndx));
+  entry.symndx = symndx;
+  entry.st_shndx = sym.get_st_shndx();
 
   // Fetch the address range field from the FDE. The offset and size
   // of the field depends on the PC encoding given in the CIE, but
@@ -1125,17 +1450,10 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
       gold_unreachable();
     }
 
-  if (is_discarded || address_range == 0)
-    {
-      // This FDE applies to a discarded function.  We
-      // can discard this FDE.
-      object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-                                pfdeend - (pfde - 8), -1);
-      return true;
-    }
-
-  cie->add_fde(new Fde(object, shndx, (pfde - 8) - pcontents,
-		       pfde, pfdeend - pfde));
+  if (address_range != 0)
+    entry.fde = new Fde(object, shndx, (pfde - 8) - pcontents,
+			pfde, pfdeend - pfde);
+  input->entries_.push_back(entry);
 
   return true;
 }
@@ -1341,6 +1659,18 @@ Eh_frame::add_ehframe_input_section<32, false>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Eh_frame_input_section*
+Eh_frame::read_input_section<32, false>(
+    Sized_relobj_file<32, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
@@ -1355,6 +1685,18 @@ Eh_frame::add_ehframe_input_section<32, true>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Eh_frame_input_section*
+Eh_frame::read_input_section<32, true>(
+    Sized_relobj_file<32, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
@@ -1369,6 +1711,18 @@ Eh_frame::add_ehframe_input_section<64, false>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Eh_frame_input_section*
+Eh_frame::read_input_section<64, false>(
+    Sized_relobj_file<64, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
@@ -1383,6 +1737,18 @@ Eh_frame::add_ehframe_input_section<64, true>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Eh_frame_input_section*
+Eh_frame::read_input_section<64, true>(
+    Sized_relobj_file<64, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 } // End namespace gold.
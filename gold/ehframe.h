@@ -37,6 +37,7 @@ template<int size, bool big_endian>
 class Track_relocs;
 
 class Eh_frame;
+class Eh_frame_input_section;
 
 // This class manages the .eh_frame_hdr section, which holds the data
 // for the PT_GNU_EH_FRAME segment.  gcc's unwind support code uses
@@ -63,6 +64,27 @@ class Eh_frame_hdr : public Output_section_data
       this->fde_offsets_.push_back(std::make_pair(fde_offset, fde_encoding));
   }
 
+  // Return the number of parts into which the lookup table is split
+  // for sorting.  This is more than one only when using threads with
+  // a large table.
+  unsigned int
+  sort_part_count() const;
+
+  // Queue the tasks which read the FDE PCs from the output file and
+  // sort them, one for each part of the lookup table.  They run after
+  // THIS_BLOCKER is unblocked, when the .eh_frame section has been
+  // written and relocated.  Each releases a blocker of NEXT_BLOCKER.
+  // The caller must already have added sort_part_count() blockers to
+  // NEXT_BLOCKER.
+  void
+  queue_sort_tasks(Workqueue*, Output_file*, Task_token* this_blocker,
+		   Task_token* next_blocker);
+
+  // Read and sort part I of the lookup table.  This may be called in
+  // parallel for different parts.
+  void
+  sort_part(Output_file*, unsigned int i);
+
  protected:
   // Set the final data size.
   void
@@ -91,48 +113,16 @@ class Eh_frame_hdr : public Output_section_data
   typedef std::vector<Fde_offset> Fde_offsets;
 
   // When writing out the header, we convert the FDE offsets into FDE
-  // addresses.  This is a list of pairs of the offset from the header
-  // to the FDE PC and to the FDE itself.
-  template<int size>
-  class Fde_addresses
-  {
-   public:
-    typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
-    typedef typename std::pair<Address, Address> Fde_address;
-    typedef typename std::vector<Fde_address> Fde_address_list;
-    typedef typename Fde_address_list::iterator iterator;
-
-    Fde_addresses(unsigned int reserve)
-      : fde_addresses_()
-    { this->fde_addresses_.reserve(reserve); }
-
-    void
-    push_back(Address pc_address, Address fde_address)
-    {
-      this->fde_addresses_.push_back(std::make_pair(pc_address, fde_address));
-    }
-
-    iterator
-    begin()
-    { return this->fde_addresses_.begin(); }
-
-    iterator
-    end()
-    { return this->fde_addresses_.end(); }
+  // addresses.  This is a pair of the output address of the FDE PC
+  // and of the FDE itself.
+  typedef std::pair<uint64_t, uint64_t> Fde_address;
 
-   private:
-    Fde_address_list fde_addresses_;
-  };
+  // A list of FDE addresses.
+  typedef std::vector<Fde_address> Fde_address_list;
 
-  // Compare Fde_address objects.
-  template<int size>
-  struct Fde_address_compare
-  {
-    bool
-    operator()(const typename Fde_addresses<size>::Fde_address& f1,
-	       const typename Fde_addresses<size>::Fde_address& f2) const
-    { return f1.first < f2.first; }
-  };
+  // Sort a list of FDE addresses by PC.
+  static void
+  radix_sort(Fde_address_list*);
 
   // Return the PC to which an FDE refers.
   template<int size, bool big_endian>
@@ -141,12 +131,10 @@ class Eh_frame_hdr : public Output_section_data
 	     const unsigned char* eh_frame_contents,
 	     section_offset_type fde_offset, unsigned char fde_encoding);
 
-  // Convert Fde_offsets to Fde_addresses.
+  // Convert part I of fde_offsets_ to FDE addresses, and sort them.
   template<int size, bool big_endian>
   void
-  get_fde_addresses(Output_file* of,
-		    const Fde_offsets* fde_offsets,
-		    Fde_addresses<size>* fde_addresses);
+  sized_sort_part(Output_file* of, unsigned int i);
 
   // The .eh_frame section.
   Output_section* eh_frame_section_;
@@ -154,6 +142,8 @@ class Eh_frame_hdr : public Output_section_data
   const Eh_frame* eh_frame_data_;
   // Data from the FDEs in the .eh_frame sections.
   Fde_offsets fde_offsets_;
+  // The parts of the lookup table, each sorted by PC.
+  std::vector<Fde_address_list> sorted_parts_;
   // Whether we found any .eh_frame sections which we could not
   // process.
   bool any_unrecognized_eh_frame_sections_;
@@ -385,6 +375,11 @@ class Eh_frame : public Output_section_data
   set_eh_frame_hdr(Eh_frame_hdr* hdr)
   { this->eh_frame_hdr_ = hdr; }
 
+  // Return the associated Eh_frame_hdr, if any.
+  Eh_frame_hdr*
+  eh_frame_hdr() const
+  { return this->eh_frame_hdr_; }
+
   // Add the input section SHNDX in OBJECT.  SYMBOLS is the contents
   // of the symbol table section (size SYMBOLS_SIZE), SYMBOL_NAMES is
   // the symbol names section (size SYMBOL_NAMES_SIZE).  RELOC_SHNDX
@@ -402,6 +397,21 @@ class Eh_frame : public Output_section_data
 			    unsigned int shndx, unsigned int reloc_shndx,
 			    unsigned int reloc_type);
 
+  // Read the CIEs and FDEs of the input section SHNDX in OBJECT.  The
+  // arguments are as for add_ehframe_input_section.  This only looks
+  // at the input section, so it may be called for different objects
+  // in parallel, before the Eh_frame is created.  The caller takes
+  // ownership of the result.
+  template<int size, bool big_endian>
+  static Eh_frame_input_section*
+  read_input_section(Sized_relobj_file<size, big_endian>* object,
+		     const unsigned char* symbols,
+		     section_size_type symbols_size,
+		     const unsigned char* symbol_names,
+		     section_size_type symbol_names_size,
+		     unsigned int shndx, unsigned int reloc_shndx,
+		     unsigned int reloc_type);
+
   // Add a CIE and an FDE for a PLT section, to permit unwinding
   // through a PLT.  The FDE data should start with 8 bytes of zero,
   // which will be replaced by a 4 byte PC relative reference to the
@@ -457,36 +467,33 @@ class Eh_frame : public Output_section_data
   // A list of unmergeable CIEs.
   typedef std::vector<Cie*> Unmergeable_cie_offsets;
 
-  // A mapping from offsets to CIEs.  This is used while reading an
-  // input section.
-  typedef std::map<uint64_t, Cie*> Offsets_to_cie;
-
-  // A list of CIEs, and a bool indicating whether the CIE is
-  // mergeable.
-  typedef std::vector<std::pair<Cie*, bool> > New_cies;
+  // A mapping from offsets to the index of a CIE in an
+  // Eh_frame_input_section.  This is used while reading an input
+  // section.
+  typedef std::map<uint64_t, unsigned int> Offsets_to_cie;
 
   // Skip an LEB128.
   static bool
   skip_leb128(const unsigned char**, const unsigned char*);
 
-  // The implementation of add_ehframe_input_section.
+  // The implementation of read_input_section.
   template<int size, bool big_endian>
-  bool
-  do_add_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
-			       const unsigned char* symbols,
-			       section_size_type symbols_size,
-			       const unsigned char* symbol_names,
-			       section_size_type symbol_names_size,
-			       unsigned int shndx,
-			       unsigned int reloc_shndx,
-			       unsigned int reloc_type,
-			       const unsigned char* pcontents,
-			       section_size_type contents_len,
-			       New_cies*);
+  static bool
+  do_read_input_section(Sized_relobj_file<size, big_endian>* object,
+			const unsigned char* symbols,
+			section_size_type symbols_size,
+			const unsigned char* symbol_names,
+			section_size_type symbol_names_size,
+			unsigned int shndx,
+			unsigned int reloc_shndx,
+			unsigned int reloc_type,
+			const unsigned char* pcontents,
+			section_size_type contents_len,
+			Eh_frame_input_section*);
 
   // Read a CIE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_cie(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -498,11 +505,11 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pcieend,
 	   Track_relocs<size, big_endian>* relocs,
 	   Offsets_to_cie* cies,
-	   New_cies* new_cies);
+	   Eh_frame_input_section*);
 
   // Read an FDE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_fde(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -512,7 +519,15 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pfde,
 	   const unsigned char* pfdeend,
 	   Track_relocs<size, big_endian>* relocs,
-	   Offsets_to_cie* cies);
+	   Offsets_to_cie* cies,
+	   Eh_frame_input_section*);
+
+  // Add the CIEs and FDEs read from an input section of OBJECT,
+  // merging the CIEs and discarding the FDEs for discarded code.
+  template<int size, bool big_endian>
+  void
+  add_input_section(Sized_relobj_file<size, big_endian>* object,
+		    Eh_frame_input_section*);
 
   // Template version of write function.
   template<int size, bool big_endian>
@@ -534,6 +549,79 @@ class Eh_frame : public Output_section_data
   section_size_type final_data_size_;
 };
 
+// The CIEs and FDEs read from an input .eh_frame section, before they
+// are added to the output .eh_frame data.  Reading a section looks
+// only at that section, so it may be done for different objects in
+// parallel; Eh_frame::add_input_section then merges the entries into
+// the output in input order.
+
+class Eh_frame_input_section
+{
+ public:
+  Eh_frame_input_section(unsigned int shndx, unsigned int reloc_shndx,
+			 unsigned int reloc_type)
+    : shndx_(shndx), reloc_shndx_(reloc_shndx), reloc_type_(reloc_type),
+      disposition_(Eh_frame::EH_UNRECOGNIZED_SECTION), cies_(), entries_()
+  { }
+
+  ~Eh_frame_input_section()
+  { this->clear(); }
+
+  // Return whether this was read from input section SHNDX with the
+  // relocation section RELOC_SHNDX of type RELOC_TYPE.
+  bool
+  is_for(unsigned int shndx, unsigned int reloc_shndx,
+	 unsigned int reloc_type) const
+  {
+    return (this->shndx_ == shndx
+	    && this->reloc_shndx_ == reloc_shndx
+	    && this->reloc_type_ == reloc_type);
+  }
+
+ private:
+  friend class Eh_frame;
+
+  // An entry in the input section, either a CIE or an FDE.
+  struct Entry
+  {
+    // The offset of the entry in the input section, and its length,
+    // including the length field and the CIE id or pointer.
+    section_offset_type input_offset;
+    section_size_type length;
+    // The index in cies_ of the CIE, or of the CIE which the FDE
+    // uses.
+    unsigned int cie_index;
+    // For an FDE, the FDE, or NULL if it is discarded.
+    Fde* fde;
+    // For an FDE, the symbol at the start of the code which it
+    // describes, and its st_shndx field.
+    unsigned int symndx;
+    unsigned int st_shndx;
+    // Whether this is a CIE.
+    bool is_cie;
+    // For a CIE, whether it is a duplicate of an earlier CIE in the
+    // same section.
+    bool is_duplicate;
+  };
+
+  // Delete the CIEs and FDEs which have not been added to the output.
+  void
+  clear();
+
+  // The input section index.
+  unsigned int shndx_;
+  // The relocation section and its type.
+  unsigned int reloc_shndx_;
+  unsigned int reloc_type_;
+  // What to do with the section.
+  Eh_frame::Eh_frame_section_disposition disposition_;
+  // The distinct CIEs in the section, and whether each one may be
+  // merged with CIEs in other sections.
+  std::vector<std::pair<Cie*, bool> > cies_;
+  // The entries in the order in which they appear in the section.
+  std::vector<Entry> entries_;
+};
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_EHFRAME_H)
@@ -30,6 +30,7 @@
 #include "object.h"
 #include "symtab.h"
 #include "errors.h"
+#include "incremental.h"
 
 namespace gold
 {
@@ -89,9 +90,15 @@ Errors::fatal(const char* format, va_list args)
 void
 Errors::fallback(const char* format, va_list args)
 {
-  fprintf(stderr, _("%s: fatal error: "), this->program_name_);
-  vfprintf(stderr, format, args);
-  fputc('\n', stderr);
+  char* buf = NULL;
+  if (vasprintf(&buf, format, args) < 0)
+    gold_nomem();
+  fprintf(stderr, _("%s: fatal error: %s\n"), this->program_name_, buf);
+  Incremental_stats::record_fallback(buf);
+  if (parameters->options_valid()
+      && parameters->options().incremental_stats())
+    Incremental_stats::print(true);
+  free(buf);
   gold_exit(GOLD_FALLBACK);
 }
 
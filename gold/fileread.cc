@@ -45,8 +45,12 @@
 #include "dirsearch.h"
 #include "target.h"
 #include "binary.h"
+#include "archive.h"
 #include "descriptors.h"
 #include "gold-threads.h"
+#include "timer.h"
+#include "trace.h"
+#include "elfcpp.h"
 #include "fileread.h"
 
 // For systems without mmap support.
@@ -124,6 +128,57 @@ static Initialize_lock file_counts_initialize_lock(&file_counts_lock);
 unsigned long long File_read::total_mapped_bytes;
 unsigned long long File_read::current_mapped_bytes;
 unsigned long long File_read::maximum_mapped_bytes;
+long long File_read::read_wait_usec;
+unsigned long long File_read::read_wait_count;
+
+// Class File_read::Read_wait_timer.  The time is only measured with
+// --stats or --trace-file.  WHAT is "open" or "read", for the trace.
+// Only explicit open and read calls are timed; the time spent in page
+// faults when a mapped view is first touched is not counted.
+
+class File_read::Read_wait_timer
+{
+ public:
+  Read_wait_timer(const char* what, const std::string& filename)
+    : what_(what), filename_(filename), start_(-1), trace_(NULL),
+      trace_start_(0), bytes_(0)
+  {
+    if (!parameters->options_valid())
+      return;
+    if (parameters->options().stats())
+      this->start_ = Timer::wall_usec();
+    this->trace_ = parameters->trace();
+    if (this->trace_ != NULL)
+      this->trace_start_ = this->trace_->now();
+  }
+
+  ~Read_wait_timer()
+  {
+    if (this->trace_ != NULL)
+      this->trace_->io_wait(this->what_, this->filename_, this->trace_start_,
+			    this->bytes_);
+    if (this->start_ < 0)
+      return;
+    long long elapsed = Timer::wall_usec() - this->start_;
+    file_counts_initialize_lock.initialize();
+    Hold_optional_lock hl(file_counts_lock);
+    File_read::read_wait_usec += elapsed;
+    ++File_read::read_wait_count;
+  }
+
+  // Record that BYTES bytes were read.
+  void
+  add_bytes(long long bytes)
+  { this->bytes_ += bytes; }
+
+ private:
+  const char* what_;
+  const std::string& filename_;
+  long long start_;
+  Trace* trace_;
+  long long trace_start_;
+  long long bytes_;
+};
 
 // Class File_read::View.
 
@@ -197,6 +252,7 @@ File_read::open(const Task* task, const std::string& name)
 	      && this->name_.empty());
   this->name_ = name;
 
+  Read_wait_timer rwt("open", this->name_);
   this->descriptor_ = open_descriptor(-1, this->name_.c_str(),
 				      O_RDONLY);
 
@@ -392,6 +448,7 @@ File_read::do_read(off_t start, section_size_type size, void* p)
     {
       this->reopen_descriptor();
 
+      Read_wait_timer rwt("read", this->name_);
       char *read_ptr = static_cast<char *>(p);
       off_t read_pos = start;
       size_t to_read = size;
@@ -402,6 +459,7 @@ File_read::do_read(off_t start, section_size_type size, void* p)
 	    gold_fatal(_("%s: pread failed: %s"),
 		       this->filename().c_str(), strerror(errno));
 
+	  rwt.add_bytes(bytes);
 	  read_pos += bytes;
 	  read_ptr += bytes;
 	  to_read -= bytes;
@@ -679,7 +737,13 @@ File_read::do_readv(off_t base, const Read_multiple& rm, size_t start,
     gold_fatal(_("%s: lseek failed: %s"),
 	       this->filename().c_str(), strerror(errno));
 
-  ssize_t got = ::readv(this->descriptor_, iov, iov_index);
+  ssize_t got;
+  {
+    Read_wait_timer rwt("read", this->name_);
+    got = ::readv(this->descriptor_, iov, iov_index);
+    if (got > 0)
+      rwt.add_bytes(got);
+  }
 
   if (got < 0)
     gold_fatal(_("%s: readv failed: %s"),
@@ -856,6 +920,11 @@ File_read::print_stats()
 	  program_name, File_read::total_mapped_bytes);
   fprintf(stderr, _("%s: maximum bytes mapped for read at one time: %llu\n"),
 	  program_name, File_read::maximum_mapped_bytes);
+  fprintf(stderr, _("%s: input file reads: %llu, waited %lld.%06lld\n"),
+	  program_name, File_read::read_wait_count,
+	  File_read::read_wait_usec / 1000000,
+	  File_read::read_wait_usec % 1000000);
+  Input_prefetch::print_stats();
 }
 
 // Class File_view.
@@ -1138,4 +1207,352 @@ Input_file::open_binary(const Task* task, const std::string& name)
 			  binary_to_elf.converted_size());
 }
 
+// Class Input_prefetch.
+
+// The amount of the start of a file to read ahead.  This covers the
+// ELF header, and for an archive the start of the symbol table.
+
+static const off_t prefetch_header_size = 8192;
+
+// The largest section header table which we read ahead.
+
+static const off_t prefetch_max_section_headers = 1024 * 1024;
+
+// The size of an archive member header, and the offset and length of
+// the member size within it.
+
+static const int prefetch_ar_header_size = 60;
+static const int prefetch_ar_size_offset = 48;
+static const int prefetch_ar_size_length = 10;
+
+unsigned int Input_prefetch::files_read_ahead;
+unsigned long long Input_prefetch::bytes_read_ahead;
+
+Input_prefetch::Input_prefetch(unsigned int depth)
+  : depth_(depth), files_(), indexes_(), current_(-1), lock_(new Lock())
+{ }
+
+Input_prefetch::~Input_prefetch()
+{
+  for (std::vector<Prefetch_file>::iterator p = this->files_.begin();
+       p != this->files_.end();
+       ++p)
+    this->close(&*p);
+  delete this->lock_;
+}
+
+// Add a file to read ahead, unless we have to search for it.
+
+void
+Input_prefetch::add_file(const Input_file_argument* input_argument)
+{
+  if (!IS_ABSOLUTE_PATH(input_argument->name())
+      && (input_argument->is_lib()
+	  || input_argument->is_searched_file()
+	  || input_argument->extra_search_path() != NULL))
+    return;
+  this->indexes_[input_argument] = this->files_.size();
+  this->files_.push_back(Prefetch_file(input_argument->name()));
+}
+
+// Note that INPUT_ARGUMENT is about to be read.
+
+void
+Input_prefetch::reading(const Input_file_argument* input_argument)
+{
+  File_indexes::const_iterator p = this->indexes_.find(input_argument);
+  if (p != this->indexes_.end())
+    this->advance(p->second);
+}
+
+// Read ahead the files after file INDEX, which is being read now.
+// Each call moves each of the next depth_ files on to its next stage,
+// so the first reads of a file have finished by the time we use them
+// to find the later ones.
+
+void
+Input_prefetch::advance(int index)
+{
+  std::vector<Prefetch_file*> files;
+  {
+    Hold_lock hl(*this->lock_);
+    if (index <= this->current_ && index >= 0)
+      return;
+    for (int i = this->current_ + 1; i <= index; ++i)
+      if (!this->files_[i].busy)
+	{
+	  this->close(&this->files_[i]);
+	  this->files_[i].stage = STAGE_DONE;
+	}
+    this->current_ = index;
+
+    int last = std::min(static_cast<int>(this->files_.size()) - 1,
+			index + static_cast<int>(this->depth_));
+    for (int i = index + 1; i <= last; ++i)
+      {
+	Prefetch_file* file = &this->files_[i];
+	if (file->stage != STAGE_DONE && !file->busy)
+	  {
+	    file->busy = true;
+	    files.push_back(file);
+	  }
+      }
+  }
+
+  for (std::vector<Prefetch_file*>::iterator p = files.begin();
+       p != files.end();
+       ++p)
+    this->next_stage(*p);
+
+  Hold_lock hl(*this->lock_);
+  for (std::vector<Prefetch_file*>::iterator p = files.begin();
+       p != files.end();
+       ++p)
+    {
+      (*p)->busy = false;
+      // If the file started being read while we worked on it, we are
+      // done with it.
+      if ((*p) - &this->files_[0] <= this->current_)
+	{
+	  this->close(*p);
+	  (*p)->stage = STAGE_DONE;
+	}
+    }
+}
+
+// Do the next stage of reading ahead FILE.  This is called without
+// the lock held, but only one thread works on a file at a time.
+
+void
+Input_prefetch::next_stage(Prefetch_file* file)
+{
+  switch (file->stage)
+    {
+    case STAGE_NONE:
+      file->descriptor = open_descriptor(-1, file->name, O_RDONLY);
+      if (file->descriptor < 0)
+	{
+	  file->stage = STAGE_DONE;
+	  return;
+	}
+      this->willneed(file, 0, prefetch_header_size);
+      file->stage = STAGE_HEADER;
+      if (parameters->options().stats())
+	{
+	  Hold_lock hl(*this->lock_);
+	  ++Input_prefetch::files_read_ahead;
+	}
+      break;
+
+    case STAGE_HEADER:
+      this->read_header(file);
+      break;
+
+    case STAGE_SECTION_HEADERS:
+      if (file->elfclass == elfcpp::ELFCLASS32)
+	{
+	  if (file->big_endian)
+	    this->read_section_headers<32, true>(file);
+	  else
+	    this->read_section_headers<32, false>(file);
+	}
+      else
+	{
+	  if (file->big_endian)
+	    this->read_section_headers<64, true>(file);
+	  else
+	    this->read_section_headers<64, false>(file);
+	}
+      file->stage = STAGE_DONE;
+      this->close(file);
+      break;
+
+    case STAGE_DONE:
+    default:
+      gold_unreachable();
+    }
+}
+
+// Read the start of FILE, and ask for the section headers of an ELF
+// file, or the symbol table of an archive.
+
+void
+Input_prefetch::read_header(Prefetch_file* file)
+{
+  // This is large enough for either an ELF header or the archive
+  // magic string and the first member header.
+  unsigned char buf[Archive::sarmag + prefetch_ar_header_size];
+  ssize_t got = ::pread(file->descriptor, buf, sizeof buf, 0);
+
+  file->stage = STAGE_DONE;
+  if (got >= static_cast<ssize_t>(elfcpp::Elf_sizes<32>::ehdr_size)
+      && buf[elfcpp::EI_MAG0] == elfcpp::ELFMAG0
+      && buf[elfcpp::EI_MAG1] == elfcpp::ELFMAG1
+      && buf[elfcpp::EI_MAG2] == elfcpp::ELFMAG2
+      && buf[elfcpp::EI_MAG3] == elfcpp::ELFMAG3)
+    {
+      int elfclass = buf[elfcpp::EI_CLASS];
+      bool big_endian = buf[elfcpp::EI_DATA] == elfcpp::ELFDATA2MSB;
+      if (elfclass == elfcpp::ELFCLASS32)
+	{
+	  if (big_endian)
+	    {
+	      elfcpp::Ehdr<32, true> ehdr(buf);
+	      file->shoff = ehdr.get_e_shoff();
+	      file->shnum = ehdr.get_e_shnum();
+	      file->shentsize = ehdr.get_e_shentsize();
+	      file->is_dynamic = ehdr.get_e_type() == elfcpp::ET_DYN;
+	    }
+	  else
+	    {
+	      elfcpp::Ehdr<32, false> ehdr(buf);
+	      file->shoff = ehdr.get_e_shoff();
+	      file->shnum = ehdr.get_e_shnum();
+	      file->shentsize = ehdr.get_e_shentsize();
+	      file->is_dynamic = ehdr.get_e_type() == elfcpp::ET_DYN;
+	    }
+	}
+      else if (elfclass == elfcpp::ELFCLASS64
+	       && got >= static_cast<ssize_t>(elfcpp::Elf_sizes<64>::ehdr_size))
+	{
+	  if (big_endian)
+	    {
+	      elfcpp::Ehdr<64, true> ehdr(buf);
+	      file->shoff = ehdr.get_e_shoff();
+	      file->shnum = ehdr.get_e_shnum();
+	      file->shentsize = ehdr.get_e_shentsize();
+	      file->is_dynamic = ehdr.get_e_type() == elfcpp::ET_DYN;
+	    }
+	  else
+	    {
+	      elfcpp::Ehdr<64, false> ehdr(buf);
+	      file->shoff = ehdr.get_e_shoff();
+	      file->shnum = ehdr.get_e_shnum();
+	      file->shentsize = ehdr.get_e_shentsize();
+	      file->is_dynamic = ehdr.get_e_type() == elfcpp::ET_DYN;
+	    }
+	}
+      else
+	elfclass = elfcpp::ELFCLASSNONE;
+
+      // With more than SHN_LORESERVE sections the count is in the
+      // first section header; we don't bother to read further.
+      if (elfclass != elfcpp::ELFCLASSNONE
+	  && file->shoff != 0
+	  && file->shnum != 0
+	  && (static_cast<off_t>(file->shnum) * file->shentsize
+	      <= prefetch_max_section_headers))
+	{
+	  file->elfclass = elfclass;
+	  file->big_endian = big_endian;
+	  this->willneed(file, file->shoff,
+			 static_cast<off_t>(file->shnum) * file->shentsize);
+	  file->stage = STAGE_SECTION_HEADERS;
+	}
+    }
+  else if (got >= static_cast<ssize_t>(Archive::sarmag
+				       + prefetch_ar_header_size)
+	   && (memcmp(buf, Archive::armag, Archive::sarmag) == 0
+	       || memcmp(buf, Archive::armagt, Archive::sarmag) == 0))
+    {
+      // The first member of an archive is normally the symbol table,
+      // named "/" or "/SYM64/".
+      const unsigned char* hdr = buf + Archive::sarmag;
+      if (hdr[0] == '/'
+	  && (hdr[1] == ' ' || memcmp(hdr, "/SYM64/", 7) == 0))
+	{
+	  char size_string[prefetch_ar_size_length + 1];
+	  memcpy(size_string, hdr + prefetch_ar_size_offset,
+		 prefetch_ar_size_length);
+	  size_string[prefetch_ar_size_length] = '\0';
+	  off_t size = strtol(size_string, NULL, 10);
+	  if (size > 0)
+	    this->willneed(file, Archive::sarmag + prefetch_ar_header_size,
+			   size);
+	}
+    }
+
+  if (file->stage == STAGE_DONE)
+    this->close(file);
+}
+
+// Read the section headers of FILE, and ask for the symbol table, its
+// string table, and the section names.
+
+template<int size, bool big_endian>
+void
+Input_prefetch::read_section_headers(Prefetch_file* file)
+{
+  const int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+  if (file->shentsize != static_cast<unsigned int>(shdr_size))
+    return;
+
+  off_t len = static_cast<off_t>(file->shnum) * shdr_size;
+  std::vector<unsigned char> buf(len);
+  if (::pread(file->descriptor, &buf[0], len, file->shoff) != len)
+    return;
+
+  const unsigned int wanted = (file->is_dynamic
+			       ? elfcpp::SHT_DYNSYM
+			       : elfcpp::SHT_SYMTAB);
+  for (unsigned int i = 0; i < file->shnum; ++i)
+    {
+      elfcpp::Shdr<size, big_endian> shdr(&buf[i * shdr_size]);
+      if (shdr.get_sh_type() != wanted)
+	continue;
+      this->willneed(file, shdr.get_sh_offset(), shdr.get_sh_size());
+      unsigned int link = shdr.get_sh_link();
+      if (link != 0 && link < file->shnum)
+	{
+	  elfcpp::Shdr<size, big_endian> strtab(&buf[link * shdr_size]);
+	  this->willneed(file, strtab.get_sh_offset(), strtab.get_sh_size());
+	}
+      break;
+    }
+}
+
+// Ask the system to read LEN bytes of FILE at START.  This does not
+// wait for the data.
+
+void
+Input_prefetch::willneed(Prefetch_file* file, off_t start, off_t len)
+{
+#ifdef HAVE_POSIX_FADVISE
+  if (::posix_fadvise(file->descriptor, start, len,
+		      POSIX_FADV_WILLNEED) != 0)
+    return;
+  if (parameters->options().stats())
+    {
+      Hold_lock hl(*this->lock_);
+      Input_prefetch::bytes_read_ahead += len;
+    }
+#else
+  (void)file;
+  (void)start;
+  (void)len;
+#endif
+}
+
+// Close FILE, if it is open.
+
+void
+Input_prefetch::close(Prefetch_file* file)
+{
+  if (file->descriptor >= 0)
+    {
+      release_descriptor(file->descriptor, true);
+      file->descriptor = -1;
+    }
+}
+
+// Print statistical information to stderr.  This is used for --stats.
+
+void
+Input_prefetch::print_stats()
+{
+  fprintf(stderr, _("%s: input files read ahead: %u (%llu bytes)\n"),
+	  program_name, Input_prefetch::files_read_ahead,
+	  Input_prefetch::bytes_read_ahead);
+}
+
 } // End namespace gold.
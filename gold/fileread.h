@@ -62,6 +62,7 @@ class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
 class File_view;
+class Lock;
 
 // File_read manages a file descriptor and mappings for a file we are
 // reading.
@@ -214,6 +215,18 @@ class File_read
     this->reopen_descriptor();
     return this->descriptor_;
   }
+
+  // Return the open file descriptor to copy data from the file
+  // without reading it, or -1 if the contents of the file were
+  // provided in memory.
+  int
+  copy_descriptor()
+  {
+    if (this->whole_file_view_ != NULL
+	&& this->whole_file_view_->is_permanent_view())
+      return -1;
+    return this->descriptor();
+  }
   
   // Return the file last modification time.  Calls gold_fatal if the stat
   // system call failed.
@@ -247,6 +260,14 @@ class File_read
   // --stats.
   static unsigned long long maximum_mapped_bytes;
 
+  // Microseconds spent waiting for system calls which read input
+  // files, and the number of such calls, if --stats.
+  static long long read_wait_usec;
+  static unsigned long long read_wait_count;
+
+  // Measures the time spent in a system call which reads the file.
+  class Read_wait_timer;
+
   // A view into the file.
   class View
   {
@@ -606,6 +627,130 @@ class Input_file
   Format format_;
 };
 
+// Input_prefetch reads ahead the parts of the input files which are
+// needed first: the ELF header, the section headers, the symbol table
+// and its string table, or the archive symbol table.  While one input
+// file is being read, it asks the system to read the parts of the
+// next few files into the page cache, so that the reads do not stall
+// when those files are opened in turn.  The files are added in the
+// order in which they will be read.  Only files whose name does not
+// have to be searched for are read ahead.
+
+class Input_prefetch
+{
+ public:
+  // DEPTH is the number of files to read ahead.
+  Input_prefetch(unsigned int depth);
+
+  ~Input_prefetch();
+
+  // Add a file to read ahead, unless it has to be searched for.
+  void
+  add_file(const Input_file_argument*);
+
+  // Start reading ahead the first files.
+  void
+  start()
+  { this->advance(-1); }
+
+  // Note that the file INPUT_ARGUMENT is about to be read, and read
+  // ahead the files after it.  This may be called by several threads
+  // at once.
+  void
+  reading(const Input_file_argument* input_argument);
+
+  // Dump statistical information to stderr.
+  static void
+  print_stats();
+
+ private:
+  // This class may not be copied.
+  Input_prefetch(const Input_prefetch&);
+  Input_prefetch& operator=(const Input_prefetch&);
+
+  // How far we have read ahead a file.
+  enum Stage
+  {
+    // Nothing done yet.
+    STAGE_NONE,
+    // Opened, and reading the start of the file.
+    STAGE_HEADER,
+    // Reading the section headers.
+    STAGE_SECTION_HEADERS,
+    // Reading the symbol table, or finished with the file.
+    STAGE_DONE
+  };
+
+  // A file to read ahead.
+  struct Prefetch_file
+  {
+    Prefetch_file(const char* a_name)
+      : name(a_name), descriptor(-1), stage(STAGE_NONE), busy(false),
+	shoff(0), shnum(0), shentsize(0), elfclass(0), big_endian(false),
+	is_dynamic(false)
+    { }
+
+    // The file name.
+    const char* name;
+    // The descriptor, while the file is open.
+    int descriptor;
+    // How far we have got.
+    Stage stage;
+    // Whether a thread is working on this file.
+    bool busy;
+    // From the ELF header.
+    off_t shoff;
+    unsigned int shnum;
+    unsigned int shentsize;
+    int elfclass;
+    bool big_endian;
+    bool is_dynamic;
+  };
+
+  typedef std::map<const Input_file_argument*, int> File_indexes;
+
+  // Read ahead the files after file INDEX.
+  void
+  advance(int index);
+
+  // Do the next stage of reading ahead FILE.
+  void
+  next_stage(Prefetch_file* file);
+
+  // Read the ELF header or archive header of FILE.
+  void
+  read_header(Prefetch_file* file);
+
+  // Read the section headers of FILE.
+  template<int size, bool big_endian>
+  void
+  read_section_headers(Prefetch_file* file);
+
+  // Ask the system to read part of FILE.
+  void
+  willneed(Prefetch_file* file, off_t start, off_t len);
+
+  // Close FILE.
+  void
+  close(Prefetch_file* file);
+
+  // The number of files to read ahead.
+  unsigned int depth_;
+  // The files, in the order in which they will be read.
+  std::vector<Prefetch_file> files_;
+  // Map from an input argument to its index in files_.
+  File_indexes indexes_;
+  // The index of the last file being read.
+  int current_;
+  // Controls access to the fields above.
+  Lock* lock_;
+
+  // The number of files read ahead, and the number of bytes asked
+  // for, if --stats.
+  static unsigned int files_read_ahead;
+  static unsigned long long bytes_read_ahead;
+};
+
 } // end namespace gold
 
 #endif // !defined(GOLD_FILEREAD_H)
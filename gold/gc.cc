@@ -22,46 +22,309 @@
 
 
 #include "gold.h"
+
+#include <algorithm>
+
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
-// Garbage collection uses a worklist style algorithm to determine the 
-// transitive closure of all referenced sections.
-void 
-Garbage_collection::do_transitive_closure()
+// Garbage collection finds the transitive closure of all referenced
+// sections, starting from the sections on the worklist.  The
+// references are kept in two compact arrays, indexed by section, and
+// the closure is found one level at a time: the frontier is the set of
+// sections marked in the last level, and the next level is the set of
+// sections they refer to which are not marked yet.  A level with a
+// large frontier is split among several tasks, which mark sections
+// with an atomic compare and swap.
+
+// The number of frontier sections a single task handles in a level.
+// A level is split among several tasks only if it has more than twice
+// this many sections.
+
+static const size_t gc_frontier_part_size = 4096;
+
+// Turn the list of references into compact arrays: the targets of the
+// references from each section are sorted, without duplicates, and
+// stored consecutively in reference_targets_.
+
+void
+Garbage_collection::build_reference_arrays()
 {
-  while (!this->worklist().empty())
+  const unsigned int count = this->section_count_;
+  std::vector<unsigned int>& offsets(this->reference_offsets_);
+  std::vector<unsigned int>& targets(this->reference_targets_);
+
+  offsets.assign(count + 1, 0);
+  for (std::vector<Reference>::const_iterator p = this->references_.begin();
+       p != this->references_.end();
+       ++p)
+    ++offsets[p->first + 1];
+  for (unsigned int i = 0; i < count; ++i)
+    offsets[i + 1] += offsets[i];
+
+  targets.resize(this->references_.size());
+  std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+  for (std::vector<Reference>::const_iterator p = this->references_.begin();
+       p != this->references_.end();
+       ++p)
+    targets[fill[p->first]++] = p->second;
+  std::vector<unsigned int>().swap(fill);
+  std::vector<Reference>().swap(this->references_);
+
+  // Sort the targets of each section and remove the duplicates,
+  // moving them down as we go.
+  unsigned int out = 0;
+  for (unsigned int i = 0; i < count; ++i)
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
-      Section_id entry = this->worklist().back();
-      this->worklist().pop_back();
-      if (!this->referenced_list().insert(entry).second)
-        continue;
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      const Garbage_collection::Sections_reachable &v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::const_iterator it_v =
-               v.begin();
-           it_v != v.end();
-           ++it_v)
-        {
-          // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push_back(*it_v);
-            }
-        }
+      std::vector<unsigned int>::iterator begin = targets.begin() + offsets[i];
+      std::vector<unsigned int>::iterator end = targets.begin() + offsets[i + 1];
+      offsets[i] = out;
+      std::sort(begin, end);
+      std::vector<unsigned int>::iterator last = std::unique(begin, end);
+      out = std::copy(begin, last, targets.begin() + out) - targets.begin();
     }
+  offsets[count] = out;
+  targets.resize(out);
+  std::vector<unsigned int>(targets).swap(targets);
+}
+
+// Mark section INDEX as referenced.
+
+inline bool
+Garbage_collection::mark_section(unsigned int index, bool atomic)
+{
+  unsigned char* mark = &this->marks_[index];
+  if (*mark != 0)
+    return false;
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+  if (atomic)
+    return __sync_bool_compare_and_swap(mark, 0, 1);
+#else
+  gold_assert(!atomic);
+#endif
+  *mark = 1;
+  return true;
+}
+
+// Mark the sections referenced by FRONTIER[BEGIN, END).
+
+void
+Garbage_collection::mark_references(const std::vector<unsigned int>& frontier,
+				    size_t begin, size_t end, bool atomic,
+				    std::vector<unsigned int>* next)
+{
+  const unsigned int* offsets = &this->reference_offsets_[0];
+  const unsigned int* targets = (this->reference_targets_.empty()
+				 ? NULL
+				 : &this->reference_targets_[0]);
+  for (size_t i = begin; i < end; ++i)
+    {
+      unsigned int section = frontier[i];
+      for (unsigned int j = offsets[section]; j < offsets[section + 1]; ++j)
+	{
+	  unsigned int target = targets[j];
+	  if (this->mark_section(target, atomic))
+	    next->push_back(target);
+	}
+    }
+}
+
+// Mark the frontier one level at a time, as long as the levels are
+// small.
+
+bool
+Garbage_collection::mark_frontier()
+{
+  // Collect the sections marked by the tasks of the last level, if any.
+  if (!this->next_frontiers_.empty())
+    this->frontier_.clear();
+  for (std::vector<std::vector<unsigned int> >::iterator p =
+	 this->next_frontiers_.begin();
+       p != this->next_frontiers_.end();
+       ++p)
+    this->frontier_.insert(this->frontier_.end(), p->begin(), p->end());
+  this->next_frontiers_.clear();
+
+  bool can_split = parameters->options().threads();
+#ifndef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+  can_split = false;
+#endif
+
+  std::vector<unsigned int> next;
+  while (!this->frontier_.empty())
+    {
+      if (can_split && this->frontier_.size() > 2 * gc_frontier_part_size)
+	return false;
+      next.clear();
+      this->mark_references(this->frontier_, 0, this->frontier_.size(),
+			    false, &next);
+      this->frontier_.swap(next);
+    }
+
+  std::vector<unsigned int>().swap(this->reference_offsets_);
+  std::vector<unsigned int>().swap(this->reference_targets_);
   this->worklist_ready();
+  return true;
+}
+
+// Split the frontier for the tasks of the next level.
+
+unsigned int
+Garbage_collection::split_frontier()
+{
+  size_t size = this->frontier_.size();
+  unsigned int count = ((size + gc_frontier_part_size - 1)
+			/ gc_frontier_part_size);
+  this->next_frontiers_.resize(count);
+  return count;
+}
+
+// Mark the sections referenced by part I of COUNT of the frontier.
+// Once all the parts are done, the frontier itself is no longer
+// needed; mark_frontier replaces it with the parts' results.
+
+void
+Garbage_collection::mark_frontier_part(unsigned int i, unsigned int count)
+{
+  size_t size = this->frontier_.size();
+  size_t begin = size / count * i + std::min<size_t>(i, size % count);
+  size_t end = begin + size / count + (i < size % count ? 1 : 0);
+  this->mark_references(this->frontier_, begin, end, true,
+			&this->next_frontiers_[i]);
+}
+
+// A task to mark the sections referenced by one part of the frontier.
+// It holds a blocker which keeps the next level from starting.
+
+class Gc_mark_part_task : public Task
+{
+ public:
+  Gc_mark_part_task(Garbage_collection* gc, unsigned int part,
+		    unsigned int count, Task_token* blocker)
+    : gc_(gc), part_(part), count_(count), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->gc_->mark_frontier_part(this->part_, this->count_); }
+
+  std::string
+  get_name() const
+  { return "Gc_mark_part_task"; }
+
+ private:
+  Garbage_collection* gc_;
+  unsigned int part_;
+  unsigned int count_;
+  Task_token* blocker_;
+};
+
+// A task to mark the next levels of the frontier.  It runs when
+// THIS_BLOCKER, if any, is unblocked, which is when the tasks of the
+// last level are done.  It marks levels itself while they are small.
+// When a level is large it queues a Gc_mark_part_task for each part of
+// it, and another Gc_mark_task to run after them.  It holds
+// NEXT_BLOCKER until the closure is complete or the next Gc_mark_task
+// is queued.
+
+class Gc_mark_task : public Task
+{
+ public:
+  Gc_mark_task(Garbage_collection* gc, Task_token* this_blocker,
+	       Task_token* next_blocker)
+    : gc_(gc), this_blocker_(this_blocker), next_blocker_(next_blocker)
+  { }
+
+  ~Gc_mark_task()
+  {
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+  }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    if (this->gc_->mark_frontier())
+      return;
+
+    unsigned int count = this->gc_->split_frontier();
+    Task_token* part_blocker = new Task_token(true);
+    part_blocker->add_blockers(count);
+    for (unsigned int i = 0; i < count; ++i)
+      workqueue->queue(new Gc_mark_part_task(this->gc_, i, count,
+					     part_blocker));
+    workqueue->add_blocker(this->next_blocker_);
+    workqueue->queue(new Gc_mark_task(this->gc_, part_blocker,
+				      this->next_blocker_));
+  }
+
+  std::string
+  get_name() const
+  { return "Gc_mark_task"; }
+
+ private:
+  Garbage_collection* gc_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Build the reference arrays, mark the sections on the worklist, and
+// queue a Gc_mark_task to mark everything they refer to.
+
+void
+Garbage_collection::queue_transitive_closure(Workqueue* workqueue,
+					     Task_token* blocker)
+{
+  for (Worklist_type::const_iterator p = this->worklist().begin();
+       p != this->worklist().end();
+       ++p)
+    this->section_index(p->first, p->second);
+
+  this->build_reference_arrays();
+
+  this->marks_.assign(this->section_count_, 0);
+  this->frontier_.clear();
+  for (Worklist_type::const_iterator p = this->worklist().begin();
+       p != this->worklist().end();
+       ++p)
+    {
+      unsigned int index = this->section_index(p->first, p->second);
+      if (this->mark_section(index, false))
+	this->frontier_.push_back(index);
+    }
+  Worklist_type().swap(this->worklist());
+
+  blocker->add_blocker();
+  workqueue->queue(new Gc_mark_task(this, NULL, blocker));
 }
 
 } // End namespace gold.
@@ -41,13 +41,14 @@ class Sized_relobj_file;
 class Output_section;
 class General_options;
 class Layout;
+class Workqueue;
+class Task_token;
 
 class Garbage_collection
 {
  public:
 
   typedef Unordered_set<Section_id, Section_id_hash> Sections_reachable;
-  typedef std::map<Section_id, Sections_reachable> Section_ref;
   typedef std::vector<Section_id> Worklist_type;
   // This maps the name of the section which can be represented as a C
   // identifier (cident) to the list of sections that have that name.
@@ -55,19 +56,13 @@ class Garbage_collection
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
 
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : is_worklist_ready_(false), section_bases_(), section_count_(0),
+    last_object_(NULL), last_base_(0), references_(), reference_offsets_(),
+    reference_targets_(), marks_(), frontier_(), next_frontiers_()
   { }
 
   // Accessor methods for the private members.
 
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
-
-  Section_ref&
-  section_reloc_map()
-  { return this->section_reloc_map_; }
-
   Worklist_type&
   worklist()
   { return this->work_list_; }
@@ -80,13 +75,37 @@ class Garbage_collection
   worklist_ready()
   { this->is_worklist_ready_ = true; }
 
+  // Queue the tasks which find all the sections reachable from the
+  // worklist.  BLOCKER is released when they are done.
   void
-  do_transitive_closure();
+  queue_transitive_closure(Workqueue*, Task_token* blocker);
 
+  // Mark the sections reachable from the frontier, one level after
+  // another, until the frontier is empty or large enough to be split
+  // among several tasks.  Return true if the closure is complete.
+  // This is called by the tasks queued by queue_transitive_closure.
   bool
-  is_section_garbage(Relobj* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  mark_frontier();
+
+  // Return the number of tasks to use to mark the next level of the
+  // frontier, and get the frontier ready for them.
+  unsigned int
+  split_frontier();
+
+  // Mark the sections reachable from part I of the frontier, which
+  // was split into COUNT parts.  This may be called in parallel for
+  // different parts.
+  void
+  mark_frontier_part(unsigned int i, unsigned int count);
+
+  bool
+  is_section_garbage(Relobj* obj, unsigned int shndx) const
+  {
+    Section_bases::const_iterator p = this->section_bases_.find(obj);
+    if (p == this->section_bases_.end())
+      return true;
+    return this->marks_[p->second + shndx] == 0;
+  }
 
   Cident_section_map*
   cident_sections()
@@ -103,19 +122,84 @@ class Garbage_collection
   add_reference(Relobj* src_object, unsigned int src_shndx,
 		Relobj* dst_object, unsigned int dst_shndx)
   {
-    Section_id src_id(src_object, src_shndx);
-    Section_id dst_id(dst_object, dst_shndx);
-    Sections_reachable& reachable = this->section_reloc_map_[src_id];
-    reachable.insert(dst_id);
+    unsigned int src = this->section_index(src_object, src_shndx);
+    unsigned int dst = this->section_index(dst_object, dst_shndx);
+    // The relocs of a section often refer to the same section several
+    // times in a row.  Duplicates are removed later, but skipping the
+    // common case here keeps the list smaller.
+    if (this->references_.empty()
+	|| this->references_.back() != Reference(src, dst))
+      this->references_.push_back(Reference(src, dst));
   }
 
  private:
+  // A reference from one section to another, by section index.
+  typedef std::pair<unsigned int, unsigned int> Reference;
+  // Maps an object to the index of its first section.
+  typedef Unordered_map<const Relobj*, unsigned int> Section_bases;
+
+  // Return the index of section SHNDX of OBJECT.  The sections of
+  // each object are given consecutive indexes.
+  unsigned int
+  section_index(Relobj* object, unsigned int shndx)
+  {
+    gold_assert(shndx < object->shnum());
+    // Relocs are processed one object at a time, so remember the last
+    // object looked up.
+    if (object == this->last_object_)
+      return this->last_base_ + shndx;
+    std::pair<Section_bases::iterator, bool> ins =
+      this->section_bases_.insert(std::make_pair(object, this->section_count_));
+    if (ins.second)
+      this->section_count_ += object->shnum();
+    this->last_object_ = object;
+    this->last_base_ = ins.first->second;
+    return this->last_base_ + shndx;
+  }
+
+  // Turn the list of references into the compact arrays
+  // reference_offsets_ and reference_targets_.
+  void
+  build_reference_arrays();
+
+  // Mark section INDEX as referenced.  Return true if it was not
+  // already marked.  If ATOMIC is true, other threads may be marking
+  // sections at the same time.
+  bool
+  mark_section(unsigned int index, bool atomic);
+
+  // Mark the sections referenced by FRONTIER[BEGIN, END), and add the
+  // ones which were not already marked to NEXT.
+  void
+  mark_references(const std::vector<unsigned int>& frontier,
+		  size_t begin, size_t end, bool atomic,
+		  std::vector<unsigned int>* next);
 
   Worklist_type work_list_;
   bool is_worklist_ready_;
-  Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
   Cident_section_map cident_sections_;
+  // The index of the first section of each object.
+  Section_bases section_bases_;
+  // The number of section indexes given out.
+  unsigned int section_count_;
+  // The object last looked up by section_index, and its first index.
+  const Relobj* last_object_;
+  unsigned int last_base_;
+  // The references added by add_reference, in the order added.  This
+  // is cleared by build_reference_arrays.
+  std::vector<Reference> references_;
+  // The references from section I are the elements of
+  // reference_targets_ from reference_offsets_[I] up to
+  // reference_offsets_[I + 1].
+  std::vector<unsigned int> reference_offsets_;
+  std::vector<unsigned int> reference_targets_;
+  // Nonzero for each section which is referenced.
+  std::vector<unsigned char> marks_;
+  // The sections marked in the last level which have not been
+  // scanned yet.
+  std::vector<unsigned int> frontier_;
+  // The sections marked by each task in the current level.
+  std::vector<std::vector<unsigned int> > next_frontiers_;
 };
 
 // Data to pass between successive invocations of do_layout
@@ -357,16 +441,14 @@ gc_process_relocs(
                 symtab->gc()->cident_sections()->find(std::string(cident_section_name));
               if (ele == symtab->gc()->cident_sections()->end())
                 continue;
-	      Section_id src_id(src_obj, src_indx);
-              Garbage_collection::Sections_reachable&
-                v(symtab->gc()->section_reloc_map()[src_id]);
               Garbage_collection::Sections_reachable& cident_secn(ele->second);
               for (Garbage_collection::Sections_reachable::iterator it_v
                      = cident_secn.begin();
                    it_v != cident_secn.end();
                    ++it_v)
                 {
-                  v.insert(*it_v);
+	          symtab->gc()->add_reference(src_obj, src_indx,
+					      it_v->first, it_v->second);
                 }
             }
         }
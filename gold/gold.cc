@@ -46,6 +46,8 @@
 #include "icf.h"
 #include "incremental.h"
 #include "timer.h"
+#include "trace.h"
+#include "mapfile.h"
 
 namespace gold
 {
@@ -66,6 +68,8 @@ gold_exit(Exit_status status)
       && parameters->options_valid()
       && parameters->options().has_plugins())
     parameters->options().plugins()->cleanup();
+  if (parameters != NULL && parameters->trace() != NULL)
+    parameters->trace()->close();
   if (status != GOLD_OK && parameters != NULL && parameters->options_valid())
     unlink_if_ordinary(parameters->options().output_file_name());
   exit(status);
@@ -134,6 +138,72 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// This class arranges to run identical code folding, and then the
+// rest of the middle tasks, after garbage collection.
+
+class Middle_icf_runner : public Task_function_runner
+{
+ public:
+  Middle_icf_runner(const General_options& options,
+		    const Input_objects* input_objects,
+		    Symbol_table* symtab,
+		    Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_icf_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_icf_tasks(this->options_, task, this->input_objects_,
+			 this->symtab_, this->layout_, workqueue,
+			 this->mapfile_);
+}
+
+// This class arranges to run the rest of the middle tasks after
+// identical code folding.
+
+class Middle_layout_runner : public Task_function_runner
+{
+ public:
+  Middle_layout_runner(const General_options& options,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_layout_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -201,7 +271,9 @@ queue_initial_tasks(const General_options& options,
   if (parameters->incremental_update())
     {
       Output_file* of = new Output_file(options.output_file_name());
-      if (of->open_base_file(options.incremental_base(), true))
+      if (!of->open_base_file(options.incremental_base(), true))
+	Incremental_stats::record_fallback(_("cannot open the base file"));
+      else
 	{
 	  ibase = open_incremental_binary(of);
 	  if (ibase != NULL
@@ -230,6 +302,35 @@ queue_initial_tasks(const General_options& options,
   Task_token* this_blocker = NULL;
   if (ibase == NULL)
     {
+#ifdef HAVE_POSIX_FADVISE
+      // Read ahead the input files named on the command line, so
+      // that the Read_symbols tasks do not wait for each file in
+      // turn.
+      if (options.prefetch_inputs() > 0)
+	{
+	  Input_prefetch* input_prefetch =
+	    new Input_prefetch(options.prefetch_inputs());
+	  for (Command_line::const_iterator p = cmdline.begin();
+	       p != cmdline.end();
+	       ++p)
+	    {
+	      if (p->is_file())
+		input_prefetch->add_file(&p->file());
+	      else if (p->is_group())
+		{
+		  const Input_file_group* group = p->group();
+		  for (Input_file_group::const_iterator q = group->begin();
+		       q != group->end();
+		       ++q)
+		    if (q->is_file())
+		      input_prefetch->add_file(&q->file());
+		}
+	    }
+	  input_prefetch->start();
+	  Read_symbols::set_input_prefetch(input_prefetch);
+	}
+#endif
+
       // Normal link.  Queue a Read_symbols task for each input file
       // on the command line.
       for (Command_line::const_iterator p = cmdline.begin();
@@ -346,9 +447,8 @@ process_incremental_input(Incremental_binary* ibase,
 
   if (input_type == INCREMENTAL_INPUT_SCRIPT)
     {
-      // Incremental_binary::check_inputs should have cancelled the
-      // incremental update if the script has changed.
-      gold_assert(!ibase->file_has_changed(input_file_index));
+      // Incremental_binary::check_inputs has cancelled the incremental
+      // update if the script has changed in a way that matters.
       return new Check_script(layout, ibase, input_file_index, input_reader,
 			      this_blocker, next_blocker);
     }
@@ -360,6 +460,7 @@ process_incremental_input(Incremental_binary* ibase,
       if (lib->filename() == "/group/"
 	  || !ibase->file_has_changed(input_file_index))
 	{
+	  Incremental_stats::record_input(true);
 	  // Queue a task to check that no references have been added to any
 	  // of the library's unused symbols.
 	  return new Check_library(symtab, layout, ibase, input_file_index,
@@ -367,6 +468,7 @@ process_incremental_input(Incremental_binary* ibase,
 	}
       else
 	{
+	  Incremental_stats::record_input(false);
 	  // Queue a Read_symbols task to process the archive normally.
 	  return new Read_symbols(input_objects, symtab, layout, search_path,
 				  0, mapfile, input_argument, NULL, NULL,
@@ -384,11 +486,13 @@ process_incremental_input(Incremental_binary* ibase,
 	{
 	  if (ibase->file_has_changed(lib->input_file_index()))
 	    {
+	      Incremental_stats::record_input(false);
 	      return new Read_member(input_objects, symtab, layout, mapfile,
 				     input_reader, this_blocker, next_blocker);
 	    }
 	  else
 	    {
+	      Incremental_stats::record_input(true);
 	      // The previous contributions from this file will be kept.
 	      // Mark the pieces of output sections contributed by this
 	      // object.
@@ -407,7 +511,9 @@ process_incremental_input(Incremental_binary* ibase,
 
   // Normal object file or shared library.  Check if the file has changed
   // since the last incremental link.
-  if (ibase->file_has_changed(input_file_index))
+  bool has_changed = ibase->file_has_changed(input_file_index);
+  Incremental_stats::record_input(!has_changed);
+  if (has_changed)
     {
       return new Read_symbols(input_objects, symtab, layout, search_path, 0,
 			      mapfile, input_argument, NULL, NULL,
@@ -491,6 +597,12 @@ queue_middle_tasks(const General_options& options,
   Timer* timer = parameters->timer();
   if (timer != NULL)
     timer->stamp(0);
+  Trace* trace = parameters->trace();
+  if (trace != NULL)
+    trace->start_phase("middle tasks");
+
+  // All the input files have been read.
+  Read_symbols::finish_input_prefetch();
 
   // We have to support the case of not seeing any input objects, and
   // generate an empty file.  Existing builds depend on being able to
@@ -521,18 +633,88 @@ queue_middle_tasks(const General_options& options,
       // Symbols named with -u should not be considered garbage.
       symtab->gc_mark_undef_symbols(layout);
       gold_assert(symtab->gc() != NULL);
-      // Do a transitive closure on all references to determine the worklist.
-      symtab->gc()->do_transitive_closure();
     }
 
+  int thread_count = options.thread_count_middle();
+  if (thread_count == 0)
+    thread_count = std::max(2, input_objects->number_of_input_objects());
+  workqueue->set_thread_count(thread_count);
+
+  // Do a transitive closure on all references to determine the
+  // sections which are not garbage.  This runs as a set of tasks; the
+  // rest of the middle tasks are queued when they are done.
+  if (parameters->options().gc_sections())
+    {
+      Task_token* gc_blocker = new Task_token(true);
+      symtab->gc()->queue_transitive_closure(workqueue, gc_blocker);
+      workqueue->queue(new Task_function(new Middle_icf_runner(options,
+							       input_objects,
+							       symtab,
+							       layout,
+							       mapfile),
+					 gc_blocker,
+					 "Task_function Middle_icf_runner"));
+      return;
+    }
+
+  queue_middle_icf_tasks(options, task, input_objects, symtab, layout,
+			 workqueue, mapfile);
+}
+
+// Queue up the identical code folding tasks, if --icf is used, and
+// then the rest of the middle tasks.  This runs after the garbage
+// collection, if any.
+
+void
+queue_middle_icf_tasks(const General_options& options,
+		       const Task* task,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout,
+		       Workqueue* workqueue,
+		       Mapfile* mapfile)
+{
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  ICF runs as a set of
+  // tasks; the rest of the middle tasks are queued when they are done.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      Task_token* icf_blocker = new Task_token(true);
+      symtab->icf()->find_identical_sections(input_objects, symtab,
+					     workqueue, icf_blocker);
+      workqueue->queue(new Task_function(new Middle_layout_runner(options,
+								  input_objects,
+								  symtab,
+								  layout,
+								  mapfile),
+					 icf_blocker,
+					 "Task_function Middle_layout_runner"));
+      return;
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle tasks, which lay out the input
+// sections and scan the relocations.  This runs after identical code
+// folding, if any.
+
+void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
+  // If --hot-segment was used, find the input sections which define
+  // the hot symbols, so that they are laid out in the hot segment.
+  if (parameters->options().hot_segment())
+    layout->find_hot_sections(symtab);
+
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -564,11 +746,13 @@ queue_middle_tasks(const General_options& options,
   layout->finalize_eh_frame_section();
 
   /* If plugins have specified a section order, re-arrange input sections
-     according to a specified section order.  If --section-ordering-file is
-     also specified, do not do anything here.  */
+     according to a specified section order.  If --section-ordering-file or
+     --call-graph-ordering-file is also specified, do not do anything
+     here.  */
   if (parameters->options().has_plugins()
       && layout->is_section_ordering_specified()
-      && !parameters->options().section_ordering_file ())
+      && !parameters->options().section_ordering_file ()
+      && !parameters->options().call_graph_ordering_file())
     {
       for (Layout::Section_list::const_iterator p
 	     = layout->section_list().begin();
@@ -577,6 +761,11 @@ queue_middle_tasks(const General_options& options,
 	(*p)->update_section_layout(layout->get_section_order_map());
     }
 
+  // If --call-graph-ordering-file was used, cluster the functions in
+  // the call graph and re-arrange the input sections to match.
+  if (parameters->options().call_graph_ordering_file())
+    layout->order_sections_by_call_graph(task, symtab);
+
   if (parameters->options().gc_sections()
       || parameters->options().icf_enabled())
     {
@@ -597,11 +786,6 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
-  int thread_count = options.thread_count_middle();
-  if (thread_count == 0)
-    thread_count = std::max(2, input_objects->number_of_input_objects());
-  workqueue->set_thread_count(thread_count);
-
   // Now we have seen all the input files.
   const bool doing_static_link =
     (!input_objects->any_dynamic()
@@ -640,12 +824,14 @@ queue_middle_tasks(const General_options& options,
     }
 
   // For incremental updates, record the existing GOT and PLT entries,
-  // and the COPY relocations.
+  // the COPY relocations, and the dynamic relocations for data in
+  // unchanged input files.
   if (parameters->incremental_update())
     {
       Incremental_binary* ibase = layout->incremental_base();
       ibase->process_got_plt(symtab, layout);
       ibase->emit_copy_relocs(symtab);
+      ibase->emit_dynamic_relocs(symtab);
     }
 
   if (is_debugging_enabled(DEBUG_SCRIPT))
@@ -771,6 +957,15 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // Add the strings of merged string sections in parallel with
+  // scanning the relocations.
+  if (parameters->options().parallel_merge_strings())
+    layout->queue_merge_tasks(workqueue, this_blocker);
+
+  // Scan the debug info for the .gdb_index section, also in parallel
+  // with scanning the relocations.
+  layout->queue_gdb_index_tasks(workqueue, this_blocker);
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -792,11 +987,15 @@ queue_final_tasks(const General_options& options,
 		  const Symbol_table* symtab,
 		  Layout* layout,
 		  Workqueue* workqueue,
-		  Output_file* of)
+		  Output_file* of,
+		  Mapfile* mapfile)
 {
   Timer* timer = parameters->timer();
   if (timer != NULL)
     timer->stamp(1);
+  Trace* trace = parameters->trace();
+  if (trace != NULL)
+    trace->start_phase("final tasks");
 
   int thread_count = options.thread_count_final();
   if (thread_count == 0)
@@ -821,11 +1020,13 @@ queue_final_tasks(const General_options& options,
   Task_token* output_sections_blocker = new Task_token(true);
   output_sections_blocker->add_blocker();
 
+  bool write_map = mapfile != NULL && mapfile->is_structured();
+
   // Use a blocker to block the final cleanup task.
   Task_token* final_blocker = new Task_token(true);
   // Write_symbols_task, Write_sections_task, Write_data_task,
-  // Relocate_tasks.
-  final_blocker->add_blockers(3);
+  // Write_map_task, Relocate_tasks.
+  final_blocker->add_blockers(write_map ? 4 : 3);
   final_blocker->add_blockers(input_objects->number_of_relobjs());
   if (!any_postprocessing_sections)
     final_blocker->add_blocker();
@@ -847,6 +1048,11 @@ queue_final_tasks(const General_options& options,
   // Queue a task to write out everything else.
   workqueue->queue(new Write_data_task(layout, symtab, of, final_blocker));
 
+  // Queue a task to write the memory map of a structured map file
+  // while the output file is written.
+  if (write_map)
+    workqueue->queue(new Write_map_task(layout, mapfile, final_blocker));
+
   // Queue a task for each input object to relocate the sections and
   // write out the local symbols.
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
@@ -861,15 +1067,49 @@ queue_final_tasks(const General_options& options,
   // input sections.  If there are any sections which require
   // postprocessing, then we need to do this last, since it may resize
   // the output file.
+  // The .eh_frame_hdr section is written with them; with threads, its
+  // lookup table is sorted in parallel first.
   if (!any_postprocessing_sections)
     {
+      Task_token* after_input_sections_blocker = input_sections_blocker;
+      unsigned int sort_task_count = layout->eh_frame_hdr_sort_task_count();
+      if (sort_task_count > 0)
+	{
+	  after_input_sections_blocker = new Task_token(true);
+	  after_input_sections_blocker->add_blockers(sort_task_count);
+	  layout->queue_eh_frame_hdr_sort_tasks(workqueue, of,
+						input_sections_blocker,
+						after_input_sections_blocker);
+	}
       Task* t = new Write_after_input_sections_task(layout, of,
-						    input_sections_blocker,
+						    after_input_sections_blocker,
 						    final_blocker);
       workqueue->queue(t);
     }
   else
     {
+      // Compress the debug sections, and sort the .eh_frame_hdr
+      // lookup table, in parallel, before the sections which require
+      // postprocessing are laid out.
+      bool any_compress_tasks = layout->any_compressed_sections();
+      unsigned int sort_task_count = layout->eh_frame_hdr_sort_task_count();
+      if (any_compress_tasks || sort_task_count > 0)
+	{
+	  // Task_token::add_blockers does not take the workqueue lock,
+	  // so add all the blockers before queueing any task.
+	  Task_token* compress_blocker = new Task_token(true);
+	  if (any_compress_tasks)
+	    compress_blocker->add_blockers(layout->compress_block_count());
+	  compress_blocker->add_blockers(sort_task_count);
+	  if (any_compress_tasks)
+	    layout->queue_compress_tasks(workqueue, final_blocker,
+					 compress_blocker);
+	  if (sort_task_count > 0)
+	    layout->queue_eh_frame_hdr_sort_tasks(workqueue, of, final_blocker,
+						  compress_blocker);
+	  final_blocker = compress_blocker;
+	}
+
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
       Task* t = new Write_after_input_sections_task(layout, of,
@@ -880,7 +1120,8 @@ queue_final_tasks(const General_options& options,
     }
 
   // Create tasks for tree-style build ID computation, if necessary.
-  if (strcmp(options.build_id(), "tree") == 0)
+  if (strcmp(options.build_id(), "tree") == 0
+      || strcmp(options.build_id(), "fast") == 0)
     {
       // Queue a task to compute the build id.  This will be blocked by
       // FINAL_BLOCKER, and will in turn schedule the task to close
@@ -232,6 +232,26 @@ queue_middle_tasks(const General_options&,
 		   Workqueue*,
 		   Mapfile*);
 
+// Queue up the middle tasks which run after garbage collection.
+extern void
+queue_middle_icf_tasks(const General_options&,
+		       const Task*,
+		       const Input_objects*,
+		       Symbol_table*,
+		       Layout*,
+		       Workqueue*,
+		       Mapfile*);
+
+// Queue up the middle tasks which run after identical code folding.
+extern void
+queue_middle_layout_tasks(const General_options&,
+			  const Task*,
+			  const Input_objects*,
+			  Symbol_table*,
+			  Layout*,
+			  Workqueue*,
+			  Mapfile*);
+
 // Queue up the final set of tasks.
 extern void
 queue_final_tasks(const General_options&,
@@ -239,7 +259,8 @@ queue_final_tasks(const General_options&,
 		  const Symbol_table*,
 		  Layout*,
 		  Workqueue*,
-		  Output_file* of);
+		  Output_file* of,
+		  Mapfile*);
 
 inline bool
 is_prefix_of(const char* prefix, const char* str)
@@ -132,6 +132,18 @@
 //
 //
 //
+// Parallelism :
+// -------------
+//
+// The section contents and the relocs which do not change between
+// iterations are checksummed in parallel, one task per object, without
+// copying the contents.  Sections which might be identical are then
+// grouped by contents in parallel, partitioned by checksum.  The
+// iterations themselves only look at the relocs to foldable sections,
+// which are small.  They run serially because each section uses the
+// sections folded earlier in the same iteration.  --stats prints the
+// number of sections checksummed, groups, and folds in each iteration.
+//
 // How to run  : --icf=[safe|all|none]
 // Optional parameters : --icf-iterations <num> --print-icf-sections
 //
@@ -147,72 +159,11 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
-// This function determines if a section or a group of identical
-// sections has unique contents.  Such unique sections or groups can be
-// declared final and need not be processed any further.
-// Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
-// IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
-//                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
-
-static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
-{
-  Unordered_map<uint32_t, unsigned int> uniq_map;
-  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
-    uniq_map_insert;
-
-  for (unsigned int i = 0; i < id_section.size(); i++)
-    {
-      if ((*is_secn_or_group_unique)[i])
-        continue;
-
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
-      if (uniq_map_insert.second)
-        {
-          (*is_secn_or_group_unique)[i] = true;
-        }
-      else
-        {
-          (*is_secn_or_group_unique)[i] = false;
-          (*is_secn_or_group_unique)[uniq_map_insert.first->second] = false;
-        }
-    }
-}
-
 // For SHF_MERGE sections that use REL relocations, the addend is stored in
 // the text section at the relocation offset.  Read  the addend value given
 // the pointer to the addend in the text section and the addend size.
@@ -252,58 +203,314 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// This appends to BUFFER the entry of a merge section which a reloc
+// points to, so that relocs to identical constants compare equal.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
-// SECN               : Section for which contents are desired.
-// SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
-
-static std::string
-get_section_contents(bool first_iteration,
-                     const Section_id& secn,
-                     unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
-                     Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+// BUFFER             : The buffer to append to.
+// CONTENTS           : The contents of the section with the reloc.
+// TARGET             : The merge section that the reloc points to.
+// ADDEND             : The symbol value and the addend of the reloc.
+// RELOC_OFFSET       : The offset of the reloc in CONTENTS.
+// ADDEND_SIZE        : The size of a REL addend in CONTENTS.
+// IS_SECTION_SYMBOL  : True if the reloc is against a section symbol.
+
+static void
+append_merge_section_entry(std::string* buffer,
+                           const unsigned char* contents,
+                           const Section_id& target,
+                           const std::pair<long long, long long>& addend,
+                           uint64_t reloc_offset,
+                           unsigned int addend_size,
+                           bool is_section_symbol)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
+  uint64_t secn_flags = target.first->section_flags(target.second);
+  uint64_t entsize = target.first->section_entsize(target.second);
+  long long offset = addend.first;
+
+  // Handle SHT_RELA and SHT_REL addends. Only one of these
+  // addends exists. When pointing to a merge section, the
+  // addend only matters if it's relative to a section
+  // symbol. In order to unambiguously identify the target
+  // of the relocation, the compiler (and assembler) must use
+  // a local non-section symbol unless Symbol+Addend does in
+  // fact point directly to the target. (In other words,
+  // a bias for a pc-relative reference or a non-zero based
+  // access forces the use of a local symbol, and the addend
+  // is used only to provide that bias.)
+  uint64_t reloc_addend_value = 0;
+  if (is_section_symbol)
+    {
+      // Get the SHT_RELA addend.  For RELA relocations,
+      // we have the addend from the relocation.
+      reloc_addend_value = addend.second;
+
+      // Handle SHT_REL addends.
+      // For REL relocations, we need to fetch the addend
+      // from the section contents.
+      const unsigned char* reloc_addend_ptr =
+        contents + static_cast<unsigned long long>(reloc_offset);
+
+      // Update the addend value with the SHT_REL addend if
+      // available.
+      get_rel_addend(reloc_addend_ptr, addend_size, &reloc_addend_value);
+
+      // Ignore the addend when it is a negative value.
+      // See the comments in Merged_symbol_value::value
+      // in object.h.
+      if (reloc_addend_value < 0xffffff00)
+        offset = offset + reloc_addend_value;
+    }
 
-  section_size_type plen;
-  const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+  section_size_type secn_len;
 
-  // The buffer to hold all the contents including relocs.  A checksum
-  // is then computed on this buffer.
-  std::string buffer;
-  std::string icf_reloc_buffer;
+  const unsigned char* str_contents =
+    target.first->section_contents(target.second, &secn_len, false) + offset;
+  gold_assert (offset < (long long) secn_len);
+
+  if ((secn_flags & elfcpp::SHF_STRINGS) != 0)
+    {
+      // String merge section.
+      const char* str_char =
+        reinterpret_cast<const char*>(str_contents);
+      switch(entsize)
+        {
+        case 1:
+          {
+            buffer->append(str_char);
+            break;
+          }
+        case 2:
+          {
+            const uint16_t* ptr_16 =
+              reinterpret_cast<const uint16_t*>(str_char);
+            unsigned int strlen_16 = 0;
+            // Find the NULL character.
+            while(*(ptr_16 + strlen_16) != 0)
+                strlen_16++;
+            buffer->append(str_char, strlen_16 * 2);
+          }
+          break;
+        case 4:
+          {
+            const uint32_t* ptr_32 =
+              reinterpret_cast<const uint32_t*>(str_char);
+            unsigned int strlen_32 = 0;
+            // Find the NULL character.
+            while(*(ptr_32 + strlen_32) != 0)
+                strlen_32++;
+            buffer->append(str_char, strlen_32 * 4);
+          }
+          break;
+        default:
+          gold_unreachable();
+        }
+    }
+  else
+    {
+      // Use the entsize to determine the length to copy.
+      uint64_t bufsize = entsize;
+      // If entsize is too big, copy all the remaining bytes.
+      if ((offset + entsize) > secn_len)
+        bufsize = secn_len - offset;
+      buffer->append(reinterpret_cast<const char*>(str_contents), bufsize);
+    }
+  buffer->append("@");
+}
 
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
+// The number of partitions used to group the sections by contents.
+// Each partition is handled by its own task.  The groups do not
+// depend on this number.
 
-  Icf::Reloc_info_list& reloc_info_list = 
-    symtab->icf()->reloc_info_list();
+static const unsigned int icf_partition_count = 16;
+
+// This class holds what ICF computes for each candidate section, and
+// runs the steps of the matching.  The checksums of the section
+// contents, and the parts of the relocs which do not change from one
+// iteration to the next, are computed in parallel for each object by
+// Icf_fingerprint_task.  Sections with the same contents and fixed
+// relocs are then put into the same class, in parallel for each
+// partition of the checksums, by Icf_classify_task.  After that the
+// iterations only need to look at the relocs to foldable sections,
+// which depend on the sections folded so far; Icf_match_task does
+// that serially.
+
+class Icf_matcher
+{
+ public:
+  Icf_matcher(Symbol_table* symtab,
+              const std::vector<Section_id>& id_section,
+              std::vector<unsigned int>* kept_section_id)
+    : symtab_(symtab), id_section_(id_section),
+      kept_section_id_(kept_section_id),
+      sections_(id_section.size()),
+      is_secn_or_group_unique_(id_section.size(), false),
+      partitions_(icf_partition_count)
+  { }
+
+  // Compute the fingerprints of sections FIRST to LAST - 1, which
+  // are all in one object.  The object must be locked.  This may be
+  // called in parallel for different objects.
+  void
+  fingerprint_sections(unsigned int first, unsigned int last);
+
+  // Finish the fingerprints, once all objects have been processed,
+  // and assign the sections which might be identical to partitions.
+  void
+  prepare_to_classify();
+
+  // Put the sections in partition PARTITION into classes of sections
+  // with the same contents.  This may be called in parallel for
+  // different partitions.
+  void
+  classify_sections(unsigned int partition);
+
+  // Run the iterations of the matching.  Return true if it converged.
+  bool
+  match_sections(Icf::Iteration_stats_list* stats);
+
+ private:
+  // What we know about each candidate section.
+  struct Section_info
+  {
+    Section_info()
+      : contents(NULL), contents_len(0), contents_cksum(0), fixed(),
+        fixed_cksum(0), fixed_class(-1U), tracked_relocs(),
+        deferred_relocs(), addralign(0), contents_copy()
+    { }
+
+    // The contents of the section.
+    const unsigned char* contents;
+    // The size of the contents.
+    section_size_type contents_len;
+    // The checksum of the contents.
+    uint32_t contents_cksum;
+    // The relocs to sections which cannot be folded, including the
+    // addends of the relocs to sections which can.  These do not
+    // change from one iteration to the next.
+    std::string fixed;
+    // The checksum of FIXED and of the contents.
+    uint32_t fixed_cksum;
+    // The number of the first section with the same FIXED and the
+    // same contents as this one.
+    unsigned int fixed_class;
+    // The relocs to sections which might be folded: the number of the
+    // section which the reloc points to, and the addend string.
+    std::vector<std::pair<unsigned int, std::string> > tracked_relocs;
+    // Relocs to merge sections in other objects, which can only be
+    // read once the other objects are unlocked: the position in FIXED
+    // and the index of the reloc in the Reloc_info.
+    std::vector<std::pair<size_t, unsigned int> > deferred_relocs;
+    // The alignment of the section.
+    uint64_t addralign;
+    // A copy of the contents, if the file views will not be kept.
+    std::vector<unsigned char> contents_copy;
+  };
+
+  // Compute the fingerprint of a single section.
+  void
+  fingerprint_section(unsigned int section_num);
+
+  // Add the deferred relocs of a section to its fixed part.
+  void
+  add_deferred_relocs(unsigned int section_num);
+
+  // Set the checksum of the fixed part and contents of a section.
+  void
+  set_fixed_cksum(Section_info* info)
+  {
+    const unsigned char* fixed =
+      reinterpret_cast<const unsigned char*>(info->fixed.data());
+    uint32_t cksum = xcrc32(fixed, info->fixed.length(), 0xffffffff);
+    const unsigned char* contents_cksum =
+      reinterpret_cast<const unsigned char*>(&info->contents_cksum);
+    info->fixed_cksum = xcrc32(contents_cksum, sizeof(info->contents_cksum),
+                               cksum);
+  }
+
+  // Return whether two sections have the same fixed part and contents.
+  bool
+  same_fixed_contents(const Section_info& a, const Section_info& b) const
+  {
+    return (a.fixed_cksum == b.fixed_cksum
+            && a.contents_len == b.contents_len
+            && a.fixed == b.fixed
+            && memcmp(a.contents, b.contents, a.contents_len) == 0);
+  }
+
+  // Return the relocs to sections which might be folded, using the
+  // current kept sections.
+  std::string
+  icf_relocs(unsigned int section_num) const;
+
+  // Mark the sections or groups of sections which are known to be
+  // unique.
+  void
+  preprocess_for_unique_sections(bool first_iteration);
+
+  // Run one iteration of the matching.
+  bool
+  match_sections(unsigned int iteration_num, Icf::Iteration_stats* stats);
+
+  // The symbol table.
+  Symbol_table* symtab_;
+  // Maps integers to sections.
+  const std::vector<Section_id>& id_section_;
+  // Maps a section to the section it is folded into.
+  std::vector<unsigned int>* kept_section_id_;
+  // Information about each section.
+  std::vector<Section_info> sections_;
+  // To check if a section or a group of identical sections is already
+  // known to be unique.
+  std::vector<bool> is_secn_or_group_unique_;
+  // The sections in each partition.
+  std::vector<std::vector<unsigned int> > partitions_;
+};
+
+// Compute the fingerprints of sections FIRST to LAST - 1.
+
+void
+Icf_matcher::fingerprint_sections(unsigned int first, unsigned int last)
+{
+  for (unsigned int i = first; i < last; ++i)
+    this->fingerprint_section(i);
+}
+
+// This computes the parts of a section's checksum which do not change
+// from one iteration to the next: the contents and the relocs.  Relocs
+// are differentiated as those pointing to sections that could be
+// folded and those that cannot.  Only relocs pointing to sections
+// that could be folded are recomputed in each iteration, by
+// icf_relocs.  This does not copy the section contents; the views are
+// cached and stay mapped until the link is done, unless
+// --no-keep-files-mapped is used.
+
+void
+Icf_matcher::fingerprint_section(unsigned int section_num)
+{
+  Section_info* info = &this->sections_[section_num];
+  const Section_id& secn(this->id_section_[section_num]);
+
+  section_size_type plen;
+  const unsigned char* contents =
+    secn.first->section_contents(secn.second, &plen, true);
+  if (!parameters->options().keep_files_mapped() && plen > 0)
+    {
+      info->contents_copy.assign(contents, contents + plen);
+      contents = &info->contents_copy[0];
+    }
+  info->contents = contents;
+  info->contents_len = plen;
+  info->contents_cksum = xcrc32(contents, plen, 0xffffffff);
+  info->addralign = secn.first->section_addralign(secn.second);
+
+  std::string& buffer(info->fixed);
+
+  Icf::Reloc_info_list& reloc_info_list =
+    this->symtab_->icf()->reloc_info_list();
 
   Icf::Reloc_info_list::iterator it_reloc_info_list =
     reloc_info_list.find(secn);
 
-  buffer.clear();
-  icf_reloc_buffer.clear();
-
   // Process relocs and put them into the buffer.
 
   if (it_reloc_info_list != reloc_info_list.end())
@@ -325,7 +532,9 @@ get_section_contents(bool first_iteration,
       Icf::Reloc_addend_size_info::const_iterator it_addend_size =
         reloc_addend_size_info.begin();
 
-      for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size)
+      for (unsigned int reloc_index = 0;
+           it_v != v.end();
+           ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size, ++reloc_index)
         {
 	  Symbol* gsym = *it_s;
 	  bool is_section_symbol = false;
@@ -337,8 +546,7 @@ get_section_contents(bool first_iteration,
 	      gsym = NULL;
 	    }
 
-	  if (first_iteration
-	      && it_v->first != NULL)
+	  if (it_v->first != NULL)
 	    {
 	      Symbol_location loc;
 	      loc.object = it_v->first;
@@ -374,15 +582,12 @@ get_section_contents(bool first_iteration,
 	  // object is NULL.
 	  if (it_v->first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if (gsym != NULL)
-                      buffer.append(gsym->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+	      // If the symbol name is available, use it.
+	      if (gsym != NULL)
+		buffer.append(gsym->name());
+	      // Append the addend.
+	      buffer.append(addend_str);
+	      buffer.append("@");
 	      continue;
 	    }
 
@@ -393,16 +598,13 @@ get_section_contents(bool first_iteration,
           if (reloc_secn.first == secn.first
               && reloc_secn.second == secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+              buffer.append("R");
+              buffer.append(addend_str);
+              buffer.append("@");
               continue;
             }
           Icf::Uniq_secn_id_map& section_id_map =
-            symtab->icf()->section_to_int_map();
+            this->symtab_->icf()->section_to_int_map();
           Icf::Uniq_secn_id_map::iterator section_id_map_it =
             section_id_map.find(reloc_secn);
           bool is_sym_preemptible = (gsym != NULL
@@ -413,133 +615,33 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+              buffer.append("ICF_R");
+              buffer.append(addend_str);
+              info->tracked_relocs.push_back(
+                  std::make_pair(section_id_map_it->second,
+                                 std::string(addend_str)));
             }
           else
             {
               // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
               uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
               // This reloc points to a merge section.  Hash the
               // contents of this section.
               if ((secn_flags & elfcpp::SHF_MERGE) != 0
 		  && parameters->target().can_icf_inline_merge_sections())
                 {
-                  uint64_t entsize =
-                    (it_v->first)->section_entsize(it_v->second);
-		  long long offset = it_a->first;
-
-		  // Handle SHT_RELA and SHT_REL addends. Only one of these
-		  // addends exists. When pointing to a merge section, the
-		  // addend only matters if it's relative to a section
-		  // symbol. In order to unambiguously identify the target
-		  // of the relocation, the compiler (and assembler) must use
-		  // a local non-section symbol unless Symbol+Addend does in
-		  // fact point directly to the target. (In other words,
-		  // a bias for a pc-relative reference or a non-zero based
-		  // access forces the use of a local symbol, and the addend
-		  // is used only to provide that bias.)
-		  uint64_t reloc_addend_value = 0;
-		  if (is_section_symbol)
-		    {
-		      // Get the SHT_RELA addend.  For RELA relocations,
-		      // we have the addend from the relocation.
-		      reloc_addend_value = it_a->second;
-
-		      // Handle SHT_REL addends.
-		      // For REL relocations, we need to fetch the addend
-		      // from the section contents.
-		      const unsigned char* reloc_addend_ptr =
-			contents + static_cast<unsigned long long>(*it_o);
-
-		      // Update the addend value with the SHT_REL addend if
-		      // available.
-		      get_rel_addend(reloc_addend_ptr, *it_addend_size,
-				     &reloc_addend_value);
-
-		      // Ignore the addend when it is a negative value.
-		      // See the comments in Merged_symbol_value::value
-		      // in object.h.
-		      if (reloc_addend_value < 0xffffff00)
-			offset = offset + reloc_addend_value;
-		    }
-
-                  section_size_type secn_len;
-
-                  const unsigned char* str_contents =
-                  (it_v->first)->section_contents(it_v->second,
-                                                  &secn_len,
-                                                  false) + offset;
-		  gold_assert (offset < (long long) secn_len);
-
-                  if ((secn_flags & elfcpp::SHF_STRINGS) != 0)
-                    {
-                      // String merge section.
-                      const char* str_char =
-                        reinterpret_cast<const char*>(str_contents);
-                      switch(entsize)
-                        {
-                        case 1:
-                          {
-                            buffer.append(str_char);
-                            break;
-                          }
-                        case 2:
-                          {
-                            const uint16_t* ptr_16 =
-                              reinterpret_cast<const uint16_t*>(str_char);
-                            unsigned int strlen_16 = 0;
-                            // Find the NULL character.
-                            while(*(ptr_16 + strlen_16) != 0)
-                                strlen_16++;
-                            buffer.append(str_char, strlen_16 * 2);
-                          }
-                          break;
-                        case 4:
-                          {
-                            const uint32_t* ptr_32 =
-                              reinterpret_cast<const uint32_t*>(str_char);
-                            unsigned int strlen_32 = 0;
-                            // Find the NULL character.
-                            while(*(ptr_32 + strlen_32) != 0)
-                                strlen_32++;
-                            buffer.append(str_char, strlen_32 * 4);
-                          }
-                          break;
-                        default:
-                          gold_unreachable();
-                        }
-                    }
-                  else
+                  // We only hold the lock on this object, so the
+                  // contents of a merge section in another object are
+                  // read later by add_deferred_relocs.
+                  if (it_v->first != secn.first)
                     {
-                      // Use the entsize to determine the length to copy.
-		      uint64_t bufsize = entsize;
-		      // If entsize is too big, copy all the remaining bytes.
-		      if ((offset + entsize) > secn_len)
-			bufsize = secn_len - offset;
-                      buffer.append(reinterpret_cast<const
-                                                     char*>(str_contents),
-                                    bufsize);
+                      info->deferred_relocs.push_back(
+                          std::make_pair(buffer.length(), reloc_index));
+                      continue;
                     }
-		  buffer.append("@");
+                  append_merge_section_entry(&buffer, contents, reloc_secn,
+                                             *it_a, *it_o, *it_addend_size,
+                                             is_section_symbol);
                 }
               else if (gsym != NULL)
                 {
@@ -565,27 +667,206 @@ get_section_contents(bool first_iteration,
         }
     }
 
-  if (first_iteration)
+  buffer.append("Contents = ");
+  if (info->deferred_relocs.empty())
+    this->set_fixed_cksum(info);
+}
+
+// Read the merge section entries which were deferred by
+// fingerprint_section and insert them into the fixed part.  This is
+// only called single-threaded, so it is OK to lock the objects.
+
+void
+Icf_matcher::add_deferred_relocs(unsigned int section_num)
+{
+  Section_info* info = &this->sections_[section_num];
+  const Section_id& secn(this->id_section_[section_num]);
+
+  Icf::Reloc_info_list& reloc_info_list =
+    this->symtab_->icf()->reloc_info_list();
+  Icf::Reloc_info_list::const_iterator p = reloc_info_list.find(secn);
+  gold_assert(p != reloc_info_list.end());
+  const Icf::Reloc_info& reloc_info(p->second);
+
+  std::string buffer;
+  size_t pos = 0;
+  for (std::vector<std::pair<size_t, unsigned int> >::const_iterator q =
+         info->deferred_relocs.begin();
+       q != info->deferred_relocs.end();
+       ++q)
     {
-      buffer.append("Contents = ");
-      buffer.append(reinterpret_cast<const char*>(contents), plen);
-      // Store the section contents that don't change to avoid recomputing
-      // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
+      buffer.append(info->fixed, pos, q->first - pos);
+      pos = q->first;
+
+      unsigned int i = q->second;
+      Section_id target(reloc_info.section_info[i]);
+      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+      Task_lock_obj<Object> tl(dummy_task, target.first);
+      bool is_section_symbol =
+        reloc_info.symbol_info[i] == reinterpret_cast<Symbol*>(-1);
+      append_merge_section_entry(&buffer, info->contents, target,
+                                 reloc_info.addend_info[i],
+                                 reloc_info.offset_info[i],
+                                 reloc_info.reloc_addend_size_info[i],
+                                 is_section_symbol);
     }
-  else
+  buffer.append(info->fixed, pos, std::string::npos);
+  info->fixed.swap(buffer);
+  this->set_fixed_cksum(info);
+}
+
+// Return the relocs to sections which might be folded.  These use the
+// kept section of the section the reloc points to, and so change as
+// sections are folded.
+
+std::string
+Icf_matcher::icf_relocs(unsigned int section_num) const
+{
+  const Section_info& info(this->sections_[section_num]);
+  std::string icf_reloc_buffer;
+  for (std::vector<std::pair<unsigned int, std::string> >::const_iterator p =
+         info.tracked_relocs.begin();
+       p != info.tracked_relocs.end();
+       ++p)
     {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
+      char kept_section_str[10];
+      snprintf(kept_section_str, sizeof(kept_section_str), "%u",
+               (*this->kept_section_id_)[p->first]);
+      icf_reloc_buffer.append(kept_section_str);
+      // Append the addend.
+      icf_reloc_buffer.append(p->second);
+      icf_reloc_buffer.append("@");
     }
+  return icf_reloc_buffer;
+}
 
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+// This function determines if a section or a group of identical
+// sections has unique contents.  Such unique sections or groups can be
+// declared final and need not be processed any further.  Before the
+// first iteration this looks only at the section's text; after that it
+// looks at the section's text and relocs to sections that cannot be
+// folded.
+
+void
+Icf_matcher::preprocess_for_unique_sections(bool first_iteration)
+{
+  Unordered_map<uint32_t, unsigned int> uniq_map;
+  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
+    uniq_map_insert;
+
+  for (unsigned int i = 0; i < this->id_section_.size(); i++)
+    {
+      if (this->is_secn_or_group_unique_[i])
+        continue;
+
+      const Section_info& info(this->sections_[i]);
+      uint32_t cksum = (first_iteration
+                        ? info.contents_cksum
+                        : info.fixed_cksum);
+      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
+      if (uniq_map_insert.second)
+        {
+          this->is_secn_or_group_unique_[i] = true;
+        }
+      else
+        {
+          this->is_secn_or_group_unique_[i] = false;
+          this->is_secn_or_group_unique_[uniq_map_insert.first->second] = false;
+        }
+    }
+}
+
+// Finish the fingerprints and assign the sections whose text is not
+// unique to partitions by checksum.
+
+void
+Icf_matcher::prepare_to_classify()
+{
+  for (unsigned int i = 0; i < this->id_section_.size(); ++i)
+    {
+      if (!this->sections_[i].deferred_relocs.empty())
+        this->add_deferred_relocs(i);
+    }
+
+  this->preprocess_for_unique_sections(true);
+
+  for (unsigned int i = 0; i < this->id_section_.size(); ++i)
+    {
+      if (this->is_secn_or_group_unique_[i])
+        continue;
+      unsigned int partition = (this->sections_[i].fixed_cksum
+                                % icf_partition_count);
+      this->partitions_[partition].push_back(i);
+    }
+}
+
+// Put each section in PARTITION into the class of the first section
+// with the same fixed part and contents.  Sections with the same
+// checksum are always in the same partition, so the classes do not
+// depend on the partitioning.  As with the matching, a multimap is
+// used because different sections can have the same checksum.
+
+void
+Icf_matcher::classify_sections(unsigned int partition)
+{
+  Unordered_multimap<uint32_t, unsigned int> classes;
+  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
+            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
+
+  const std::vector<unsigned int>& sections(this->partitions_[partition]);
+  for (std::vector<unsigned int>::const_iterator p = sections.begin();
+       p != sections.end();
+       ++p)
+    {
+      unsigned int i = *p;
+      Section_info* info = &this->sections_[i];
+      key_range = classes.equal_range(info->fixed_cksum);
+      Unordered_multimap<uint32_t, unsigned int>::iterator it;
+      for (it = key_range.first; it != key_range.second; ++it)
+        {
+          if (this->same_fixed_contents(this->sections_[it->second], *info))
+            break;
+        }
+      if (it != key_range.second)
+        info->fixed_class = it->second;
+      else
+        {
+          classes.insert(std::make_pair(info->fixed_cksum, i));
+          info->fixed_class = i;
+        }
+    }
+
+  std::vector<unsigned int>().swap(this->partitions_[partition]);
+}
+
+// Run the iterations of the matching, up to --icf-iterations (two by
+// default), and record statistics for each of them in STATS.
+
+bool
+Icf_matcher::match_sections(Icf::Iteration_stats_list* stats)
+{
+  unsigned int num_iterations = 0;
+
+  // Default number of iterations to run ICF is 2.
+  unsigned int max_iterations = (parameters->options().icf_iterations() > 0)
+                            ? parameters->options().icf_iterations()
+                            : 2;
+
+  bool converged = false;
+
+  while (!converged && (num_iterations < max_iterations))
+    {
+      num_iterations++;
+      Icf::Iteration_stats iteration_stats;
+      converged = this->match_sections(num_iterations, &iteration_stats);
+      stats->push_back(iteration_stats);
+    }
+
+  return converged;
 }
 
 // This function computes a checksum on each section to detect and form
-// groups of identical sections.  The first iteration does this for all 
+// groups of identical sections.  The first iteration does this for all
 // sections.
 // Further iterations do this only for the kept sections from each group to
 // determine if larger groups of identical sections could be formed.  The
@@ -594,160 +875,320 @@ get_section_contents(bool first_iteration,
 // CRC32 is the checksumming algorithm and can have collisions.  That is,
 // two sections with different contents can have the same checksum. Hence,
 // a multimap is used to maintain more than one group of checksum
-// identical sections.  A section is added to a group only after its
-// contents are explicitly compared with the kept section of the group.
+// identical sections.  A section is added to a group only after it is
+// explicitly compared with the kept section of the group: the class of
+// its contents and fixed relocs, and its relocs to foldable sections.
+//
+// The relocs to foldable sections use the kept sections as they are
+// when the section is reached, including sections folded earlier in
+// the same iteration, so this is done serially.
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// ID_SECTION         : Vector mapping a section to an unique integer.
-// IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
-//                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// STATS                   : Statistics for this iteration.
 
-static bool
-match_sections(unsigned int iteration_num,
-               Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
-               std::vector<unsigned int>* kept_section_id,
-               const std::vector<Section_id>& id_section,
-	       const std::vector<uint64_t>& section_addraligns,
-               std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+bool
+Icf_matcher::match_sections(unsigned int iteration_num,
+                            Icf::Iteration_stats* stats)
 {
   Unordered_multimap<uint32_t, unsigned int> section_cksum;
   std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
             Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
   bool converged = true;
+  std::vector<unsigned int>& kept_section_id(*this->kept_section_id_);
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
+  // The first iteration was preprocessed by prepare_to_classify.
+  if (iteration_num > 1)
+    this->preprocess_for_unique_sections(false);
+
+  stats->hashed = 0;
+  stats->groups = 0;
+  stats->folded = 0;
 
-  std::vector<std::string> full_section_contents;
+  std::vector<std::string> group_icf_relocs(this->id_section_.size());
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < this->id_section_.size(); i++)
     {
-      full_section_contents.push_back("");
-      if ((*is_secn_or_group_unique)[i])
+      if (this->is_secn_or_group_unique_[i])
         continue;
 
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
+      if (iteration_num > 1 && kept_section_id[i] != i)
         {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
-        }
-      else
-        {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
+          // This section is already folded into something.
+          continue;
         }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
-      size_t count = section_cksum.count(cksum);
-
-      if (count == 0)
-        {
-          // Start a group with this cksum.
-          section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
-        }
-      else
+      const Section_info& info(this->sections_[i]);
+      std::string this_icf_relocs = this->icf_relocs(i);
+      const unsigned char* this_icf_relocs_array =
+        reinterpret_cast<const unsigned char*>(this_icf_relocs.data());
+      uint32_t cksum = xcrc32(this_icf_relocs_array, this_icf_relocs.length(),
+                              info.fixed_cksum);
+      ++stats->hashed;
+
+      key_range = section_cksum.equal_range(cksum);
+      Unordered_multimap<uint32_t, unsigned int>::iterator it;
+      // Search all the groups with this cksum for a match.
+      for (it = key_range.first; it != key_range.second; ++it)
         {
-          key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
-          // Search all the groups with this cksum for a match.
-          for (it = key_range.first; it != key_range.second; ++it)
-            {
-              unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
-
-	      // Check section alignment here.
-	      // The section with the larger alignment requirement
-	      // should be kept.  We assume alignment can only be 
-	      // zero or positive integral powers of two.
-	      uint64_t align_i = section_addraligns[i];
-	      uint64_t align_kept = section_addraligns[kept_section];
-	      if (align_i <= align_kept)
-		{
-		  (*kept_section_id)[i] = kept_section;
-		}
-	      else
-		{
-		  (*kept_section_id)[kept_section] = i;
-		  it->second = i;
-		  full_section_contents[kept_section].swap(
-		      full_section_contents[i]);
-		}
+          unsigned int kept_section = it->second;
+          if (this->sections_[kept_section].fixed_class != info.fixed_class)
+            continue;
+          if (group_icf_relocs[kept_section] != this_icf_relocs)
+            continue;
 
-              converged = false;
-              break;
+          // Check section alignment here.
+          // The section with the larger alignment requirement
+          // should be kept.  We assume alignment can only be
+          // zero or positive integral powers of two.
+          uint64_t align_i = info.addralign;
+          uint64_t align_kept = this->sections_[kept_section].addralign;
+          if (align_i <= align_kept)
+            {
+              kept_section_id[i] = kept_section;
             }
-          if (it == key_range.second)
+          else
             {
-              // Create a new group for this cksum.
-              section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
+              kept_section_id[kept_section] = i;
+              it->second = i;
+              group_icf_relocs[kept_section].swap(group_icf_relocs[i]);
             }
+
+          converged = false;
+          ++stats->folded;
+          break;
+        }
+      if (it == key_range.second)
+        {
+          // Create a new group for this cksum.
+          section_cksum.insert(std::make_pair(cksum, i));
+          group_icf_relocs[i].swap(this_icf_relocs);
+          ++stats->groups;
         }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
-        (*is_secn_or_group_unique)[i] = true;
+      if (iteration_num == 1 && info.tracked_relocs.empty())
+        this->is_secn_or_group_unique_[i] = true;
     }
 
   // If a section was folded into another section that was later folded
   // again then the former has to be updated.
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  unsigned int total_folded = 0;
+  for (unsigned int i = 0; i < this->id_section_.size(); i++)
     {
       // Find the end of the folding chain
       unsigned int kept = i;
-      while ((*kept_section_id)[kept] != kept)
+      while (kept_section_id[kept] != kept)
         {
-          kept = (*kept_section_id)[kept];
+          kept = kept_section_id[kept];
         }
       // Update every element of the chain
       unsigned int current = i;
-      while ((*kept_section_id)[current] != kept)
+      while (kept_section_id[current] != kept)
         {
-          unsigned int next = (*kept_section_id)[current];
-          (*kept_section_id)[current] = kept;
+          unsigned int next = kept_section_id[current];
+          kept_section_id[current] = kept;
           current = next;
         }
+      if (kept != i)
+        ++total_folded;
     }
+  stats->total_folded = total_folded;
 
   return converged;
 }
 
+// A task to compute the fingerprints of the candidate sections of one
+// object.  We hold a lock on the object, and a blocker which keeps
+// the classification from starting until all objects are done.
+
+class Icf_fingerprint_task : public Task
+{
+ public:
+  Icf_fingerprint_task(Icf_matcher* matcher, Relobj* object,
+                       unsigned int first, unsigned int last,
+                       Task_token* blocker)
+    : matcher_(matcher), object_(object), first_(first), last_(last),
+      blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->matcher_->fingerprint_sections(this->first_, this->last_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_fingerprint_task " + this->object_->name(); }
+
+ private:
+  Icf_matcher* matcher_;
+  Relobj* object_;
+  unsigned int first_;
+  unsigned int last_;
+  Task_token* blocker_;
+};
+
+// A task to classify the sections of one partition.  It holds a
+// blocker which keeps the matching from starting.
+
+class Icf_classify_task : public Task
+{
+ public:
+  Icf_classify_task(Icf_matcher* matcher, unsigned int partition,
+                    Task_token* blocker)
+    : matcher_(matcher), partition_(partition), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->matcher_->classify_sections(this->partition_); }
+
+  std::string
+  get_name() const
+  { return "Icf_classify_task"; }
+
+ private:
+  Icf_matcher* matcher_;
+  unsigned int partition_;
+  Task_token* blocker_;
+};
+
+// A task which runs after all the fingerprints are computed.  It
+// finishes them and queues an Icf_classify_task for each partition.
+// It holds NEXT_BLOCKER until those tasks are queued.
+
+class Icf_prepare_task : public Task
+{
+ public:
+  Icf_prepare_task(Icf_matcher* matcher, Task_token* this_blocker,
+                   Task_token* next_blocker)
+    : matcher_(matcher), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Icf_prepare_task()
+  { delete this->this_blocker_; }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    this->matcher_->prepare_to_classify();
+    for (unsigned int i = 0; i < icf_partition_count; ++i)
+      {
+        workqueue->add_blocker(this->next_blocker_);
+        workqueue->queue(new Icf_classify_task(this->matcher_, i,
+                                               this->next_blocker_));
+      }
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_prepare_task"; }
+
+ private:
+  Icf_matcher* matcher_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// The last ICF task, which runs the iterations of the matching once
+// all the sections are classified.  It holds NEXT_BLOCKER, which keeps
+// the rest of the link from starting.
+
+class Icf_match_task : public Task
+{
+ public:
+  Icf_match_task(Icf* icf, Symbol_table* symtab, Icf_matcher* matcher,
+                 Task_token* this_blocker, Task_token* next_blocker)
+    : icf_(icf), symtab_(symtab), matcher_(matcher),
+      this_blocker_(this_blocker), next_blocker_(next_blocker)
+  { }
+
+  ~Icf_match_task()
+  { delete this->this_blocker_; }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  {
+    bool converged =
+      this->matcher_->match_sections(this->icf_->iteration_stats());
+    delete this->matcher_;
+    this->matcher_ = NULL;
+    this->icf_->finish_identical_sections(this->symtab_, converged);
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_match_task"; }
+
+ private:
+  Icf* icf_;
+  Symbol_table* symtab_;
+  Icf_matcher* matcher_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // During safe icf (--icf=safe), only fold functions that are ctors or dtors.
 // This function returns true if the section name is that of a ctor or a dtor.
 
@@ -766,21 +1207,23 @@ is_function_ctor_or_dtor(const std::string& section_name)
   return false;
 }
 
-// This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (twice by default)
-// which computes the crc checksums and detects identical functions.
+// This is the main ICF function called in gold.cc.  This decides which
+// sections are candidates, and queues the tasks which compute the
+// checksums and detect identical functions.  BLOCKER is released when
+// they are done.
 
 void
 Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+                             Symbol_table* symtab, Workqueue* workqueue,
+                             Task_token* blocker)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<uint64_t> section_addraligns;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
+  // The candidate sections of each object, as the object and the
+  // number of its first candidate section.
+  std::vector<std::pair<Relobj*, unsigned int> > object_sections;
+
   // Decide which sections are possible candidates first.
 
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
@@ -793,6 +1236,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
       const Task* dummy_task = reinterpret_cast<const Task*>(-1);
       Task_lock_obj<Object> tl(dummy_task, *p);
 
+      unsigned int first_section_num = section_num;
       for (unsigned int i = 0;i < (*p)->shnum(); ++i)
         {
 	  const std::string section_name = (*p)->section_name(i);
@@ -816,31 +1260,44 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-	  section_addraligns.push_back((*p)->section_addralign(i));
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
           section_num++;
         }
+      if (section_num > first_section_num)
+        object_sections.push_back(std::make_pair(*p, first_section_num));
     }
 
-  unsigned int num_iterations = 0;
+  Icf_matcher* matcher = new Icf_matcher(symtab, this->id_section_,
+                                         &this->kept_section_id_);
 
-  // Default number of iterations to run ICF is 2.
-  unsigned int max_iterations = (parameters->options().icf_iterations() > 0)
-                            ? parameters->options().icf_iterations()
-                            : 2;
-
-  bool converged = false;
+  Task_token* fingerprint_blocker = new Task_token(true);
+  fingerprint_blocker->add_blockers(object_sections.size());
+  Task_token* classify_blocker = new Task_token(true);
+  classify_blocker->add_blocker();
+  blocker->add_blocker();
 
-  while (!converged && (num_iterations < max_iterations))
+  for (unsigned int i = 0; i < object_sections.size(); ++i)
     {
-      num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+      unsigned int last = (i + 1 < object_sections.size()
+                           ? object_sections[i + 1].second
+                           : section_num);
+      workqueue->queue(new Icf_fingerprint_task(matcher,
+                                                object_sections[i].first,
+                                                object_sections[i].second,
+                                                last, fingerprint_blocker));
     }
+  workqueue->queue(new Icf_prepare_task(matcher, fingerprint_blocker,
+                                        classify_blocker));
+  workqueue->queue(new Icf_match_task(this, symtab, matcher,
+                                      classify_blocker, blocker));
+}
+
+// Finish ICF once the groups of identical sections have been formed.
+
+void
+Icf::finish_identical_sections(Symbol_table* symtab, bool converged)
+{
+  unsigned int num_iterations = this->iteration_stats_.size();
+  this->converged_ = converged;
 
   if (parameters->options().print_icf_sections())
     {
@@ -864,7 +1321,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 	{
 	  gold_warning(_("Could not find symbol %s to unfold\n"), name);
 	}
-      else if (sym->source() == Symbol::FROM_OBJECT 
+      else if (sym->source() == Symbol::FROM_OBJECT
                && !sym->object()->is_dynamic())
         {
           Relobj* obj = static_cast<Relobj*>(sym->object());
@@ -881,6 +1338,34 @@ Icf::find_identical_sections(const Input_objects* input_objects,
   this->icf_ready();
 }
 
+// Print statistics about the iterations of the matching.
+
+void
+Icf::print_stats() const
+{
+  if (!parameters->options().icf_enabled())
+    return;
+
+  fprintf(stderr, _("%s: ICF candidate sections: %u\n"),
+          program_name, static_cast<unsigned int>(this->id_section_.size()));
+  for (unsigned int i = 0; i < this->iteration_stats_.size(); ++i)
+    {
+      const Iteration_stats& s(this->iteration_stats_[i]);
+      fprintf(stderr,
+              _("%s: ICF iteration %u: %u sections checksummed, "
+                "%u groups, %u sections folded, %u folded in total\n"),
+              program_name, i + 1, s.hashed, s.groups, s.folded,
+              s.total_folded);
+    }
+  unsigned int num_iterations = this->iteration_stats_.size();
+  if (this->converged_)
+    fprintf(stderr, _("%s: ICF converged after %u iteration(s)\n"),
+            program_name, num_iterations);
+  else
+    fprintf(stderr, _("%s: ICF stopped after %u iteration(s)\n"),
+            program_name, num_iterations);
+}
+
 // Unfolds the section denoted by OBJ and SHNDX if folded.
 
 void
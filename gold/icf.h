@@ -35,6 +35,8 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Workqueue;
+class Task_token;
 
 class Icf
 {
@@ -64,11 +66,26 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  // Statistics about one iteration of the matching, for --stats.
+  struct Iteration_stats
+  {
+    // The number of sections checksummed in this iteration.
+    unsigned int hashed;
+    // The number of groups of identical sections formed.
+    unsigned int groups;
+    // The number of sections folded in this iteration.
+    unsigned int folded;
+    // The total number of folded sections after this iteration.
+    unsigned int total_folded;
+  };
+
+  typedef std::vector<Iteration_stats> Iteration_stats_list;
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
+    reloc_info_list_(), iteration_stats_(), converged_(false)
   { }
 
   // Returns the kept folded identical section corresponding to
@@ -77,10 +94,26 @@ class Icf
   get_folded_section(Relobj* dup_obj, unsigned int dup_shndx);
 
   // Forms groups of identical sections where the first member
-  // of each group is the kept section during folding.
+  // of each group is the kept section during folding.  This queues
+  // tasks which do the work; the last of them releases BLOCKER.
   void
   find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+                          Symbol_table* symtab, Workqueue* workqueue,
+                          Task_token* blocker);
+
+  // Called by the last ICF task when the groups have been formed.
+  // CONVERGED is true if the last iteration did not fold anything.
+  void
+  finish_identical_sections(Symbol_table* symtab, bool converged);
+
+  // Returns the statistics list, to be filled in for each iteration.
+  Iteration_stats_list*
+  iteration_stats()
+  { return &this->iteration_stats_; }
+
+  // Print statistics about the iterations for --stats.
+  void
+  print_stats() const;
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
@@ -160,6 +193,10 @@ class Icf
   bool icf_ready_;
   // This list is populated by gc_process_relocs in gc.h.
   Reloc_info_list reloc_info_list_;
+  // Statistics for each iteration of the matching.
+  Iteration_stats_list iteration_stats_;
+  // Whether the matching converged.
+  bool converged_;
 };
 
 // This function returns true if this section corresponds to a function that
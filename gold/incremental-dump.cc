@@ -96,7 +96,7 @@ dump_incremental_inputs(const char* argv0, const char* filename,
   Incremental_inputs_reader<size, big_endian>
       incremental_inputs(inc->inputs_reader());
 
-  if (incremental_inputs.version() != 2)
+  if (incremental_inputs.version() != 3)
     {
       fprintf(stderr, "%s: %s: unknown incremental version %d\n", argv0,
               filename, incremental_inputs.version());
@@ -178,6 +178,9 @@ dump_incremental_inputs(const char* argv0, const char* filename,
 	case INCREMENTAL_INPUT_SCRIPT:
 	  printf("Linker script\n");
 	  printf("    Object count: %d\n", input_file.get_object_count());
+	  printf("    Signature: 0x%llx\n",
+		 static_cast<unsigned long long>(
+		     input_file.get_script_signature()));
 	  break;
 	default:
 	  fprintf(stderr, "%s: invalid file type for object %u: %d\n",
@@ -22,6 +22,7 @@
 
 #include "gold.h"
 
+#include <algorithm>
 #include <set>
 #include <cstdarg>
 #include "libiberty.h"
@@ -43,7 +44,8 @@ namespace gold {
 // Version number for the .gnu_incremental_inputs section.
 // Version 1 was the initial checkin.
 // Version 2 adds some padding to ensure 8-byte alignment where necessary.
-const unsigned int INCREMENTAL_LINK_VERSION = 2;
+// Version 3 adds a signature to the script entries.
+const unsigned int INCREMENTAL_LINK_VERSION = 3;
 
 // This class manages the .gnu_incremental_inputs section, which holds
 // the header information, a directory of input files, and separate
@@ -143,6 +145,7 @@ vexplain_no_incremental(const char* format, va_list args)
     gold_nomem();
   gold_info(_("the link might take longer: "
 	      "cannot perform incremental link: %s"), buf);
+  Incremental_stats::record_fallback(buf);
   free(buf);
 }
 
@@ -171,6 +174,57 @@ Incremental_binary::error(const char* format, ...) const
   va_end(args);
 }
 
+// Class Incremental_stats.
+
+std::string Incremental_stats::fallback_reason;
+unsigned int Incremental_stats::unchanged_inputs;
+unsigned int Incremental_stats::changed_inputs;
+unsigned int Incremental_stats::changed_scripts;
+
+// Only the first reason is kept; later ones are consequences of it.
+
+void
+Incremental_stats::record_fallback(const char* reason)
+{
+  if (Incremental_stats::fallback_reason.empty())
+    Incremental_stats::fallback_reason = reason;
+}
+
+void
+Incremental_stats::record_input(bool unchanged)
+{
+  if (unchanged)
+    ++Incremental_stats::unchanged_inputs;
+  else
+    ++Incremental_stats::changed_inputs;
+}
+
+void
+Incremental_stats::print(bool failed)
+{
+  const char* mode;
+  if (failed)
+    mode = _("update failed");
+  else if (parameters->incremental_update())
+    mode = _("update");
+  else
+    mode = _("full");
+  fprintf(stderr, _("%s: incremental link: %s\n"), program_name, mode);
+  if (!Incremental_stats::fallback_reason.empty())
+    fprintf(stderr, _("%s: incremental fallback reason: %s\n"),
+	    program_name, Incremental_stats::fallback_reason.c_str());
+  if (!failed && parameters->incremental_update())
+    {
+      fprintf(stderr, _("%s: incremental input files unchanged: %u\n"),
+	      program_name, Incremental_stats::unchanged_inputs);
+      fprintf(stderr, _("%s: incremental input files changed: %u\n"),
+	      program_name, Incremental_stats::changed_inputs);
+      fprintf(stderr, _("%s: incremental input scripts changed "
+			"compatibly: %u\n"),
+	      program_name, Incremental_stats::changed_scripts);
+    }
+}
+
 // Return TRUE if a section of type SH_TYPE can be updated in place
 // during an incremental update.  We can update sections of type PROGBITS,
 // NOBITS, INIT_ARRAY, FINI_ARRAY, PREINIT_ARRAY, NOTE, and
@@ -453,9 +507,30 @@ Sized_incremental_binary<size, big_endian>::do_check_inputs(
 	case INCREMENTAL_INPUT_SCRIPT:
 	  if (this->do_file_has_changed(i))
 	    {
-	      explain_no_incremental(_("%s: script file changed"),
-				     input_file.filename());
-	      return false;
+	      // We can keep going if the script still names the same
+	      // input files, and does nothing else.
+	      uint64_t old_signature = input_file.get_script_signature();
+	      if (old_signature == 0)
+		{
+		  explain_no_incremental(_("%s: script file changed, and it "
+					   "does more than name input files"),
+					 input_file.filename());
+		  return false;
+		}
+	      const Input_argument* arg = this->get_input_argument(i);
+	      Position_dependent_options posdep;
+	      if (arg != NULL)
+		posdep = arg->file().options();
+	      uint64_t new_signature;
+	      if (!input_script_signature(input_file.filename(), posdep,
+					  &new_signature)
+		  || new_signature != old_signature)
+		{
+		  explain_no_incremental(_("%s: script file changed"),
+					 input_file.filename());
+		  return false;
+		}
+	      Incremental_stats::record_changed_script();
 	    }
 	  break;
 	default:
@@ -726,6 +801,161 @@ Sized_incremental_binary<size, big_endian>::do_emit_copy_relocs(
     }
 }
 
+// Return the input section range containing ADDR, or NULL.
+
+template<int size, bool big_endian>
+const typename Sized_incremental_binary<size, big_endian>::Input_range*
+Sized_incremental_binary<size, big_endian>::find_input_range(
+    const Input_ranges& ranges,
+    uint64_t addr)
+{
+  typename Input_ranges::const_iterator p =
+      std::upper_bound(ranges.begin(), ranges.end(),
+		       Input_range(addr, addr, 0, false));
+  if (p == ranges.begin())
+    return NULL;
+  --p;
+  if (addr >= p->end)
+    return NULL;
+  return &*p;
+}
+
+// Emit the dynamic relocations for data in unchanged input files.
+// These are not recorded in the incremental info, and the unchanged
+// files are not scanned again, so we copy them from the existing
+// output file.  The dynamic relocations for replaced files are
+// regenerated when their relocations are scanned, and the ones for
+// the GOT and PLT by process_got_plt.
+
+template<int size, bool big_endian>
+void
+Sized_incremental_binary<size, big_endian>::do_emit_dynamic_relocs(
+    Symbol_table* symtab)
+{
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+  const int reloc_size = elfcpp::Elf_sizes<size>::rela_size;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  // Find the dynamic relocation section.  The .rela.plt section
+  // has sh_info set, and its entries are regenerated with the PLT.
+  const unsigned int shnum = this->elf_file_.shnum();
+  unsigned int reloc_shndx = 0;
+  for (unsigned int i = 1; i < shnum; ++i)
+    {
+      if (this->elf_file_.section_type(i) == elfcpp::SHT_RELA
+	  && (this->elf_file_.section_flags(i) & elfcpp::SHF_ALLOC) != 0
+	  && this->elf_file_.section_info(i) == 0)
+	{
+	  reloc_shndx = i;
+	  break;
+	}
+    }
+  if (reloc_shndx == 0)
+    return;
+  Location reloc_location(this->elf_file_.section_contents(reloc_shndx));
+  if (reloc_location.data_size == 0)
+    return;
+
+  // Record where each input section was placed.
+  Input_ranges ranges;
+  for (unsigned int i = 0; i < this->inputs_reader_.input_file_count(); ++i)
+    {
+      Input_entry_reader input_file = this->inputs_reader_.input_file(i);
+      if (input_file.type() != INCREMENTAL_INPUT_OBJECT
+	  && input_file.type() != INCREMENTAL_INPUT_ARCHIVE_MEMBER)
+	continue;
+      bool unchanged = this->input_objects_[i] != NULL;
+      unsigned int nsections = input_file.get_input_section_count();
+      for (unsigned int j = 0; j < nsections; ++j)
+	{
+	  typename Input_entry_reader::Input_section_info sect =
+	      input_file.get_input_section(j);
+	  if (sect.output_shndx == 0
+	      || sect.sh_offset == -1
+	      || sect.sh_size == 0
+	      || (this->elf_file_.section_flags(sect.output_shndx)
+		  & elfcpp::SHF_ALLOC) == 0)
+	    continue;
+	  uint64_t start = (this->elf_file_.section_addr(sect.output_shndx)
+			    + sect.sh_offset);
+	  ranges.push_back(Input_range(start, start + sect.sh_size,
+				       sect.output_shndx, unchanged));
+	}
+    }
+  std::sort(ranges.begin(), ranges.end());
+
+  unsigned int dynsym_shndx = this->elf_file_.section_link(reloc_shndx);
+  Location dynsym_location(this->elf_file_.section_contents(dynsym_shndx));
+  Location dynstr_location(this->elf_file_.section_contents(
+      this->elf_file_.section_link(dynsym_shndx)));
+  View reloc_view(this->view(reloc_location));
+  View dynsym_view(this->view(dynsym_location));
+  View dynstr_view(this->view(dynstr_location));
+  elfcpp::Elf_strtab dynstr(dynstr_view.data(), dynstr_location.data_size);
+
+  Sized_target<size, big_endian>* target =
+      parameters->sized_target<size, big_endian>();
+
+  const unsigned char* prel = reloc_view.data();
+  const unsigned int reloc_count = reloc_location.data_size / reloc_size;
+  for (unsigned int i = 0; i < reloc_count; ++i, prel += reloc_size)
+    {
+      elfcpp::Rela<size, big_endian> rel(prel);
+      Address r_offset = rel.get_r_offset();
+      unsigned int r_sym = elfcpp::elf_r_sym<size>(rel.get_r_info());
+      unsigned int r_type = elfcpp::elf_r_type<size>(rel.get_r_info());
+      typename elfcpp::Elf_types<size>::Elf_Swxword r_addend =
+	  rel.get_r_addend();
+
+      const Input_range* range = find_input_range(ranges, r_offset);
+      if (range == NULL || !range->unchanged)
+	continue;
+
+      Symbol* gsym = NULL;
+      if (r_sym == 0)
+	{
+	  // The addend of a relocation with no symbol is an address,
+	  // which is stale if it points into a replaced file.
+	  const Input_range* target_range =
+	      find_input_range(ranges, static_cast<Address>(r_addend));
+	  if (target_range != NULL && !target_range->unchanged)
+	    gold_fallback(_("dynamic relocation at 0x%llx refers to a "
+			    "replaced input file; relink with "
+			    "--incremental-full"),
+			  static_cast<unsigned long long>(r_offset));
+	}
+      else
+	{
+	  const char* name;
+	  if (r_sym * sym_size >= dynsym_location.data_size)
+	    gold_fallback(_("invalid dynamic symbol index %u; relink with "
+			    "--incremental-full"), r_sym);
+	  elfcpp::Sym<size, big_endian> sym(dynsym_view.data()
+					    + r_sym * sym_size);
+	  if (!dynstr.get_c_string(sym.get_st_name(), &name))
+	    name = NULL;
+	  if (name != NULL)
+	    gsym = symtab->lookup(name);
+	  if (gsym == NULL)
+	    gold_fallback(_("cannot find symbol %s for dynamic relocation; "
+			    "relink with --incremental-full"),
+			  name != NULL ? name : "<invalid>");
+	  gsym->set_needs_dynsym_entry();
+	}
+
+      Output_section* os = this->output_section(range->output_shndx);
+      off_t offset = (r_offset
+		      - this->elf_file_.section_addr(range->output_shndx));
+      gold_debug(DEBUG_INCREMENTAL,
+		 "Dynamic reloc: %08lx type %d %s + %ld",
+		 static_cast<long>(r_offset), r_type,
+		 gsym != NULL ? gsym->name() : "<none>",
+		 static_cast<long>(r_addend));
+      target->emit_dynamic_reloc_for_update(gsym, r_type, os, offset,
+					    r_addend);
+    }
+}
+
 // Apply incremental relocations for symbols whose values have changed.
 
 template<int size, bool big_endian>
@@ -973,6 +1203,7 @@ Incremental_inputs::report_command_line(int argc, const char* const* argv)
 	  || strcmp(argv[i], "--incremental-unchanged") == 0
 	  || strcmp(argv[i], "--incremental-unknown") == 0
 	  || strcmp(argv[i], "--incremental-startup-unchanged") == 0
+	  || strcmp(argv[i], "--incremental-stats") == 0
 	  || is_prefix_of("--incremental-base=", argv[i])
 	  || is_prefix_of("--incremental-patch=", argv[i])
 	  || is_prefix_of("--debug=", argv[i]))
@@ -1179,13 +1410,15 @@ Incremental_inputs::report_comdat_group(Object* obj, const char* name)
 void
 Incremental_inputs::report_script(Script_info* script,
 				  unsigned int arg_serial,
-				  Timespec mtime)
+				  Timespec mtime,
+				  uint64_t signature)
 {
   Stringpool::Key filename_key;
 
   this->strtab_->add(script->filename().c_str(), false, &filename_key);
   Incremental_script_entry* entry =
-      new Incremental_script_entry(filename_key, arg_serial, script, mtime);
+      new Incremental_script_entry(filename_key, arg_serial, script, mtime,
+				   signature);
   this->inputs_.push_back(entry);
   script->set_incremental_info(entry);
 }
@@ -1295,6 +1528,8 @@ Output_section_incremental_inputs<size, big_endian>::set_final_data_size()
 	    info_offset += 4;
 	    // Each member.
 	    info_offset += (entry->get_object_count() * 4);
+	    // Signature.
+	    info_offset += 8;
 	  }
 	  break;
 	case INCREMENTAL_INPUT_OBJECT:
@@ -1544,6 +1779,11 @@ Output_section_incremental_inputs<size, big_endian>::write_info_blocks(
 		Swap32::writeval(pov, obj->get_offset());
 		pov += 4;
 	      }
+
+	    // Write the signature.
+	    Swap32::writeval(pov, entry->signature() >> 32);
+	    Swap32::writeval(pov + 4, entry->signature() & 0xffffffff);
+	    pov += 8;
 	  }
 	  break;
 
@@ -92,6 +92,43 @@ can_incremental_update(unsigned int sh_type);
 Incremental_binary*
 open_incremental_binary(Output_file* file);
 
+// Statistics for --incremental-stats, which reports how an
+// incremental link was done and, if it fell back to a full link, why.
+
+class Incremental_stats
+{
+ public:
+  // Record the reason that an incremental update was not done.
+  static void
+  record_fallback(const char* reason);
+
+  // Record an input file which was reused from the base file
+  // (UNCHANGED is true) or read again.
+  static void
+  record_input(bool unchanged);
+
+  // Record an input script which changed, but still adds the same
+  // input files.
+  static void
+  record_changed_script()
+  { ++Incremental_stats::changed_scripts; }
+
+  // Print the statistics to stderr.  FAILED is true if the link is
+  // exiting with the fallback status.
+  static void
+  print(bool failed);
+
+ private:
+  // The reason that an incremental update was not done.
+  static std::string fallback_reason;
+  // Number of input files reused from the base file.
+  static unsigned int unchanged_inputs;
+  // Number of input files read again.
+  static unsigned int changed_inputs;
+  // Number of input scripts which changed compatibly.
+  static unsigned int changed_scripts;
+};
+
 // Base class for recording each input file.
 
 class Incremental_input_entry
@@ -305,11 +342,16 @@ class Incremental_script_entry : public Incremental_input_entry
  public:
   Incremental_script_entry(Stringpool::Key filename_key,
 			   unsigned int arg_serial, Script_info* /*script*/,
-			   Timespec mtime)
+			   Timespec mtime, uint64_t signature)
     : Incremental_input_entry(filename_key, arg_serial, mtime),
-      objects_()
+      objects_(), signature_(signature)
   { }
 
+  // Return the signature of the input files named by the script.
+  uint64_t
+  signature() const
+  { return this->signature_; }
+
   // Add a member object to the archive.
   void
   add_object(Incremental_input_entry* obj_entry)
@@ -343,6 +385,9 @@ class Incremental_script_entry : public Incremental_input_entry
  private:
   // Objects that have been included by this script.
   std::vector<Incremental_input_entry*> objects_;
+  // Signature of the input files named by the script, or 0 if the
+  // script does anything else; see input_script_signature.
+  uint64_t signature_;
 };
 
 // Class for recording input object files.
@@ -596,10 +641,11 @@ class Incremental_inputs
   void
   report_comdat_group(Object* obj, const char* name);
 
-  // Record the info for input script SCRIPT.
+  // Record the info for input script SCRIPT.  SIGNATURE is the
+  // signature of the input files named by the script.
   void
   report_script(Script_info* script, unsigned int arg_serial,
-		Timespec mtime);
+		Timespec mtime, uint64_t signature);
 
   // Return the running count of incremental relocations.
   unsigned int
@@ -972,6 +1018,18 @@ class Incremental_inputs_reader
 			     + 4 + n * 4);
     }
 
+    // Return the signature of the input files named by the script --
+    // for scripts only.
+    uint64_t
+    get_script_signature() const
+    {
+      gold_assert(this->type() == INCREMENTAL_INPUT_SCRIPT);
+      const unsigned char* p = (this->inputs_->p_ + this->info_offset_ + 4
+				+ this->get_object_count() * 4);
+      return ((static_cast<uint64_t>(Swap32::readval(p)) << 32)
+	      | Swap32::readval(p + 4));
+    }
+
     // Return the member count -- for archives only.
     unsigned int
     get_member_count() const
@@ -1396,6 +1454,10 @@ class Incremental_binary
     get_unused_symbol(unsigned int n) const
     { return this->do_get_unused_symbol(n); }
 
+    uint64_t
+    get_script_signature() const
+    { return this->do_get_script_signature(); }
+
    protected:
     virtual const char*
     do_filename() const = 0;
@@ -1414,6 +1476,9 @@ class Incremental_binary
 
     virtual const char*
     do_get_unused_symbol(unsigned int n) const = 0;
+
+    virtual uint64_t
+    do_get_script_signature() const = 0;
   };
 
   // Return the number of input files.
@@ -1474,6 +1539,12 @@ class Incremental_binary
   emit_copy_relocs(Symbol_table* symtab)
   { this->do_emit_copy_relocs(symtab); }
 
+  // Emit the dynamic relocations for unchanged input files from the
+  // existing output file.
+  void
+  emit_dynamic_relocs(Symbol_table* symtab)
+  { this->do_emit_dynamic_relocs(symtab); }
+
   // Apply incremental relocations for symbols whose values have changed.
   void
   apply_incremental_relocs(const Symbol_table* symtab, Layout* layout,
@@ -1560,6 +1631,10 @@ class Incremental_binary
   virtual void
   do_emit_copy_relocs(Symbol_table* symtab) = 0;
 
+  // Emit the dynamic relocations for unchanged input files.
+  virtual void
+  do_emit_dynamic_relocs(Symbol_table* symtab) = 0;
+
   // Apply incremental relocations for symbols whose values have changed.
   virtual void
   do_apply_incremental_relocs(const Symbol_table*, Layout*, Output_file*) = 0;
@@ -1694,6 +1769,11 @@ class Sized_incremental_binary : public Incremental_binary
   virtual void
   do_emit_copy_relocs(Symbol_table* symtab);
 
+  // Emit the dynamic relocations for unchanged input files from the
+  // existing output file.
+  virtual void
+  do_emit_dynamic_relocs(Symbol_table* symtab);
+
   // Apply incremental relocations for symbols whose values have changed.
   virtual void
   do_apply_incremental_relocs(const Symbol_table* symtab, Layout* layout,
@@ -1737,6 +1817,10 @@ class Sized_incremental_binary : public Incremental_binary
     do_get_unused_symbol(unsigned int n) const
     { return this->reader_.get_unused_symbol(n); }
 
+    uint64_t
+    do_get_script_signature() const
+    { return this->reader_.get_script_signature(); }
+
     Input_entry_reader reader_;
   };
 
@@ -1768,6 +1852,34 @@ class Sized_incremental_binary : public Incremental_binary
   };
   typedef std::vector<Copy_reloc> Copy_relocs;
 
+  // The address range of an input section in the existing output
+  // file, used to find the input file that a dynamic relocation
+  // applies to.
+  struct Input_range
+  {
+    Input_range(uint64_t s, uint64_t e, unsigned int shndx, bool u)
+      : start(s), end(e), output_shndx(shndx), unchanged(u)
+    { }
+
+    bool
+    operator<(const Input_range& r) const
+    { return this->start < r.start; }
+
+    // The first address of the section.
+    uint64_t start;
+    // The address following the section.
+    uint64_t end;
+    // The index of the output section in the existing output file.
+    unsigned int output_shndx;
+    // Whether the input file is unchanged in this link.
+    bool unchanged;
+  };
+  typedef std::vector<Input_range> Input_ranges;
+
+  // Return the range containing ADDR, or NULL.
+  static const Input_range*
+  find_input_range(const Input_ranges& ranges, uint64_t addr);
+
   bool
   find_incremental_inputs_sections(unsigned int* p_inputs_shndx,
 				   unsigned int* p_symtab_shndx,
@@ -56,6 +56,7 @@
 #include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "call-graph.h"
 #include "layout.h"
 
 namespace gold
@@ -239,7 +240,102 @@ Free_list::print_stats()
 	  program_name, Free_list::num_allocate_visits);
 }
 
-// A Hash_task computes the MD5 checksum of an array of char.
+// Helpers for xxhash64_buffer.
+
+static const uint64_t xxh_prime1 = 0x9e3779b185ebca87ULL;
+static const uint64_t xxh_prime2 = 0xc2b2ae3d27d4eb4fULL;
+static const uint64_t xxh_prime3 = 0x165667b19e3779f9ULL;
+static const uint64_t xxh_prime4 = 0x85ebca77c2b2ae63ULL;
+static const uint64_t xxh_prime5 = 0x27d4eb2f165667c5ULL;
+
+static inline uint64_t
+xxh_rotl64(uint64_t x, int r)
+{ return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t
+xxh_round(uint64_t acc, uint64_t input)
+{
+  acc += input * xxh_prime2;
+  return xxh_rotl64(acc, 31) * xxh_prime1;
+}
+
+static inline uint64_t
+xxh_read64(const unsigned char* p)
+{ return elfcpp::Swap_unaligned<64, false>::readval(p); }
+
+// Compute the 64-bit xxHash (XXH64) of SIZE bytes at P, and store it
+// little-endian in DST.  This is used for --build-id=fast.  It is much
+// faster than MD5 or SHA-1, and a build ID does not need a
+// cryptographic hash.
+
+void
+xxhash64_buffer(const unsigned char* p, size_t size, unsigned char* dst)
+{
+  const unsigned char* const pend = p + size;
+  uint64_t h;
+
+  if (size >= 32)
+    {
+      uint64_t v1 = xxh_prime1 + xxh_prime2;
+      uint64_t v2 = xxh_prime2;
+      uint64_t v3 = 0;
+      uint64_t v4 = -xxh_prime1;
+      const unsigned char* const plimit = pend - 32;
+      do
+	{
+	  v1 = xxh_round(v1, xxh_read64(p));
+	  v2 = xxh_round(v2, xxh_read64(p + 8));
+	  v3 = xxh_round(v3, xxh_read64(p + 16));
+	  v4 = xxh_round(v4, xxh_read64(p + 24));
+	  p += 32;
+	}
+      while (p <= plimit);
+
+      h = (xxh_rotl64(v1, 1) + xxh_rotl64(v2, 7) + xxh_rotl64(v3, 12)
+	   + xxh_rotl64(v4, 18));
+      const uint64_t v[4] = { v1, v2, v3, v4 };
+      for (int i = 0; i < 4; ++i)
+	{
+	  h ^= xxh_round(0, v[i]);
+	  h = h * xxh_prime1 + xxh_prime4;
+	}
+    }
+  else
+    h = xxh_prime5;
+
+  h += static_cast<uint64_t>(size);
+
+  while (p + 8 <= pend)
+    {
+      h ^= xxh_round(0, xxh_read64(p));
+      h = xxh_rotl64(h, 27) * xxh_prime1 + xxh_prime4;
+      p += 8;
+    }
+  if (p + 4 <= pend)
+    {
+      uint64_t k = elfcpp::Swap_unaligned<32, false>::readval(p);
+      h ^= k * xxh_prime1;
+      h = xxh_rotl64(h, 23) * xxh_prime2 + xxh_prime3;
+      p += 4;
+    }
+  while (p < pend)
+    {
+      h ^= *p * xxh_prime5;
+      h = xxh_rotl64(h, 11) * xxh_prime1;
+      ++p;
+    }
+
+  h ^= h >> 33;
+  h *= xxh_prime2;
+  h ^= h >> 29;
+  h *= xxh_prime3;
+  h ^= h >> 32;
+
+  elfcpp::Swap_unaligned<64, false>::writeval(dst, h);
+}
+
+// A Hash_task computes the MD5 checksum of an array of char, or its
+// xxHash for --build-id=fast.
 
 class Hash_task : public Task
 {
@@ -248,8 +344,9 @@ class Hash_task : public Task
 	    size_t offset,
 	    size_t size,
 	    unsigned char* dst,
+	    bool fast,
 	    Task_token* final_blocker)
-    : of_(of), offset_(offset), size_(size), dst_(dst),
+    : of_(of), offset_(offset), size_(size), dst_(dst), fast_(fast),
       final_blocker_(final_blocker)
   { }
 
@@ -258,7 +355,10 @@ class Hash_task : public Task
   {
     const unsigned char* iv =
 	this->of_->get_input_view(this->offset_, this->size_);
-    md5_buffer(reinterpret_cast<const char*>(iv), this->size_, this->dst_);
+    if (this->fast_)
+      xxhash64_buffer(iv, this->size_, this->dst_);
+    else
+      md5_buffer(reinterpret_cast<const char*>(iv), this->size_, this->dst_);
     this->of_->free_input_view(this->offset_, this->size_, iv);
   }
 
@@ -280,6 +380,7 @@ class Hash_task : public Task
   const size_t offset_;
   const size_t size_;
   unsigned char* const dst_;
+  const bool fast_;
   Task_token* const final_blocker_;
 };
 
@@ -375,6 +476,7 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
   off_t file_size = layout->finalize(this->input_objects_,
 				     this->symtab_,
 				     this->target_,
+				     workqueue,
 				     task);
 
   // Now we know the final size of the output file and we know where
@@ -383,7 +485,10 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
   if (this->mapfile_ != NULL)
     {
       this->mapfile_->print_discarded_sections(this->input_objects_);
-      layout->print_to_mapfile(this->mapfile_);
+      // The memory map of a structured map file is written by
+      // Write_map_task, in parallel with the output file.
+      if (!this->mapfile_->is_structured())
+	layout->print_to_mapfile(this->mapfile_);
     }
 
   Output_file* of;
@@ -413,7 +518,8 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 
   // Queue up the final set of tasks.
   gold::queue_final_tasks(this->options_, this->input_objects_,
-			  this->symtab_, layout, workqueue, of);
+			  this->symtab_, layout, workqueue, of,
+			  this->mapfile_);
 }
 
 // Layout methods.
@@ -451,6 +557,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     build_id_note_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
+    compressed_sections_(),
     group_signatures_(),
     output_file_size_(-1),
     have_added_input_section_(false),
@@ -473,6 +580,11 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     section_segment_map_(),
     input_section_position_(),
     input_section_glob_(),
+    call_graph_(NULL),
+    hot_symbols_(),
+    hot_symbols_found_(0),
+    hot_sections_(),
+    hot_segment_(NULL),
     incremental_base_(NULL),
     free_list_()
 {
@@ -1183,7 +1295,32 @@ Layout::layout(Sized_relobj_file<size, big_endian>* object, unsigned int shndx,
           = (parameters->options().text_unlikely_segment()
              && is_prefix_of(".text.unlikely",
                              object->section_name(shndx).c_str()));
-      if (text_unlikely_segment)
+      // With --hot-segment, the sections which define hot functions
+      // and read-only data go to the hot segment.
+      bool hot_segment
+	= (!this->hot_sections_.empty()
+	   && sh_type == elfcpp::SHT_PROGBITS
+	   && ((shdr.get_sh_flags()
+		& (elfcpp::SHF_ALLOC | elfcpp::SHF_WRITE | elfcpp::SHF_TLS))
+	       == elfcpp::SHF_ALLOC)
+	   && !this->script_options_->saw_sections_clause()
+	   && (this->hot_sections_.find(Const_section_id(object, shndx))
+	       != this->hot_sections_.end()));
+      if (hot_segment)
+	{
+	  elfcpp::Elf_Xword flags
+	    = this->get_output_section_flags(shdr.get_sh_flags());
+
+	  Stringpool::Key name_key;
+	  const char* os_name = ((flags & elfcpp::SHF_EXECINSTR) != 0
+				 ? ".text.hot"
+				 : ".rodata.hot");
+	  os_name = this->namepool_.add(os_name, true, &name_key);
+	  os = this->get_output_section(os_name, name_key, sh_type, flags,
+					ORDER_INVALID, false);
+	  os->set_is_hot();
+	}
+      else if (text_unlikely_segment)
         {
 	  elfcpp::Elf_Xword flags
 	    = this->get_output_section_flags(shdr.get_sh_flags());
@@ -1620,8 +1757,8 @@ Layout::remove_eh_frame_for_plt(Output_data* plt, const unsigned char* cie_data,
 					       fde_data, fde_length);
 }
 
-// Scan a .debug_info or .debug_types section, and add summary
-// information to the .gdb_index section.
+// Record a .debug_info or .debug_types section to be scanned for
+// summary information for the .gdb_index section.
 
 template<int size, bool big_endian>
 void
@@ -1696,8 +1833,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* ocs =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_sections_.push_back(ocs);
+      os = ocs;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -1841,6 +1983,23 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
 	os->set_free_space_fill(new Output_fill_debug_line());
     }
 
+  // The dynamic symbol table and the other dynamic sections are
+  // regenerated by each incremental update.  Leave room after them so
+  // that they can grow, for example when an incremental update of a
+  // shared library adds exported symbols.
+  if ((flags & elfcpp::SHF_ALLOC) != 0
+      && (type == elfcpp::SHT_DYNSYM
+	  || type == elfcpp::SHT_STRTAB
+	  || type == elfcpp::SHT_HASH
+	  || type == elfcpp::SHT_GNU_HASH
+	  || type == elfcpp::SHT_GNU_versym
+	  || type == elfcpp::SHT_GNU_verdef
+	  || type == elfcpp::SHT_GNU_verneed
+	  || type == elfcpp::SHT_REL
+	  || type == elfcpp::SHT_RELA
+	  || type == elfcpp::SHT_DYNAMIC))
+    os->set_has_trailing_patch_space();
+
   // If we have already attached the sections to segments, then we
   // need to attach this one now.  This happens for sections created
   // directly by the linker.
@@ -1994,8 +2153,15 @@ Layout::attach_allocated_section_to_segment(const Target* target,
   // People who need segments sorted on some other basis will
   // have to use a linker script.
 
+  // All the hot output sections go into the same segment.
+  if (os->is_hot() && this->hot_segment_ != NULL)
+    {
+      this->hot_segment_->add_output_section_to_load(this, os, seg_flags);
+      return;
+    }
+
   Segment_list::const_iterator p;
-  if (!os->is_unique_segment())
+  if (!os->is_unique_segment() && !os->is_hot())
     {
       for (p = this->segment_list_.begin();
 	   p != this->segment_list_.end();
@@ -2038,13 +2204,21 @@ Layout::attach_allocated_section_to_segment(const Target* target,
 	}
     }
 
-  if (p == this->segment_list_.end()
+  if (os->is_hot()
+      || p == this->segment_list_.end()
       || os->is_unique_segment())
     {
       Output_segment* oseg = this->make_output_segment(elfcpp::PT_LOAD,
 						       seg_flags);
       if (os->is_large_data_section())
 	oseg->set_is_large_data_segment();
+      // The hot segment is kept apart from the other segments, as
+      // though it were unique.
+      if (os->is_hot())
+	{
+	  oseg->set_is_unique_segment();
+	  this->hot_segment_ = oseg;
+	}
       oseg->add_output_section_to_load(this, os, seg_flags);
       if (is_address_set)
 	oseg->set_addresses(addr, addr);
@@ -2712,6 +2886,123 @@ Layout::read_layout_from_file()
     }
 }
 
+// Read the call graph profile from the file specified with option
+// --call-graph-ordering-file.  The sections are only ordered once the
+// symbols have been resolved, but we need to keep track of the input
+// sections as they are added.
+
+void
+Layout::read_call_graph_from_file()
+{
+  this->call_graph_ = new Call_graph();
+  this->call_graph_->read(parameters->options().call_graph_ordering_file());
+  this->set_section_ordering_specified();
+}
+
+// Use the call graph profile to compute an order for the input
+// sections which hold the functions it names, and re-arrange the
+// input sections of each output section to match.
+
+void
+Layout::order_sections_by_call_graph(const Task* task,
+				     const Symbol_table* symtab)
+{
+  gold_assert(this->call_graph_ != NULL);
+  this->section_order_map_.clear();
+  this->call_graph_->compute_order(task, symtab, &this->section_order_map_);
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->update_section_layout(&this->section_order_map_);
+}
+
+// Read the names of the hot symbols for --hot-segment.  Each line of
+// the --hot-symbols-file file starts with the name of a symbol; the
+// rest of the line, such as a sample count from a profile, is
+// ignored, as are blank lines and lines starting with '#'.  The
+// functions in the call graph profile are hot as well.  The hot
+// sections can only be found once the symbols have been resolved, so
+// this forces the input sections to be laid out twice.
+
+void
+Layout::read_hot_symbols()
+{
+  const char* filename = parameters->options().hot_symbols_file();
+  if (filename != NULL)
+    {
+      std::ifstream in;
+      std::string line;
+
+      in.open(filename);
+      if (!in)
+	gold_fatal(_("unable to open --hot-symbols-file file %s: %s"),
+		   filename, strerror(errno));
+
+      while (std::getline(in, line))
+	{
+	  size_t start = line.find_first_not_of(" \t\r");
+	  if (start == std::string::npos || line[start] == '#')
+	    continue;
+	  size_t end = line.find_first_of(" \t\r", start);
+	  if (end == std::string::npos)
+	    end = line.length();
+	  this->hot_symbols_.push_back(line.substr(start, end - start));
+	}
+    }
+
+  if (this->call_graph_ != NULL)
+    this->call_graph_->add_function_names(&this->hot_symbols_);
+
+  std::sort(this->hot_symbols_.begin(), this->hot_symbols_.end());
+  this->hot_symbols_.erase(std::unique(this->hot_symbols_.begin(),
+				       this->hot_symbols_.end()),
+			   this->hot_symbols_.end());
+
+  this->set_unique_segment_for_sections_specified();
+}
+
+// Find the input sections which define the hot symbols.  Symbols
+// which are undefined, or defined in a shared library or outside of
+// an ordinary section, are ignored.
+
+void
+Layout::find_hot_sections(const Symbol_table* symtab)
+{
+  // A SECTIONS clause decides the segments itself.
+  if (this->script_options_->saw_sections_clause())
+    {
+      gold_warning(_("ignoring --hot-segment because of the SECTIONS "
+		     "clause in the linker script"));
+      return;
+    }
+
+  for (std::vector<std::string>::const_iterator p =
+	 this->hot_symbols_.begin();
+       p != this->hot_symbols_.end();
+       ++p)
+    {
+      Symbol* sym = symtab->lookup(p->c_str());
+      if (sym == NULL)
+	continue;
+      if (sym->is_forwarder())
+	sym = symtab->resolve_forwards(sym);
+      if (sym->source() != Symbol::FROM_OBJECT
+	  || !sym->is_defined()
+	  || sym->object()->is_dynamic()
+	  || sym->object()->pluginobj() != NULL)
+	continue;
+
+      bool is_ordinary;
+      unsigned int shndx = sym->shndx(&is_ordinary);
+      if (!is_ordinary)
+	continue;
+
+      const Relobj* relobj = static_cast<const Relobj*>(sym->object());
+      this->hot_sections_.insert(Const_section_id(relobj, shndx));
+      ++this->hot_symbols_found_;
+    }
+}
+
 // Finalize the layout.  When this is called, we have created all the
 // output sections and all the output segments which are based on
 // input sections.  We have several things to do, and we have to do
@@ -2746,7 +3037,7 @@ Layout::read_layout_from_file()
 
 off_t
 Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
-		 Target* target, const Task* task)
+		 Target* target, Workqueue* workqueue, const Task* task)
 {
   unsigned int local_dynamic_count = 0;
   unsigned int forced_local_dynamic_count = 0;
@@ -2773,7 +3064,7 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
       std::vector<Symbol*> dynamic_symbols;
       Versions versions(*this->script_options()->version_script_info(),
 			&this->dynpool_);
-      this->create_dynamic_symtab(input_objects, symtab, &dynstr,
+      this->create_dynamic_symtab(input_objects, symtab, workqueue, &dynstr,
 				  &local_dynamic_count,
 				  &forced_local_dynamic_count,
 				  &dynamic_symbols,
@@ -2844,7 +3135,8 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
       pass++;
     }
   while (target->may_relax()
-	 && target->relax(pass, input_objects, symtab, this, task));
+	 && target->relax(pass, input_objects, symtab, this, workqueue,
+			  task));
 
   // If there is a load segment that contains the file and program headers,
   // provide a symbol __ehdr_start pointing there.
@@ -3137,6 +3429,8 @@ Layout::create_build_id()
     descsz = 128 / 8;
   else if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
     descsz = 160 / 8;
+  else if (strcmp(style, "fast") == 0)
+    descsz = 64 / 8;
   else if (strcmp(style, "uuid") == 0)
     {
 #ifndef __MINGW32__
@@ -3478,6 +3772,12 @@ Layout::segment_precedes(const Output_segment* seg1,
   if ((flags1 & elfcpp::PF_R) != (flags2 & elfcpp::PF_R))
     return (flags1 & elfcpp::PF_R) == 0;
 
+  // The hot segment comes after the other segments with the same
+  // flags, so that it can be aligned without moving them.
+  if (seg1 != seg2
+      && (seg1 == this->hot_segment_ || seg2 == this->hot_segment_))
+    return seg2 == this->hot_segment_;
+
   // We shouldn't get here--we shouldn't create segments which we
   // can't distinguish.  Unless of course we are using a weird linker
   // script or overlapping --section-start options.  We could also get
@@ -3656,6 +3956,12 @@ Layout::set_segment_offsets(const Target* target, Output_segment* load_seg,
 	      uint64_t max_align = (*p)->maximum_alignment();
 	      if (max_align > abi_pagesize)
 		addr = align_address(addr, max_align);
+	      // Align the start of the hot segment so that it can be
+	      // mapped with huge pages.  We only align the address, not
+	      // the file offset, so this wastes little file space.
+	      if (*p == this->hot_segment_)
+		addr = align_address(addr,
+				     parameters->options().hot_segment_align());
 	      aligned_addr = addr;
 
 	      if (load_seg == *p)
@@ -3820,6 +4126,25 @@ Layout::set_segment_offsets(const Target* target, Output_segment* load_seg,
       gold_assert(shndx_begin == shndx_load_seg);
     }
 
+  // A position independent output is loaded at an address which is a
+  // multiple of the largest p_align.  Raise the p_align of the first
+  // PT_LOAD segment, if its address and offset allow it, so that the
+  // hot segment stays aligned after relocation by the loader.
+  if (this->hot_segment_ != NULL)
+    {
+      uint64_t hot_align = parameters->options().hot_segment_align();
+      for (Segment_list::iterator p = this->segment_list_.begin();
+	   p != this->segment_list_.end();
+	   ++p)
+	{
+	  if ((*p)->type() != elfcpp::PT_LOAD)
+	    continue;
+	  if ((((*p)->vaddr() - (*p)->offset()) & (hot_align - 1)) == 0)
+	    (*p)->set_minimum_p_align(hot_align);
+	  break;
+	}
+    }
+
   // Handle the non-PT_LOAD segments, setting their offsets from their
   // section's offsets.
   for (Segment_list::iterator p = this->segment_list_.begin();
@@ -4310,6 +4635,7 @@ Layout::allocated_output_section_count() const
 void
 Layout::create_dynamic_symtab(const Input_objects* input_objects,
 			      Symbol_table* symtab,
+			      Workqueue* workqueue,
 			      Output_section** pdynstr,
 			      unsigned int* plocal_dynamic_count,
 			      unsigned int* pforced_local_dynamic_count,
@@ -4475,7 +4801,7 @@ Layout::create_dynamic_symtab(const Input_objects* input_objects,
       unsigned int hashlen;
       Dynobj::create_gnu_hash_table(*pdynamic_symbols,
 				    local_symcount + forced_local_count,
-				    &phash, &hashlen);
+				    workqueue, &phash, &hashlen);
 
       Output_section* hashsec =
 	this->choose_output_section(NULL, ".gnu.hash", elfcpp::SHT_GNU_HASH,
@@ -4513,7 +4839,7 @@ Layout::create_dynamic_symtab(const Input_objects* input_objects,
       unsigned int hashlen;
       Dynobj::create_elf_hash_table(*pdynamic_symbols,
 				    local_symcount + forced_local_count,
-				    &phash, &hashlen);
+				    workqueue, &phash, &hashlen);
 
       Output_section* hashsec =
 	this->choose_output_section(NULL, ".hash", elfcpp::SHT_HASH,
@@ -5564,9 +5890,9 @@ Layout::write_sections_after_input_sections(Output_file* of)
   this->section_headers_->write(of);
 }
 
-// If a tree-style build ID was requested, the parallel part of that computation
-// is already done, and the final hash-of-hashes is computed here.  For other
-// types of build IDs, all the work is done here.
+// If a tree-style or fast build ID was requested, the parallel part of
+// that computation is already done, and the final hash-of-hashes is
+// computed here.  For other types of build IDs, all the work is done here.
 
 void
 Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
@@ -5590,6 +5916,8 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
 	sha1_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
       else if (strcmp(style, "md5") == 0)
 	md5_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+      else if (strcmp(style, "fast") == 0)
+	xxhash64_buffer(iv, output_file_size, ov);
       else
 	gold_unreachable();
 
@@ -5598,9 +5926,13 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
   else
     {
       // Non-overlapping substrings of the output file have been hashed.
-      // Compute SHA-1 hash of the hashes.
-      sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
-		  size_of_hashes, ov);
+      // Compute SHA-1 hash of the hashes, or the xxHash for
+      // --build-id=fast.
+      if (strcmp(parameters->options().build_id(), "fast") == 0)
+	xxhash64_buffer(array_of_hashes, size_of_hashes, ov);
+      else
+	sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
+		    size_of_hashes, ov);
       delete[] array_of_hashes;
     }
 
@@ -5671,6 +6003,32 @@ Layout::print_to_mapfile(Mapfile* mapfile) const
        p != this->unattached_section_list_.end();
        ++p)
     (*p)->print_to_mapfile(mapfile);
+
+  if (this->hot_segment_ != NULL)
+    {
+      // Find the gaps between the previous PT_LOAD segment and the
+      // hot segment, which is the price paid for aligning it.
+      const Output_segment* prev = NULL;
+      for (Segment_list::const_iterator p = this->segment_list_.begin();
+	   *p != this->hot_segment_;
+	   ++p)
+	if ((*p)->type() == elfcpp::PT_LOAD)
+	  prev = *p;
+      uint64_t addr_padding = 0;
+      uint64_t file_padding = 0;
+      if (prev != NULL)
+	{
+	  addr_padding = (this->hot_segment_->vaddr()
+			  - (prev->vaddr() + prev->memsz()));
+	  file_padding = (this->hot_segment_->offset()
+			  - (prev->offset() + prev->filesz()));
+	}
+      mapfile->print_hot_segment(this->hot_segment_,
+				 parameters->options().hot_segment_align(),
+				 addr_padding, file_padding,
+				 this->hot_symbols_.size(),
+				 this->hot_symbols_found_);
+    }
 }
 
 // Print statistical information to stderr.  This is used for --stats.
@@ -5686,6 +6044,91 @@ Layout::print_stats() const
        p != this->section_list_.end();
        ++p)
     (*p)->print_merge_stats();
+
+  if (this->call_graph_ != NULL)
+    this->call_graph_->print_stats();
+}
+
+// Queue tasks to finish adding the strings of merged string sections.
+
+void
+Layout::queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->queue_merge_tasks(workqueue, blocker);
+}
+
+// Queue tasks to scan the debug info for the .gdb_index section.
+
+void
+Layout::queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->gdb_index_data_ != NULL)
+    this->gdb_index_data_->queue_scan_tasks(workqueue, blocker);
+}
+
+// Return the number of blocks of the compressed debug sections.
+
+unsigned int
+Layout::compress_block_count() const
+{
+  unsigned int count = 0;
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    {
+      if ((*p)->has_postprocessing_buffer())
+	count += (*p)->compute_block_count();
+    }
+  return count;
+}
+
+// Queue tasks to compress the compressed debug sections.
+
+void
+Layout::queue_compress_tasks(Workqueue* workqueue, Task_token* this_blocker,
+			     Task_token* next_blocker)
+{
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    {
+      // A section which is not in the output has no buffer.
+      if ((*p)->has_postprocessing_buffer())
+	(*p)->queue_compress_tasks(workqueue, this_blocker, next_blocker);
+    }
+}
+
+// Return the number of tasks which sort the .eh_frame_hdr lookup
+// table.
+
+unsigned int
+Layout::eh_frame_hdr_sort_task_count() const
+{
+  if (this->eh_frame_data_ == NULL)
+    return 0;
+  const Eh_frame_hdr* hdr = this->eh_frame_data_->eh_frame_hdr();
+  if (hdr == NULL)
+    return 0;
+  unsigned int parts = hdr->sort_part_count();
+  return parts > 1 ? parts : 0;
+}
+
+// Queue tasks to sort the .eh_frame_hdr lookup table.
+
+void
+Layout::queue_eh_frame_hdr_sort_tasks(Workqueue* workqueue, Output_file* of,
+				      Task_token* this_blocker,
+				      Task_token* next_blocker)
+{
+  gold_assert(this->eh_frame_data_ != NULL);
+  Eh_frame_hdr* hdr = this->eh_frame_data_->eh_frame_hdr();
+  gold_assert(hdr != NULL);
+  hdr->queue_sort_tasks(workqueue, of, this_blocker, next_blocker);
 }
 
 // Write_sections_task methods.
@@ -5800,9 +6243,41 @@ Write_after_input_sections_task::run(Workqueue*)
   this->layout_->write_sections_after_input_sections(this->of_);
 }
 
+// Write_map_task methods.
+
+// We can always run.
+
+Task_token*
+Write_map_task::is_runnable()
+{
+  return NULL;
+}
+
+// We need to unlock FINAL_BLOCKER when finished.
+
+void
+Write_map_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->final_blocker_);
+}
+
+// Run the task.  Everything the memory map reads is fixed once the
+// layout is finalized, and the input sections are described by what
+// was saved when the objects were laid out, so this does not need to
+// lock the objects which are being relocated.
+
+void
+Write_map_task::run(Workqueue*)
+{
+  this->layout_->print_to_mapfile(this->mapfile_);
+  this->mapfile_->finish();
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
+// A "fast" build ID is always a tree, hashing the chunks and then the
+// hashes with xxHash; it does not depend on the file size.
 // We compute a checksum over the entire file because that is simplest.
 
 void
@@ -5816,27 +6291,35 @@ Build_id_task_runner::run(Workqueue* workqueue, const Task*)
   unsigned char* array_of_hashes = NULL;
   size_t size_of_hashes = 0;
 
-  if (strcmp(this->options_->build_id(), "tree") == 0
+  const bool fast = strcmp(this->options_->build_id(), "fast") == 0;
+  if ((fast || strcmp(this->options_->build_id(), "tree") == 0)
       && this->options_->build_id_chunk_size_for_treehash() > 0
       && filesize > 0
-      && (filesize >= this->options_->build_id_min_file_size_for_treehash()))
+      && (fast
+	  || (filesize
+	      >= this->options_->build_id_min_file_size_for_treehash())))
     {
       static const size_t MD5_OUTPUT_SIZE_IN_BYTES = 16;
+      static const size_t XXHASH64_OUTPUT_SIZE_IN_BYTES = 8;
+      const size_t hash_size = (fast
+				? XXHASH64_OUTPUT_SIZE_IN_BYTES
+				: MD5_OUTPUT_SIZE_IN_BYTES);
       const size_t chunk_size =
 	  this->options_->build_id_chunk_size_for_treehash();
       const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
       post_hash_tasks_blocker->add_blockers(num_hashes);
-      size_of_hashes = num_hashes * MD5_OUTPUT_SIZE_IN_BYTES;
+      size_of_hashes = num_hashes * hash_size;
       array_of_hashes = new unsigned char[size_of_hashes];
       unsigned char *dst = array_of_hashes;
       for (size_t i = 0, src_offset = 0; i < num_hashes;
-	   i++, dst += MD5_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
+	   i++, dst += hash_size, src_offset += chunk_size)
 	{
 	  size_t size = std::min(chunk_size, filesize - src_offset);
 	  workqueue->queue(new Hash_task(of,
 					 src_offset,
 					 size,
 					 dst,
+					 fast,
 					 post_hash_tasks_blocker));
 	}
     }
@@ -40,6 +40,7 @@ namespace gold
 {
 
 class General_options;
+class Call_graph;
 class Incremental_inputs;
 class Incremental_binary;
 class Input_objects;
@@ -57,6 +58,7 @@ class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
 class Eh_frame;
 class Gdb_index;
 class Target;
@@ -70,6 +72,11 @@ is_compressed_debug_section(const char* secname);
 extern std::string
 corresponding_uncompressed_section_name(std::string secname);
 
+// Compute the 64-bit xxHash of SIZE bytes at P, and store it
+// little-endian in the 8 bytes at DST.
+extern void
+xxhash64_buffer(const unsigned char* p, size_t size, unsigned char* dst);
+
 // Maintain a list of free space within a section, segment, or file.
 // Used for incremental update links.
 
@@ -607,6 +614,28 @@ class Layout
   void
   read_layout_from_file();
 
+  // Read the call graph profile from the file specified with linker
+  // option --call-graph-ordering-file.
+  void
+  read_call_graph_from_file();
+
+  // Order the input sections using the call graph profile.  This is
+  // called after all input sections have been laid out.
+  void
+  order_sections_by_call_graph(const Task*, const Symbol_table*);
+
+  // Read the names of the hot symbols for --hot-segment, from the
+  // file specified with --hot-symbols-file and from the call graph
+  // profile.
+  void
+  read_hot_symbols();
+
+  // Find the input sections which define the hot symbols.  This is
+  // called after all symbols have been read, before the input
+  // sections are laid out for the second time.
+  void
+  find_hot_sections(const Symbol_table*);
+
   // Layout an input reloc section when doing a relocatable link.  The
   // section is RELOC_SHNDX in OBJECT, with data in SHDR.
   // DATA_SECTION is the reloc section to which it refers.  RR is the
@@ -814,7 +843,8 @@ class Layout
 
   // Finalize the layout after all the input sections have been added.
   off_t
-  finalize(const Input_objects*, Symbol_table*, Target*, const Task*);
+  finalize(const Input_objects*, Symbol_table*, Target*, Workqueue*,
+	   const Task*);
 
   // Return whether any sections require postprocessing.
   bool
@@ -942,6 +972,49 @@ class Layout
   void
   print_stats() const;
 
+  // Queue tasks to finish adding the strings of merged string
+  // sections, for --parallel-merge-strings.  The tasks hold BLOCKER
+  // until they are done.
+  void
+  queue_merge_tasks(Workqueue*, Task_token* blocker);
+
+  // Queue tasks to scan the debug info for the .gdb_index section.
+  // The tasks hold BLOCKER until they are done.
+  void
+  queue_gdb_index_tasks(Workqueue*, Task_token* blocker);
+
+  // Return whether there are any compressed debug sections.
+  bool
+  any_compressed_sections() const
+  { return !this->compressed_sections_.empty(); }
+
+  // Return the number of blocks of the compressed debug sections,
+  // each of which is compressed by its own task.
+  unsigned int
+  compress_block_count() const;
+
+  // Queue tasks to compress the compressed debug sections once
+  // THIS_BLOCKER is unblocked.  NEXT_BLOCKER is unblocked when they
+  // are done.  The caller must already have added
+  // compress_block_count() blockers to NEXT_BLOCKER.
+  void
+  queue_compress_tasks(Workqueue*, Task_token* this_blocker,
+		       Task_token* next_blocker);
+
+  // Return the number of tasks which sort the .eh_frame_hdr lookup
+  // table, or 0 if it is sorted when it is written.
+  unsigned int
+  eh_frame_hdr_sort_task_count() const;
+
+  // Queue tasks to sort the .eh_frame_hdr lookup table once
+  // THIS_BLOCKER is unblocked.  NEXT_BLOCKER is unblocked when they
+  // are done.  The caller must already have added
+  // eh_frame_hdr_sort_task_count() blockers to NEXT_BLOCKER.
+  void
+  queue_eh_frame_hdr_sort_tasks(Workqueue*, Output_file*,
+				Task_token* this_blocker,
+				Task_token* next_blocker);
+
   // A list of segments.
 
   typedef std::vector<Output_segment*> Segment_list;
@@ -1107,7 +1180,7 @@ class Layout
 
   // Create the dynamic symbol table.
   void
-  create_dynamic_symtab(const Input_objects*, Symbol_table*,
+  create_dynamic_symtab(const Input_objects*, Symbol_table*, Workqueue*,
 			Output_section** pdynstr,
 			unsigned int* plocal_dynamic_count,
 			unsigned int* pforced_local_dynamic_count,
@@ -1415,6 +1488,8 @@ class Layout
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
   Output_reduced_debug_info_section* debug_info_;
+  // The compressed debug sections.
+  std::vector<Output_compressed_section*> compressed_sections_;
   // A list of group sections and their signatures.
   Group_signatures group_signatures_;
   // The size of the output file.
@@ -1469,6 +1544,16 @@ class Layout
   Unordered_map<std::string, unsigned int> input_section_position_;
   // Vector of glob only patterns in the section_ordering file.
   std::vector<std::string> input_section_glob_;
+  // The call graph read from the --call-graph-ordering-file file.
+  Call_graph* call_graph_;
+  // The names of the symbols whose sections go to the hot segment.
+  std::vector<std::string> hot_symbols_;
+  // The number of hot symbols which were found in input sections.
+  unsigned int hot_symbols_found_;
+  // The input sections which go to the hot segment.
+  Unordered_set<Const_section_id, Const_section_id_hash> hot_sections_;
+  // The hot segment, for --hot-segment.
+  Output_segment* hot_segment_;
   // For incremental links, the base file to be modified.
   Incremental_binary* incremental_base_;
   // For incremental links, a list of free space within the file.
@@ -1627,6 +1712,39 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task writes the memory map of a map file in a structured
+// format.  It runs in parallel with the tasks which write the output
+// file, and must finish before the output file is closed.
+
+class Write_map_task : public Task
+{
+ public:
+  Write_map_task(const Layout* layout, Mapfile* mapfile,
+		 Task_token* final_blocker)
+    : layout_(layout), mapfile_(mapfile), final_blocker_(final_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Write_map_task"; }
+
+ private:
+  const Layout* layout_;
+  Mapfile* mapfile_;
+  Task_token* final_blocker_;
+};
+
 // This task function handles computation of the build id.
 // When using --build-id=tree, it schedules the tasks that
 // compute the hashes for each chunk of the file. This task
@@ -49,6 +49,7 @@
 #include "incremental.h"
 #include "gdb-index.h"
 #include "timer.h"
+#include "trace.h"
 
 using namespace gold;
 
@@ -174,6 +175,14 @@ main(int argc, char** argv)
   // Store some options in the globally accessible parameters.
   set_parameters_options(&command_line.options());
 
+  // If the user asked for a trace file, open it.  This must be done
+  // after the options are set, since it checks for --threads.  It is
+  // closed by gold_exit.
+  Trace trace;
+  if (command_line.options().user_set_trace_file()
+      && trace.open(command_line.options().trace_file()))
+    set_parameters_trace(&trace);
+
   // Do this as early as possible (since it prints a welcome message).
   write_debug_script(command_line.options().output_file_name(),
                      program_name, args.c_str());
@@ -235,6 +244,12 @@ main(int argc, char** argv)
   if (parameters->options().section_ordering_file())
     layout.read_layout_from_file();
 
+  if (parameters->options().call_graph_ordering_file())
+    layout.read_call_graph_from_file();
+
+  if (parameters->options().hot_segment())
+    layout.read_hot_symbols();
+
   // Load plugin libraries.
   if (command_line.options().has_plugins())
     command_line.options().plugins()->load_plugins(&layout);
@@ -297,15 +312,22 @@ main(int argc, char** argv)
 #endif
       File_read::print_stats();
       Archive::print_stats();
+      parameters->target().print_stats();
       Lib_group::print_stats();
       fprintf(stderr, _("%s: output file size: %lld bytes\n"),
 	      program_name, static_cast<long long>(layout.output_file_size()));
       symtab.print_stats();
       layout.print_stats();
+      icf.print_stats();
       Gdb_index::print_stats();
       Free_list::print_stats();
+      workqueue.print_stats();
     }
 
+  // Report how an incremental link was done.
+  if (command_line.options().incremental_stats())
+    Incremental_stats::print(false);
+
   // Issue defined symbol report.
   if (command_line.options().user_set_print_symbol_counts())
     input_objects.print_symbol_counts(&symtab);
@@ -313,7 +335,9 @@ main(int argc, char** argv)
   // Output cross reference table.
   if (command_line.options().cref())
     input_objects.print_cref(&symtab,
-			     mapfile == NULL ? stdout : mapfile->file());
+			     (mapfile == NULL || mapfile->is_structured()
+			      ? stdout
+			      : mapfile->file()));
 
   if (mapfile != NULL)
     mapfile->close();
@@ -25,6 +25,7 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 
 #include "archive.h"
 #include "symtab.h"
@@ -33,17 +34,302 @@
 
 // This file holds the code for printing information to the map file.
 // In general we try to produce pretty much the same format as GNU ld.
+// With --Map-format=json or --Map-format=csv we instead write a
+// sequence of records, one per line, which are easy to parse.  Each
+// record has a kind, which is one of archive_member, common,
+// discarded_section, output_section, input_section, linker_data,
+// symbol and hot_segment, and some of the fields below.
 
 namespace gold
 {
 
+// The fields of a record in a structured map file.  These are the
+// columns of a CSV map file, in order.
+
+enum Map_field
+{
+  MAP_FIELD_KIND,
+  MAP_FIELD_OUTPUT_SECTION,
+  MAP_FIELD_NAME,
+  MAP_FIELD_ADDRESS,
+  MAP_FIELD_SIZE,
+  MAP_FIELD_ALIGNMENT,
+  MAP_FIELD_PADDING,
+  MAP_FIELD_OBJECT,
+  MAP_FIELD_ARCHIVE,
+  MAP_FIELD_MEMBER,
+  MAP_FIELD_REASON,
+  MAP_FIELD_COUNT
+};
+
+// The names of the fields.
+
+static const char* const map_field_names[MAP_FIELD_COUNT] =
+{
+  "kind",
+  "output_section",
+  "name",
+  "address",
+  "size",
+  "alignment",
+  "padding",
+  "object",
+  "archive",
+  "member",
+  "reason"
+};
+
+// A record in a structured map file.  Fields which are not set are
+// omitted from a JSON map file and empty in a CSV map file.
+
+class Map_record
+{
+ public:
+  Map_record(const char* kind)
+    : is_set_(), is_number_()
+  { this->set_string(MAP_FIELD_KIND, kind); }
+
+  // Set a string field.
+  void
+  set_string(Map_field field, const std::string& value)
+  {
+    this->values_[field] = value;
+    this->is_set_[field] = true;
+    this->is_number_[field] = false;
+  }
+
+  // Set a numeric field.
+  void
+  set_number(Map_field field, uint64_t value)
+  {
+    char buf[30];
+    snprintf(buf, sizeof buf, "%llu", static_cast<unsigned long long>(value));
+    this->values_[field] = buf;
+    this->is_set_[field] = true;
+    this->is_number_[field] = true;
+  }
+
+  // Set the object, archive and member fields for the object named
+  // NAME.  The name of an archive member is "ARCHIVE(MEMBER)".
+  void
+  set_object(const std::string& name);
+
+  // Copy the output section and object fields from another record.
+  void
+  copy_location(const Map_record& r)
+  {
+    static const Map_field fields[] =
+      {
+	MAP_FIELD_OUTPUT_SECTION, MAP_FIELD_OBJECT, MAP_FIELD_ARCHIVE,
+	MAP_FIELD_MEMBER
+      };
+    for (size_t i = 0; i < sizeof fields / sizeof fields[0]; ++i)
+      {
+	Map_field f = fields[i];
+	this->values_[f] = r.values_[f];
+	this->is_set_[f] = r.is_set_[f];
+	this->is_number_[f] = r.is_number_[f];
+      }
+  }
+
+  // Write the members of the record as a JSON object, without the
+  // braces.  If NESTED, this is a symbol within an input section, and
+  // the fields it shares with the section are omitted.
+  void
+  write_json_members(FILE*, bool nested) const;
+
+  // Write the record as a line of CSV.
+  void
+  write_csv(FILE*) const;
+
+ private:
+  std::string values_[MAP_FIELD_COUNT];
+  bool is_set_[MAP_FIELD_COUNT];
+  bool is_number_[MAP_FIELD_COUNT];
+};
+
+// Set the object fields.
+
+void
+Map_record::set_object(const std::string& name)
+{
+  this->set_string(MAP_FIELD_OBJECT, name);
+  size_t paren = name.find('(');
+  if (paren != std::string::npos
+      && paren > 0
+      && name.length() > paren + 2
+      && name[name.length() - 1] == ')')
+    {
+      this->set_string(MAP_FIELD_ARCHIVE, name.substr(0, paren));
+      this->set_string(MAP_FIELD_MEMBER,
+		       name.substr(paren + 1, name.length() - paren - 2));
+    }
+}
+
+// Return the length of the UTF-8 sequence which starts at S[I], or 0
+// if the bytes there are not a valid UTF-8 sequence of more than one
+// byte.
+
+static size_t
+utf8_sequence_length(const std::string& s, size_t i)
+{
+  unsigned char c = s[i];
+  // The range of the second byte; the bytes after it are always
+  // 0x80 to 0xbf.  The limits exclude overlong sequences, surrogates,
+  // and code points above 0x10ffff.
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xbf;
+  size_t len;
+  if (c >= 0xc2 && c <= 0xdf)
+    len = 2;
+  else if (c >= 0xe0 && c <= 0xef)
+    {
+      len = 3;
+      if (c == 0xe0)
+	lo = 0xa0;
+      else if (c == 0xed)
+	hi = 0x9f;
+    }
+  else if (c >= 0xf0 && c <= 0xf4)
+    {
+      len = 4;
+      if (c == 0xf0)
+	lo = 0x90;
+      else if (c == 0xf4)
+	hi = 0x8f;
+    }
+  else
+    return 0;
+
+  if (len > s.length() - i)
+    return 0;
+  for (size_t j = 1; j < len; ++j)
+    {
+      unsigned char d = s[i + j];
+      if (d < lo || d > hi)
+	return 0;
+      lo = 0x80;
+      hi = 0xbf;
+    }
+  return len;
+}
+
+// Write S to F as a JSON string.  A JSON file must be UTF-8, but file
+// and symbol names may be in any encoding.  Valid UTF-8 sequences are
+// copied, and any other byte is written as the code point with the
+// same value, as though the name were Latin-1.
+
+void
+write_json_string(FILE* f, const std::string& s)
+{
+  putc('"', f);
+  size_t i = 0;
+  while (i < s.length())
+    {
+      unsigned char c = s[i];
+      if (c == '"' || c == '\\')
+	{
+	  putc('\\', f);
+	  putc(c, f);
+	  ++i;
+	}
+      else if (c < 0x20)
+	{
+	  fprintf(f, "\\u%04x", c);
+	  ++i;
+	}
+      else if (c < 0x80)
+	{
+	  putc(c, f);
+	  ++i;
+	}
+      else
+	{
+	  size_t len = utf8_sequence_length(s, i);
+	  if (len == 0)
+	    {
+	      fprintf(f, "\\u%04x", c);
+	      ++i;
+	    }
+	  else
+	    {
+	      fwrite(s.data() + i, 1, len, f);
+	      i += len;
+	    }
+	}
+    }
+  putc('"', f);
+}
+
+// Write the members of a record as a JSON object.
+
+void
+Map_record::write_json_members(FILE* f, bool nested) const
+{
+  bool first = true;
+  for (int i = 0; i < MAP_FIELD_COUNT; ++i)
+    {
+      if (!this->is_set_[i])
+	continue;
+      if (nested
+	  && (i == MAP_FIELD_KIND
+	      || i == MAP_FIELD_OUTPUT_SECTION
+	      || i == MAP_FIELD_OBJECT
+	      || i == MAP_FIELD_ARCHIVE
+	      || i == MAP_FIELD_MEMBER))
+	continue;
+      if (!first)
+	fputs(", ", f);
+      first = false;
+      fprintf(f, "\"%s\": ", map_field_names[i]);
+      if (this->is_number_[i])
+	fputs(this->values_[i].c_str(), f);
+      else
+	write_json_string(f, this->values_[i]);
+    }
+}
+
+// Write a record as a line of CSV.  Fields which contain a comma, a
+// quote or a line break are quoted.
+
+void
+Map_record::write_csv(FILE* f) const
+{
+  for (int i = 0; i < MAP_FIELD_COUNT; ++i)
+    {
+      if (i > 0)
+	putc(',', f);
+      const std::string& v(this->values_[i]);
+      if (v.find_first_of(",\"\r\n") == std::string::npos)
+	fputs(v.c_str(), f);
+      else
+	{
+	  putc('"', f);
+	  for (std::string::const_iterator p = v.begin(); p != v.end(); ++p)
+	    {
+	      if (*p == '"')
+		putc('"', f);
+	      putc(*p, f);
+	    }
+	  putc('"', f);
+	}
+    }
+  putc('\n', f);
+}
+
 // Mapfile constructor.
 
 Mapfile::Mapfile()
   : map_file_(NULL),
     printed_archive_header_(false),
     printed_common_header_(false),
-    printed_memory_map_header_(false)
+    printed_memory_map_header_(false),
+    format_(General_options::MAP_FORMAT_TEXT),
+    wrote_record_(false),
+    finished_(false),
+    current_output_section_(NULL),
+    current_end_(0),
+    object_symbols_()
 {
 }
 
@@ -72,6 +358,11 @@ Mapfile::open(const char* map_filename)
 	  return false;
 	}
     }
+
+  this->format_ = parameters->options().Map_format_enum();
+  if (this->is_structured())
+    this->start_structured();
+
   return true;
 }
 
@@ -80,11 +371,99 @@ Mapfile::open(const char* map_filename)
 void
 Mapfile::close()
 {
+  if (this->is_structured())
+    this->finish();
   if (fclose(this->map_file_) != 0)
     gold_error(_("cannot close map file: %s"), strerror(errno));
   this->map_file_ = NULL;
 }
 
+// Write the start of a structured map file: the opening of the array
+// of records for JSON, and the header line for CSV.
+
+void
+Mapfile::start_structured()
+{
+  if (this->format_ == General_options::MAP_FORMAT_JSON)
+    fputs("{\"records\": [\n", this->map_file_);
+  else
+    {
+      for (int i = 0; i < MAP_FIELD_COUNT; ++i)
+	fprintf(this->map_file_, "%s%s", i > 0 ? "," : "", map_field_names[i]);
+      putc('\n', this->map_file_);
+    }
+}
+
+// Finish a structured map file.
+
+void
+Mapfile::finish()
+{
+  if (this->finished_)
+    return;
+  if (this->format_ == General_options::MAP_FORMAT_JSON)
+    fputs(this->wrote_record_ ? "\n]}\n" : "]}\n", this->map_file_);
+  fflush(this->map_file_);
+  this->finished_ = true;
+}
+
+// Write a record to a structured map file.  A JSON record holds the
+// symbols defined in an input section as an array; a CSV map file has
+// a line for each of them following the section.
+
+void
+Mapfile::write_record(const Map_record& record,
+		      const std::vector<Map_record>* symbols)
+{
+  gold_assert(!this->finished_);
+  FILE* f = this->map_file_;
+  if (this->format_ == General_options::MAP_FORMAT_CSV)
+    {
+      record.write_csv(f);
+      if (symbols != NULL)
+	for (std::vector<Map_record>::const_iterator p = symbols->begin();
+	     p != symbols->end();
+	     ++p)
+	  p->write_csv(f);
+      return;
+    }
+
+  if (this->wrote_record_)
+    fputs(",\n", f);
+  this->wrote_record_ = true;
+  putc('{', f);
+  record.write_json_members(f, false);
+  if (symbols != NULL)
+    {
+      fputs(", \"symbols\": [", f);
+      for (std::vector<Map_record>::const_iterator p = symbols->begin();
+	   p != symbols->end();
+	   ++p)
+	{
+	  fputs(p == symbols->begin() ? "{" : ", {", f);
+	  p->write_json_members(f, true);
+	  putc('}', f);
+	}
+      putc(']', f);
+    }
+  putc('}', f);
+}
+
+// Set the padding of a record in a structured map file: the space
+// between the end of the previous data in the output section and
+// ADDRESS.
+
+void
+Mapfile::set_padding(Map_record* record, const Output_section* os,
+		     uint64_t address, uint64_t size)
+{
+  if (os == NULL || os != this->current_output_section_)
+    return;
+  if (address >= this->current_end_)
+    record->set_number(MAP_FIELD_PADDING, address - this->current_end_);
+  this->current_end_ = address + size;
+}
+
 // Advance to a column.
 
 void
@@ -108,6 +487,24 @@ void
 Mapfile::report_include_archive_member(const std::string& member_name,
 				       const Symbol* sym, const char* why)
 {
+  if (this->is_structured())
+    {
+      Map_record record("archive_member");
+      record.set_object(member_name);
+      if (sym == NULL)
+	record.set_string(MAP_FIELD_REASON, why);
+      else
+	{
+	  record.set_string(MAP_FIELD_NAME, sym->name());
+	  if (sym->source() == Symbol::FROM_OBJECT)
+	    record.set_string(MAP_FIELD_REASON, sym->object()->name());
+	  else
+	    record.set_string(MAP_FIELD_REASON, "-u");
+	}
+      this->write_record(record, NULL);
+      return;
+    }
+
   // We print a header before the list of archive members, mainly for
   // GNU ld compatibility.
   if (!this->printed_archive_header_)
@@ -154,6 +551,16 @@ Mapfile::report_include_archive_member(const std::string& member_name,
 void
 Mapfile::report_allocate_common(const Symbol* sym, uint64_t symsize)
 {
+  if (this->is_structured())
+    {
+      Map_record record("common");
+      record.set_string(MAP_FIELD_NAME, sym->name());
+      record.set_number(MAP_FIELD_SIZE, symsize);
+      record.set_object(sym->object()->name());
+      this->write_record(record, NULL);
+      return;
+    }
+
   if (!this->printed_common_header_)
     {
       fprintf(this->map_file_, _("\nAllocating common symbols\n"));
@@ -235,6 +642,12 @@ Mapfile::print_input_section_symbols(
 void
 Mapfile::print_input_section(Relobj* relobj, unsigned int shndx)
 {
+  if (this->is_structured())
+    {
+      this->write_input_section(relobj, shndx);
+      return;
+    }
+
   putc(' ', this->map_file_);
 
   std::string name = relobj->section_name(shndx);
@@ -315,12 +728,165 @@ Mapfile::print_input_section(Relobj* relobj, unsigned int shndx)
     }
 }
 
+// Write an input section to a structured map file.  This only uses
+// information which may be read while the object is being relocated.
+
+void
+Mapfile::write_input_section(Relobj* relobj, unsigned int shndx)
+{
+  bool is_included = relobj->is_section_included(shndx);
+  Map_record record(is_included ? "input_section" : "discarded_section");
+
+  // The sections of an object which was not laid out in this link, as
+  // in an incremental update, were not saved.
+  Relobj::Map_section ms;
+  if (relobj->has_map_sections())
+    {
+      ms = relobj->map_section(shndx);
+      record.set_string(MAP_FIELD_NAME, relobj->map_section_name(shndx));
+    }
+
+  Output_section* os = NULL;
+  if (is_included)
+    {
+      os = relobj->output_section(shndx);
+      record.set_string(MAP_FIELD_OUTPUT_SECTION, os->name());
+    }
+  if (os != NULL)
+    {
+      uint64_t addr = relobj->output_section_offset(shndx);
+      if (addr != -1ULL)
+	{
+	  addr += os->address();
+	  record.set_number(MAP_FIELD_ADDRESS, addr);
+	  this->set_padding(&record, os, addr, ms.size);
+	}
+    }
+  if (relobj->has_map_sections())
+    {
+      record.set_number(MAP_FIELD_SIZE, ms.size);
+      record.set_number(MAP_FIELD_ALIGNMENT, ms.addralign);
+    }
+  record.set_object(relobj->name());
+
+  if (os == NULL)
+    this->write_record(record, NULL);
+  else
+    {
+      std::vector<Map_record> symbols;
+      this->get_input_section_symbols(record, relobj, shndx, &symbols);
+      this->write_record(record, &symbols);
+    }
+}
+
+// Set the address and size fields of a record for a symbol.
+
+template<int size>
+static void
+set_symbol_value(Map_record* record, const Symbol* sym)
+{
+  const Sized_symbol<size>* ssym = static_cast<const Sized_symbol<size>*>(sym);
+  record->set_number(MAP_FIELD_ADDRESS, ssym->value());
+  record->set_number(MAP_FIELD_SIZE, ssym->symsize());
+}
+
+// Sort the symbols defined in an object by section index, keeping
+// them in symbol table order within a section.
+
+struct Section_symbol_less
+{
+  bool
+  operator()(const std::pair<unsigned int, const Symbol*>& a,
+	     const std::pair<unsigned int, const Symbol*>& b) const
+  { return a.first < b.first; }
+};
+
+// Get the records for the global symbols defined in an input section.
+// Rather than scanning all the global symbols of the object for each
+// section, as the text map file does, we sort them by section the
+// first time we see the object.
+
+void
+Mapfile::get_input_section_symbols(const Map_record& section,
+				   const Relobj* relobj, unsigned int shndx,
+				   std::vector<Map_record>* symbols)
+{
+  std::pair<Object_symbols::iterator, bool> ins =
+    this->object_symbols_.insert(std::make_pair(relobj, Section_symbols()));
+  Section_symbols* ss = &ins.first->second;
+  if (ins.second)
+    {
+      const Object::Symbols* syms = relobj->get_global_symbols();
+      for (Object::Symbols::const_iterator p = syms->begin();
+	   p != syms->end();
+	   ++p)
+	{
+	  const Symbol* sym = *p;
+	  bool is_ordinary;
+	  if (sym != NULL
+	      && sym->source() == Symbol::FROM_OBJECT
+	      && sym->object() == relobj
+	      && sym->is_defined())
+	    {
+	      unsigned int sym_shndx = sym->shndx(&is_ordinary);
+	      if (is_ordinary)
+		ss->push_back(std::make_pair(sym_shndx, sym));
+	    }
+	}
+      std::stable_sort(ss->begin(), ss->end(), Section_symbol_less());
+    }
+
+  Section_symbols::const_iterator p =
+    std::lower_bound(ss->begin(), ss->end(),
+		     std::make_pair(shndx, static_cast<const Symbol*>(NULL)),
+		     Section_symbol_less());
+  for (; p != ss->end() && p->first == shndx; ++p)
+    {
+      Map_record record("symbol");
+      record.copy_location(section);
+      record.set_string(MAP_FIELD_NAME, p->second->name());
+      if (parameters->target().get_size() == 32)
+	set_symbol_value<32>(&record, p->second);
+      else
+	set_symbol_value<64>(&record, p->second);
+      symbols->push_back(record);
+    }
+}
+
 // Print an Output_section_data.  This is printed to look like an
 // input section.
 
 void
 Mapfile::print_output_data(const Output_data* od, const char* name)
 {
+  if (this->is_structured())
+    {
+      Map_record record("linker_data");
+      const Output_section* os = od->output_section();
+      // Fill between input sections does not record its output
+      // section, but lies within the one being written.
+      const Output_section* cur = this->current_output_section_;
+      if (os == NULL
+	  && cur != NULL
+	  && od->is_address_valid()
+	  && od->address() >= cur->address()
+	  && od->address() < cur->address() + cur->current_data_size())
+	os = cur;
+      if (os != NULL)
+	record.set_string(MAP_FIELD_OUTPUT_SECTION, os->name());
+      record.set_string(MAP_FIELD_NAME, name);
+      if (od->is_address_valid())
+	{
+	  record.set_number(MAP_FIELD_ADDRESS, od->address());
+	  this->set_padding(&record, os, od->address(),
+			    od->current_data_size());
+	}
+      record.set_number(MAP_FIELD_SIZE, od->current_data_size());
+      record.set_number(MAP_FIELD_ALIGNMENT, od->addralign());
+      this->write_record(record, NULL);
+      return;
+    }
+
   this->print_memory_map_header();
 
   putc(' ', this->map_file_);
@@ -367,7 +933,7 @@ Mapfile::print_discarded_sections(const Input_objects* input_objects)
 	       || sh_type == elfcpp::SHT_GROUP)
 	      && !relobj->is_section_included(i))
 	    {
-	      if (!printed_header)
+	      if (!printed_header && !this->is_structured())
 		{
 		  fprintf(this->map_file_, _("\nDiscarded input sections\n\n"));
 		  printed_header = true;
@@ -384,6 +950,19 @@ Mapfile::print_discarded_sections(const Input_objects* input_objects)
 void
 Mapfile::print_output_section(const Output_section* os)
 {
+  if (this->is_structured())
+    {
+      this->current_output_section_ = os;
+      this->current_end_ = os->address();
+      Map_record record("output_section");
+      record.set_string(MAP_FIELD_NAME, os->name());
+      record.set_number(MAP_FIELD_ADDRESS, os->address());
+      record.set_number(MAP_FIELD_SIZE, os->current_data_size());
+      record.set_number(MAP_FIELD_ALIGNMENT, os->addralign());
+      this->write_record(record, NULL);
+      return;
+    }
+
   this->print_memory_map_header();
 
   fprintf(this->map_file_, "\n%s", os->name());
@@ -409,4 +988,51 @@ Mapfile::print_output_section(const Output_section* os)
   putc('\n', this->map_file_);
 }
 
+// Print the huge page coverage of the hot segment.
+
+void
+Mapfile::print_hot_segment(const Output_segment* seg, uint64_t huge_page_size,
+			   uint64_t addr_padding, uint64_t file_padding,
+			   size_t requested, unsigned int found)
+{
+  if (this->is_structured())
+    {
+      Map_record record("hot_segment");
+      record.set_number(MAP_FIELD_ADDRESS, seg->vaddr());
+      record.set_number(MAP_FIELD_SIZE, seg->memsz());
+      record.set_number(MAP_FIELD_ALIGNMENT, huge_page_size);
+      record.set_number(MAP_FIELD_PADDING, addr_padding);
+      this->write_record(record, NULL);
+      return;
+    }
+
+  uint64_t start = seg->vaddr();
+  uint64_t end = start + seg->memsz();
+  uint64_t pages = ((align_address(end, huge_page_size)
+		     - (start & ~(huge_page_size - 1)))
+		    / huge_page_size);
+  double coverage = 0.0;
+  if (pages > 0)
+    coverage = (100.0 * static_cast<double>(seg->memsz())
+		/ static_cast<double>(pages * huge_page_size));
+
+  fprintf(this->map_file_, _("\nHot segment\n\n"));
+  fprintf(this->map_file_, _("Address          0x%0*llx\n"),
+	  parameters->target().get_size() / 4,
+	  static_cast<unsigned long long>(start));
+  fprintf(this->map_file_, _("Size             0x%llx\n"),
+	  static_cast<unsigned long long>(seg->memsz()));
+  fprintf(this->map_file_, _("Huge page size   0x%llx\n"),
+	  static_cast<unsigned long long>(huge_page_size));
+  fprintf(this->map_file_, _("Huge pages       %llu\n"),
+	  static_cast<unsigned long long>(pages));
+  fprintf(this->map_file_, _("Coverage         %.1f%%\n"), coverage);
+  fprintf(this->map_file_, _("Address padding  0x%llx\n"),
+	  static_cast<unsigned long long>(addr_padding));
+  fprintf(this->map_file_, _("File padding     0x%llx\n"),
+	  static_cast<unsigned long long>(file_padding));
+  fprintf(this->map_file_, _("Hot symbols      %u of %zu found\n"),
+	  found, requested);
+}
+
 } // End namespace gold.
@@ -25,6 +25,9 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
+
+#include "options.h"
 
 namespace gold
 {
@@ -35,7 +38,9 @@ class Relobj;
 template<int size, bool big_endian>
 class Sized_relobj_file;
 class Output_section;
+class Output_segment;
 class Output_data;
+class Map_record;
 
 // This class manages map file output.
 
@@ -59,6 +64,19 @@ class Mapfile
   file()
   { return this->map_file_; }
 
+  // Return whether the map file is written in a structured format,
+  // JSON or CSV, rather than as text.  The memory map of a structured
+  // map file is written by Write_map_task, in parallel with the
+  // output sections.
+  bool
+  is_structured() const
+  { return this->format_ != General_options::MAP_FORMAT_TEXT; }
+
+  // Finish a map file in a structured format.  This is called when
+  // the memory map has been written, or by close.
+  void
+  finish();
+
   // Report that we are including a member from an archive.  This is
   // called by the archive reading code.
   void
@@ -85,6 +103,16 @@ class Mapfile
   void
   print_output_data(const Output_data*, const char* name);
 
+  // Print the huge page coverage of the hot segment, for
+  // --hot-segment.  HUGE_PAGE_SIZE is the alignment of the segment.
+  // ADDR_PADDING and FILE_PADDING are the gaps between the previous
+  // PT_LOAD segment and the hot segment in memory and in the file.
+  // FOUND of the REQUESTED hot symbols were found.
+  void
+  print_hot_segment(const Output_segment*, uint64_t huge_page_size,
+		    uint64_t addr_padding, uint64_t file_padding,
+		    size_t requested, unsigned int found);
+
  private:
   // The space we allow for a section name.
   static const size_t section_name_map_length;
@@ -103,6 +131,41 @@ class Mapfile
   print_input_section_symbols(const Sized_relobj_file<size, big_endian>*,
 			      unsigned int shndx);
 
+  // Write the start of a map file in a structured format.
+  void
+  start_structured();
+
+  // Write a record to a map file in a structured format, followed by
+  // the records for the symbols defined in an input section, if
+  // SYMBOLS is not NULL.
+  void
+  write_record(const Map_record&, const std::vector<Map_record>* symbols);
+
+  // Write an input section to a map file in a structured format.
+  void
+  write_input_section(Relobj*, unsigned int shndx);
+
+  // Add the records for the global symbols defined in an input section
+  // to SYMBOLS.
+  void
+  get_input_section_symbols(const Map_record& section, const Relobj*,
+			    unsigned int shndx,
+			    std::vector<Map_record>* symbols);
+
+  // Set the padding field of a record for data at ADDRESS with SIZE
+  // bytes in output section OS.
+  void
+  set_padding(Map_record*, const Output_section* os, uint64_t address,
+	      uint64_t size);
+
+  // The global symbols defined in the sections of an object, as
+  // pairs of section index and symbol, sorted by section index.
+  typedef std::vector<std::pair<unsigned int, const Symbol*> >
+    Section_symbols;
+
+  // Map from an object to the symbols defined in its sections.
+  typedef Unordered_map<const Relobj*, Section_symbols> Object_symbols;
+
   // Map file to write to.
   FILE* map_file_;
   // Whether we have printed the archive member header.
@@ -111,8 +174,28 @@ class Mapfile
   bool printed_common_header_;
   // Whether we have printed the memory map header.
   bool printed_memory_map_header_;
+  // The format of the map file.
+  General_options::Map_file_format format_;
+  // Whether we have written a record to a structured map file.
+  bool wrote_record_;
+  // Whether we have finished a structured map file.
+  bool finished_;
+  // The output section whose input sections are being written to a
+  // structured map file.
+  const Output_section* current_output_section_;
+  // The end of the last data written in that output section.
+  uint64_t current_end_;
+  // The symbols defined in the sections of each object, for a
+  // structured map file.  Each entry is built when the first section
+  // of the object is written.
+  Object_symbols object_symbols_;
 };
 
+// Write S to F as a JSON string.
+
+extern void
+write_json_string(FILE* f, const std::string& s);
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_MAP_H)
@@ -25,6 +25,10 @@
 #include <cstdlib>
 #include <algorithm>
 
+#include "gold-threads.h"
+#include "parameters.h"
+#include "options.h"
+#include "timer.h"
 #include "merge.h"
 #include "compressed_output.h"
 
@@ -431,6 +435,46 @@ Output_merge_data::do_print_merge_stats(const char* section_name)
 
 // Class Output_merge_string.
 
+template<typename Char_type>
+Output_merge_string<Char_type>::Output_merge_string(uint64_t addralign)
+  : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
+    concurrent_stringpool_(NULL), lock_(NULL), merged_strings_lists_(),
+    input_count_(0), input_size_(0), task_count_(0), add_time_(0),
+    offsets_time_(0), map_time_(0), write_time_(0)
+{
+  this->stringpool_.set_no_zero_null();
+  if (parameters->options().tail_merge_strings())
+    this->stringpool_.set_optimize();
+  if (parameters->options().parallel_merge_strings())
+    {
+      this->concurrent_stringpool_ = new Concurrent_pool(addralign);
+      this->concurrent_stringpool_->set_no_zero_null();
+      if (parameters->options().tail_merge_strings())
+	this->concurrent_stringpool_->set_optimize();
+      this->lock_ = new Lock();
+    }
+}
+
+template<typename Char_type>
+Output_merge_string<Char_type>::~Output_merge_string()
+{
+  delete this->concurrent_stringpool_;
+  delete this->lock_;
+}
+
+// Set the keeps-input-sections flag.  The input sections may then be
+// added again after the merge tasks have run, so we don't defer them.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_set_keeps_input_sections()
+{
+  gold_assert(this->input_count_ == 0);
+  Output_merge_base::do_set_keeps_input_sections();
+  delete this->concurrent_stringpool_;
+  this->concurrent_stringpool_ = NULL;
+}
+
 // Add an input section to a merged string section.
 
 template<typename Char_type>
@@ -438,6 +482,64 @@ bool
 Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 						     unsigned int shndx)
 {
+  if (this->concurrent_stringpool_ != NULL)
+    {
+      // Check the length now, so that our caller can fall back to
+      // an ordinary section; the strings are added later by a
+      // Merge_strings_task.
+      section_size_type sec_len = object->section_size(shndx);
+      section_size_type uncompressed_size;
+      if (object->section_is_compressed(shndx, &uncompressed_size))
+	sec_len = uncompressed_size;
+      if (sec_len % sizeof(Char_type) != 0)
+	{
+	  object->error(_("mergeable string section length not multiple of "
+			  "character size"));
+	  return false;
+	}
+      this->merged_strings_lists_.push_back(new Merged_strings_list(object,
+								    shndx));
+      return true;
+    }
+
+  Timer timer;
+  if (parameters->options().stats())
+    timer.start();
+
+  Merged_strings_list* merged_strings_list =
+      new Merged_strings_list(object, shndx);
+  if (!this->add_strings(merged_strings_list,
+			 this->merged_strings_lists_.size(),
+			 &this->input_count_, &this->input_size_))
+    {
+      delete merged_strings_list;
+      return false;
+    }
+  this->merged_strings_lists_.push_back(merged_strings_list);
+
+  // For script processing, we keep the input sections.
+  if (this->keeps_input_sections())
+    record_input_section(object, shndx);
+
+  if (parameters->options().stats())
+    this->add_time_ += timer.get_elapsed_time().wall;
+
+  return true;
+}
+
+// Add the strings of an input section.
+
+template<typename Char_type>
+bool
+Output_merge_string<Char_type>::add_strings(
+    Merged_strings_list* merged_strings_list,
+    size_t index,
+    size_t* pcount,
+    size_t* psize)
+{
+  Relobj* object = merged_strings_list->object;
+  unsigned int shndx = merged_strings_list->shndx;
+
   section_size_type sec_len;
   bool is_new;
   const unsigned char* pdata = object->decompressed_section_contents(shndx,
@@ -468,9 +570,6 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	--pend0;
     }
 
-  Merged_strings_list* merged_strings_list =
-      new Merged_strings_list(object, shndx);
-  this->merged_strings_lists_.push_back(merged_strings_list);
   Merged_strings& merged_strings = merged_strings_list->merged_strings;
 
   // Count the number of non-null strings in the section and size the list.
@@ -490,6 +589,11 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   // The index I is in bytes, not characters.
   section_size_type i = 0;
 
+  // The strings are ordered by input section and then by position
+  // within the input section, as though they had been added to a
+  // Stringpool one after another.
+  uint64_t order = static_cast<uint64_t>(index) << 32;
+
   // We assume here that the beginning of the section is correctly
   // aligned, so each string within the section must retain the same
   // modulo.
@@ -507,20 +611,34 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	      != init_align_modulo))
 	  has_misaligned_strings = true;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      if (this->concurrent_stringpool_ == NULL)
+	{
+	  Stringpool::Key key;
+	  this->stringpool_.add_with_length(p, len, true, &key);
+	  merged_strings.push_back(Merged_string(i, key));
+	}
+      else
+	{
+	  Concurrent_key key;
+	  this->concurrent_stringpool_->add_with_length(p, len, true, order,
+							&key);
+	  merged_strings.push_back(Merged_string(i, key));
+	  ++order;
+	}
 
-      merged_strings.push_back(Merged_string(i, key));
       p += len + 1;
       i += (len + 1) * sizeof(Char_type);
     }
 
   // Record the last offset in the input section so that we can
   // compute the length of the last string.
-  merged_strings.push_back(Merged_string(i, 0));
+  if (this->concurrent_stringpool_ == NULL)
+    merged_strings.push_back(Merged_string(i, Stringpool::Key(0)));
+  else
+    merged_strings.push_back(Merged_string(i, Concurrent_key(NULL)));
 
-  this->input_count_ += count;
-  this->input_size_ += i;
+  *pcount += count;
+  *psize += i;
 
   if (has_misaligned_strings)
     gold_warning(_("%s: section %s contains incorrectly aligned strings;"
@@ -528,16 +646,126 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 		 object->name().c_str(),
 		 object->section_name(shndx).c_str());
 
-  // For script processing, we keep the input sections.
-  if (this->keeps_input_sections())
-    record_input_section(object, shndx);
-
   if (is_new)
     delete[] pdata;
 
   return true;
 }
 
+// Add the strings of the input sections which do_add_input_section
+// deferred.  This runs in a Merge_strings_task, in parallel with the
+// other tasks for this section.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::add_deferred_strings(size_t first,
+						     size_t last)
+{
+  Timer timer;
+  if (parameters->options().stats())
+    timer.start();
+
+  size_t count = 0;
+  size_t size = 0;
+  for (size_t i = first; i < last; ++i)
+    {
+      // We checked the section length in do_add_input_section.
+      bool ok = this->add_strings(this->merged_strings_lists_[i], i, &count,
+				  &size);
+      gold_assert(ok);
+    }
+
+  Hold_lock hl(*this->lock_);
+  this->input_count_ += count;
+  this->input_size_ += size;
+  if (parameters->options().stats())
+    this->add_time_ += timer.get_elapsed_time().wall;
+}
+
+// A Task to add the strings of the input sections from one object to
+// an Output_merge_string, for --parallel-merge-strings.  We hold a
+// lock on the object, and a blocker which keeps the layout from being
+// finalized until all the strings have been added.
+
+template<typename Char_type>
+class Merge_strings_task : public Task
+{
+ public:
+  Merge_strings_task(Output_merge_string<Char_type>* merge_section,
+		     Relobj* object, size_t first, size_t last,
+		     Task_token* blocker)
+    : merge_section_(merge_section), object_(object), first_(first),
+      last_(last), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->merge_section_->add_deferred_strings(this->first_, this->last_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Merge_strings_task " + this->object_->name(); }
+
+ private:
+  Output_merge_string<Char_type>* merge_section_;
+  Relobj* object_;
+  size_t first_;
+  size_t last_;
+  Task_token* blocker_;
+};
+
+// Queue a Merge_strings_task for each input object with deferred
+// input sections.  The input sections of an object are added
+// together, so they are adjacent in merged_strings_lists_.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_queue_merge_tasks(Workqueue* workqueue,
+						     Task_token* blocker)
+{
+  if (this->concurrent_stringpool_ == NULL)
+    return;
+
+  size_t count = this->merged_strings_lists_.size();
+  size_t first = 0;
+  while (first < count)
+    {
+      Relobj* object = this->merged_strings_lists_[first]->object;
+      size_t last = first + 1;
+      while (last < count
+	     && this->merged_strings_lists_[last]->object == object)
+	++last;
+
+      workqueue->add_blocker(blocker);
+      workqueue->queue(new Merge_strings_task<Char_type>(this, object, first,
+							 last, blocker));
+      ++this->task_count_;
+      first = last;
+    }
+}
+
 // Finalize the mappings from the input sections to the output
 // section, and return the final data size.
 
@@ -545,7 +773,20 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
-  this->stringpool_.set_string_offsets();
+  Timer timer;
+  if (parameters->options().stats())
+    timer.start();
+
+  if (this->concurrent_stringpool_ == NULL)
+    this->stringpool_.set_string_offsets();
+  else
+    this->concurrent_stringpool_->set_string_offsets();
+
+  if (parameters->options().stats())
+    {
+      this->offsets_time_ += timer.get_elapsed_time().wall;
+      timer.start();
+    }
 
   for (typename Merged_strings_lists::const_iterator l =
 	 this->merged_strings_lists_.begin();
@@ -559,6 +800,10 @@ Output_merge_string<Char_type>::finalize_merged_data()
       Object_merge_map::Input_merge_map* input_merge_map =
         merge_map->get_or_make_input_merge_map(this, (*l)->shndx);
 
+      // Every input section has at least the entry for its end,
+      // unless a deferred input section was never added.
+      gold_assert(!(*l)->merged_strings.empty());
+
       for (typename Merged_strings::const_iterator p =
 	     (*l)->merged_strings.begin();
 	   p != (*l)->merged_strings.end();
@@ -569,9 +814,19 @@ Output_merge_string<Char_type>::finalize_merged_data()
 	    input_merge_map->add_mapping(last_input_offset, length,
                                          last_output_offset);
 	  last_input_offset = p->offset;
-	  if (p->stringpool_key != 0)
-	    last_output_offset =
-	        this->stringpool_.get_offset_from_key(p->stringpool_key);
+	  if (this->concurrent_stringpool_ == NULL)
+	    {
+	      if (p->stringpool_key != 0)
+		last_output_offset =
+		  this->stringpool_.get_offset_from_key(p->stringpool_key);
+	    }
+	  else
+	    {
+	      if (p->concurrent_key != NULL)
+		last_output_offset =
+		  this->concurrent_stringpool_->get_offset_from_key(
+		      p->concurrent_key);
+	    }
 	}
       delete *l;
     }
@@ -581,7 +836,13 @@ Output_merge_string<Char_type>::finalize_merged_data()
   // finds a better alignment.
   this->merged_strings_lists_.clear();
 
-  return this->stringpool_.get_strtab_size();
+  if (parameters->options().stats())
+    this->map_time_ += timer.get_elapsed_time().wall;
+
+  if (this->concurrent_stringpool_ == NULL)
+    return this->stringpool_.get_strtab_size();
+  else
+    return this->concurrent_stringpool_->get_strtab_size();
 }
 
 template<typename Char_type>
@@ -598,7 +859,17 @@ template<typename Char_type>
 void
 Output_merge_string<Char_type>::do_write(Output_file* of)
 {
-  this->stringpool_.write(of, this->offset());
+  Timer timer;
+  if (parameters->options().stats())
+    timer.start();
+
+  if (this->concurrent_stringpool_ == NULL)
+    this->stringpool_.write(of, this->offset());
+  else
+    this->concurrent_stringpool_->write(of, this->offset());
+
+  if (parameters->options().stats())
+    this->write_time_ += timer.get_elapsed_time().wall;
 }
 
 // Write a merged string section to a buffer.
@@ -607,7 +878,17 @@ template<typename Char_type>
 void
 Output_merge_string<Char_type>::do_write_to_buffer(unsigned char* buffer)
 {
-  this->stringpool_.write_to_buffer(buffer, this->data_size());
+  Timer timer;
+  if (parameters->options().stats())
+    timer.start();
+
+  if (this->concurrent_stringpool_ == NULL)
+    this->stringpool_.write_to_buffer(buffer, this->data_size());
+  else
+    this->concurrent_stringpool_->write_to_buffer(buffer, this->data_size());
+
+  if (parameters->options().stats())
+    this->write_time_ += timer.get_elapsed_time().wall;
 }
 
 // Return the name of the types of string to use with
@@ -654,7 +935,29 @@ Output_merge_string<Char_type>::do_print_merge_stats(const char* section_name)
 	  program_name, buf, this->input_size_);
   fprintf(stderr, _("%s: %s input strings: %zu\n"),
 	  program_name, buf, this->input_count_);
-  this->stringpool_.print_stats(buf);
+  if (this->concurrent_stringpool_ == NULL)
+    this->stringpool_.print_stats(buf);
+  else
+    {
+      fprintf(stderr, _("%s: %s add tasks: %zu\n"),
+	      program_name, buf, this->task_count_);
+      this->concurrent_stringpool_->print_stats(buf);
+    }
+  this->print_time(buf, "add", this->add_time_);
+  this->print_time(buf, "set offsets", this->offsets_time_);
+  this->print_time(buf, "map", this->map_time_);
+  this->print_time(buf, "write", this->write_time_);
+}
+
+// Print the time spent in one phase.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::print_time(const char* buf, const char* phase,
+					   long ms)
+{
+  fprintf(stderr, _("%s: %s %s time: %ld.%03ld\n"),
+	  program_name, buf, phase, ms / 1000, ms % 1000);
 }
 
 // Instantiate the templates we need.
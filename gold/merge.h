@@ -393,19 +393,26 @@ class Output_merge_data : public Output_merge_base
   Merge_data_hashtable hashtable_;
 };
 
+template<typename Char_type>
+class Merge_strings_task;
+
 // Handle SHF_MERGE sections with string data.  This is a template
 // based on the type of the characters in the string.
 
+// With --parallel-merge-strings, do_add_input_section only records
+// the input section, and the strings are added later by a
+// Merge_strings_task for each input object, which run in parallel
+// with the relocation scan.  The strings then go into a
+// Concurrent_stringpool, which assigns the same offsets that the
+// Stringpool would have.
+
 template<typename Char_type>
 class Output_merge_string : public Output_merge_base
 {
  public:
-  Output_merge_string(uint64_t addralign)
-    : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
-      merged_strings_lists_(), input_count_(0), input_size_(0)
-  {
-    this->stringpool_.set_no_zero_null();
-  }
+  Output_merge_string(uint64_t addralign);
+
+  ~Output_merge_string();
 
  protected:
   // Add an input section.
@@ -455,13 +462,18 @@ class Output_merge_string : public Output_merge_base
 
   // Set keeps-input-sections flag.
   void
-  do_set_keeps_input_sections()
-  {
-    gold_assert(this->input_count_ == 0);
-    Output_merge_base::do_set_keeps_input_sections();
-  }
+  do_set_keeps_input_sections();
+
+  // Queue the Merge_strings_tasks.
+  void
+  do_queue_merge_tasks(Workqueue*, Task_token*);
 
  private:
+  friend class Merge_strings_task<Char_type>;
+
+  typedef Concurrent_stringpool_template<Char_type> Concurrent_pool;
+  typedef typename Concurrent_pool::Key Concurrent_key;
+
   // The name of the string type, for stats.
   const char*
   string_name();
@@ -472,12 +484,21 @@ class Output_merge_string : public Output_merge_base
   {
     // The offset in the input section.
     section_offset_type offset;
-    // The key in the Stringpool.
-    Stringpool::Key stringpool_key;
+    union
+    {
+      // The key in the Stringpool.
+      Stringpool::Key stringpool_key;
+      // The key in the Concurrent_stringpool.
+      Concurrent_key concurrent_key;
+    };
 
     Merged_string(section_offset_type offseta, Stringpool::Key stringpool_keya)
       : offset(offseta), stringpool_key(stringpool_keya)
     { }
+
+    Merged_string(section_offset_type offseta, Concurrent_key concurrent_keya)
+      : offset(offseta), concurrent_key(concurrent_keya)
+    { }
   };
 
   typedef std::vector<Merged_string> Merged_strings;
@@ -498,8 +519,30 @@ class Output_merge_string : public Output_merge_base
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
+  // Add the strings of the input section in MERGED_STRINGS_LIST, which
+  // is entry INDEX in merged_strings_lists_.  Add the number of
+  // strings and bytes to *PCOUNT and *PSIZE.  Return false if the
+  // section can not be merged.
+  bool
+  add_strings(Merged_strings_list* merged_strings_list, size_t index,
+	      size_t* pcount, size_t* psize);
+
+  // Add the strings of the input sections FIRST up to LAST in
+  // merged_strings_lists_.  This is called by a Merge_strings_task.
+  void
+  add_deferred_strings(size_t first, size_t last);
+
+  // Print a time in milliseconds for --stats.
+  static void
+  print_time(const char* buf, const char* phase, long ms);
+
   // As we see the strings, we add them to a Stringpool.
   Stringpool_template<Char_type> stringpool_;
+  // With --parallel-merge-strings, we add them to this
+  // Concurrent_stringpool instead.
+  Concurrent_pool* concurrent_stringpool_;
+  // Lock for the statistics when strings are added in parallel.
+  Lock* lock_;
   // Map from a location in an input object to an entry in the
   // Stringpool.
   Merged_strings_lists merged_strings_lists_;
@@ -507,6 +550,16 @@ class Output_merge_string : public Output_merge_base
   size_t input_count_;
   // The total size of input sections.
   size_t input_size_;
+  // The number of Merge_strings_tasks.
+  size_t task_count_;
+  // Milliseconds spent adding strings, assigning offsets, building the
+  // input section maps, and writing the section, for --stats.  With
+  // --parallel-merge-strings, the time adding strings is the sum over
+  // the tasks.
+  long add_time_;
+  long offsets_time_;
+  long map_time_;
+  long write_time_;
 };
 
 } // End namespace gold.
@@ -42,6 +42,7 @@
 #include "compressed_output.h"
 #include "incremental.h"
 #include "merge.h"
+#include "ehframe.h"
 
 namespace gold
 {
@@ -476,6 +477,7 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
     local_plt_offsets_(),
     kept_comdat_sections_(),
     has_eh_frame_(false),
+    eh_frame_input_(NULL),
     is_deferred_layout_(false),
     deferred_layout_(),
     deferred_layout_relocs_(),
@@ -487,6 +489,7 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
 template<int size, bool big_endian>
 Sized_relobj_file<size, big_endian>::~Sized_relobj_file()
 {
+  delete this->eh_frame_input_;
 }
 
 // Set up an object file based on the file header.  This sets up the
@@ -917,6 +920,76 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  if (this->has_eh_frame_)
+    this->read_eh_frame_input(sd);
+}
+
+// With --threads, the symbols of different objects are read in
+// parallel, so read the .eh_frame section now too; layout then only
+// has to add the CIEs and FDEs to the output.  We only do this for
+// the usual case of a single .eh_frame section.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::read_eh_frame_input(
+    Read_symbols_data* sd)
+{
+  if (this->eh_frame_input_ != NULL
+      || !parameters->options().threads()
+      || parameters->options().relocatable()
+      || parameters->incremental())
+    return;
+
+  const unsigned int shnum = this->shnum();
+  const unsigned char* const pshdrs = sd->section_headers->data();
+  const char* names =
+    reinterpret_cast<const char*>(sd->section_names->data());
+
+  unsigned int eh_frame_shndx = 0;
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      if (shdr.get_sh_name() < sd->section_names_size
+	  && this->check_eh_frame_flags(&shdr)
+	  && strcmp(names + shdr.get_sh_name(), ".eh_frame") == 0)
+	{
+	  if (eh_frame_shndx != 0)
+	    return;
+	  eh_frame_shndx = i;
+	}
+    }
+  if (eh_frame_shndx == 0)
+    return;
+
+  // Find the reloc section, as in do_layout.
+  unsigned int reloc_shndx = 0;
+  unsigned int reloc_type = elfcpp::SHT_NULL;
+  p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if ((sh_type == elfcpp::SHT_REL || sh_type == elfcpp::SHT_RELA)
+	  && this->adjust_shndx(shdr.get_sh_info()) == eh_frame_shndx)
+	{
+	  if (reloc_shndx != 0)
+	    reloc_shndx = -1U;
+	  else
+	    {
+	      reloc_shndx = i;
+	      reloc_type = sh_type;
+	    }
+	}
+    }
+
+  this->eh_frame_input_ =
+    Eh_frame::read_input_section(this, sd->symbols->data(),
+				 sd->symbols_size,
+				 sd->symbol_names->data(),
+				 sd->symbol_names_size,
+				 eh_frame_shndx, reloc_shndx, reloc_type);
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -1394,6 +1467,27 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
 
   const char* pnames = reinterpret_cast<const char*>(pnamesu);
 
+  // Save the section names, sizes and alignments for a structured map
+  // file, which is written while this object is being relocated.
+  if (!is_pass_two && parameters->options().structured_map())
+    {
+      std::vector<Relobj::Map_section> map_sections(shnum);
+      pshdrs = shdrs + This::shdr_size;
+      for (unsigned int i = 1; i < shnum; ++i, pshdrs += This::shdr_size)
+	{
+	  typename This::Shdr shdr(pshdrs);
+	  Relobj::Map_section& ms(map_sections[i]);
+	  ms.name = shdr.get_sh_name();
+	  section_size_type uncompressed_size;
+	  if (this->section_is_compressed(i, &uncompressed_size))
+	    ms.size = uncompressed_size;
+	  else
+	    ms.size = shdr.get_sh_size();
+	  ms.addralign = shdr.get_sh_addralign();
+	}
+      this->save_map_sections(pnames, section_names_size, &map_sections);
+    }
+
   // If any input files have been claimed by plugins, we need to defer
   // actual layout until the replacement files have arrived.
   const bool should_defer_layout =
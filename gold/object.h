@@ -47,6 +47,7 @@ class Output_file;
 class Output_symtab_xindex;
 class Pluginobj;
 class Dynobj;
+class Eh_frame_input_section;
 class Object_merge_map;
 class Relocatable_relocs;
 struct Symbols_data;
@@ -1103,7 +1104,9 @@ class Relobj : public Object
       reloc_counts_(NULL),
       reloc_bases_(NULL),
       first_dyn_reloc_(0),
-      dyn_reloc_count_(0)
+      dyn_reloc_count_(0),
+      map_section_names_(),
+      map_sections_()
   { }
 
   // During garbage collection, the Read_symbols_data pass for 
@@ -1376,6 +1379,57 @@ class Relobj : public Object
   is_big_endian() const
   { return this->do_is_big_endian(); }
 
+  // The name, size and alignment of an input section, saved at
+  // layout time for a map file in a structured format.  That map file
+  // is written while the object is locked for relocation, so it can
+  // not read the section headers.
+  struct Map_section
+  {
+    Map_section()
+      : name(0), size(0), addralign(0)
+    { }
+
+    // Offset of the name in the saved section names.
+    section_size_type name;
+    // Size of the section contents, after any decompression.
+    uint64_t size;
+    // Required alignment.
+    uint64_t addralign;
+  };
+
+  // Save the section names NAMES, and MAP_SECTIONS, which is indexed
+  // by section index.  This takes over the contents of MAP_SECTIONS.
+  void
+  save_map_sections(const char* names, section_size_type names_size,
+		    std::vector<Map_section>* map_sections)
+  {
+    this->map_section_names_.assign(names, names_size);
+    this->map_sections_.swap(*map_sections);
+  }
+
+  // Return whether the sections were saved for the map file.
+  bool
+  has_map_sections() const
+  { return !this->map_sections_.empty(); }
+
+  // Return the saved information for section SHNDX.
+  const Map_section&
+  map_section(unsigned int shndx) const
+  {
+    gold_assert(shndx < this->map_sections_.size());
+    return this->map_sections_[shndx];
+  }
+
+  // Return the saved name of section SHNDX.
+  const char*
+  map_section_name(unsigned int shndx) const
+  {
+    section_size_type offset = this->map_section(shndx).name;
+    if (offset >= this->map_section_names_.size())
+      return "";
+    return this->map_section_names_.c_str() + offset;
+  }
+
  protected:
   // The output section to be used for each input section, indexed by
   // the input section number.  The output section is NULL if the
@@ -1577,6 +1631,10 @@ class Relobj : public Object
   unsigned int first_dyn_reloc_;
   // Count of dynamic relocations for this object.
   unsigned int dyn_reloc_count_;
+  // Section names saved for a structured map file.
+  std::string map_section_names_;
+  // Sections saved for a structured map file.
+  std::vector<Map_section> map_sections_;
 };
 
 // This class is used to handle relocations against a section symbol
@@ -2229,6 +2287,16 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   unsigned int
   symbol_section_and_value(unsigned int sym, Address* value, bool* is_ordinary);
 
+  // Return the .eh_frame section read while reading the symbols, if
+  // any, and forget about it.  The caller takes ownership.
+  Eh_frame_input_section*
+  release_eh_frame_input()
+  {
+    Eh_frame_input_section* ret = this->eh_frame_input_;
+    this->eh_frame_input_ = NULL;
+    return ret;
+  }
+
   // Return a pointer to the Symbol_value structure which holds the
   // value of a local symbol.
   const Symbol_value<size>*
@@ -2637,6 +2705,10 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   find_eh_frame(const unsigned char* pshdrs, const char* names,
 		section_size_type names_size) const;
 
+  // Read the .eh_frame section along with the symbols.
+  void
+  read_eh_frame_input(Read_symbols_data*);
+
   // Whether to include a section group in the link.
   bool
   include_section_group(Symbol_table*, Layout*, unsigned int, const char*,
@@ -2865,6 +2937,8 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   Kept_comdat_section_table kept_comdat_sections_;
   // Whether this object has a GNU style .eh_frame section.
   bool has_eh_frame_;
+  // The .eh_frame section, if it was read along with the symbols.
+  Eh_frame_input_section* eh_frame_input_;
   // True if the layout of this object was deferred, waiting for plugin
   // replacement files.
   bool is_deferred_layout_;
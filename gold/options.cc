@@ -997,7 +997,8 @@ General_options::General_options()
     fix_v4bx_(FIX_V4BX_NONE),
     endianness_(ENDIANNESS_NOT_SET),
     discard_locals_(DISCARD_SEC_MERGE),
-    orphan_handling_enum_(ORPHAN_PLACE)
+    orphan_handling_enum_(ORPHAN_PLACE),
+    Map_format_enum_(MAP_FORMAT_TEXT)
 {
   // Turn off option registration once construction is complete.
   gold::options::ready_to_register = false;
@@ -1169,6 +1170,17 @@ General_options::finalize()
         this->set_orphan_handling_enum(ORPHAN_ERROR);
     }
 
+  // Parse the --Map-format argument.
+  if (this->user_set_Map_format())
+    {
+      if (strcmp(this->Map_format(), "text") == 0)
+	this->set_Map_format_enum(MAP_FORMAT_TEXT);
+      else if (strcmp(this->Map_format(), "json") == 0)
+	this->set_Map_format_enum(MAP_FORMAT_JSON);
+      else if (strcmp(this->Map_format(), "csv") == 0)
+	this->set_Map_format_enum(MAP_FORMAT_CSV);
+    }
+
   // -M is equivalent to "-Map -".
   if (this->print_map() && !this->user_set_Map())
     {
@@ -1213,6 +1225,13 @@ General_options::finalize()
 	       program_name);
 #endif
 
+#ifndef HAVE_ZSTD
+  if (strcmp(this->compress_debug_sections(), "zstd") == 0)
+    gold_fatal(_("cannot use --compress-debug-sections=zstd: "
+		 "%s was compiled without zstd support"),
+	       program_name);
+#endif
+
   std::string libpath;
   if (this->user_set_Y())
     {
@@ -1329,6 +1348,41 @@ General_options::finalize()
 		 "[0.0, 1.0)"),
 	       this->hash_bucket_empty_fraction());
 
+  if (this->hash_bloom_shift() > 31)
+    gold_fatal(_("--hash-bloom-shift value %u out of range [1, 31]"),
+	       this->hash_bloom_shift());
+
+  // With 64-bit words, 1 << 25 words is a 1 << 31 bit filter, the
+  // largest that the 32-bit mask computation can represent.
+  if (this->hash_bloom_words() > (1 << 25)
+      || (this->hash_bloom_words() & (this->hash_bloom_words() - 1)) != 0)
+    gold_fatal(_("--hash-bloom-words value %u is not a power of 2 "
+		 "no larger than %u"),
+	       this->hash_bloom_words(), 1U << 25);
+
+  if (this->call_graph_ordering_file() != NULL
+      && this->section_ordering_file() != NULL)
+    gold_fatal(_("--call-graph-ordering-file and --section-ordering-file "
+		 "are incompatible"));
+
+  // --hot-symbols-file implies --hot-segment.
+  if (this->hot_symbols_file() != NULL)
+    this->set_hot_segment(true);
+
+  if (this->hot_segment())
+    {
+      if (this->hot_symbols_file() == NULL
+	  && this->call_graph_ordering_file() == NULL)
+	gold_fatal(_("--hot-segment requires --hot-symbols-file or "
+		     "--call-graph-ordering-file"));
+      if (this->relocatable())
+	gold_fatal(_("-r and --hot-segment are incompatible"));
+      uint64_t align = this->hot_segment_align();
+      if (align == 0 || (align & (align - 1)) != 0)
+	gold_fatal(_("--hot-segment-align value 0x%llx is not a power of 2"),
+		   static_cast<unsigned long long>(align));
+    }
+
   if (this->implicit_incremental_ && this->incremental_mode_ == INCREMENTAL_OFF)
     gold_fatal(_("Options --incremental-changed, --incremental-unchanged, "
 		 "--incremental-unknown require the use of --incremental"));
@@ -1366,6 +1420,11 @@ General_options::finalize()
 			 "incremental link"));
 	  this->set_compress_debug_sections("none");
 	}
+      if (this->hot_segment())
+	{
+	  gold_warning(_("ignoring --hot-segment for an incremental link"));
+	  this->set_hot_segment(false);
+	}
     }
 
   // --rosegment-gap implies --rosegment.
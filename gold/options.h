@@ -698,6 +698,10 @@ class General_options
 	      N_("(aarch64 only) Do not apply link-time values "
 		 "for dynamic relocations"));
 
+  DEFINE_string(archive_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Cache archive symbol tables in DIRECTORY"),
+		N_("DIRECTORY"));
+
   DEFINE_bool(as_needed, options::TWO_DASHES, '\0', false,
 	      N_("Use DT_NEEDED only for shared libraries that are used"),
 	      N_("Use DT_NEEDED for all shared libraries"));
@@ -715,16 +719,22 @@ class General_options
   DEFINE_string(format, options::TWO_DASHES, 'b', "elf",
 		N_("Set input format"), ("[elf,binary]"));
 
+  DEFINE_bool(batch_relocs, options::TWO_DASHES, '\0', false,
+	      N_("Apply common relocations in batches (x86-64 only)"),
+	      N_("Apply each relocation separately"));
+
   DEFINE_bool(be8, options::TWO_DASHES, '\0', false,
 	      N_("Output BE8 format image"), NULL);
 
   DEFINE_optional_string(build_id, options::TWO_DASHES, '\0', "tree",
-			 N_("Generate build ID note"),
+			 N_("Generate build ID note; STYLE is tree, fast, "
+			    "sha1, md5, uuid, 0xHEX or none"),
 			 N_("[=STYLE]"));
 
   DEFINE_uint64(build_id_chunk_size_for_treehash,
 		options::TWO_DASHES, '\0', 2 << 20,
-		N_("Chunk size for '--build-id=tree'"), N_("SIZE"));
+		N_("Chunk size for '--build-id=tree' and '--build-id=fast'"),
+		N_("SIZE"));
 
   DEFINE_uint64(build_id_min_file_size_for_treehash, options::TWO_DASHES,
 		'\0', 40 << 20,
@@ -755,14 +765,24 @@ class General_options
 
   // c
 
+  DEFINE_string(call_graph_ordering_file, options::TWO_DASHES, '\0', NULL,
+		N_("Order functions using the call graph profile in FILENAME"),
+		N_("FILENAME"));
+
   DEFINE_bool(check_sections, options::TWO_DASHES, '\0', true,
 	      N_("Check segment addresses for overlaps"),
 	      N_("Do not check segment addresses for overlaps"));
 
   DEFINE_enum(compress_debug_sections, options::TWO_DASHES, '\0', "none",
 	      N_("Compress .debug_* sections in the output file"),
-	      ("[none,zlib,zlib-gnu,zlib-gabi]"),
-	      {"none", "zlib", "zlib-gnu", "zlib-gabi"});
+	      ("[none,zlib,zlib-gnu,zlib-gabi,zstd]"),
+	      {"none", "zlib", "zlib-gnu", "zlib-gabi", "zstd"});
+
+  DEFINE_uint64(compress_debug_sections_block_size, options::TWO_DASHES, '\0',
+		0,
+		N_("Compress debug sections larger than SIZE in blocks of "
+		   "SIZE bytes, in parallel (default 0: compress each "
+		   "section as a single block)"), N_("SIZE"));
 
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
@@ -925,6 +945,16 @@ class General_options
   DEFINE_string(soname, options::ONE_DASH, 'h', NULL,
 		N_("Set shared library name"), N_("FILENAME"));
 
+  DEFINE_uint(hash_bloom_shift, options::TWO_DASHES, '\0', 0,
+	      N_("Shift count for the second bit of the GNU hash bloom "
+		 "filter (default: log2 of the filter size in bits)"),
+	      N_("SHIFT"));
+  DEFINE_uint(hash_bloom_words, options::TWO_DASHES, '\0', 0,
+	      N_("Number of words in the GNU hash bloom filter, a power "
+		 "of 2 no larger than 33554432 (default: based on the "
+		 "number of symbols)"),
+	      N_("COUNT"));
+
   DEFINE_double(hash_bucket_empty_fraction, options::TWO_DASHES, '\0', 0.0,
 		N_("Min fraction of empty buckets in dynamic hash"),
 		N_("FRACTION"));
@@ -933,6 +963,18 @@ class General_options
 	      N_("Dynamic hash style"), N_("[sysv,gnu,both]"),
 	      {"sysv", "gnu", "both"});
 
+  DEFINE_bool(hot_segment, options::TWO_DASHES, '\0', false,
+	      N_("Place hot text and read-only data in a separate segment "
+		 "aligned for huge pages"),
+	      N_("Do not place hot sections in a separate segment"));
+  DEFINE_uint64(hot_segment_align, options::TWO_DASHES, '\0', 0x200000,
+		N_("Set the address alignment of the hot segment"),
+		N_("SIZE"));
+  DEFINE_string(hot_symbols_file, options::TWO_DASHES, '\0', NULL,
+		N_("Layout the sections defining the symbols listed in "
+		   "FILENAME in the hot segment (implies --hot-segment)"),
+		N_("FILENAME"));
+
   // i
 
   DEFINE_bool_alias(i, relocatable, options::EXACTLY_ONE_DASH, '\0',
@@ -986,6 +1028,11 @@ class General_options
 		    "(default 10)"),
 		 N_("PERCENT"));
 
+  DEFINE_bool(incremental_stats, options::TWO_DASHES, '\0', false,
+	      N_("Print how an incremental link was done, and why it "
+		 "fell back to a full link"),
+	      NULL);
+
   DEFINE_string(init, options::ONE_DASH, '\0', "_init",
 		N_("Call SYMBOL at load-time"), N_("SYMBOL"));
 
@@ -1040,11 +1087,21 @@ class General_options
 	      N_("Map the output file for writing"),
 	      N_("Do not map the output file for writing"));
 
+  DEFINE_bool(stream_output, options::TWO_DASHES, '\0', false,
+	      N_("Write the output file with pwrite and copy_file_range "
+		 "instead of mapping it"),
+	      N_("Map the output file for writing (default)"));
+
   DEFINE_bool(print_map, options::TWO_DASHES, 'M', false,
 	      N_("Write map file on standard output"), NULL);
 
   DEFINE_string(Map, options::ONE_DASH, '\0', NULL, N_("Write map file"),
 		N_("MAPFILENAME"));
+  DEFINE_enum(Map_format, options::TWO_DASHES, '\0', "text",
+	      N_("Map file format; with json or csv, --cref is written "
+		 "to standard output"),
+	      N_("[text,json,csv]"),
+	      {"text", "json", "csv"});
 
   // n
 
@@ -1089,6 +1146,11 @@ class General_options
   DEFINE_bool(p, options::ONE_DASH, 'p', false,
 	      N_("Ignored for ARM compatibility"), NULL);
 
+  DEFINE_bool(parallel_merge_strings, options::TWO_DASHES, '\0', false,
+	      N_("Add the strings of merged string sections in parallel"),
+	      N_("Add the strings of merged string sections in input "
+		 "order"));
+
   DEFINE_bool(pie, options::ONE_DASH, '\0', false,
 	      N_("Create a position independent executable"),
 	      N_("Do not create a position independent executable"));
@@ -1137,6 +1199,12 @@ class General_options
 	      N_("Use posix_fallocate to reserve space in the output file"),
 	      N_("Use fallocate or ftruncate to reserve space"));
 
+  DEFINE_uint(prefetch_inputs, options::TWO_DASHES, '\0', 4,
+	      N_("Read ahead the headers and symbols of the next COUNT "
+		 "input files (0 to disable); --stats times only the open "
+		 "and read calls, not page faults in mapped files"),
+	      N_("COUNT"));
+
   DEFINE_bool(preread_archive_symbols, options::TWO_DASHES, '\0', false,
 	      N_("Preread archive symbols when multi-threaded"), NULL);
 
@@ -1250,6 +1318,12 @@ class General_options
 		 "output sections"),
 	      N_("(PowerPC only) Each output section has its own stubs"));
 
+  DEFINE_bool(stub_scan_skip, options::TWO_DASHES, '\0', true,
+	      N_("(AArch64, ARM only) In later stub relaxation passes, skip "
+		 "sections whose branches can not have changed stubs"),
+	      N_("(AArch64, ARM only) Scan every section for stubs in "
+		 "every relaxation pass"));
+
   DEFINE_uint(split_stack_adjust_size, options::TWO_DASHES, '\0', 0x4000,
 	      N_("Stack size when -fsplit-stack function calls non-split"),
 	      N_("SIZE"));
@@ -1267,6 +1341,12 @@ class General_options
   DEFINE_bool(stats, options::TWO_DASHES, '\0', false,
 	      N_("Print resource usage statistics"), NULL);
 
+  DEFINE_uint(symbol_shards, options::TWO_DASHES, '\0', 0,
+	      N_("Split the symbol table into COUNT shards, and resolve "
+		 "the symbols of each large input file one shard per "
+		 "task; input files are still resolved one at a time"),
+	      N_("COUNT"));
+
   DEFINE_string(sysroot, options::TWO_DASHES, '\0', "",
 		N_("Set target system root directory"), N_("DIR"));
 
@@ -1274,6 +1354,15 @@ class General_options
 
   DEFINE_bool(trace, options::TWO_DASHES, 't', false,
 	      N_("Print the name of each input file"), NULL);
+  DEFINE_string(trace_file, options::TWO_DASHES, '\0', NULL,
+		N_("Write a trace of the tasks run by the link, in Chrome "
+		   "trace event format"),
+		N_("FILENAME"));
+
+  DEFINE_bool(tail_merge_strings, options::TWO_DASHES, '\0', false,
+	      N_("Share the suffixes of strings in merged string sections "
+		 "(implied by -O2)"),
+	      N_("Only merge identical strings in merged string sections"));
 
   DEFINE_bool(target1_abs, options::TWO_DASHES, '\0', false,
 	      N_("(ARM only) Force R_ARM_TARGET1 type to R_ARM_ABS32"),
@@ -1301,6 +1390,10 @@ class General_options
 	      N_("Number of threads to use in middle pass"), N_("COUNT"));
   DEFINE_uint(thread_count_final, options::TWO_DASHES, '\0', 0,
 	      N_("Number of threads to use in final pass"), N_("COUNT"));
+  DEFINE_bool(thread_work_stealing, options::TWO_DASHES, '\0', false,
+	      N_("Give each thread its own run queue and steal work "
+		 "from other threads when idle"),
+	      N_("Share a single run queue between all threads"));
 
   DEFINE_bool(tls_optimize, options::TWO_DASHES, '\0', true,
 	      N_("(PowerPC/64 only) Optimize GD/LD/IE code to IE/LE"),
@@ -1746,6 +1839,28 @@ class General_options
   orphan_handling_enum() const
   { return this->orphan_handling_enum_; }
 
+  enum Map_file_format
+  {
+    // The GNU ld compatible text format (default).
+    MAP_FORMAT_TEXT,
+    // A JSON document.
+    MAP_FORMAT_JSON,
+    // Comma separated values.
+    MAP_FORMAT_CSV
+  };
+
+  Map_file_format
+  Map_format_enum() const
+  { return this->Map_format_enum_; }
+
+  // Whether a map file is written in a machine readable format.
+  bool
+  structured_map() const
+  {
+    return (this->user_set_Map()
+	    && this->Map_format_enum_ != MAP_FORMAT_TEXT);
+  }
+
  private:
   // Don't copy this structure.
   General_options(const General_options&);
@@ -1805,6 +1920,10 @@ class General_options
   set_orphan_handling_enum(Orphan_handling value)
   { this->orphan_handling_enum_ = value; }
 
+  void
+  set_Map_format_enum(Map_file_format value)
+  { this->Map_format_enum_ = value; }
+
   // These are called by finalize() to set up the search-path correctly.
   void
   add_to_library_path_with_sysroot(const std::string& arg)
@@ -1872,6 +1991,8 @@ class General_options
   std::vector<Position_dependent_options*> options_stack_;
   // Orphan handling option, decoded to an enum value.
   Orphan_handling orphan_handling_enum_;
+  // Map file format option, decoded to an enum value.
+  Map_file_format Map_format_enum_;
 };
 
 // The position-dependent options.  We use this to store the state of
@@ -29,11 +29,17 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <deque>
+#include <map>
 
 #ifdef HAVE_SYS_MMAN_H
 #include <sys/mman.h>
 #endif
 
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+
 #include "libiberty.h"
 
 #include "dwarf.h"
@@ -2387,7 +2393,9 @@ Output_section::Output_section(const char* name, elfcpp::Elf_Word type,
     always_keeps_input_sections_(false),
     has_fixed_layout_(false),
     is_patch_space_allowed_(false),
+    has_trailing_patch_space_(false),
     is_unique_segment_(false),
+    is_hot_(false),
     tls_offset_(0),
     extra_segment_flags_(0),
     segment_alignment_(0),
@@ -3213,6 +3221,19 @@ Output_section::set_final_data_size()
   this->set_data_size(data_size);
 }
 
+// Return the amount of free space to leave after this section in a
+// full incremental link.
+
+off_t
+Output_section::trailing_patch_space() const
+{
+  if (!this->has_trailing_patch_space_ || !parameters->incremental_full())
+    return 0;
+  double pct = parameters->options().incremental_patch();
+  off_t extra = static_cast<off_t>(this->data_size() * pct);
+  return align_address(extra, this->addralign());
+}
+
 // Reset the address and file offset.
 
 void
@@ -4068,6 +4089,18 @@ Output_section::print_merge_stats()
     p->print_merge_stats(this->name_);
 }
 
+// Queue tasks to finish adding the input sections of merge sections.
+
+void
+Output_section::queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  Input_section_list::iterator p;
+  for (p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    p->queue_merge_tasks(workqueue, blocker);
+}
+
 // Set a fixed layout for the section.  Used for incremental update links.
 
 void
@@ -4519,6 +4552,7 @@ Output_segment::set_section_list_addresses(Layout* layout, bool reset,
 
   off_t off = startoff;
   off_t foff = *pfoff;
+  off_t maxfoff = foff;
   for (Output_data_list::iterator p = pdl->begin();
        p != pdl->end();
        ++p)
@@ -4662,6 +4696,11 @@ Output_segment::set_section_list_addresses(Layout* layout, bool reset,
       if (!is_tls || !is_bss)
 	off += (*p)->data_size();
 
+      // In a full incremental link, leave room for sections which are
+      // regenerated by each update to grow.
+      if ((*p)->is_section())
+	off += (*p)->output_section()->trailing_patch_space();
+
       // We don't allocate space in the file for SHT_NOBITS sections,
       // unless a script has force-placed one in the middle of a segment.
       if (!is_bss)
@@ -4669,6 +4708,10 @@ Output_segment::set_section_list_addresses(Layout* layout, bool reset,
 
       if (off > maxoff)
 	maxoff = off;
+      // In an incremental update the sections need not be in file
+      // order, so the file image extends to the highest offset.
+      if (foff > maxfoff)
+	maxfoff = foff;
 
       if ((*p)->is_section())
 	{
@@ -4678,7 +4721,7 @@ Output_segment::set_section_list_addresses(Layout* layout, bool reset,
     }
 
   *poff = maxoff;
-  *pfoff = foff;
+  *pfoff = maxfoff;
   return addr + (maxoff - startoff);
 }
 
@@ -4976,6 +5019,316 @@ Output_segment::print_section_list_to_mapfile(Mapfile* mapfile,
     (*p)->print_to_mapfile(mapfile);
 }
 
+// Write LEN bytes at DATA to OFFSET in the descriptor O of the output
+// file NAME.
+
+static void
+gold_pwrite(const char* name, int o, off_t offset, const void* data,
+	    size_t len)
+{
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  while (len > 0)
+    {
+      ssize_t bytes = ::pwrite(o, p, len, offset);
+      if (bytes < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  gold_fatal(_("%s: pwrite: %s"), name, strerror(errno));
+	}
+      if (bytes == 0)
+	gold_fatal(_("%s: pwrite: unexpected 0 return-value"), name);
+      p += bytes;
+      offset += bytes;
+      len -= bytes;
+    }
+}
+
+// Write the output view VIEW, of SIZE bytes, to START in the
+// descriptor O of the output file NAME.  A view is normally written
+// in full.  If OVERLAPPED, another view covers part of the same bytes
+// of the file, as the x86-64 PLT has a view of all of .got.plt but
+// fills in only the entries after the first three.  Each view was
+// zero-filled by Output_file::get_output_view, and the file reads as
+// zeroes where it was not written, so in that case only the bytes
+// which are not zero are written, and the views do not clobber each
+// other.
+
+static void
+gold_pwrite_view(const char* name, int o, off_t start,
+		 const unsigned char* view, size_t size, bool overlapped)
+{
+  if (!overlapped)
+    {
+      gold_pwrite(name, o, start, view, size);
+      return;
+    }
+
+  size_t i = 0;
+  while (i < size)
+    {
+      while (i < size && view[i] == 0)
+	++i;
+      const size_t begin = i;
+      while (i < size && view[i] != 0)
+	++i;
+      if (i > begin)
+	gold_pwrite(name, o, start + begin, view + begin, i - begin);
+    }
+}
+
+// With --stream-output, the parts of the output file covered by the
+// views handed out so far.  The ranges are kept disjoint: a view
+// which overlaps other views is merged with them into one range
+// marked as overlapped, and every view in that range is written with
+// only its bytes which are not zero.  This is done when the view is
+// written, so a view written in full before an overlapping view was
+// handed out lands first, and the later view only adds to it.
+
+class Output_file_ranges
+{
+ public:
+  Output_file_ranges()
+    : lock_(), ranges_()
+  { }
+
+  // Record that SIZE bytes at START are written by a view.  Return
+  // whether they overlap bytes written by another view.
+  bool
+  add(off_t start, size_t size);
+
+  // Return whether the view of SIZE bytes at START, which must have
+  // been recorded by add, overlaps another view.
+  bool
+  is_overlapped(off_t start, size_t size);
+
+ private:
+  // The end of a range, and whether more than one view covers it.
+  struct Range
+  {
+    Range(off_t a_end, bool a_overlapped)
+      : end(a_end), overlapped(a_overlapped)
+    { }
+
+    off_t end;
+    bool overlapped;
+  };
+
+  // Map from the start of a range to the range.
+  typedef std::map<off_t, Range> Ranges;
+
+  // Lock for ranges_, since views are handed out by several threads.
+  Lock lock_;
+  // The disjoint ranges.
+  Ranges ranges_;
+};
+
+bool
+Output_file_ranges::add(off_t start, size_t size)
+{
+  if (size == 0)
+    return false;
+  off_t end = start + static_cast<off_t>(size);
+
+  Hold_lock hl(this->lock_);
+
+  // Find the first range which ends after START.
+  Ranges::iterator p = this->ranges_.upper_bound(start);
+  if (p != this->ranges_.begin())
+    {
+      Ranges::iterator prev = p;
+      --prev;
+      if (prev->second.end > start)
+	p = prev;
+    }
+
+  if (p == this->ranges_.end() || p->first >= end)
+    {
+      this->ranges_.insert(std::make_pair(start, Range(end, false)));
+      return false;
+    }
+
+  // Merge all the ranges which overlap this one.
+  off_t merged_start = std::min(start, p->first);
+  off_t merged_end = end;
+  while (p != this->ranges_.end() && p->first < end)
+    {
+      merged_end = std::max(merged_end, p->second.end);
+      this->ranges_.erase(p++);
+    }
+  this->ranges_.insert(std::make_pair(merged_start,
+				      Range(merged_end, true)));
+  return true;
+}
+
+bool
+Output_file_ranges::is_overlapped(off_t start, size_t size)
+{
+  if (size == 0)
+    return false;
+
+  Hold_lock hl(this->lock_);
+  Ranges::iterator p = this->ranges_.upper_bound(start);
+  gold_assert(p != this->ranges_.begin());
+  --p;
+  gold_assert(p->second.end >= start + static_cast<off_t>(size));
+  return p->second.overlapped;
+}
+
+#ifdef ENABLE_THREADS
+
+// With --stream-output and --threads, the output views are written by
+// a thread of their own, so that the threads which fill them in do
+// not wait for the writes.  The number of bytes waiting to be written
+// is bounded, so that the views of a large output file are not all
+// held in memory at once.
+
+class Output_file_writer
+{
+ public:
+  Output_file_writer(const char* name, int o);
+
+  // Queue VIEW, of SIZE bytes, to be written at START in the file.
+  // OVERLAPPED is passed to gold_pwrite_view.  The writer frees VIEW
+  // once it is written.
+  void
+  queue(off_t start, size_t size, unsigned char* view, bool overlapped);
+
+  // Wait until all the queued views have been written.
+  void
+  flush();
+
+  // Write the remaining views and stop the thread.
+  void
+  finish();
+
+ private:
+  // The maximum number of bytes waiting to be written.  A single
+  // view larger than this is queued when nothing else is waiting.
+  static const size_t max_queued_bytes = 64 * 1024 * 1024;
+
+  // A view waiting to be written.
+  struct Pending_write
+  {
+    Pending_write(off_t a_start, size_t a_size, unsigned char* a_view,
+		  bool a_overlapped)
+      : start(a_start), size(a_size), view(a_view), overlapped(a_overlapped)
+    { }
+
+    off_t start;
+    size_t size;
+    unsigned char* view;
+    bool overlapped;
+  };
+
+  // The function passed to pthread_create.
+  static void*
+  thread_body(void*);
+
+  // Write views until finish is called.
+  void
+  run();
+
+  // The name of the output file.
+  const char* name_;
+  // The output file descriptor.
+  int o_;
+  // Lock for the fields below.
+  Lock lock_;
+  // Signalled when a view is queued, or when the thread should stop.
+  Condvar queued_;
+  // Signalled when a view has been written.
+  Condvar written_;
+  // The views waiting to be written.
+  std::deque<Pending_write> queue_;
+  // The number of bytes queued and not yet written, including the
+  // view being written.
+  size_t queued_bytes_;
+  // True when finish has been called.
+  bool stopping_;
+  // The writer thread.
+  pthread_t tid_;
+};
+
+Output_file_writer::Output_file_writer(const char* name, int o)
+  : name_(name), o_(o), lock_(), queued_(this->lock_),
+    written_(this->lock_), queue_(), queued_bytes_(0), stopping_(false)
+{
+  int err = pthread_create(&this->tid_, NULL,
+			   &Output_file_writer::thread_body,
+			   reinterpret_cast<void*>(this));
+  if (err != 0)
+    gold_fatal(_("pthread_create failed: %s"), strerror(err));
+}
+
+void*
+Output_file_writer::thread_body(void* arg)
+{
+  static_cast<Output_file_writer*>(arg)->run();
+  return NULL;
+}
+
+void
+Output_file_writer::queue(off_t start, size_t size, unsigned char* view,
+			  bool overlapped)
+{
+  Hold_lock hl(this->lock_);
+  while (this->queued_bytes_ > 0
+	 && this->queued_bytes_ + size > max_queued_bytes)
+    this->written_.wait();
+  this->queue_.push_back(Pending_write(start, size, view, overlapped));
+  this->queued_bytes_ += size;
+  this->queued_.signal();
+}
+
+void
+Output_file_writer::flush()
+{
+  Hold_lock hl(this->lock_);
+  while (this->queued_bytes_ > 0)
+    this->written_.wait();
+}
+
+void
+Output_file_writer::finish()
+{
+  {
+    Hold_lock hl(this->lock_);
+    this->stopping_ = true;
+    this->queued_.signal();
+  }
+  int err = pthread_join(this->tid_, NULL);
+  if (err != 0)
+    gold_fatal(_("pthread_join failed: %s"), strerror(err));
+}
+
+void
+Output_file_writer::run()
+{
+  Hold_lock hl(this->lock_);
+  while (true)
+    {
+      while (this->queue_.empty() && !this->stopping_)
+	this->queued_.wait();
+      if (this->queue_.empty())
+	break;
+
+      Pending_write pw(this->queue_.front());
+      this->queue_.pop_front();
+
+      this->lock_.release();
+      gold_pwrite_view(this->name_, this->o_, pw.start, pw.view, pw.size,
+		       pw.overlapped);
+      delete[] pw.view;
+      this->lock_.acquire();
+
+      this->queued_bytes_ -= pw.size;
+      this->written_.broadcast();
+    }
+}
+
+#endif // defined(ENABLE_THREADS)
+
 // Output_file methods.
 
 Output_file::Output_file(const char* name)
@@ -4985,7 +5338,11 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    is_streaming_(false),
+    copy_file_range_failed_(false),
+    ranges_(NULL),
+    writer_(NULL)
 {
 }
 
@@ -5135,14 +5492,221 @@ Output_file::open(off_t file_size)
 	}
     }
 
+  // An incremental update patches the existing file in place, so it
+  // always maps it.
+  if (parameters->options().stream_output()
+      && !parameters->incremental()
+      && this->open_stream())
+    return;
+
   this->map();
 }
 
+// Set up the file for --stream-output.  Return false if the file is
+// not a regular file, in which case we map an anonymous buffer as
+// usual.
+
+bool
+Output_file::open_stream()
+{
+  const int o = this->o_;
+  struct stat statbuf;
+  if (o == STDOUT_FILENO || o == STDERR_FILENO
+      || this->is_temporary_
+      || ::fstat(o, &statbuf) != 0
+      || !S_ISREG(statbuf.st_mode))
+    return false;
+
+  // As in map_no_anonymous, reserve the disk space.  This also sets
+  // the size of the file, so that any part of it which is never
+  // written reads as zeroes.
+  int err = gold_fallocate(o, 0, this->file_size_);
+  if (err != 0)
+    gold_fatal(_("%s: %s"), this->name_, strerror(err));
+
+  this->is_streaming_ = true;
+  this->ranges_ = new Output_file_ranges();
+#ifdef ENABLE_THREADS
+  if (parameters->options().threads())
+    this->writer_ = new Output_file_writer(this->name_, o);
+#endif
+  return true;
+}
+
+// Write LEN bytes at DATA to OFFSET in the file with --stream-output.
+// This is written like an output view, so that it is ordered with the
+// views queued for the writer thread.
+
+void
+Output_file::stream_write(off_t offset, const void* data, size_t len)
+{
+  unsigned char* view = this->stream_output_view(offset, len);
+  memcpy(view, data, len);
+  this->stream_write_view(offset, len, view);
+}
+
+// Get an output view with --stream-output: a zero-filled buffer which
+// is written to the file when it is released.
+
+unsigned char*
+Output_file::stream_output_view(off_t start, size_t size)
+{
+  gold_assert(start >= 0
+	      && start + static_cast<off_t>(size) <= this->file_size_);
+  this->ranges_->add(start, size);
+  return new unsigned char[size]();
+}
+
+// Write an output view with --stream-output.  The view was allocated
+// by stream_output_view, and is freed once it is written.
+
+void
+Output_file::stream_write_view(off_t start, size_t size, unsigned char* view)
+{
+  if (size > 0)
+    {
+      bool overlapped = this->ranges_->is_overlapped(start, size);
+#ifdef ENABLE_THREADS
+      if (this->writer_ != NULL)
+	{
+	  this->writer_->queue(start, size, view, overlapped);
+	  return;
+	}
+#endif
+      gold_pwrite_view(this->name_, this->o_, start, view, size, overlapped);
+    }
+  delete[] view;
+}
+
+// Map SIZE bytes at START in the file with --stream-output, for the
+// input views and the input/output views.  Several relocation tasks
+// may have input/output views of the same part of the file, so these
+// share the pages of the file rather than being separate buffers.
+// The output views written so far must be in the file first.
+
+unsigned char*
+Output_file::map_view(off_t start, size_t size, bool writable)
+{
+  gold_assert(start >= 0
+	      && start + static_cast<off_t>(size) <= this->file_size_);
+
+#ifdef ENABLE_THREADS
+  if (this->writer_ != NULL)
+    this->writer_->flush();
+#endif
+
+  // Views written later which overlap this one must not clobber what
+  // is written through the mapping.
+  if (writable)
+    this->ranges_->add(start, size);
+
+  const off_t page_size = ::sysconf(_SC_PAGESIZE);
+  const off_t map_start = start & ~(page_size - 1);
+  const size_t map_size = std::max(size + (start - map_start),
+				   static_cast<size_t>(1));
+  int prot = PROT_READ;
+  if (writable)
+    prot |= PROT_WRITE;
+  void* base = ::mmap(NULL, map_size, prot, MAP_SHARED, this->o_, map_start);
+  if (base == MAP_FAILED)
+    gold_fatal(_("%s: mmap: %s"), this->name_, strerror(errno));
+  return static_cast<unsigned char*>(base) + (start - map_start);
+}
+
+// Unmap a view returned by map_view.
+
+void
+Output_file::unmap_view(off_t start, size_t size, unsigned char* view)
+{
+  const off_t page_size = ::sysconf(_SC_PAGESIZE);
+  const off_t map_start = start & ~(page_size - 1);
+  const size_t map_size = std::max(size + (start - map_start),
+				   static_cast<size_t>(1));
+  if (::munmap(view - (start - map_start), map_size) < 0)
+    gold_error(_("%s: munmap: %s"), this->name_, strerror(errno));
+}
+
+// Copy LEN bytes at IN_OFFSET in DESCRIPTOR to OFFSET in the output
+// file with copy_file_range, which copies the data within the kernel,
+// or shares the blocks on file systems which support reflinks.  This
+// is only done with --stream-output, since otherwise the file is
+// mapped and we would have to write through the mapping.
+
+#ifdef HAVE_COPY_FILE_RANGE
+
+bool
+Output_file::copy_from_file(int descriptor, off_t in_offset, off_t offset,
+			    size_t len)
+{
+  if (!this->is_streaming_ || this->copy_file_range_failed_)
+    return false;
+
+  gold_assert(offset >= 0
+	      && offset + static_cast<off_t>(len) <= this->file_size_);
+
+  // The copy is written at once, so it could land before a queued
+  // view which overlaps it.  Let the caller write it as a view.
+  if (this->ranges_->add(offset, len))
+    return false;
+
+  loff_t in = in_offset;
+  loff_t out = offset;
+  while (len > 0)
+    {
+      ssize_t bytes = ::copy_file_range(descriptor, &in, this->o_, &out,
+					len, 0);
+      if (bytes < 0 && errno == EINTR)
+	continue;
+      if (bytes <= 0)
+	{
+	  // If the kernel or the file system can not do this at all,
+	  // don't try again.  Other failures, such as copying between
+	  // file systems, only affect this input file.
+	  if (bytes < 0 && (errno == ENOSYS || errno == EOPNOTSUPP))
+	    this->copy_file_range_failed_ = true;
+	  return false;
+	}
+      len -= bytes;
+    }
+  return true;
+}
+
+#else // !defined(HAVE_COPY_FILE_RANGE)
+
+bool
+Output_file::copy_from_file(int, off_t, off_t, size_t)
+{
+  return false;
+}
+
+#endif // !defined(HAVE_COPY_FILE_RANGE)
+
 // Resize the output file.
 
 void
 Output_file::resize(off_t file_size)
 {
+  // With --stream-output, just change the size of the file.  Make
+  // sure no queued write lands past the end of a smaller file.
+  if (this->is_streaming_)
+    {
+#ifdef ENABLE_THREADS
+      if (this->writer_ != NULL)
+	this->writer_->flush();
+#endif
+      if (file_size > this->file_size_)
+	{
+	  int err = gold_fallocate(this->o_, this->file_size_,
+				   file_size - this->file_size_);
+	  if (err != 0)
+	    gold_fatal(_("%s: %s"), this->name_, strerror(err));
+	}
+      else if (::ftruncate(this->o_, file_size) < 0)
+	gold_fatal(_("%s: ftruncate: %s"), this->name_, strerror(errno));
+      this->file_size_ = file_size;
+      return;
+    }
+
   // If the mmap is mapping an anonymous memory buffer, this is easy:
   // just mremap to the new size.  If it's mapping to a file, we want
   // to unmap to flush to the file, then remap after growing the file.
@@ -5293,8 +5857,22 @@ Output_file::unmap()
 void
 Output_file::close()
 {
+  // With --stream-output, wait for the remaining views to be written.
+  if (this->is_streaming_)
+    {
+#ifdef ENABLE_THREADS
+      if (this->writer_ != NULL)
+	{
+	  this->writer_->finish();
+	  delete this->writer_;
+	  this->writer_ = NULL;
+	}
+#endif
+      delete this->ranges_;
+      this->ranges_ = NULL;
+    }
   // If the map isn't file-backed, we need to write it now.
-  if (this->map_is_anonymous_ && !this->is_temporary_)
+  else if (this->map_is_anonymous_ && !this->is_temporary_)
     {
       size_t bytes_to_write = this->file_size_;
       size_t offset = 0;
@@ -5313,7 +5891,8 @@ Output_file::close()
 	    }
 	}
     }
-  this->unmap();
+  if (!this->is_streaming_)
+    this->unmap();
 
   // We don't close stdout or stderr
   if (this->o_ != STDOUT_FILENO
@@ -42,6 +42,8 @@ class Output_merge_base;
 class Output_section;
 class Relocatable_relocs;
 class Target;
+class Output_file_writer;
+class Output_file_ranges;
 template<int size, bool big_endian>
 class Sized_target;
 template<int size, bool big_endian>
@@ -94,13 +96,21 @@ class Output_file
   filename()
   { return this->name_; }
 
-  // We currently always use mmap which makes the view handling quite
-  // simple.  In the future we may support other approaches.
+  // Normally the whole file is mapped into memory, which makes the
+  // view handling quite simple.  With --stream-output, an output view
+  // is a separate buffer which is written to the file with pwrite
+  // when it is released, and input views map just the part of the
+  // file they cover.
 
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    if (this->is_streaming_)
+      this->stream_write(offset, data, len);
+    else
+      memcpy(this->base_ + offset, data, len);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
   // the file and the size.
@@ -109,36 +119,68 @@ class Output_file
   {
     gold_assert(start >= 0
 		&& start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streaming_)
+      return this->stream_output_view(start, size);
     return this->base_ + start;
   }
 
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t start, size_t size, unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->stream_write_view(start, size, view);
+  }
 
   // Get a read/write buffer.  This is used when we want to write part
   // of the file, read it in, and write it again.
   unsigned char*
   get_input_output_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->is_streaming_)
+      return this->map_view(start, size, true);
+    return this->get_output_view(start, size);
+  }
 
   // Write a read/write buffer back to the file.
   void
-  write_input_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_input_output_view(off_t start, size_t size, unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->unmap_view(start, size, view);
+  }
 
   // Get a read buffer.  This is used when we just want to read part
   // of the file back it in.
   const unsigned char*
   get_input_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->is_streaming_)
+      return this->map_view(start, size, false);
+    return this->get_output_view(start, size);
+  }
 
   // Release a read bfufer.
   void
-  free_input_view(off_t, size_t, const unsigned char*)
-  { }
+  free_input_view(off_t start, size_t size, const unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->unmap_view(start, size, const_cast<unsigned char*>(view));
+  }
+
+  // Copy LEN bytes at IN_OFFSET in the file DESCRIPTOR to OFFSET in
+  // the output file, without reading them into memory.  Return false
+  // if the data was not copied, in which case the caller must write
+  // it some other way.
+  bool
+  copy_from_file(int descriptor, off_t in_offset, off_t offset, size_t len);
+
+  // Return whether the output file is being written with
+  // --stream-output.
+  bool
+  is_streaming() const
+  { return this->is_streaming_; }
 
  private:
   // Map the file into memory or, if that fails, allocate anonymous
@@ -158,6 +200,33 @@ class Output_file
   void
   unmap();
 
+  // Set up the file for --stream-output.  Return false if it can not
+  // be written that way.
+  bool
+  open_stream();
+
+  // Write LEN bytes at DATA to OFFSET in the file with
+  // --stream-output.
+  void
+  stream_write(off_t offset, const void* data, size_t len);
+
+  // Get an output view with --stream-output.
+  unsigned char*
+  stream_output_view(off_t start, size_t size);
+
+  // Write an output view with --stream-output, and free it.
+  void
+  stream_write_view(off_t start, size_t size, unsigned char* view);
+
+  // Map SIZE bytes at START in the file with --stream-output, after
+  // waiting for pending writes.
+  unsigned char*
+  map_view(off_t start, size_t size, bool writable);
+
+  // Unmap a view returned by map_view.
+  void
+  unmap_view(off_t start, size_t size, unsigned char* view);
+
   // File name.
   const char* name_;
   // File descriptor.
@@ -172,6 +241,17 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // True if the file is written with --stream-output rather than
+  // being mapped.
+  bool is_streaming_;
+  // True if copy_file_range failed for this file, so that we stop
+  // trying it.
+  bool copy_file_range_failed_;
+  // The parts of the file covered by views with --stream-output.
+  Output_file_ranges* ranges_;
+  // The thread which writes output views with --stream-output, or
+  // NULL if they are written by the thread which releases them.
+  Output_file_writer* writer_;
 };
 
 // An abtract class for data which has to go into the output file.
@@ -812,6 +892,14 @@ class Output_section_data : public Output_data
   print_merge_stats(const char* section_name)
   { this->do_print_merge_stats(section_name); }
 
+  // Queue tasks to finish adding the input sections whose contents
+  // were deferred by --parallel-merge-strings.  The tasks hold
+  // BLOCKER until they are done.  This should only be called for
+  // SHF_MERGE sections.
+  void
+  queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+  { this->do_queue_merge_tasks(workqueue, blocker); }
+
  protected:
   // The child class must implement do_write.
 
@@ -845,6 +933,11 @@ class Output_section_data : public Output_data
   do_print_merge_stats(const char*)
   { gold_unreachable(); }
 
+  // Queue merge tasks.
+  virtual void
+  do_queue_merge_tasks(Workqueue*, Task_token*)
+  { }
+
   // Return the required alignment.
   uint64_t
   do_addralign() const
@@ -3615,6 +3708,16 @@ class Output_section : public Output_data
   set_is_unique_segment()
   { this->is_unique_segment_ = true; }
 
+  // Whether this output section goes into the hot segment, for
+  // --hot-segment.
+  bool
+  is_hot() const
+  { return this->is_hot_; }
+
+  void
+  set_is_hot()
+  { this->is_hot_ = true; }
+
   uint64_t extra_segment_flags() const
   { return this->extra_segment_flags_; }
 
@@ -3641,6 +3744,11 @@ class Output_section : public Output_data
   void
   create_postprocessing_buffer();
 
+  // Return whether the postprocessing buffer has been created.
+  bool
+  has_postprocessing_buffer() const
+  { return this->postprocessing_buffer_ != NULL; }
+
   // If a section requires postprocessing, this is the size of the
   // buffer to which relocations should be applied.
   off_t
@@ -3961,6 +4069,16 @@ class Output_section : public Output_data
 	this->u2_.posd->print_merge_stats(section_name);
     }
 
+    // Queue tasks to finish adding the input sections of merge
+    // sections.
+    void
+    queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+    {
+      if (this->shndx_ == MERGE_DATA_SECTION_CODE
+	  || this->shndx_ == MERGE_STRING_SECTION_CODE)
+	this->u2_.posd->queue_merge_tasks(workqueue, blocker);
+    }
+
    private:
     // Code values which appear in shndx_.  If the value is not one of
     // these codes, it is the input section index in the object file.
@@ -4056,6 +4174,16 @@ class Output_section : public Output_data
   const Output_relaxed_input_section*
   find_relaxed_input_section(const Relobj* object, unsigned int shndx) const;
 
+  // Build the fast look-up maps if they are not valid.  After this,
+  // find_relaxed_input_section may be called from several threads,
+  // until the input sections are changed.
+  void
+  prepare_lookup_maps() const
+  {
+    if (!this->lookup_maps_->is_valid())
+      this->build_lookup_maps();
+  }
+
   // Whether section offsets need adjustment due to relaxation.
   bool
   section_offsets_need_adjustment() const
@@ -4090,6 +4218,11 @@ class Output_section : public Output_data
   void
   print_merge_stats();
 
+  // Queue tasks to finish adding the input sections of merge
+  // sections.
+  void
+  queue_merge_tasks(Workqueue*, Task_token* blocker);
+
   // Set a fixed layout for the section.  Used for incremental update links.
   void
   set_fixed_layout(uint64_t sh_addr, off_t sh_offset, off_t sh_size,
@@ -4106,6 +4239,17 @@ class Output_section : public Output_data
   set_is_patch_space_allowed()
   { this->is_patch_space_allowed_ = true; }
 
+  // Set flag to leave free space after this section.  Used for full
+  // incremental links, for sections which are regenerated by each
+  // incremental update, such as the dynamic symbol table.
+  void
+  set_has_trailing_patch_space()
+  { this->has_trailing_patch_space_ = true; }
+
+  // Return the amount of free space to leave after this section.
+  off_t
+  trailing_patch_space() const;
+
   // Set a fill method to use for free space left in the output section
   // during incremental links.
   void
@@ -4611,8 +4755,12 @@ class Output_section : public Output_data
   bool has_fixed_layout_ : 1;
   // True if we can add patch space to this section.
   bool is_patch_space_allowed_ : 1;
+  // True if we leave free space after this section.
+  bool has_trailing_patch_space_ : 1;
   // True if this output section goes into a unique segment.
   bool is_unique_segment_ : 1;
+  // True if this output section goes into the hot segment.
+  bool is_hot_ : 1;
   // For SHT_TLS sections, the offset of this section relative to the base
   // of the TLS segment.
   uint64_t tls_offset_;
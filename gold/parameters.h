@@ -29,6 +29,7 @@ namespace gold
 class General_options;
 class Errors;
 class Timer;
+class Trace;
 class Target;
 template<int size, bool big_endian>
 class Sized_target;
@@ -60,6 +61,9 @@ class Parameters
   void
   set_timer(Timer* timer);
 
+  void
+  set_trace(Trace* trace);
+
   void
   set_options(const General_options* options);
 
@@ -79,6 +83,11 @@ class Parameters
   timer() const
   { return this->timer_; }
 
+  // Return the trace object, or NULL if --trace-file was not used.
+  Trace*
+  trace() const
+  { return this->trace_; }
+
   // Whether the options are valid.  This should not normally be
   // called, but it is needed by gold_exit.
   bool
@@ -190,6 +199,7 @@ class Parameters
 
   Errors* errors_;
   Timer* timer_;
+  Trace* trace_;
   const General_options* options_;
   Target* target_;
   bool doing_static_link_valid_;
@@ -211,6 +221,9 @@ set_parameters_errors(Errors* errors);
 extern void
 set_parameters_timer(Timer* timer);
 
+extern void
+set_parameters_trace(Trace* trace);
+
 extern void
 set_parameters_options(const General_options* options);
 
@@ -673,7 +673,8 @@ class Target_powerpc : public Sized_target<size, big_endian>
   { return !parameters->options().relocatable(); }
 
   bool
-  do_relax(int, const Input_objects*, Symbol_table*, Layout*, const Task*);
+  do_relax(int, const Input_objects*, Symbol_table*, Layout*, Workqueue*,
+	   const Task*);
 
   void
   do_plt_fde_location(const Output_data*, unsigned char*,
@@ -3385,6 +3386,7 @@ Target_powerpc<size, big_endian>::do_relax(int pass,
 					   const Input_objects*,
 					   Symbol_table* symtab,
 					   Layout* layout,
+					   Workqueue*,
 					   const Task* task)
 {
   unsigned int prev_brlt_size = 0;
@@ -86,12 +86,23 @@ class Unblock_token : public Task
 
 // Class read_symbols.
 
+Input_prefetch* Read_symbols::input_prefetch;
+
 Read_symbols::~Read_symbols()
 {
   // The this_blocker_ and next_blocker_ pointers are passed on to the
   // Add_symbols task.
 }
 
+// Delete the object which reads ahead the input files.
+
+void
+Read_symbols::finish_input_prefetch()
+{
+  delete Read_symbols::input_prefetch;
+  Read_symbols::input_prefetch = NULL;
+}
+
 // If appropriate, issue a warning about skipping an incompatible
 // file.
 
@@ -272,6 +283,9 @@ Read_symbols::do_read_symbols(Workqueue* workqueue)
   if (this->input_argument_->is_lib())
     return this->do_lib_group(workqueue);
 
+  if (Read_symbols::input_prefetch != NULL)
+    Read_symbols::input_prefetch->reading(&this->input_argument_->file());
+
   Input_file* input_file = new Input_file(&this->input_argument_->file());
   if (!input_file->open(*this->dirpath_, this, &this->dirindex_))
     return false;
@@ -591,7 +605,7 @@ Add_symbols::locks(Task_locker* tl)
 // Add the symbols in the object to the symbol table.
 
 void
-Add_symbols::run(Workqueue*)
+Add_symbols::run(Workqueue* workqueue)
 {
   Pluginobj* pluginobj = this->object_->pluginobj();
   if (pluginobj != NULL)
@@ -632,7 +646,12 @@ Add_symbols::run(Workqueue*)
 					    this->library_, script_info);
 	}
       this->object_->layout(this->symtab_, this->layout_, this->sd_);
+      // Large objects may leave their symbols to tasks which resolve
+      // them in parallel.  Those tasks hold up the next input file.
+      this->symtab_->set_allow_sharded_add(this->next_blocker_ != NULL);
       this->object_->add_symbols(this->symtab_, this->sd_, this->layout_);
+      this->symtab_->set_allow_sharded_add(false);
+      this->symtab_->queue_sharded_add(workqueue, this->next_blocker_);
       this->object_->discard_decompressed_sections();
       delete this->sd_;
       this->sd_ = NULL;
@@ -713,7 +732,12 @@ Check_script::run(Workqueue*)
   Script_info* script_info =
       this->ibase_->get_script_info(this->input_file_index_);
   Timespec mtime = this->input_reader_->get_mtime();
-  incremental_inputs->report_script(script_info, arg_serial, mtime);
+  // If the script changed compatibly, record its new time stamp, so
+  // that the next update does not check it again.
+  if (this->ibase_->file_has_changed(this->input_file_index_))
+    get_mtime(this->filename_.c_str(), &mtime);
+  incremental_inputs->report_script(script_info, arg_serial, mtime,
+				    this->input_reader_->get_script_signature());
 }
 
 // Class Check_library.
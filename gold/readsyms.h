@@ -82,6 +82,16 @@ class Read_symbols : public Task
 	  int dirindex, Mapfile*, const Input_argument*, Input_group*,
 	  Task_token* next_blocker);
 
+  // Set the object which reads ahead the input files.
+  static void
+  set_input_prefetch(Input_prefetch* input_prefetch)
+  { Read_symbols::input_prefetch = input_prefetch; }
+
+  // Delete the object which reads ahead the input files, if any,
+  // once all the input files have been read.
+  static void
+  finish_input_prefetch();
+
   // The standard Task methods.
 
   Task_token*
@@ -124,6 +134,9 @@ class Read_symbols : public Task
   Archive_member* member_;
   Task_token* this_blocker_;
   Task_token* next_blocker_;
+
+  // Reads ahead the input files named on the command line.
+  static Input_prefetch* input_prefetch;
 };
 
 // This Task handles adding the symbols to the symbol table.  These
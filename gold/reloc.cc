@@ -687,6 +687,27 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
   File_read::Read_multiple rm;
   bool is_sorted = true;
 
+  // With --stream-output, the contents of a non-allocated section
+  // without relocations, such as most debug sections, are copied to
+  // the output file without reading them into memory.  Find which
+  // sections have relocations.
+  std::vector<bool> has_relocs;
+  if (of->is_streaming())
+    {
+      has_relocs.resize(shnum, false);
+      const unsigned char* ps = pshdrs + This::shdr_size;
+      for (unsigned int i = 1; i < shnum; ++i, ps += This::shdr_size)
+	{
+	  typename This::Shdr shdr(ps);
+	  unsigned int sh_type = shdr.get_sh_type();
+	  if (sh_type != elfcpp::SHT_REL && sh_type != elfcpp::SHT_RELA)
+	    continue;
+	  unsigned int index = this->adjust_shndx(shdr.get_sh_info());
+	  if (index < shnum)
+	    has_relocs[index] = true;
+	}
+    }
+
   const unsigned char* p = pshdrs + This::shdr_size;
   for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
     {
@@ -810,6 +831,18 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
 	    view = of->get_input_output_view(view_start, view_size);
 	  else
 	    {
+	      if (!must_decompress
+		  && !has_relocs.empty()
+		  && !has_relocs[i]
+		  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
+		{
+		  int descriptor = this->input_file()->file().copy_descriptor();
+		  if (descriptor >= 0
+		      && of->copy_from_file(descriptor,
+					    this->offset() + shdr.get_sh_offset(),
+					    view_start, view_size))
+		    continue;
+		}
 	      view = of->get_output_view(view_start, view_size);
 	      if (!must_decompress)
 		{
@@ -490,6 +490,13 @@ class Target_s390 : public Sized_target<size, true>
   void
   emit_copy_reloc(Symbol_table*, Symbol*, Output_section*, off_t);
 
+  // Emit a dynamic relocation copied from the base file.
+  void
+  emit_dynamic_reloc_for_update(Symbol* gsym, unsigned int r_type,
+				Output_section* os, off_t offset,
+				typename elfcpp::Elf_types<size>::Elf_Swxword
+				  addend);
+
   // Apply an incremental relocation.
   void
   apply_relocation(const Relocate_info<size, true>* relinfo,
@@ -1986,6 +1993,21 @@ Target_s390<size>::emit_copy_reloc(
 				     this->rela_dyn_section(NULL));
 }
 
+// Emit a dynamic relocation copied from the base file.
+
+template<int size>
+void
+Target_s390<size>::emit_dynamic_reloc_for_update(
+    Symbol* gsym, unsigned int r_type, Output_section* os, off_t offset,
+    typename elfcpp::Elf_types<size>::Elf_Swxword addend)
+{
+  Reloc_section* rela_dyn = this->rela_dyn_section(NULL);
+  if (gsym == NULL)
+    rela_dyn->add_absolute(r_type, os, offset, addend);
+  else
+    rela_dyn->add_global(gsym, r_type, os, offset, addend);
+}
+
 // Create a GOT entry for the TLS module index.
 
 template<int size>
@@ -1098,6 +1098,17 @@ Script_options::Script_options()
 {
 }
 
+size_t
+Script_options::non_input_command_count() const
+{
+  return (this->symbol_assignments_.size()
+	  + this->assertions_.size()
+	  + this->symbol_references_.size()
+	  + this->version_script_info_.version_count()
+	  + (this->saw_sections_clause() ? 1 : 0)
+	  + (this->saw_phdrs_clause() ? 1 : 0));
+}
+
 // Returns true if NAME is on the list of symbol assignments waiting
 // to be processed.
 
@@ -1483,6 +1494,71 @@ class Parser_closure
   Script_info* script_info_;
 };
 
+// Add the input files in INPUTS to the signature data in *DATA.
+
+static void
+add_input_signature(const Input_argument& arg, std::string* data)
+{
+  if (arg.is_group())
+    {
+      data->push_back('(');
+      for (Input_file_group::const_iterator p = arg.group()->begin();
+	   p != arg.group()->end();
+	   ++p)
+	add_input_signature(*p, data);
+      data->push_back(')');
+      return;
+    }
+
+  gold_assert(arg.is_file());
+  const Input_file_argument& file(arg.file());
+  data->push_back(file.is_lib() ? 'l' : 'f');
+  data->append(file.name());
+  data->push_back('\0');
+  if (file.extra_search_path() != NULL)
+    data->append(file.extra_search_path());
+  data->push_back('\0');
+  const Position_dependent_options& posdep(file.options());
+  data->push_back(posdep.as_needed() ? 'n' : '-');
+  data->push_back(posdep.Bdynamic() ? 'd' : '-');
+  data->push_back(posdep.whole_archive() ? 'w' : '-');
+  data->push_back('0' + static_cast<int>(posdep.format_enum()));
+}
+
+// Parse the input script TEXT read from FILENAME, and return a
+// signature of the input files which it names, or 0 if it does
+// anything else.  The signature is recorded for an incremental link,
+// so that an update can accept a script which has been rewritten
+// without changing its effect.  We parse into a separate
+// Script_options, so that we can see exactly what the script does.
+
+static uint64_t
+script_signature(const std::string& text, const char* filename,
+		 const Position_dependent_options& posdep,
+		 bool is_in_sysroot)
+{
+  Lex lex(text.c_str(), text.length(), PARSING_LINKER_SCRIPT);
+  Script_options script_options;
+  Parser_closure closure(filename, posdep, false, false, is_in_sysroot,
+			 NULL, &script_options, &lex, false, NULL);
+  if (yyparse(&closure) != 0
+      || script_options.non_input_command_count() != 0)
+    return 0;
+
+  std::string data;
+  if (closure.saw_inputs())
+    for (Input_arguments::const_iterator p = closure.inputs()->begin();
+	 p != closure.inputs()->end();
+	 ++p)
+      add_input_signature(*p, &data);
+
+  unsigned char hash[8];
+  xxhash64_buffer(reinterpret_cast<const unsigned char*>(data.data()),
+		  data.size(), hash);
+  uint64_t signature = elfcpp::Swap_unaligned<64, false>::readval(hash);
+  return signature == 0 ? 1 : signature;
+}
+
 // FILE was found as an argument on the command line.  Try to read it
 // as a script.  Return true if the file was handled.
 
@@ -1504,14 +1580,7 @@ read_input_script(Workqueue* workqueue, Symbol_table* symtab, Layout* layout,
 
   Script_info* script_info = NULL;
   if (layout->incremental_inputs() != NULL)
-    {
-      const std::string& filename = input_file->filename();
-      Timespec mtime = input_file->file().get_mtime();
-      unsigned int arg_serial = input_argument->file().arg_serial();
-      script_info = new Script_info(filename);
-      layout->incremental_inputs()->report_script(script_info, arg_serial,
-						  mtime);
-    }
+    script_info = new Script_info(input_file->filename());
 
   Parser_closure closure(input_file->filename().c_str(),
 			 input_argument->file().options(),
@@ -1546,6 +1615,18 @@ read_input_script(Workqueue* workqueue, Symbol_table* symtab, Layout* layout,
     gold_error(_("%s: SECTIONS seen after other input files; try -T/--script"),
 	       input_file->filename().c_str());
 
+  if (script_info != NULL)
+    {
+      Timespec mtime = input_file->file().get_mtime();
+      unsigned int arg_serial = input_argument->file().arg_serial();
+      uint64_t signature = script_signature(input_string,
+					    input_file->filename().c_str(),
+					    input_argument->file().options(),
+					    input_file->is_in_sysroot());
+      layout->incremental_inputs()->report_script(script_info, arg_serial,
+						  mtime, signature);
+    }
+
   if (!closure.saw_inputs())
     return true;
 
@@ -1573,6 +1654,32 @@ read_input_script(Workqueue* workqueue, Symbol_table* symtab, Layout* layout,
   return true;
 }
 
+// Read the input script FILENAME again for an incremental update.
+
+bool
+input_script_signature(const char* filename,
+		       const Position_dependent_options& posdep,
+		       uint64_t* signature)
+{
+  Dirsearch dirsearch;
+  const Task* task = reinterpret_cast<const Task*>(-1);
+  Input_file_argument input_argument(filename,
+				     Input_file_argument::INPUT_FILE_TYPE_FILE,
+				     "", false, posdep);
+  Input_file input_file(&input_argument);
+  int dummy = 0;
+  if (!input_file.open(dirsearch, task, &dummy))
+    return false;
+
+  std::string input_string;
+  Lex::read_file(&input_file, &input_string);
+  input_file.file().unlock(task);
+
+  *signature = script_signature(input_string, filename, posdep,
+				input_file.is_in_sysroot());
+  return *signature != 0;
+}
+
 // Helper function for read_version_script(), read_commandline_script() and
 // script_include_directive().  Processes the given file in the mode indicated
 // by first_token and lex_mode.
@@ -41,6 +41,7 @@ namespace gold
 {
 
 class General_options;
+class Position_dependent_options;
 class Command_line;
 class Symbol_table;
 class Layout;
@@ -179,6 +180,11 @@ class Version_script_info
   empty() const
   { return this->version_trees_.empty(); }
 
+  // Return the number of versions defined so far.
+  size_t
+  version_count() const
+  { return this->version_trees_.size(); }
+
   // If there is a version associated with SYMBOL, return true, and
   // set *VERSION to the version, and *IS_GLOBAL to whether the symbol
   // should be global.  Otherwise, return false.
@@ -541,6 +547,12 @@ class Script_options
   saw_phdrs_clause() const
   { return this->script_sections_.saw_phdrs_clause(); }
 
+  // Return the number of commands seen so far which do something other
+  // than name input files.  This is used to decide whether an input
+  // script may change in an incremental update.
+  size_t
+  non_input_command_count() const;
+
   // Set section addresses using a SECTIONS clause.  Return the
   // segment which should hold the file header and segment headers;
   // this may return NULL, in which case the headers are not in a
@@ -589,6 +601,18 @@ read_input_script(Workqueue*, Symbol_table*, Layout*, Dirsearch*, int,
 		  const Input_argument*, Input_file*,
 		  Task_token* next_blocker, bool* used_next_blocker);
 
+// Read the input script FILENAME again, as it would be read by
+// read_input_script with options POSDEP, and set *SIGNATURE to a
+// signature of the input files which it names.  Return false if the
+// script can not be read, or if it does anything other than name
+// input files.  This is used to check whether an input script which
+// has changed since an incremental link still has the same effect.
+
+bool
+input_script_signature(const char* filename,
+		       const Position_dependent_options& posdep,
+		       uint64_t* signature);
+
 // FILE was found as an argument to --script (-T).
 // Read it as a script, and execute its contents immediately.
 
@@ -24,15 +24,172 @@
 
 #include <cstring>
 #include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "output.h"
 #include "parameters.h"
+#include "gold-threads.h"
 #include "stringpool.h"
 
 namespace gold
 {
 
+// Sorting strings to find suffixes.  When sorting into an ELF strtab,
+// we want to sort so that when one string is a suffix of another, we
+// always see the shorter string immediately after the longer string.
+// For example, we want to see these strings in this order:
+//   abcd
+//   cd
+//   d
+// When strings are not suffixes, we don't care what order they are
+// in, but we need to ensure that suffixes wind up next to each other.
+// So we do a reversed lexicographic sort on the reversed string.
+
+// Return whether the string S1 of length LEN1 sorts before the string
+// S2 of length LEN2.
+
+template<typename Stringpool_char>
+inline bool
+suffix_sort_before(const Stringpool_char* s1, size_t len1,
+		   const Stringpool_char* s2, size_t len2)
+{
+  const size_t minlen = len1 < len2 ? len1 : len2;
+  const Stringpool_char* p1 = s1 + len1 - 1;
+  const Stringpool_char* p2 = s2 + len2 - 1;
+  for (size_t i = minlen; i > 0; --i, --p1, --p2)
+    {
+      if (*p1 != *p2)
+	return *p1 > *p2;
+    }
+  return len1 > len2;
+}
+
+// Return the radix sort digit of the string S of length LEN at byte
+// DEPTH, counting from the end of the string.  The digits of a
+// character are its bytes from the most significant, adjusted so that
+// they compare as the characters do in suffix_sort_before.  Digit 0
+// means that the string has ended.
+
+template<typename Stringpool_char>
+inline unsigned int
+suffix_sort_digit(const Stringpool_char* s, size_t len, size_t depth)
+{
+  const size_t charsize = sizeof(Stringpool_char);
+  const size_t i = depth / charsize;
+  if (i >= len)
+    return 0;
+  uint64_t c = static_cast<uint64_t>(s[len - 1 - i]);
+  if (std::numeric_limits<Stringpool_char>::is_signed)
+    c ^= static_cast<uint64_t>(1) << (charsize * 8 - 1);
+  const unsigned int shift = (charsize - 1 - depth % charsize) * 8;
+  return ((c >> shift) & 0xff) + 1;
+}
+
+// A range of elements still to be sorted, all of which have the same
+// last DEPTH bytes.
+
+struct Suffix_sort_range
+{
+  size_t begin;
+  size_t end;
+  size_t depth;
+
+  Suffix_sort_range(size_t begina, size_t enda, size_t deptha)
+    : begin(begina), end(enda), depth(deptha)
+  { }
+};
+
+// Sort the strings in *V into the order of suffix_sort_before.  Any
+// string which is a suffix of another string then immediately follows
+// a string of which it is a suffix.  STRING_OF returns the string and
+// the length of an element of *V.
+
+// This is an MSD radix sort on the bytes of the strings taken from
+// the end, so the time is linear in the total length of the suffixes
+// which distinguish the strings, rather than needing O(N log N)
+// string comparisons.  This matters for large .debug_str sections,
+// where most strings share long suffixes.  Small ranges are finished
+// with an insertion sort.
+
+template<typename Stringpool_char, typename Element, typename String_of>
+void
+suffix_sort(std::vector<Element>* v, String_of string_of)
+{
+  const size_t small_range = 16;
+  const unsigned int digits = 257;
+
+  std::vector<Element> aux(v->size());
+  std::vector<Suffix_sort_range> ranges;
+  ranges.push_back(Suffix_sort_range(0, v->size(), 0));
+  while (!ranges.empty())
+    {
+      Suffix_sort_range r(ranges.back());
+      ranges.pop_back();
+
+      if (r.end - r.begin < small_range)
+	{
+	  for (size_t i = r.begin + 1; i < r.end; ++i)
+	    {
+	      Element e = (*v)[i];
+	      size_t len;
+	      const Stringpool_char* s = string_of(e, &len);
+	      size_t j = i;
+	      while (j > r.begin)
+		{
+		  size_t prevlen;
+		  const Stringpool_char* prev = string_of((*v)[j - 1], &prevlen);
+		  if (!suffix_sort_before(s, len, prev, prevlen))
+		    break;
+		  (*v)[j] = (*v)[j - 1];
+		  --j;
+		}
+	      (*v)[j] = e;
+	    }
+	  continue;
+	}
+
+      size_t counts[digits];
+      memset(counts, 0, sizeof counts);
+      for (size_t i = r.begin; i < r.end; ++i)
+	{
+	  size_t len;
+	  const Stringpool_char* s = string_of((*v)[i], &len);
+	  ++counts[suffix_sort_digit(s, len, r.depth)];
+	}
+
+      // Larger digits come first, and digit 0, for strings which have
+      // ended, comes last.  Since the strings are unique, at most one
+      // string can end here.
+      gold_assert(counts[0] <= 1);
+      size_t starts[digits];
+      size_t pos = r.begin;
+      for (unsigned int d = digits; d > 0; --d)
+	{
+	  starts[d - 1] = pos;
+	  pos += counts[d - 1];
+	}
+
+      for (size_t i = r.begin; i < r.end; ++i)
+	{
+	  size_t len;
+	  const Stringpool_char* s = string_of((*v)[i], &len);
+	  aux[starts[suffix_sort_digit(s, len, r.depth)]++] = (*v)[i];
+	}
+      std::copy(aux.begin() + r.begin, aux.begin() + r.end,
+		v->begin() + r.begin);
+
+      pos = r.begin;
+      for (unsigned int d = digits - 1; d > 0; --d)
+	{
+	  if (counts[d] > 1)
+	    ranges.push_back(Suffix_sort_range(pos, pos + counts[d],
+					       r.depth + 1));
+	  pos += counts[d];
+	}
+    }
+}
+
 template<typename Stringpool_char>
 Stringpool_template<Stringpool_char>::Stringpool_template(uint64_t addralign)
   : string_set_(), key_to_offset_(), strings_(), strtab_size_(0),
@@ -320,40 +477,6 @@ Stringpool_template<Stringpool_char>::find(const Stringpool_char* s,
   return p->first.string;
 }
 
-// Comparison routine used when sorting into an ELF strtab.  We want
-// to sort this so that when one string is a suffix of another, we
-// always see the shorter string immediately after the longer string.
-// For example, we want to see these strings in this order:
-//   abcd
-//   cd
-//   d
-// When strings are not suffixes, we don't care what order they are
-// in, but we need to ensure that suffixes wind up next to each other.
-// So we do a reversed lexicographic sort on the reversed string.
-
-template<typename Stringpool_char>
-bool
-Stringpool_template<Stringpool_char>::Stringpool_sort_comparison::operator()(
-  const Stringpool_sort_info& sort_info1,
-  const Stringpool_sort_info& sort_info2) const
-{
-  const Hashkey& h1(sort_info1->first);
-  const Hashkey& h2(sort_info2->first);
-  const Stringpool_char* s1 = h1.string;
-  const Stringpool_char* s2 = h2.string;
-  const size_t len1 = h1.length;
-  const size_t len2 = h2.length;
-  const size_t minlen = len1 < len2 ? len1 : len2;
-  const Stringpool_char* p1 = s1 + len1 - 1;
-  const Stringpool_char* p2 = s2 + len2 - 1;
-  for (size_t i = minlen; i > 0; --i, --p1, --p2)
-    {
-      if (*p1 != *p2)
-	return *p1 > *p2;
-    }
-  return len1 > len2;
-}
-
 // Return whether s1 is a suffix of s2.
 
 template<typename Stringpool_char>
@@ -408,7 +531,7 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
            ++p)
         v.push_back(Stringpool_sort_info(p));
 
-      std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
+      suffix_sort<Stringpool_char>(&v, Stringpool_sort_string());
 
       section_offset_type last_offset = -1;
       for (typename std::vector<Stringpool_sort_info>::iterator last = v.end(),
@@ -521,6 +644,439 @@ Stringpool_template<Stringpool_char>::print_stats(const char* name) const
 	  program_name, name, this->strings_.size());
 }
 
+// Class Concurrent_stringpool_template.
+
+// One shard of a Concurrent_stringpool_template.
+
+template<typename Stringpool_char>
+struct Concurrent_stringpool_template<Stringpool_char>::Shard
+{
+  Shard(Lock* locka)
+    : lock(locka), string_set(), blocks(), block_used(0), block_size(0)
+  { }
+
+  ~Shard()
+  {
+    for (std::vector<char*>::iterator p = this->blocks.begin();
+	 p != this->blocks.end();
+	 ++p)
+      delete[] *p;
+    delete this->lock;
+  }
+
+  // The lock, or NULL if we are not using threads.
+  Lock* lock;
+  // The strings in this shard.
+  String_set_type string_set;
+  // The arena blocks holding copied strings.  The last block is the
+  // one being filled.
+  std::vector<char*> blocks;
+  // The number of bytes used in the last block.
+  size_t block_used;
+  // The size of the last block.
+  size_t block_size;
+};
+
+template<typename Stringpool_char>
+Concurrent_stringpool_template<Stringpool_char>::Concurrent_stringpool_template(
+    uint64_t addralign)
+  : shards_(), strtab_size_(0), next_offset_(0), zero_null_(true),
+    optimize_(false), addralign_(addralign)
+{
+  if (parameters->options_valid()
+      && parameters->options().optimize() >= 2
+      && addralign <= sizeof(Stringpool_char))
+    this->optimize_ = true;
+
+  const bool threads = (parameters->options_valid()
+			&& parameters->options().threads());
+  const unsigned int count = threads ? thread_shard_count : 1;
+  this->shards_.reserve(count);
+  for (unsigned int i = 0; i < count; ++i)
+    this->shards_.push_back(new Shard(threads ? new Lock() : NULL));
+}
+
+template<typename Stringpool_char>
+Concurrent_stringpool_template<Stringpool_char>::~Concurrent_stringpool_template()
+{
+  for (typename std::vector<Shard*>::iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    delete *p;
+}
+
+template<typename Stringpool_char>
+void
+Concurrent_stringpool_template<Stringpool_char>::clear()
+{
+  for (typename std::vector<Shard*>::iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    {
+      Shard* shard = *p;
+      shard->string_set.clear();
+      for (std::vector<char*>::iterator b = shard->blocks.begin();
+	   b != shard->blocks.end();
+	   ++b)
+	delete[] *b;
+      shard->blocks.clear();
+      shard->block_used = 0;
+      shard->block_size = 0;
+    }
+  this->next_offset_ = 0;
+}
+
+template<typename Stringpool_char>
+Concurrent_stringpool_template<Stringpool_char>::Hashkey::Hashkey(
+    const Stringpool_char* s,
+    size_t len)
+  : string(s), length(len), hash_code(string_hash<Stringpool_char>(s, len))
+{ }
+
+template<typename Stringpool_char>
+inline bool
+Concurrent_stringpool_template<Stringpool_char>::Stringpool_eq::operator()(
+    const Hashkey& h1,
+    const Hashkey& h2) const
+{
+  return (h1.hash_code == h2.hash_code
+	  && h1.length == h2.length
+	  && (h1.string == h2.string
+	      || memcmp(h1.string, h2.string,
+			h1.length * sizeof(Stringpool_char)) == 0));
+}
+
+// Copy a string into the arena of SHARD.  The shard lock must be
+// held.  LEN is the length of S in characters.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Concurrent_stringpool_template<Stringpool_char>::add_string(
+    Shard* shard,
+    const Stringpool_char* s,
+    size_t len)
+{
+  const size_t bytes = (len + 1) * sizeof(Stringpool_char);
+
+  char* ret;
+  if (bytes > arena_block_size)
+    {
+      // A string which does not fit in a block gets a block of its
+      // own, which we put before the block being filled.
+      ret = new char[bytes];
+      shard->blocks.insert(shard->blocks.end()
+			   - (shard->blocks.empty() ? 0 : 1),
+			   ret);
+    }
+  else
+    {
+      // Keep strings aligned to the character size.
+      size_t used = align_address(shard->block_used,
+				  sizeof(Stringpool_char));
+      if (shard->blocks.empty() || used + bytes > shard->block_size)
+	{
+	  shard->blocks.push_back(new char[arena_block_size]);
+	  shard->block_size = arena_block_size;
+	  used = 0;
+	}
+      ret = shard->blocks.back() + used;
+      shard->block_used = used + bytes;
+    }
+
+  memcpy(ret, s, bytes - sizeof(Stringpool_char));
+  memset(ret + bytes - sizeof(Stringpool_char), 0, sizeof(Stringpool_char));
+  return reinterpret_cast<const Stringpool_char*>(ret);
+}
+
+// Add a string to the pool.  The hash code is computed before taking
+// the shard lock, so the lock is only held for the table lookup and
+// the copy.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Concurrent_stringpool_template<Stringpool_char>::add_with_length(
+    const Stringpool_char* s,
+    size_t length,
+    bool copy,
+    uint64_t order,
+    Key* pkey)
+{
+  gold_assert(this->strtab_size_ == 0);
+
+  Hashkey hk(s, length);
+  Shard* shard = this->shard(hk.hash_code);
+
+  Hold_optional_lock hl(shard->lock);
+
+  typename String_set_type::iterator p = shard->string_set.find(hk);
+  if (p == shard->string_set.end())
+    {
+      if (copy)
+	hk.string = add_string(shard, s, length);
+      p = shard->string_set.insert(std::make_pair(hk,
+						  Entry(hk.string, length,
+							order))).first;
+    }
+  else if (order < p->second.order)
+    p->second.order = order;
+
+  if (pkey != NULL)
+    *pkey = &p->second;
+  return p->second.string;
+}
+
+// Sort entries by the order they were added with.  If two strings
+// were given the same order, fall back to comparing the strings, so
+// that the result does not depend on which was added first.
+
+template<typename Stringpool_char>
+bool
+Concurrent_stringpool_template<Stringpool_char>::Entry_order_comparison::
+operator()(const Entry* e1, const Entry* e2) const
+{
+  if (e1->order != e2->order)
+    return e1->order < e2->order;
+  if (e1->length != e2->length)
+    return e1->length < e2->length;
+  return memcmp(e1->string, e2->string,
+		e1->length * sizeof(Stringpool_char)) < 0;
+}
+
+// Return the string of an entry, for suffix_sort.
+
+template<typename Stringpool_char>
+inline const Stringpool_char*
+Concurrent_stringpool_template<Stringpool_char>::Entry_string::operator()(
+    const Entry* e,
+    size_t* plen) const
+{
+  *plen = e->length;
+  return e->string;
+}
+
+// Return whether s1 is a suffix of s2.
+
+template<typename Stringpool_char>
+bool
+Concurrent_stringpool_template<Stringpool_char>::is_suffix(
+    const Stringpool_char* s1,
+    size_t len1,
+    const Stringpool_char* s2,
+    size_t len2)
+{
+  if (len1 > len2)
+    return false;
+  return memcmp(s1, s2 + len2 - len1, len1 * sizeof(Stringpool_char)) == 0;
+}
+
+// Turn the stringpool into an ELF strtab.  This lays the strings out
+// exactly as Stringpool_template would if they had been added to it
+// in order.
+
+template<typename Stringpool_char>
+void
+Concurrent_stringpool_template<Stringpool_char>::set_string_offsets()
+{
+  if (this->strtab_size_ != 0)
+    {
+      // We've already computed the offsets.
+      return;
+    }
+
+  if (this->next_offset_ != 0)
+    {
+      // The offsets were given out by assign_offset.
+      this->strtab_size_ = this->next_offset_;
+      return;
+    }
+
+  const size_t charsize = sizeof(Stringpool_char);
+
+  size_t count = 0;
+  for (typename std::vector<Shard*>::const_iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    count += (*p)->string_set.size();
+
+  std::vector<Entry*> v;
+  v.reserve(count);
+  for (typename std::vector<Shard*>::const_iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    for (typename String_set_type::iterator q = (*p)->string_set.begin();
+	 q != (*p)->string_set.end();
+	 ++q)
+      v.push_back(&q->second);
+
+  // Offset 0 may be reserved for the empty string.
+  section_offset_type offset = this->zero_null_ ? charsize : 0;
+
+  if (!this->optimize_)
+    {
+      std::sort(v.begin(), v.end(), Entry_order_comparison());
+      for (typename std::vector<Entry*>::iterator p = v.begin();
+	   p != v.end();
+	   ++p)
+	{
+	  Entry* e = *p;
+	  if (this->zero_null_ && e->length == 0)
+	    e->offset = 0;
+	  else
+	    {
+	      e->offset = align_address(offset, this->addralign_);
+	      offset = e->offset + (e->length + 1) * charsize;
+	    }
+	}
+    }
+  else
+    {
+      suffix_sort<Stringpool_char>(&v, Entry_string());
+
+      section_offset_type last_offset = -1;
+      for (typename std::vector<Entry*>::iterator last = v.end(),
+	     curr = v.begin();
+	   curr != v.end();
+	   last = curr++)
+	{
+	  section_offset_type this_offset;
+	  if (this->zero_null_ && (*curr)->string[0] == 0)
+	    this_offset = 0;
+	  else if (last != v.end()
+		   && ((((*curr)->length - (*last)->length)
+			% this->addralign_) == 0)
+		   && is_suffix((*curr)->string, (*curr)->length,
+				(*last)->string, (*last)->length))
+	    this_offset = (last_offset
+			   + (((*last)->length - (*curr)->length)
+			      * charsize));
+	  else
+	    {
+	      this_offset = align_address(offset, this->addralign_);
+	      offset = this_offset + ((*curr)->length + 1) * charsize;
+	    }
+	  (*curr)->offset = this_offset;
+	  last_offset = this_offset;
+	}
+    }
+
+  this->strtab_size_ = offset;
+}
+
+// Get the offset of a string in the ELF strtab.  The string must
+// exist.
+
+template<typename Stringpool_char>
+section_offset_type
+Concurrent_stringpool_template<Stringpool_char>::get_offset_with_length(
+    const Stringpool_char* s,
+    size_t length) const
+{
+  gold_assert(this->strtab_size_ != 0);
+  Hashkey hk(s, length);
+  const Shard* shard = this->shard(hk.hash_code);
+  typename String_set_type::const_iterator p = shard->string_set.find(hk);
+  if (p != shard->string_set.end())
+    return p->second.offset;
+  gold_unreachable();
+}
+
+template<typename Stringpool_char>
+section_offset_type
+Concurrent_stringpool_template<Stringpool_char>::get_offset_from_key(
+    Key k) const
+{
+  gold_assert(this->strtab_size_ != 0);
+  return k->offset;
+}
+
+// Give the string with key K the next offset in the string table.
+
+template<typename Stringpool_char>
+section_offset_type
+Concurrent_stringpool_template<Stringpool_char>::assign_offset(Key k)
+{
+  gold_assert(this->strtab_size_ == 0);
+  Entry* e = const_cast<Entry*>(k);
+  if (e->offset != -1)
+    return e->offset;
+
+  const size_t charsize = sizeof(Stringpool_char);
+  if (this->next_offset_ == 0)
+    this->next_offset_ = this->zero_null_ ? charsize : 0;
+
+  if (this->zero_null_ && e->length == 0)
+    e->offset = 0;
+  else
+    {
+      e->offset = align_address(this->next_offset_, this->addralign_);
+      this->next_offset_ = e->offset + (e->length + 1) * charsize;
+    }
+  return e->offset;
+}
+
+// Write the ELF strtab into the buffer.
+
+template<typename Stringpool_char>
+void
+Concurrent_stringpool_template<Stringpool_char>::write_to_buffer(
+    unsigned char* buffer,
+    section_size_type bufsize)
+{
+  gold_assert(this->strtab_size_ != 0);
+  gold_assert(bufsize >= this->strtab_size_);
+  if (this->zero_null_)
+    buffer[0] = '\0';
+  for (typename std::vector<Shard*>::const_iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    for (typename String_set_type::const_iterator q =
+	   (*p)->string_set.begin();
+	 q != (*p)->string_set.end();
+	 ++q)
+      {
+	const int len = (q->second.length + 1) * sizeof(Stringpool_char);
+	const section_offset_type offset = q->second.offset;
+	gold_assert(static_cast<section_size_type>(offset) + len
+		    <= this->strtab_size_);
+	memcpy(buffer + offset, q->second.string, len);
+      }
+}
+
+// Write the ELF strtab into the output file at the specified offset.
+
+template<typename Stringpool_char>
+void
+Concurrent_stringpool_template<Stringpool_char>::write(Output_file* of,
+						       off_t offset)
+{
+  gold_assert(this->strtab_size_ != 0);
+  unsigned char* view = of->get_output_view(offset, this->strtab_size_);
+  this->write_to_buffer(view, this->strtab_size_);
+  of->write_output_view(offset, this->strtab_size_, view);
+}
+
+// Print statistical information to stderr.  This is used for --stats.
+
+template<typename Stringpool_char>
+void
+Concurrent_stringpool_template<Stringpool_char>::print_stats(
+    const char* name) const
+{
+  size_t entries = 0;
+  size_t blocks = 0;
+  for (typename std::vector<Shard*>::const_iterator p = this->shards_.begin();
+       p != this->shards_.end();
+       ++p)
+    {
+      entries += (*p)->string_set.size();
+      blocks += (*p)->blocks.size();
+    }
+  fprintf(stderr, _("%s: %s entries: %zu; shards: %zu\n"),
+	  program_name, name, entries, this->shards_.size());
+  fprintf(stderr, _("%s: %s arena blocks: %zu\n"),
+	  program_name, name, blocks);
+}
+
 // Instantiate the templates we need.
 
 template
@@ -532,4 +1088,13 @@ class Stringpool_template<uint16_t>;
 template
 class Stringpool_template<uint32_t>;
 
+template
+class Concurrent_stringpool_template<char>;
+
+template
+class Concurrent_stringpool_template<uint16_t>;
+
+template
+class Concurrent_stringpool_template<uint32_t>;
+
 } // End namespace gold.
@@ -31,6 +31,7 @@ namespace gold
 {
 
 class Output_file;
+class Lock;
 
 // Return the length of a string in units of Char_type.
 
@@ -378,14 +379,19 @@ class Stringpool_template
   typedef Unordered_map<Hashkey, Hashval, Stringpool_hash,
 			Stringpool_eq> String_set_type;
 
-  // Comparison routine used when sorting into a string table.
+  // Routine used when sorting into a string table to get the string
+  // and its length.
 
   typedef typename String_set_type::iterator Stringpool_sort_info;
 
-  struct Stringpool_sort_comparison
+  struct Stringpool_sort_string
   {
-    bool
-    operator()(const Stringpool_sort_info&, const Stringpool_sort_info&) const;
+    const Stringpool_char*
+    operator()(const Stringpool_sort_info& p, size_t* plen) const
+    {
+      *plen = p->first.length;
+      return p->first.string;
+    }
   };
 
   // Keys map to offsets via a Chunked_vector.  We only use the
@@ -416,6 +422,241 @@ class Stringpool_template
 // The most common type of Stringpool.
 typedef Stringpool_template<char> Stringpool;
 
+// A string pool which may be added to by several threads at once.
+// The strings are spread over a number of shards by hash code; each
+// shard has its own hash table, lock, and bump-allocated arena for
+// copied strings.
+
+// Because the order in which threads add strings is not fixed, the
+// string table offsets can not be assigned as the strings are added,
+// as Stringpool_template does.  Instead each string is added with an
+// ORDER, and when the offsets are set the strings are laid out in
+// order of the smallest ORDER each was added with.  If the ORDER
+// values are the positions at which a serial caller would have added
+// the strings to a Stringpool_template, the string table is
+// identical.  For the same reason there are no integer keys; the key
+// of a string is a pointer to its entry, which may be used to get
+// its offset.
+
+// The output .strtab and .dynstr are still built with a
+// Stringpool_template.  Their strings are added by serial loops in
+// Layout::finalize and Symbol_table::finalize, so there is no
+// concurrency to gain, and the symbol versioning code in dynobj.cc
+// keys its tables on the integer Stringpool::Key of the version and
+// file names.
+
+template<typename Stringpool_char>
+class Concurrent_stringpool_template
+{
+ public:
+  // An entry in the pool.
+  struct Entry;
+
+  // The key of a string in the pool.
+  typedef const Entry* Key;
+
+  // Create a Concurrent_stringpool.
+  Concurrent_stringpool_template(uint64_t addralign = 1);
+
+  ~Concurrent_stringpool_template();
+
+  // Clear all the data from the stringpool.
+  void
+  clear();
+
+  // Indicate that we should not reserve offset 0 to hold the empty
+  // string when converting the stringpool to a string table.
+  void
+  set_no_zero_null()
+  { this->zero_null_ = false; }
+
+  // Indicate that this string pool should be optimized, even if not
+  // running with -O2.
+  void
+  set_optimize()
+  { this->optimize_ = true; }
+
+  // Add the string S to the pool.  This returns a canonical permanent
+  // pointer to the string in the pool.  If COPY is true, the string
+  // is copied into permanent storage.  If PKEY is not NULL, this sets
+  // *PKEY to the key for the string.  This may be called from several
+  // threads at once.
+  const Stringpool_char*
+  add(const Stringpool_char* s, bool copy, uint64_t order, Key* pkey)
+  { return this->add_with_length(s, string_length(s), copy, order, pkey); }
+
+  // Add string S of length LEN characters to the pool.  If COPY is
+  // true, S need not be null terminated.
+  const Stringpool_char*
+  add_with_length(const Stringpool_char* s, size_t len, bool copy,
+		  uint64_t order, Key* pkey);
+
+  // Turn the stringpool into a string table: determine the offsets of
+  // all the strings.  After this is called, no more strings may be
+  // added to the stringpool.
+  void
+  set_string_offsets();
+
+  // Get the offset of the string S in the string table.  This may
+  // only be called after set_string_offsets has been called.
+  section_offset_type
+  get_offset(const Stringpool_char* s) const
+  { return this->get_offset_with_length(s, string_length(s)); }
+
+  // Get the offset of string S, with length LENGTH characters, in the
+  // string table.
+  section_offset_type
+  get_offset_with_length(const Stringpool_char* s, size_t length) const;
+
+  // Get the offset of the string with key K.
+  section_offset_type
+  get_offset_from_key(Key k) const;
+
+  // Give the string with key K the next offset in the string table,
+  // unless it already has one, and return its offset.  This is for a
+  // caller which needs the offsets of the strings as it goes, while
+  // other threads may still be adding strings; the strings are laid
+  // out in the order of the calls, and the table is not optimized.
+  // This may not be called from two threads at once.  If it is used
+  // at all, it must be called for every string in the pool before
+  // set_string_offsets.
+  section_offset_type
+  assign_offset(Key k);
+
+  // Get the size of the string table.  This returns the number of
+  // bytes, not in units of Stringpool_char.
+  section_size_type
+  get_strtab_size() const
+  {
+    gold_assert(this->strtab_size_ != 0);
+    return this->strtab_size_;
+  }
+
+  // Write the string table into the output file at the specified
+  // offset.
+  void
+  write(Output_file*, off_t offset);
+
+  // Write the string table into the specified buffer, of the
+  // specified size.  buffer_size should be at least
+  // get_strtab_size().
+  void
+  write_to_buffer(unsigned char* buffer, section_size_type buffer_size);
+
+  // Dump statistical information to stderr.
+  void
+  print_stats(const char*) const;
+
+ private:
+  Concurrent_stringpool_template(const Concurrent_stringpool_template&);
+  Concurrent_stringpool_template& operator=(
+      const Concurrent_stringpool_template&);
+
+  // The hash table key, as in Stringpool_template.
+  struct Hashkey
+  {
+    const Stringpool_char* string;
+    // Length is in characters, not bytes.
+    size_t length;
+    size_t hash_code;
+
+    Hashkey()
+      : string(NULL), length(0), hash_code(0)
+    { }
+
+    Hashkey(const Stringpool_char* s, size_t len);
+  };
+
+  struct Stringpool_hash
+  {
+    size_t
+    operator()(const Hashkey& hk) const
+    { return hk.hash_code; }
+  };
+
+  struct Stringpool_eq
+  {
+    bool
+    operator()(const Hashkey&, const Hashkey&) const;
+  };
+
+  typedef Unordered_map<Hashkey, Entry, Stringpool_hash,
+			Stringpool_eq> String_set_type;
+
+  // Comparison routine used when sorting by order.
+  struct Entry_order_comparison
+  {
+    bool
+    operator()(const Entry*, const Entry*) const;
+  };
+
+  // Routine used when sorting to find suffixes to get the string and
+  // its length.
+  struct Entry_string
+  {
+    const Stringpool_char*
+    operator()(const Entry* e, size_t* plen) const;
+  };
+
+  // One shard of the pool.
+  struct Shard;
+
+  // The number of shards to use when running with threads.
+  static const unsigned int thread_shard_count = 64;
+
+  // The size of an arena block.
+  static const size_t arena_block_size = 64 * 1024;
+
+  // Return the shard for hash code HASH_CODE.
+  Shard*
+  shard(size_t hash_code) const
+  { return this->shards_[hash_code % this->shards_.size()]; }
+
+  // Copy a string into the arena of SHARD, returning the copy.
+  static const Stringpool_char*
+  add_string(Shard* shard, const Stringpool_char*, size_t);
+
+  // Return whether s1 is a suffix of s2.
+  static bool
+  is_suffix(const Stringpool_char* s1, size_t len1,
+	    const Stringpool_char* s2, size_t len2);
+
+  // The shards.
+  std::vector<Shard*> shards_;
+  // Size of string table.
+  section_size_type strtab_size_;
+  // The next offset to give out in assign_offset, or 0 if
+  // assign_offset has not been called.
+  section_size_type next_offset_;
+  // Whether to reserve offset 0 to hold the null string.
+  bool zero_null_;
+  // Whether to optimize the string table.
+  bool optimize_;
+  // The alignment of strings in the stringpool.
+  uint64_t addralign_;
+};
+
+// An entry in a Concurrent_stringpool_template.
+
+template<typename Stringpool_char>
+struct Concurrent_stringpool_template<Stringpool_char>::Entry
+{
+  Entry(const Stringpool_char* s, size_t len, uint64_t ordera)
+    : string(s), length(len), order(ordera), offset(-1)
+  { }
+
+  // The canonical string.
+  const Stringpool_char* string;
+  // Length is in characters, not bytes.
+  size_t length;
+  // The smallest order the string was added with.
+  uint64_t order;
+  // The offset in the string table, once it has been set.
+  section_offset_type offset;
+};
+
+typedef Concurrent_stringpool_template<char> Concurrent_stringpool;
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_STRINGPOOL_H)
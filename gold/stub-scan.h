@@ -0,0 +1,532 @@
+// stub-scan.h -- scan for branch stubs in parallel  -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_STUB_SCAN_H
+#define GOLD_STUB_SCAN_H
+
+#include <cstdio>
+#include <vector>
+
+#include "elfcpp.h"
+#include "fileread.h"
+#include "layout.h"
+#include "object.h"
+#include "output.h"
+#include "parameters.h"
+#include "timer.h"
+
+namespace gold
+{
+
+// Targets which add stubs for branches which can not reach their
+// destinations, such as AArch64 and ARM, scan the relocations of
+// every code section in every relaxation pass, until the sizes of
+// the stub tables stop changing.  The classes here let them scan the
+// objects in parallel, and skip the sections whose stubs can not have
+// changed since the previous pass.
+
+// Whether a branch needs a stub, and which kind of stub, only depends
+// on its offset, that is, the distance from the branch to its
+// destination.  When a section is scanned, we record the slack of the
+// section, which is the smallest distance from the offset of one of
+// its branches to one of the limits where the choice of stub changes.
+// In each later pass, we find the largest amount by which two
+// addresses in the output file moved relative to each other.  If the
+// sum of those amounts since the section was scanned is less than its
+// slack, none of its branches can have crossed a limit, and the
+// section does not need to be scanned again.
+
+// This holds the state of one relaxation pass.
+
+template<int size>
+class Stub_scan_pass
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  Stub_scan_pass()
+    : moved_distance_(0), scan_all_(true),
+      refresh_(false), min_shift_(0), max_shift_(0),
+      output_section_addresses_(), start_time_(0), stats_()
+  { }
+
+  // Start a relaxation pass.  SCAN_ALL is true if every section must
+  // be scanned; with --no-stub-scan-skip, every section is scanned in
+  // every pass.  This must be called before the objects update their
+  // addresses.
+  void
+  start(const Layout* layout, bool scan_all);
+
+  // Record that the output address of an input section moved by
+  // MIN_SHIFT and MAX_SHIFT bytes.
+  void
+  add_shifts(int64_t min_shift, int64_t max_shift)
+  {
+    this->min_shift_ = std::min(this->min_shift_, min_shift);
+    this->max_shift_ = std::max(this->max_shift_, max_shift);
+  }
+
+  // Record that some address moved by an unknown amount.  Every
+  // section is scanned in this pass.
+  void
+  set_scan_all()
+  { this->scan_all_ = true; }
+
+  // Compute the distance moved in this pass, after all the shifts
+  // have been added.  When every section is scanned, the distance
+  // does not matter.
+  void
+  finish_shifts()
+  {
+    if (!this->scan_all_)
+      this->moved_distance_ += this->max_shift_ - this->min_shift_;
+  }
+
+  // Start scanning again the sections which were skipped in this
+  // pass and which use stubs.  This is done in the last pass, to
+  // update the destination addresses of their stubs.
+  void
+  start_refresh()
+  { this->refresh_ = true; }
+
+  // Finish the pass.  SCANNED and SKIPPED are the number of sections
+  // which were scanned and skipped.
+  void
+  finish(size_t scanned, size_t skipped)
+  {
+    Pass_stats ps;
+    ps.scanned = scanned;
+    ps.skipped = skipped;
+    ps.usec = Timer::wall_usec() - this->start_time_;
+    this->stats_.push_back(ps);
+  }
+
+  // Whether every section must be scanned.
+  bool
+  scan_all() const
+  { return this->scan_all_; }
+
+  // Whether this is a refresh scan.
+  bool
+  refresh() const
+  { return this->refresh_; }
+
+  // The sum of the distances moved in the passes so far.
+  uint64_t
+  moved_distance() const
+  { return this->moved_distance_; }
+
+  // Print statistics to stderr.
+  void
+  print_stats() const;
+
+ private:
+  // Statistics for one pass.
+  struct Pass_stats
+  {
+    size_t scanned;
+    size_t skipped;
+    long long usec;
+  };
+
+  // The sum of the distances moved in the passes so far.
+  uint64_t moved_distance_;
+  // Whether every section must be scanned in this pass.
+  bool scan_all_;
+  // Whether this is a refresh scan.
+  bool refresh_;
+  // The smallest and largest amounts by which an address moved in
+  // this pass.  These start at zero, which stands for the absolute
+  // addresses which never move.
+  int64_t min_shift_;
+  int64_t max_shift_;
+  // The start and end addresses of the allocated output sections in
+  // the previous pass.
+  std::vector<std::pair<Address, Address> > output_section_addresses_;
+  // When the pass started.
+  long long start_time_;
+  // Statistics for each pass.
+  std::vector<Pass_stats> stats_;
+};
+
+template<int size>
+void
+Stub_scan_pass<size>::start(const Layout* layout, bool scan_all)
+{
+  this->scan_all_ = scan_all || !parameters->options().stub_scan_skip();
+  this->refresh_ = false;
+  this->min_shift_ = 0;
+  this->max_shift_ = 0;
+  this->start_time_ = Timer::wall_usec();
+
+  // The linker created sections, such as the PLT, are not input
+  // sections, so we also take into account how far the output
+  // sections moved.  Their sizes do not change during relaxation, so
+  // their contents move with them.  The lookup maps are built now so
+  // that the objects may find their relaxed sections in parallel.
+  const Layout::Section_list& sections(layout->section_list());
+  if (this->output_section_addresses_.size() != sections.size())
+    {
+      this->output_section_addresses_.clear();
+      this->output_section_addresses_.resize(sections.size(),
+					     std::make_pair(0, 0));
+      this->scan_all_ = true;
+    }
+  for (size_t i = 0; i < sections.size(); ++i)
+    {
+      const Output_section* os = sections[i];
+      os->prepare_lookup_maps();
+      if ((os->flags() & elfcpp::SHF_ALLOC) == 0
+	  || !os->is_address_valid()
+	  || !os->is_data_size_valid())
+	continue;
+      Address start = os->address();
+      Address end = start + os->data_size();
+      std::pair<Address, Address>* prev = &this->output_section_addresses_[i];
+      int64_t start_shift = (static_cast<int64_t>(start)
+			     - static_cast<int64_t>(prev->first));
+      int64_t end_shift = (static_cast<int64_t>(end)
+			   - static_cast<int64_t>(prev->second));
+      this->add_shifts(start_shift, start_shift);
+      this->add_shifts(end_shift, end_shift);
+      prev->first = start;
+      prev->second = end;
+    }
+}
+
+template<int size>
+void
+Stub_scan_pass<size>::print_stats() const
+{
+  if (this->stats_.empty())
+    return;
+  fprintf(stderr, _("%s: stub relaxation passes: %zu\n"),
+	  program_name, this->stats_.size());
+  for (size_t i = 0; i < this->stats_.size(); ++i)
+    {
+      const Pass_stats& ps(this->stats_[i]);
+      fprintf(stderr, _("%s: stub relaxation pass %zu: %zu sections scanned, "
+			"%zu skipped, time %lld.%06lld\n"),
+	      program_name, i + 1, ps.scanned, ps.skipped,
+	      ps.usec / 1000000, ps.usec % 1000000);
+    }
+}
+
+// This holds the state of the input sections of one object.
+
+template<int size>
+class Stub_scan_sections
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  static const Address invalid_address = static_cast<Address>(-1);
+
+  Stub_scan_sections()
+    : sections_(), moved_at_scan_(0), min_shift_(0), max_shift_(0),
+      unknown_shift_(false), scanned_count_(0), skipped_count_(0)
+  { }
+
+  // Record the current output addresses of the sections of RELOBJ,
+  // and how far they moved.  This may be called for several objects
+  // in parallel.
+  void
+  update_addresses(const Relobj* relobj);
+
+  // Add how far the sections moved to PASS.
+  void
+  add_shifts_to(Stub_scan_pass<size>* pass) const
+  {
+    if (this->unknown_shift_)
+      pass->set_scan_all();
+    pass->add_shifts(this->min_shift_, this->max_shift_);
+  }
+
+  // Whether section SHNDX moved in this pass, or has not been seen
+  // before.
+  bool
+  moved(unsigned int shndx) const
+  { return this->sections_[shndx].moved; }
+
+  // Return whether the relocations for section SHNDX must be scanned
+  // in PASS.  This also counts the scanned and skipped sections.
+  bool
+  needs_scan(unsigned int shndx, const Stub_scan_pass<size>* pass);
+
+  // Start scanning the relocations for section SHNDX.
+  void
+  start_scan(unsigned int shndx, const Stub_scan_pass<size>* pass)
+  {
+    Section* s = &this->sections_[shndx];
+    s->limit = -1ULL;
+    s->scanned = true;
+    s->skipped = false;
+    s->untracked = false;
+    s->uses_stubs = false;
+    this->moved_at_scan_ = pass->moved_distance();
+  }
+
+  // Record a branch in section SHNDX whose offset is SLACK bytes from
+  // the nearest limit.  USES_STUB is true if it uses a stub.
+  void
+  add_branch(unsigned int shndx, uint64_t slack, bool uses_stub)
+  {
+    Section* s = &this->sections_[shndx];
+    if (this->moved_at_scan_ + slack < s->limit)
+      s->limit = this->moved_at_scan_ + slack;
+    if (uses_stub)
+      s->uses_stubs = true;
+  }
+
+  // Record that section SHNDX has a branch to a destination whose
+  // address we do not track.  The section is always scanned.
+  void
+  add_untracked_branch(unsigned int shndx)
+  { this->sections_[shndx].untracked = true; }
+
+  // The number of sections scanned and skipped in this pass.
+  size_t
+  scanned_count() const
+  { return this->scanned_count_; }
+
+  size_t
+  skipped_count() const
+  { return this->skipped_count_; }
+
+  // Return the distance from OFFSET to the nearest of the COUNT
+  // limits in LIMITS.
+  static uint64_t
+  slack(int64_t offset, const int64_t* limits, size_t count)
+  {
+    uint64_t ret = -1ULL;
+    for (size_t i = 0; i < count; ++i)
+      {
+	uint64_t d = (offset < limits[i]
+		      ? limits[i] - offset
+		      : offset - limits[i]);
+	ret = std::min(ret, d);
+      }
+    return ret;
+  }
+
+  // Return the output address of section SHNDX in RELOBJ, or
+  // invalid_address if it has none or it needs special handling.
+  static Address
+  section_address(const Relobj* relobj, unsigned int shndx);
+
+  // Return whether we track how far the address of the global symbol
+  // GSYM moves.  Set *SERIAL to true if its value may not be computed
+  // while other objects are scanned, because it is in a merge section
+  // whose offset map is built on first use.
+  static bool
+  symbol_is_tracked(const Symbol* gsym, bool* serial);
+
+ private:
+  // The state of one input section.
+  struct Section
+  {
+    Section()
+      : address(invalid_address), limit(0), moved(true), scanned(false),
+	skipped(false), untracked(false), uses_stubs(false)
+    { }
+
+    // The output address in this pass.
+    Address address;
+    // The section must be scanned again once the sum of the distances
+    // moved reaches this.
+    uint64_t limit;
+    // Whether the section moved in this pass.
+    bool moved : 1;
+    // Whether the relocations for the section have been scanned.
+    bool scanned : 1;
+    // Whether the section was skipped in this pass.
+    bool skipped : 1;
+    // Whether the section has a branch to an untracked destination.
+    bool untracked : 1;
+    // Whether the section has a branch which uses a stub.
+    bool uses_stubs : 1;
+  };
+
+  std::vector<Section> sections_;
+  // The sum of the distances moved when the current section was
+  // scanned.
+  uint64_t moved_at_scan_;
+  // The smallest and largest amounts by which a section moved in this
+  // pass.
+  int64_t min_shift_;
+  int64_t max_shift_;
+  // Whether a section moved by an unknown amount in this pass.
+  bool unknown_shift_;
+  // The number of sections scanned and skipped in this pass.
+  size_t scanned_count_;
+  size_t skipped_count_;
+};
+
+template<int size>
+typename Stub_scan_sections<size>::Address
+Stub_scan_sections<size>::section_address(const Relobj* relobj,
+					  unsigned int shndx)
+{
+  Output_section* os = relobj->output_section(shndx);
+  if (os == NULL
+      || (os->flags() & elfcpp::SHF_ALLOC) == 0
+      || !os->is_address_valid())
+    return invalid_address;
+  uint64_t offset = relobj->output_section_offset(shndx);
+  if (offset != -1ULL)
+    return os->address() + offset;
+  const Output_relaxed_input_section* poris =
+    os->find_relaxed_input_section(relobj, shndx);
+  if (poris != NULL)
+    return poris->address();
+  return invalid_address;
+}
+
+template<int size>
+bool
+Stub_scan_sections<size>::symbol_is_tracked(const Symbol* gsym, bool* serial)
+{
+  *serial = false;
+  switch (gsym->source())
+    {
+    case Symbol::FROM_OBJECT:
+      {
+	Object* object = gsym->object();
+	bool is_ordinary;
+	unsigned int shndx = gsym->shndx(&is_ordinary);
+	if (object->is_dynamic()
+	    || object->pluginobj() != NULL
+	    || !is_ordinary
+	    || shndx == elfcpp::SHN_UNDEF)
+	  return true;
+	const Relobj* relobj = static_cast<const Relobj*>(object);
+	if (Stub_scan_sections<size>::section_address(relobj, shndx)
+	    != invalid_address)
+	  return true;
+	*serial = (relobj->output_section(shndx) != NULL
+		   && relobj->output_section_offset(shndx) == -1ULL);
+	return false;
+      }
+
+    case Symbol::IS_CONSTANT:
+    case Symbol::IS_UNDEFINED:
+      return true;
+
+    default:
+      return false;
+    }
+}
+
+template<int size>
+void
+Stub_scan_sections<size>::update_addresses(const Relobj* relobj)
+{
+  unsigned int shnum = relobj->shnum();
+  if (this->sections_.size() < shnum)
+    this->sections_.resize(shnum);
+  this->scanned_count_ = 0;
+  this->skipped_count_ = 0;
+
+  int64_t min_shift = 0;
+  int64_t max_shift = 0;
+  bool unknown_shift = false;
+  for (unsigned int i = 1; i < shnum; ++i)
+    {
+      Section* s = &this->sections_[i];
+      Address address = Stub_scan_sections<size>::section_address(relobj, i);
+      s->moved = address != s->address;
+      if (!s->moved)
+	continue;
+      if (address == invalid_address || s->address == invalid_address)
+	unknown_shift = true;
+      else
+	{
+	  int64_t shift = (static_cast<int64_t>(address)
+			   - static_cast<int64_t>(s->address));
+	  min_shift = std::min(min_shift, shift);
+	  max_shift = std::max(max_shift, shift);
+	}
+      s->address = address;
+    }
+  this->min_shift_ = min_shift;
+  this->max_shift_ = max_shift;
+  this->unknown_shift_ = unknown_shift;
+}
+
+template<int size>
+bool
+Stub_scan_sections<size>::needs_scan(unsigned int shndx,
+				     const Stub_scan_pass<size>* pass)
+{
+  Section* s = &this->sections_[shndx];
+  bool ret;
+  if (pass->refresh())
+    {
+      ret = s->skipped && s->uses_stubs;
+      if (ret)
+	{
+	  s->skipped = false;
+	  ++this->scanned_count_;
+	  --this->skipped_count_;
+	}
+    }
+  else
+    {
+      ret = (pass->scan_all()
+	     || !s->scanned
+	     || s->untracked
+	     || pass->moved_distance() >= s->limit);
+      s->skipped = !ret;
+      if (ret)
+	++this->scanned_count_;
+      else
+	++this->skipped_count_;
+    }
+  return ret;
+}
+
+// Divide the relocatable objects in INPUT_OBJECTS into groups which
+// may be scanned in parallel, and store them in GROUPS.  The members
+// of an archive share a File_read, which can only be locked by one
+// thread at a time, so they go in the same group.
+
+inline void
+stub_scan_groups(const Input_objects* input_objects,
+		 std::vector<std::vector<Relobj*> >* groups)
+{
+  groups->clear();
+  Unordered_map<const File_read*, size_t> group_index;
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    {
+      const File_read* file = &(*p)->input_file()->file();
+      std::pair<Unordered_map<const File_read*, size_t>::iterator, bool> ins =
+	group_index.insert(std::make_pair(file, groups->size()));
+      if (ins.second)
+	groups->push_back(std::vector<Relobj*>());
+      (*groups)[ins.first->second].push_back(*p);
+    }
+}
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_STUB_SCAN_H)
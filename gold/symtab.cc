@@ -565,17 +565,26 @@ Symbol::set_undefined()
 
 Symbol_table::Symbol_table(unsigned int count,
                            const Version_script_info& version_script)
-  : saw_undefined_(0), offset_(0), table_(count), namepool_(),
-    forwarders_(), commons_(), tls_commons_(), small_commons_(),
-    large_commons_(), forced_locals_(), warnings_(),
-    version_script_(version_script), gc_(NULL), icf_(NULL),
+  : saw_undefined_(0), offset_(0), tables_(), allow_sharded_add_(false),
+    sharded_add_(NULL), sharded_add_count_(0), namepool_(), forwarders_(), commons_(),
+    tls_commons_(), small_commons_(), large_commons_(), forced_locals_(),
+    warnings_(), version_script_(version_script), gc_(NULL), icf_(NULL),
     target_symbols_()
 {
+  unsigned int shards = 1;
+  if (parameters->options_valid()
+      && parameters->options().symbol_shards() > 1)
+    shards = parameters->options().symbol_shards();
+  this->tables_.reserve(shards);
+  for (unsigned int i = 0; i < shards; ++i)
+    this->tables_.push_back(Symbol_table_type(count / shards));
+
   namepool_.reserve(count);
 }
 
 Symbol_table::~Symbol_table()
 {
+  gold_assert(this->sharded_add_ == NULL);
 }
 
 // The symbol table key equality function.  This is called with
@@ -715,8 +724,9 @@ Symbol_table::lookup(const char* name, const char* version) const
     }
 
   Symbol_table_key key(name_key, version_key);
-  Symbol_table::Symbol_table_type::const_iterator p = this->table_.find(key);
-  if (p == this->table_.end())
+  const Symbol_table_type& table(this->table(name_key));
+  Symbol_table::Symbol_table_type::const_iterator p = table.find(key);
+  if (p == table.end())
     return NULL;
   return p->second;
 }
@@ -754,7 +764,7 @@ Symbol_table::resolve(Sized_symbol<size>* to, const Sized_symbol<size>* from)
 // by visibility.
 
 void
-Symbol_table::force_local(Symbol* sym)
+Symbol_table::force_local(Symbol* sym, Symbol_shard* shard)
 {
   if (!sym->is_defined() && !sym->is_common())
     return;
@@ -764,7 +774,10 @@ Symbol_table::force_local(Symbol* sym)
       return;
     }
   sym->set_is_forced_local();
-  this->forced_locals_.push_back(sym);
+  if (shard != NULL)
+    shard->defer(NULL, sym, NULL);
+  else
+    this->forced_locals_.push_back(sym);
 }
 
 // Adjust NAME for wrapping, and update *NAME_KEY if necessary.  This
@@ -824,7 +837,8 @@ template<int size, bool big_endian>
 void
 Symbol_table::define_default_version(Sized_symbol<size>* sym,
 				     bool default_is_new,
-				     Symbol_table_type::iterator pdef)
+				     Symbol_table_type::iterator pdef,
+				     Symbol_shard* shard)
 {
   if (default_is_new)
     {
@@ -891,7 +905,14 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
 	  const Sized_symbol<size>* symdef;
 	  symdef = this->get_sized_symbol<size>(pdef->second);
 	  Symbol_table::resolve<size, big_endian>(sym, symdef);
-	  this->make_forwarder(pdef->second, sym);
+	  if (shard == NULL)
+	    this->make_forwarder(pdef->second, sym);
+	  else
+	    {
+	      // The forwarders_ map is shared by all the shards.
+	      pdef->second->set_forwarder();
+	      shard->defer(NULL, pdef->second, sym);
+	    }
 	  pdef->second = sym;
 	  sym->set_is_default();
 	}
@@ -927,6 +948,11 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
 // ORIG_ST_SHNDX is the section index in the input file, or SHN_UNDEF
 // for a special section code.  ST_SHNDX may be modified if the symbol
 // is defined in a section being discarded.
+//
+// If SHARD is not NULL, this is being run in parallel with the other
+// shards of the symbol table.  Only the shard of the table which
+// holds NAME is touched, and updates to the lists shared by all the
+// shards are recorded in SHARD.
 
 template<int size, bool big_endian>
 Sized_symbol<size>*
@@ -939,7 +965,8 @@ Symbol_table::add_from_object(Object* object,
 			      const elfcpp::Sym<size, big_endian>& sym,
 			      unsigned int st_shndx,
 			      bool is_ordinary,
-			      unsigned int orig_st_shndx)
+			      unsigned int orig_st_shndx,
+			      Symbol_shard* shard)
 {
   // Print a message if this symbol is being traced.
   if (parameters->options().is_trace_symbol(name))
@@ -969,19 +996,21 @@ Symbol_table::add_from_object(Object* object,
 	}
     }
 
+  Symbol_table_type& table(this->table(name_key));
+
   Symbol* const snull = NULL;
   std::pair<typename Symbol_table_type::iterator, bool> ins =
-    this->table_.insert(std::make_pair(std::make_pair(name_key, version_key),
-				       snull));
+    table.insert(std::make_pair(std::make_pair(name_key, version_key),
+				snull));
 
   std::pair<typename Symbol_table_type::iterator, bool> insdefault =
-    std::make_pair(this->table_.end(), false);
+    std::make_pair(table.end(), false);
   if (is_default_version)
     {
       const Stringpool::Key vnull_key = 0;
-      insdefault = this->table_.insert(std::make_pair(std::make_pair(name_key,
-								     vnull_key),
-						      snull));
+      insdefault = table.insert(std::make_pair(std::make_pair(name_key,
+							      vnull_key),
+					       snull));
     }
 
   // ins.first: an iterator, which is a pointer to a pair.
@@ -1009,7 +1038,7 @@ Symbol_table::add_from_object(Object* object,
 
       if (is_default_version)
 	this->define_default_version<size, big_endian>(ret, insdefault.second,
-						       insdefault.first);
+						       insdefault.first, shard);
       else
 	{
 	  bool dummy;
@@ -1034,7 +1063,7 @@ Symbol_table::add_from_object(Object* object,
 	      // (See PR gold/18703.)
 	      ret->set_is_not_default();
 	      const Stringpool::Key vnull_key = 0;
-	      this->table_.erase(std::make_pair(name_key, vnull_key));
+	      table.erase(std::make_pair(name_key, vnull_key));
 	    }
 	}
     }
@@ -1102,13 +1131,12 @@ Symbol_table::add_from_object(Object* object,
 		  // This means that we don't want a symbol table
 		  // entry after all.
 		  if (!is_default_version)
-		    this->table_.erase(ins.first);
+		    table.erase(ins.first);
 		  else
 		    {
-		      this->table_.erase(insdefault.first);
+		      table.erase(insdefault.first);
 		      // Inserting INSDEFAULT invalidated INS.
-		      this->table_.erase(std::make_pair(name_key,
-							version_key));
+		      table.erase(std::make_pair(name_key, version_key));
 		    }
 		  return NULL;
 		}
@@ -1135,9 +1163,14 @@ Symbol_table::add_from_object(Object* object,
   // because undefined symbols only in dynamic objects should't trigger rescans.
   if (!was_undefined_in_reg && ret->is_undefined() && ret->in_reg())
     {
-      ++this->saw_undefined_;
-      if (parameters->options().has_plugins())
-	parameters->options().plugins()->new_undefined_symbol(ret);
+      if (shard != NULL)
+	++shard->saw_undefined;
+      else
+	{
+	  ++this->saw_undefined_;
+	  if (parameters->options().has_plugins())
+	    parameters->options().plugins()->new_undefined_symbol(ret);
+	}
     }
 
   // Keep track of common symbols, to speed up common symbol
@@ -1146,16 +1179,21 @@ Symbol_table::add_from_object(Object* object,
   // replacement file.
   if (!was_common && ret->is_common() && ret->object()->pluginobj() == NULL)
     {
+      Commons_type* commons;
       if (ret->type() == elfcpp::STT_TLS)
-	this->tls_commons_.push_back(ret);
+	commons = &this->tls_commons_;
       else if (!is_ordinary
 	       && st_shndx == parameters->target().small_common_shndx())
-	this->small_commons_.push_back(ret);
+	commons = &this->small_commons_;
       else if (!is_ordinary
 	       && st_shndx == parameters->target().large_common_shndx())
-	this->large_commons_.push_back(ret);
+	commons = &this->large_commons_;
+      else
+	commons = &this->commons_;
+      if (shard != NULL)
+	shard->defer(commons, ret, NULL);
       else
-	this->commons_.push_back(ret);
+	commons->push_back(ret);
     }
 
   // If we're not doing a relocatable link, then any symbol with
@@ -1166,218 +1204,549 @@ Symbol_table::add_from_object(Object* object,
 	  || ret->binding() == elfcpp::STB_GNU_UNIQUE
 	  || ret->binding() == elfcpp::STB_WEAK)
       && !parameters->options().relocatable())
-    this->force_local(ret);
+    this->force_local(ret, shard);
 
   return ret;
 }
 
-// Add all the symbols in a relocatable object to the hash table.
+// A symbol read from a relocatable object by read_relobj_symbol.
 
 template<int size, bool big_endian>
+struct Symbol_table::Relobj_symbol
+{
+  // The index of the symbol among the external symbols of the object.
+  size_t index;
+  // The canonicalized name and version.
+  const char* name;
+  Stringpool::Key name_key;
+  const char* version;
+  Stringpool::Key version_key;
+  // The section index, possibly adjusted, and the original one.
+  unsigned int st_shndx;
+  unsigned int orig_st_shndx;
+  bool is_ordinary;
+  bool is_default_version;
+  bool is_forced_local;
+  bool is_defined_in_discarded_section;
+  // A copy of the symbol, possibly adjusted.
+  unsigned char sym[elfcpp::Elf_sizes<size>::sym_size];
+};
+
+// The symbols of a relocatable object which add_from_relobj left to
+// be resolved in parallel, one task per shard of the symbol table.
+
+class Sharded_add
+{
+ public:
+  Sharded_add(Symbol_table* symtab, unsigned int shard_count)
+    : symtab_(symtab), shards_(shard_count)
+  { }
+
+  virtual
+  ~Sharded_add()
+  { }
+
+  // The number of shards.
+  unsigned int
+  shard_count() const
+  { return this->shards_.size(); }
+
+  // Resolve the symbols in shard I.
+  void
+  run_shard(unsigned int i)
+  { this->do_run_shard(&this->shards_[i]); }
+
+  // Apply the updates deferred by the shards.  This is called after
+  // all the shards have run.
+  void
+  finish()
+  { this->symtab_->finish_sharded_add(&this->shards_); }
+
+ protected:
+  // Resolve the symbols in SHARD.
+  virtual void
+  do_run_shard(Symbol_table::Symbol_shard* shard) = 0;
+
+  // The symbol table.
+  Symbol_table* symtab_;
+  // The shards.
+  Symbol_table::Symbol_shards shards_;
+};
+
+template<int size, bool big_endian>
+class Sized_sharded_add : public Sharded_add
+{
+ public:
+  Sized_sharded_add(Symbol_table* symtab, unsigned int shard_count,
+		    Sized_relobj_file<size, big_endian>* relobj,
+		    size_t count,
+		    typename Sized_relobj_file<size, big_endian>::Symbols*
+		      sympointers)
+    : Sharded_add(symtab, shard_count), relobj_(relobj), symbols_(),
+      sympointers_(sympointers)
+  { this->symbols_.reserve(count); }
+
+  // Add a symbol to be resolved in its shard.
+  void
+  add(const Symbol_table::Relobj_symbol<size, big_endian>& rsym)
+  {
+    unsigned int shard = this->symtab_->shard(rsym.name_key);
+    this->shards_[shard].symbols.push_back(this->symbols_.size());
+    this->symbols_.push_back(rsym);
+  }
+
+ protected:
+  void
+  do_run_shard(Symbol_table::Symbol_shard* shard)
+  {
+    for (std::vector<size_t>::const_iterator p = shard->symbols.begin();
+	 p != shard->symbols.end();
+	 ++p)
+      {
+	const Symbol_table::Relobj_symbol<size, big_endian>& rsym =
+	  this->symbols_[*p];
+	shard->symndx = rsym.index;
+	(*this->sympointers_)[rsym.index] =
+	  this->symtab_->add_relobj_symbol(this->relobj_, rsym, shard);
+      }
+  }
+
+ private:
+  // The object.
+  Sized_relobj_file<size, big_endian>* relobj_;
+  // The symbols read from the object.
+  std::vector<Symbol_table::Relobj_symbol<size, big_endian> > symbols_;
+  // Where to record the resolved symbols.
+  typename Sized_relobj_file<size, big_endian>::Symbols* sympointers_;
+};
+
+// A task which resolves the symbols in one shard of the symbol table.
+
+class Add_symbols_shard : public Task
+{
+ public:
+  Add_symbols_shard(Sharded_add* sharded_add, unsigned int shard,
+		    Task_token* shards_blocker)
+    : sharded_add_(sharded_add), shard_(shard),
+      shards_blocker_(shards_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->shards_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->sharded_add_->run_shard(this->shard_); }
+
+  std::string
+  get_name() const
+  { return "Add_symbols_shard"; }
+
+ private:
+  Sharded_add* sharded_add_;
+  unsigned int shard_;
+  Task_token* shards_blocker_;
+};
+
+// A task which runs when all the shards are done.  This blocks the
+// next input file from adding its symbols.
+
+class Add_symbols_shards_finish : public Task
+{
+ public:
+  Add_symbols_shards_finish(Sharded_add* sharded_add,
+			    Task_token* shards_blocker,
+			    Task_token* next_blocker)
+    : sharded_add_(sharded_add), shards_blocker_(shards_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Add_symbols_shards_finish()
+  {
+    delete this->shards_blocker_;
+    delete this->sharded_add_;
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->shards_blocker_->is_blocked())
+      return this->shards_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->sharded_add_->finish(); }
+
+  std::string
+  get_name() const
+  { return "Add_symbols_shards_finish"; }
+
+ private:
+  Sharded_add* sharded_add_;
+  Task_token* shards_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Objects with fewer external symbols than this are not worth
+// resolving in shards.
+
+static const size_t min_sharded_add_symbols = 1024;
+
+// Return whether the COUNT external symbols of a relocatable object
+// may be resolved in shards.  Resolving a symbol must then only touch
+// the symbol and its shard of the table, which rules out anything
+// which may change the name of a symbol, look at other symbols, or
+// depend on the order in which the symbols are seen.
+
+bool
+Symbol_table::should_shard_add(size_t count) const
+{
+  return (this->allow_sharded_add_
+	  && this->tables_.size() > 1
+	  && count >= min_sharded_add_symbols
+	  && !parameters->options().has_plugins()
+	  && !parameters->options().any_wrap()
+	  && !parameters->options().gc_sections()
+	  && !parameters->options().detect_odr_violations()
+	  && !parameters->incremental()
+	  && !parameters->target().has_make_symbol()
+	  && !parameters->target().has_resolve()
+	  && this->weak_aliases_.empty());
+}
+
+// Queue the tasks to resolve the symbols left by add_from_relobj.
+
 void
-Symbol_table::add_from_relobj(
+Symbol_table::queue_sharded_add(Workqueue* workqueue, Task_token* next_blocker)
+{
+  Sharded_add* sharded_add = this->sharded_add_;
+  if (sharded_add == NULL)
+    return;
+  this->sharded_add_ = NULL;
+
+  // The calling task is about to release NEXT_BLOCKER, so add a
+  // blocker for the finishing task.  Since NEXT_BLOCKER may be shared
+  // by several tasks, we need to increment the count with the
+  // workqueue lock held.
+  gold_assert(next_blocker != NULL);
+  workqueue->add_blocker(next_blocker);
+
+  const unsigned int shard_count = sharded_add->shard_count();
+  Task_token* shards_blocker = new Task_token(true);
+  shards_blocker->add_blockers(shard_count);
+
+  for (unsigned int i = 0; i < shard_count; ++i)
+    workqueue->queue(new Add_symbols_shard(sharded_add, i, shards_blocker));
+  workqueue->queue(new Add_symbols_shards_finish(sharded_add, shards_blocker,
+						 next_blocker));
+}
+
+// Apply the updates deferred by the shards.  Sorting them by symbol
+// index gives the same lists we would have built without shards.
+
+void
+Symbol_table::finish_sharded_add(Symbol_shards* shards)
+{
+  std::vector<Symbol_shard::Action> actions;
+  for (Symbol_shards::const_iterator p = shards->begin();
+       p != shards->end();
+       ++p)
+    {
+      this->saw_undefined_ += p->saw_undefined;
+      actions.insert(actions.end(), p->actions.begin(), p->actions.end());
+    }
+
+  std::stable_sort(actions.begin(), actions.end());
+
+  for (std::vector<Symbol_shard::Action>::const_iterator p = actions.begin();
+       p != actions.end();
+       ++p)
+    {
+      if (p->commons != NULL)
+	p->commons->push_back(p->sym);
+      else if (p->to != NULL)
+	this->forwarders_[p->sym] = p->to;
+      else
+	this->forced_locals_.push_back(p->sym);
+    }
+}
+
+// Read external symbol I of RELOBJ, at P, into *RSYM.  This
+// canonicalizes the name and version and applies the version script,
+// which must be done serially.
+
+template<int size, bool big_endian>
+bool
+Symbol_table::read_relobj_symbol(
     Sized_relobj_file<size, big_endian>* relobj,
-    const unsigned char* syms,
-    size_t count,
+    const unsigned char* p,
+    size_t i,
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
-    typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
+    Relobj_symbol<size, big_endian>* rsym,
     size_t* defined)
 {
-  *defined = 0;
-
-  gold_assert(size == parameters->target().get_size());
-
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
 
-  const bool just_symbols = relobj->just_symbols();
+  elfcpp::Sym<size, big_endian> sym(p);
 
-  const unsigned char* p = syms;
-  for (size_t i = 0; i < count; ++i, p += sym_size)
+  unsigned int st_name = sym.get_st_name();
+  if (st_name >= sym_name_size)
     {
-      (*sympointers)[i] = NULL;
-
-      elfcpp::Sym<size, big_endian> sym(p);
-
-      unsigned int st_name = sym.get_st_name();
-      if (st_name >= sym_name_size)
-	{
-	  relobj->error(_("bad global symbol name offset %u at %zu"),
-			st_name, i);
-	  continue;
-	}
+      relobj->error(_("bad global symbol name offset %u at %zu"),
+		    st_name, i);
+      return false;
+    }
 
-      const char* name = sym_names + st_name;
+  const char* name = sym_names + st_name;
 
-      if (!parameters->options().relocatable()
-	  && name[0] == '_'
-	  && name[1] == '_'
-	  && strcmp (name + (name[2] == '_'), "__gnu_lto_slim") == 0)
-        gold_info(_("%s: plugin needed to handle lto object"),
-		  relobj->name().c_str());
+  if (!parameters->options().relocatable()
+      && name[0] == '_'
+      && name[1] == '_'
+      && strcmp (name + (name[2] == '_'), "__gnu_lto_slim") == 0)
+    gold_info(_("%s: plugin needed to handle lto object"),
+	      relobj->name().c_str());
 
-      bool is_ordinary;
-      unsigned int st_shndx = relobj->adjust_sym_shndx(i + symndx_offset,
-						       sym.get_st_shndx(),
-						       &is_ordinary);
-      unsigned int orig_st_shndx = st_shndx;
-      if (!is_ordinary)
-	orig_st_shndx = elfcpp::SHN_UNDEF;
+  bool is_ordinary;
+  unsigned int st_shndx = relobj->adjust_sym_shndx(i + symndx_offset,
+						   sym.get_st_shndx(),
+						   &is_ordinary);
+  unsigned int orig_st_shndx = st_shndx;
+  if (!is_ordinary)
+    orig_st_shndx = elfcpp::SHN_UNDEF;
+
+  if (st_shndx != elfcpp::SHN_UNDEF)
+    ++*defined;
+
+  // A symbol defined in a section which we are not including must
+  // be treated as an undefined symbol.
+  bool is_defined_in_discarded_section = false;
+  if (st_shndx != elfcpp::SHN_UNDEF
+      && is_ordinary
+      && !relobj->is_section_included(st_shndx)
+      && !this->is_section_folded(relobj, st_shndx))
+    {
+      st_shndx = elfcpp::SHN_UNDEF;
+      is_defined_in_discarded_section = true;
+    }
 
-      if (st_shndx != elfcpp::SHN_UNDEF)
-	++*defined;
+  // In an object file, an '@' in the name separates the symbol
+  // name from the version name.  If there are two '@' characters,
+  // this is the default version.
+  const char* ver = strchr(name, '@');
+  Stringpool::Key ver_key = 0;
+  int namelen = 0;
+  // IS_DEFAULT_VERSION: is the version default?
+  // IS_FORCED_LOCAL: is the symbol forced local?
+  bool is_default_version = false;
+  bool is_forced_local = false;
 
-      // A symbol defined in a section which we are not including must
-      // be treated as an undefined symbol.
-      bool is_defined_in_discarded_section = false;
-      if (st_shndx != elfcpp::SHN_UNDEF
-	  && is_ordinary
-	  && !relobj->is_section_included(st_shndx)
-          && !this->is_section_folded(relobj, st_shndx))
-	{
-	  st_shndx = elfcpp::SHN_UNDEF;
-	  is_defined_in_discarded_section = true;
-	}
+  // FIXME: For incremental links, we don't store version information,
+  // so we need to ignore version symbols for now.
+  if (parameters->incremental_update() && ver != NULL)
+    {
+      namelen = ver - name;
+      ver = NULL;
+    }
 
-      // In an object file, an '@' in the name separates the symbol
-      // name from the version name.  If there are two '@' characters,
-      // this is the default version.
-      const char* ver = strchr(name, '@');
-      Stringpool::Key ver_key = 0;
-      int namelen = 0;
-      // IS_DEFAULT_VERSION: is the version default?
-      // IS_FORCED_LOCAL: is the symbol forced local?
-      bool is_default_version = false;
-      bool is_forced_local = false;
-
-      // FIXME: For incremental links, we don't store version information,
-      // so we need to ignore version symbols for now.
-      if (parameters->incremental_update() && ver != NULL)
+  if (ver != NULL)
+    {
+      // The symbol name is of the form foo@VERSION or foo@@VERSION
+      namelen = ver - name;
+      ++ver;
+      if (*ver == '@')
 	{
-	  namelen = ver - name;
-	  ver = NULL;
+	  is_default_version = true;
+	  ++ver;
 	}
-
-      if (ver != NULL)
-        {
-          // The symbol name is of the form foo@VERSION or foo@@VERSION
-          namelen = ver - name;
-          ++ver;
-	  if (*ver == '@')
-	    {
-	      is_default_version = true;
-	      ++ver;
-	    }
-	  ver = this->namepool_.add(ver, true, &ver_key);
-        }
-      // We don't want to assign a version to an undefined symbol,
-      // even if it is listed in the version script.  FIXME: What
-      // about a common symbol?
-      else
+      ver = this->namepool_.add(ver, true, &ver_key);
+    }
+  // We don't want to assign a version to an undefined symbol,
+  // even if it is listed in the version script.  FIXME: What
+  // about a common symbol?
+  else
+    {
+      namelen = strlen(name);
+      if (!this->version_script_.empty()
+	  && st_shndx != elfcpp::SHN_UNDEF)
 	{
-	  namelen = strlen(name);
-	  if (!this->version_script_.empty()
-	      && st_shndx != elfcpp::SHN_UNDEF)
+	  // The symbol name did not have a version, but the
+	  // version script may assign a version anyway.
+	  std::string version;
+	  bool is_global;
+	  if (this->version_script_.get_symbol_version(name, &version,
+						       &is_global))
 	    {
-	      // The symbol name did not have a version, but the
-	      // version script may assign a version anyway.
-	      std::string version;
-	      bool is_global;
-	      if (this->version_script_.get_symbol_version(name, &version,
-							   &is_global))
+	      if (!is_global)
+		is_forced_local = true;
+	      else if (!version.empty())
 		{
-		  if (!is_global)
-		    is_forced_local = true;
-		  else if (!version.empty())
-		    {
-		      ver = this->namepool_.add_with_length(version.c_str(),
-							    version.length(),
-							    true,
-							    &ver_key);
-		      is_default_version = true;
-		    }
+		  ver = this->namepool_.add_with_length(version.c_str(),
+							version.length(),
+							true,
+							&ver_key);
+		  is_default_version = true;
 		}
 	    }
 	}
+    }
 
-      elfcpp::Sym<size, big_endian>* psym = &sym;
-      unsigned char symbuf[sym_size];
-      elfcpp::Sym<size, big_endian> sym2(symbuf);
-      if (just_symbols)
+  memcpy(rsym->sym, p, sym_size);
+  elfcpp::Sym<size, big_endian> sym2(rsym->sym);
+  if (relobj->just_symbols())
+    {
+      elfcpp::Sym_write<size, big_endian> sw(rsym->sym);
+      if (orig_st_shndx != elfcpp::SHN_UNDEF
+	  && is_ordinary
+	  && relobj->e_type() == elfcpp::ET_REL)
 	{
-	  memcpy(symbuf, p, sym_size);
-	  elfcpp::Sym_write<size, big_endian> sw(symbuf);
-	  if (orig_st_shndx != elfcpp::SHN_UNDEF
-	      && is_ordinary
-	      && relobj->e_type() == elfcpp::ET_REL)
-	    {
-	      // Symbol values in relocatable object files are section
-	      // relative.  This is normally what we want, but since here
-	      // we are converting the symbol to absolute we need to add
-	      // the section address.  The section address in an object
-	      // file is normally zero, but people can use a linker
-	      // script to change it.
-	      sw.put_st_value(sym.get_st_value()
-			      + relobj->section_address(orig_st_shndx));
-	    }
-	  st_shndx = elfcpp::SHN_ABS;
-	  is_ordinary = false;
-	  psym = &sym2;
+	  // Symbol values in relocatable object files are section
+	  // relative.  This is normally what we want, but since here
+	  // we are converting the symbol to absolute we need to add
+	  // the section address.  The section address in an object
+	  // file is normally zero, but people can use a linker
+	  // script to change it.
+	  sw.put_st_value(sym.get_st_value()
+			  + relobj->section_address(orig_st_shndx));
 	}
+      st_shndx = elfcpp::SHN_ABS;
+      is_ordinary = false;
+    }
 
-      // Fix up visibility if object has no-export set.
-      if (relobj->no_export()
-	  && (orig_st_shndx != elfcpp::SHN_UNDEF || !is_ordinary))
-        {
-	  // We may have copied symbol already above.
-	  if (psym != &sym2)
-	    {
-	      memcpy(symbuf, p, sym_size);
-	      psym = &sym2;
-	    }
+  // Fix up visibility if object has no-export set.
+  if (relobj->no_export()
+      && (orig_st_shndx != elfcpp::SHN_UNDEF || !is_ordinary))
+    {
+      elfcpp::STV visibility = sym2.get_st_visibility();
+      if (visibility == elfcpp::STV_DEFAULT
+	  || visibility == elfcpp::STV_PROTECTED)
+	{
+	  elfcpp::Sym_write<size, big_endian> sw(rsym->sym);
+	  unsigned char nonvis = sym2.get_st_nonvis();
+	  sw.put_st_other(elfcpp::STV_HIDDEN, nonvis);
+	}
+    }
 
-	  elfcpp::STV visibility = sym2.get_st_visibility();
-	  if (visibility == elfcpp::STV_DEFAULT
-	      || visibility == elfcpp::STV_PROTECTED)
-	    {
-	      elfcpp::Sym_write<size, big_endian> sw(symbuf);
-	      unsigned char nonvis = sym2.get_st_nonvis();
-	      sw.put_st_other(elfcpp::STV_HIDDEN, nonvis);
-	    }
-        }
+  Stringpool::Key name_key;
+  name = this->namepool_.add_with_length(name, namelen, true,
+					 &name_key);
+
+  rsym->index = i;
+  rsym->name = name;
+  rsym->name_key = name_key;
+  rsym->version = ver;
+  rsym->version_key = ver_key;
+  rsym->st_shndx = st_shndx;
+  rsym->orig_st_shndx = orig_st_shndx;
+  rsym->is_ordinary = is_ordinary;
+  rsym->is_default_version = is_default_version;
+  rsym->is_forced_local = is_forced_local;
+  rsym->is_defined_in_discarded_section = is_defined_in_discarded_section;
+  return true;
+}
 
-      Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+// Add a symbol read by read_relobj_symbol to the symbol table.  SHARD
+// is as for add_from_object.
 
-      Sized_symbol<size>* res;
-      res = this->add_from_object(relobj, name, name_key, ver, ver_key,
-				  is_default_version, *psym, st_shndx,
-				  is_ordinary, orig_st_shndx);
+template<int size, bool big_endian>
+Sized_symbol<size>*
+Symbol_table::add_relobj_symbol(
+    Sized_relobj_file<size, big_endian>* relobj,
+    const Relobj_symbol<size, big_endian>& rsym,
+    Symbol_shard* shard)
+{
+  elfcpp::Sym<size, big_endian> sym(rsym.sym);
+  Sized_symbol<size>* res;
+  res = this->add_from_object(relobj, rsym.name, rsym.name_key, rsym.version,
+			      rsym.version_key, rsym.is_default_version, sym,
+			      rsym.st_shndx, rsym.is_ordinary,
+			      rsym.orig_st_shndx, shard);
 
-      if (res == NULL)
-	continue;
-      
-      if (is_forced_local)
-	this->force_local(res);
+  if (res == NULL)
+    return NULL;
+
+  if (rsym.is_forced_local)
+    this->force_local(res, shard);
+
+  // Do not treat this symbol as garbage if this symbol will be
+  // exported to the dynamic symbol table.  This is true when
+  // building a shared library or using --export-dynamic and
+  // the symbol is externally visible.
+  if (parameters->options().gc_sections()
+      && res->is_externally_visible()
+      && !res->is_from_dynobj()
+      && (parameters->options().shared()
+	  || parameters->options().export_dynamic()
+	  || parameters->options().in_dynamic_list(res->name())))
+    this->gc_mark_symbol(res);
+
+  if (rsym.is_defined_in_discarded_section)
+    res->set_is_defined_in_discarded_section();
+
+  return res;
+}
+
+// Add all the symbols in a relocatable object to the hash table.  If
+// the object is large enough, and sharding is allowed, the symbols
+// are only read here, and are resolved by the tasks queued by
+// queue_sharded_add.
+
+template<int size, bool big_endian>
+void
+Symbol_table::add_from_relobj(
+    Sized_relobj_file<size, big_endian>* relobj,
+    const unsigned char* syms,
+    size_t count,
+    size_t symndx_offset,
+    const char* sym_names,
+    size_t sym_name_size,
+    typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
+    size_t* defined)
+{
+  *defined = 0;
 
-      // Do not treat this symbol as garbage if this symbol will be
-      // exported to the dynamic symbol table.  This is true when
-      // building a shared library or using --export-dynamic and
-      // the symbol is externally visible.
-      if (parameters->options().gc_sections()
-	  && res->is_externally_visible()
-	  && !res->is_from_dynobj()
-          && (parameters->options().shared()
-	      || parameters->options().export_dynamic()
-	      || parameters->options().in_dynamic_list(res->name())))
-        this->gc_mark_symbol(res);
+  gold_assert(size == parameters->target().get_size());
 
-      if (is_defined_in_discarded_section)
-	res->set_is_defined_in_discarded_section();
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
 
-      (*sympointers)[i] = res;
+  Sized_sharded_add<size, big_endian>* sharded_add = NULL;
+  if (this->should_shard_add(count))
+    {
+      gold_assert(this->sharded_add_ == NULL);
+      sharded_add = new Sized_sharded_add<size, big_endian>(this,
+							    this->tables_.size(),
+							    relobj, count,
+							    sympointers);
+      this->sharded_add_ = sharded_add;
+      ++this->sharded_add_count_;
+    }
+
+  const unsigned char* p = syms;
+  for (size_t i = 0; i < count; ++i, p += sym_size)
+    {
+      (*sympointers)[i] = NULL;
+
+      Relobj_symbol<size, big_endian> rsym;
+      if (!this->read_relobj_symbol(relobj, p, i, symndx_offset, sym_names,
+				    sym_name_size, &rsym, defined))
+	continue;
+
+      if (sharded_add != NULL)
+	sharded_add->add(rsym);
+      else
+	(*sympointers)[i] = this->add_relobj_symbol(relobj, rsym, NULL);
     }
 }
 
@@ -1817,9 +2186,9 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
   Sized_symbol<size>* sym;
 
   bool add_to_table = false;
-  typename Symbol_table_type::iterator add_loc = this->table_.end();
+  typename Symbol_table_type::iterator add_loc;
   bool add_def_to_table = false;
-  typename Symbol_table_type::iterator add_def_loc = this->table_.end();
+  typename Symbol_table_type::iterator add_def_loc;
 
   if (only_if_ref)
     {
@@ -1858,21 +2227,21 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
       if (*pversion != NULL)
 	*pversion = this->namepool_.add(*pversion, true, &version_key);
 
+      Symbol_table_type& table(this->table(name_key));
+
       Symbol* const snull = NULL;
       std::pair<typename Symbol_table_type::iterator, bool> ins =
-	this->table_.insert(std::make_pair(std::make_pair(name_key,
-							  version_key),
-					   snull));
+	table.insert(std::make_pair(std::make_pair(name_key, version_key),
+				    snull));
 
       std::pair<typename Symbol_table_type::iterator, bool> insdefault =
-	std::make_pair(this->table_.end(), false);
+	std::make_pair(table.end(), false);
       if (is_default_version)
 	{
 	  const Stringpool::Key vnull = 0;
-	  insdefault =
-	    this->table_.insert(std::make_pair(std::make_pair(name_key,
-							      vnull),
-					       snull));
+	  insdefault = table.insert(std::make_pair(std::make_pair(name_key,
+								  vnull),
+						   snull));
 	}
 
       if (!ins.second)
@@ -1887,7 +2256,8 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
 		this->get_sized_symbol<size>(oldsym);
 	      this->define_default_version<size, big_endian>(soldsym,
 							     insdefault.second,
-							     insdefault.first);
+							     insdefault.first,
+							     NULL);
 	    }
 	}
       else
@@ -2572,68 +2942,76 @@ Symbol_table::set_dynsym_indexes(unsigned int index,
   if (parameters->target().has_custom_set_dynsym_indexes())
     {
       std::vector<Symbol*> dyn_symbols;
-      for (Symbol_table_type::iterator p = this->table_.begin();
-           p != this->table_.end();
-           ++p)
-        {
-          Symbol* sym = p->second;
-          if (sym->is_forced_local())
-	    continue;
-          if (!sym->should_add_dynsym_entry(this))
-            sym->set_dynsym_index(-1U);
-          else
-            dyn_symbols.push_back(sym);
-        }
+      for (std::vector<Symbol_table_type>::iterator t =
+             this->tables_.begin();
+           t != this->tables_.end();
+           ++t)
+	for (Symbol_table_type::iterator p = t->begin();
+	     p != t->end();
+	     ++p)
+	  {
+	    Symbol* sym = p->second;
+	    if (sym->is_forced_local())
+	      continue;
+	    if (!sym->should_add_dynsym_entry(this))
+	      sym->set_dynsym_index(-1U);
+	    else
+	      dyn_symbols.push_back(sym);
+	  }
 
       return parameters->target().set_dynsym_indexes(&dyn_symbols, index, syms,
                                                      dynpool, versions, this);
     }
 
-  for (Symbol_table_type::iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
-    {
-      Symbol* sym = p->second;
+  for (std::vector<Symbol_table_type>::iterator t =
+         this->tables_.begin();
+       t != this->tables_.end();
+       ++t)
+    for (Symbol_table_type::iterator p = t->begin();
+	 p != t->end();
+	 ++p)
+      {
+	Symbol* sym = p->second;
 
-      if (sym->is_forced_local())
-        continue;
+	if (sym->is_forced_local())
+	  continue;
 
-      // Note that SYM may already have a dynamic symbol index, since
-      // some symbols appear more than once in the symbol table, with
-      // and without a version.
+	// Note that SYM may already have a dynamic symbol index, since
+	// some symbols appear more than once in the symbol table, with
+	// and without a version.
 
-      if (!sym->should_add_dynsym_entry(this))
-	sym->set_dynsym_index(-1U);
-      else if (!sym->has_dynsym_index())
-	{
-	  sym->set_dynsym_index(index);
-	  ++index;
-	  syms->push_back(sym);
-	  dynpool->add(sym->name(), false, NULL);
-
-	  // If the symbol is defined in a dynamic object and is
-	  // referenced strongly in a regular object, then mark the
-	  // dynamic object as needed.  This is used to implement
-	  // --as-needed.
-	  if (sym->is_from_dynobj()
-	      && sym->in_reg()
-	      && !sym->is_undef_binding_weak())
-	    sym->object()->set_is_needed();
-
-	  // Record any version information, except those from
-	  // as-needed libraries not seen to be needed.  Note that the
-	  // is_needed state for such libraries can change in this loop.
-	  if (sym->version() != NULL)
-	    {
-	      if (!sym->is_from_dynobj()
-		  || !sym->object()->as_needed()
-		  || sym->object()->is_needed())
-		versions->record_version(this, dynpool, sym);
-	      else
-		as_needed_sym.push_back(sym);
-	    }
-	}
-    }
+	if (!sym->should_add_dynsym_entry(this))
+	  sym->set_dynsym_index(-1U);
+	else if (!sym->has_dynsym_index())
+	  {
+	    sym->set_dynsym_index(index);
+	    ++index;
+	    syms->push_back(sym);
+	    dynpool->add(sym->name(), false, NULL);
+
+	    // If the symbol is defined in a dynamic object and is
+	    // referenced strongly in a regular object, then mark the
+	    // dynamic object as needed.  This is used to implement
+	    // --as-needed.
+	    if (sym->is_from_dynobj()
+		&& sym->in_reg()
+		&& !sym->is_undef_binding_weak())
+	      sym->object()->set_is_needed();
+
+	    // Record any version information, except those from
+	    // as-needed libraries not seen to be needed.  Note that the
+	    // is_needed state for such libraries can change in this loop.
+	    if (sym->version() != NULL)
+	      {
+		if (!sym->is_from_dynobj()
+		    || !sym->object()->as_needed()
+		    || sym->object()->is_needed())
+		  versions->record_version(this, dynpool, sym);
+		else
+		  as_needed_sym.push_back(sym);
+	      }
+	  }
+      }
 
   // Process version information for symbols from as-needed libraries.
   for (std::vector<Symbol*>::iterator p = as_needed_sym.begin();
@@ -2764,14 +3142,18 @@ Symbol_table::sized_finalize(off_t off, Stringpool* pool,
     }
 
   // Now do all the remaining symbols.
-  for (Symbol_table_type::iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
-    {
-      Symbol* sym = p->second;
-      if (this->sized_finalize_symbol<size>(sym))
-	this->add_to_final_symtab<size>(sym, pool, &index, &off);
-    }
+  for (std::vector<Symbol_table_type>::iterator t =
+         this->tables_.begin();
+       t != this->tables_.end();
+       ++t)
+    for (Symbol_table_type::iterator p = t->begin();
+	 p != t->end();
+	 ++p)
+      {
+	Symbol* sym = p->second;
+	if (this->sized_finalize_symbol<size>(sym))
+	  this->add_to_final_symtab<size>(sym, pool, &index, &off);
+      }
 
   // Now do target-specific symbols.
   for (std::vector<Symbol*>::iterator p = this->target_symbols_.begin();
@@ -3080,186 +3462,190 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
   else
     dynamic_view = of->get_output_view(this->dynamic_offset_, dynamic_size);
 
-  for (Symbol_table_type::const_iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
-    {
-      Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
+  for (std::vector<Symbol_table_type>::const_iterator t =
+         this->tables_.begin();
+       t != this->tables_.end();
+       ++t)
+    for (Symbol_table_type::const_iterator p = t->begin();
+	 p != t->end();
+	 ++p)
+      {
+	Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
 
-      // Possibly warn about unresolved symbols in shared libraries.
-      this->warn_about_undefined_dynobj_symbol(sym);
+	// Possibly warn about unresolved symbols in shared libraries.
+	this->warn_about_undefined_dynobj_symbol(sym);
 
-      unsigned int sym_index = sym->symtab_index();
-      unsigned int dynsym_index;
-      if (dynamic_view == NULL)
-	dynsym_index = -1U;
-      else
-	dynsym_index = sym->dynsym_index();
+	unsigned int sym_index = sym->symtab_index();
+	unsigned int dynsym_index;
+	if (dynamic_view == NULL)
+	  dynsym_index = -1U;
+	else
+	  dynsym_index = sym->dynsym_index();
 
-      if (sym_index == -1U && dynsym_index == -1U)
-	{
-	  // This symbol is not included in the output file.
-	  continue;
-	}
+	if (sym_index == -1U && dynsym_index == -1U)
+	  {
+	    // This symbol is not included in the output file.
+	    continue;
+	  }
 
-      unsigned int shndx;
-      typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
-      typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
-      elfcpp::STB binding = sym->binding();
-
-      // If --weak-unresolved-symbols is set, change binding of unresolved
-      // global symbols to STB_WEAK.
-      if (parameters->options().weak_unresolved_symbols()
-	  && binding == elfcpp::STB_GLOBAL
-	  && sym->is_undefined())
-	binding = elfcpp::STB_WEAK;
-
-      // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
-      if (binding == elfcpp::STB_GNU_UNIQUE
-	  && !parameters->options().gnu_unique())
-	binding = elfcpp::STB_GLOBAL;
+	unsigned int shndx;
+	typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
+	typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
+	elfcpp::STB binding = sym->binding();
 
-      switch (sym->source())
-	{
-	case Symbol::FROM_OBJECT:
+	// If --weak-unresolved-symbols is set, change binding of unresolved
+	// global symbols to STB_WEAK.
+	if (parameters->options().weak_unresolved_symbols()
+	    && binding == elfcpp::STB_GLOBAL
+	    && sym->is_undefined())
+	  binding = elfcpp::STB_WEAK;
+
+	// If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
+	if (binding == elfcpp::STB_GNU_UNIQUE
+	    && !parameters->options().gnu_unique())
+	  binding = elfcpp::STB_GLOBAL;
+
+	switch (sym->source())
 	  {
-	    bool is_ordinary;
-	    unsigned int in_shndx = sym->shndx(&is_ordinary);
+	  case Symbol::FROM_OBJECT:
+	    {
+	      bool is_ordinary;
+	      unsigned int in_shndx = sym->shndx(&is_ordinary);
 
-	    if (!is_ordinary
-		&& in_shndx != elfcpp::SHN_ABS
-		&& !Symbol::is_common_shndx(in_shndx))
-	      {
-		gold_error(_("%s: unsupported symbol section 0x%x"),
-			   sym->demangled_name().c_str(), in_shndx);
-		shndx = in_shndx;
-	      }
-	    else
-	      {
-		Object* symobj = sym->object();
-		if (symobj->is_dynamic())
-		  {
-		    if (sym->needs_dynsym_value())
-		      dynsym_value = target.dynsym_value(sym);
-		    shndx = elfcpp::SHN_UNDEF;
-		    if (sym->is_undef_binding_weak())
-		      binding = elfcpp::STB_WEAK;
-		    else
-		      binding = elfcpp::STB_GLOBAL;
-		  }
-		else if (symobj->pluginobj() != NULL)
-		  shndx = elfcpp::SHN_UNDEF;
-		else if (in_shndx == elfcpp::SHN_UNDEF
-			 || (!is_ordinary
-			     && (in_shndx == elfcpp::SHN_ABS
-				 || Symbol::is_common_shndx(in_shndx))))
+	      if (!is_ordinary
+		  && in_shndx != elfcpp::SHN_ABS
+		  && !Symbol::is_common_shndx(in_shndx))
+		{
+		  gold_error(_("%s: unsupported symbol section 0x%x"),
+			     sym->demangled_name().c_str(), in_shndx);
 		  shndx = in_shndx;
-		else
-		  {
-		    Relobj* relobj = static_cast<Relobj*>(symobj);
-		    Output_section* os = relobj->output_section(in_shndx);
-                    if (this->is_section_folded(relobj, in_shndx))
-                      {
-                        // This global symbol must be written out even though
-                        // it is folded.
-                        // Get the os of the section it is folded onto.
-                        Section_id folded =
-                             this->icf_->get_folded_section(relobj, in_shndx);
-                        gold_assert(folded.first !=NULL);
-                        Relobj* folded_obj = 
-                          reinterpret_cast<Relobj*>(folded.first);
-                        os = folded_obj->output_section(folded.second);  
-                        gold_assert(os != NULL);
-                      }
-		    gold_assert(os != NULL);
-		    shndx = os->out_shndx();
-
-		    if (shndx >= elfcpp::SHN_LORESERVE)
-		      {
-			if (sym_index != -1U)
-			  symtab_xindex->add(sym_index, shndx);
-			if (dynsym_index != -1U)
-			  dynsym_xindex->add(dynsym_index, shndx);
-			shndx = elfcpp::SHN_XINDEX;
-		      }
-
-		    // In object files symbol values are section
-		    // relative.
-		    if (parameters->options().relocatable())
-		      sym_value -= os->address();
-		  }
-	      }
-	  }
-	  break;
+		}
+	      else
+		{
+		  Object* symobj = sym->object();
+		  if (symobj->is_dynamic())
+		    {
+		      if (sym->needs_dynsym_value())
+			dynsym_value = target.dynsym_value(sym);
+		      shndx = elfcpp::SHN_UNDEF;
+		      if (sym->is_undef_binding_weak())
+			binding = elfcpp::STB_WEAK;
+		      else
+			binding = elfcpp::STB_GLOBAL;
+		    }
+		  else if (symobj->pluginobj() != NULL)
+		    shndx = elfcpp::SHN_UNDEF;
+		  else if (in_shndx == elfcpp::SHN_UNDEF
+			   || (!is_ordinary
+			       && (in_shndx == elfcpp::SHN_ABS
+				   || Symbol::is_common_shndx(in_shndx))))
+		    shndx = in_shndx;
+		  else
+		    {
+		      Relobj* relobj = static_cast<Relobj*>(symobj);
+		      Output_section* os = relobj->output_section(in_shndx);
+		      if (this->is_section_folded(relobj, in_shndx))
+			{
+			  // This global symbol must be written out even though
+			  // it is folded.
+			  // Get the os of the section it is folded onto.
+			  Section_id folded =
+			       this->icf_->get_folded_section(relobj, in_shndx);
+			  gold_assert(folded.first !=NULL);
+			  Relobj* folded_obj = 
+			    reinterpret_cast<Relobj*>(folded.first);
+			  os = folded_obj->output_section(folded.second);  
+			  gold_assert(os != NULL);
+			}
+		      gold_assert(os != NULL);
+		      shndx = os->out_shndx();
+
+		      if (shndx >= elfcpp::SHN_LORESERVE)
+			{
+			  if (sym_index != -1U)
+			    symtab_xindex->add(sym_index, shndx);
+			  if (dynsym_index != -1U)
+			    dynsym_xindex->add(dynsym_index, shndx);
+			  shndx = elfcpp::SHN_XINDEX;
+			}
+
+		      // In object files symbol values are section
+		      // relative.
+		      if (parameters->options().relocatable())
+			sym_value -= os->address();
+		    }
+		}
+	    }
+	    break;
 
-	case Symbol::IN_OUTPUT_DATA:
-	  {
-	    Output_data* od = sym->output_data();
+	  case Symbol::IN_OUTPUT_DATA:
+	    {
+	      Output_data* od = sym->output_data();
 
-	    shndx = od->out_shndx();
-	    if (shndx >= elfcpp::SHN_LORESERVE)
-	      {
-		if (sym_index != -1U)
-		  symtab_xindex->add(sym_index, shndx);
-		if (dynsym_index != -1U)
-		  dynsym_xindex->add(dynsym_index, shndx);
-		shndx = elfcpp::SHN_XINDEX;
-	      }
+	      shndx = od->out_shndx();
+	      if (shndx >= elfcpp::SHN_LORESERVE)
+		{
+		  if (sym_index != -1U)
+		    symtab_xindex->add(sym_index, shndx);
+		  if (dynsym_index != -1U)
+		    dynsym_xindex->add(dynsym_index, shndx);
+		  shndx = elfcpp::SHN_XINDEX;
+		}
 
-	    // In object files symbol values are section
-	    // relative.
-	    if (parameters->options().relocatable())
-	      {
-		Output_section* os = od->output_section();
-		gold_assert(os != NULL);
-		sym_value -= os->address();
-	      }
-	  }
-	  break;
+	      // In object files symbol values are section
+	      // relative.
+	      if (parameters->options().relocatable())
+		{
+		  Output_section* os = od->output_section();
+		  gold_assert(os != NULL);
+		  sym_value -= os->address();
+		}
+	    }
+	    break;
 
-	case Symbol::IN_OUTPUT_SEGMENT:
-	  {
-	    Output_segment* oseg = sym->output_segment();
-	    Output_section* osect = oseg->first_section();
-	    if (osect == NULL)
-	      shndx = elfcpp::SHN_ABS;
-	    else
-	      shndx = osect->out_shndx();
-	  }
-	  break;
+	  case Symbol::IN_OUTPUT_SEGMENT:
+	    {
+	      Output_segment* oseg = sym->output_segment();
+	      Output_section* osect = oseg->first_section();
+	      if (osect == NULL)
+		shndx = elfcpp::SHN_ABS;
+	      else
+		shndx = osect->out_shndx();
+	    }
+	    break;
 
-	case Symbol::IS_CONSTANT:
-	  shndx = elfcpp::SHN_ABS;
-	  break;
+	  case Symbol::IS_CONSTANT:
+	    shndx = elfcpp::SHN_ABS;
+	    break;
 
-	case Symbol::IS_UNDEFINED:
-	  shndx = elfcpp::SHN_UNDEF;
-	  break;
+	  case Symbol::IS_UNDEFINED:
+	    shndx = elfcpp::SHN_UNDEF;
+	    break;
 
-	default:
-	  gold_unreachable();
-	}
+	  default:
+	    gold_unreachable();
+	  }
 
-      if (sym_index != -1U)
-	{
-	  sym_index -= first_global_index;
-	  gold_assert(sym_index < output_count);
-	  unsigned char* ps = psyms + (sym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
-						     binding, sympool, ps);
-	}
+	if (sym_index != -1U)
+	  {
+	    sym_index -= first_global_index;
+	    gold_assert(sym_index < output_count);
+	    unsigned char* ps = psyms + (sym_index * sym_size);
+	    this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
+						       binding, sympool, ps);
+	  }
 
-      if (dynsym_index != -1U)
-	{
-	  dynsym_index -= first_dynamic_global_index;
-	  gold_assert(dynsym_index < dynamic_count);
-	  unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
-						     binding, dynpool, pd);
-          // Allow a target to adjust dynamic symbol value.
-          parameters->target().adjust_dyn_symbol(sym, pd);
-	}
-    }
+	if (dynsym_index != -1U)
+	  {
+	    dynsym_index -= first_dynamic_global_index;
+	    gold_assert(dynsym_index < dynamic_count);
+	    unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
+	    this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
+						       binding, dynpool, pd);
+	    // Allow a target to adjust dynamic symbol value.
+	    parameters->target().adjust_dyn_symbol(sym, pd);
+	  }
+      }
 
   // Write the target-specific symbols.
   for (std::vector<Symbol*>::const_iterator p = this->target_symbols_.begin();
@@ -3461,13 +3847,29 @@ Symbol_table::sized_write_section_symbol(const Output_section* os,
 void
 Symbol_table::print_stats() const
 {
+  size_t entries = 0;
+  size_t buckets = 0;
+  for (std::vector<Symbol_table_type>::const_iterator p =
+	 this->tables_.begin();
+       p != this->tables_.end();
+       ++p)
+    {
+      entries += p->size();
+#if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
+      buckets += p->bucket_count();
+#endif
+    }
 #if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
   fprintf(stderr, _("%s: symbol table entries: %zu; buckets: %zu\n"),
-	  program_name, this->table_.size(), this->table_.bucket_count());
+	  program_name, entries, buckets);
 #else
   fprintf(stderr, _("%s: symbol table entries: %zu\n"),
-	  program_name, this->table_.size());
+	  program_name, entries);
 #endif
+  if (this->tables_.size() > 1)
+    fprintf(stderr, _("%s: symbol table shards: %zu; "
+		      "objects resolved in shards: %zu\n"),
+	    program_name, this->tables_.size(), this->sharded_add_count_);
   this->namepool_.print_stats("symbol table stringpool");
 }
 
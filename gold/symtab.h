@@ -60,6 +60,11 @@ class Output_file;
 class Output_symtab_xindex;
 class Garbage_collection;
 class Icf;
+class Workqueue;
+class Task_token;
+class Sharded_add;
+template<int size, bool big_endian>
+class Sized_sharded_add;
 
 // The base class of an entry in the symbol table.  The symbol table
 // can have a lot of entries, so we don't want this class too big.
@@ -1476,6 +1481,21 @@ class Symbol_table
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
+  // Set whether add_from_relobj may leave the symbols of a large
+  // object to be resolved by tasks running in parallel, one for each
+  // shard of the symbol table (see --symbol-shards).  This is only
+  // set while adding the symbols of an object which is followed by a
+  // blocker, so that the tasks can hold up the next object.
+  void
+  set_allow_sharded_add(bool allow)
+  { this->allow_sharded_add_ = allow; }
+
+  // If the last call to add_from_relobj left symbols to be resolved
+  // in shards, queue the tasks to do it.  NEXT_BLOCKER is kept
+  // blocked until they are all done.
+  void
+  queue_sharded_add(Workqueue*, Task_token* next_blocker);
+
   // Add one external symbol from the plugin object OBJ to the symbol table.
   // Returns a pointer to the resolved symbol in the symbol table.
   template<int size, bool big_endian>
@@ -1693,13 +1713,15 @@ class Symbol_table
   void
   for_all_symbols(F f) const
   {
-    for (Symbol_table_type::const_iterator p = this->table_.begin();
-         p != this->table_.end();
-         ++p)
-      {
-	Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
-	f(sym);
-      }
+    for (size_t i = 0; i < this->tables_.size(); ++i)
+      for (Symbol_table_type::const_iterator p = this->tables_[i].begin();
+	   p != this->tables_[i].end();
+	   ++p)
+	{
+	  Sized_symbol<size>* sym =
+	    static_cast<Sized_symbol<size>*>(p->second);
+	  f(sym);
+	}
   }
 
   // Dump statistical information to stderr.
@@ -1754,24 +1776,125 @@ class Symbol_table
                         Unordered_set<Symbol_location, Symbol_location_hash> >
   Odr_map;
 
+  // A symbol read from a relocatable object, ready to be added to the
+  // symbol table.
+  template<int size, bool big_endian>
+  struct Relobj_symbol;
+
+  // The state of one shard while the symbols of an object are being
+  // resolved in parallel.  Updates to the lists shared by all the
+  // shards are deferred, and applied in symbol order when all the
+  // shards are done, so that the result does not depend on the order
+  // in which the shards ran.
+  struct Symbol_shard
+  {
+    // A deferred update.  If COMMONS is not NULL, SYM is added to
+    // that list of common symbols.  Otherwise, if TO is not NULL, SYM
+    // is made a forwarder to TO.  Otherwise SYM is added to the list
+    // of forced local symbols.
+    struct Action
+    {
+      size_t symndx;
+      Commons_type* commons;
+      Symbol* sym;
+      Symbol* to;
+
+      // Actions are applied in symbol order.
+      bool
+      operator<(const Action& a) const
+      { return this->symndx < a.symndx; }
+    };
+
+    Symbol_shard()
+      : symbols(), symndx(0), saw_undefined(0), actions()
+    { }
+
+    // Record a deferred update for the current symbol.
+    void
+    defer(Commons_type* commons, Symbol* sym, Symbol* to)
+    {
+      Action a = { this->symndx, commons, sym, to };
+      this->actions.push_back(a);
+    }
+
+    // The indexes of the symbols which fall in this shard.
+    std::vector<size_t> symbols;
+    // The index of the symbol currently being added.
+    size_t symndx;
+    // The number of new undefined symbols seen.
+    size_t saw_undefined;
+    // The deferred updates, in symbol order.
+    std::vector<Action> actions;
+  };
+
+  typedef std::vector<Symbol_shard> Symbol_shards;
+
+  // Let the sharded add tasks resolve symbols.
+  friend class Sharded_add;
+  template<int, bool>
+  friend class Sized_sharded_add;
+
+  // Return the index of the shard of the symbol hash table which
+  // holds the symbols named NAME_KEY.
+  unsigned int
+  shard(Stringpool::Key name_key) const
+  { return name_key % this->tables_.size(); }
+
+  // Return the shard of the symbol hash table which holds the symbols
+  // named NAME_KEY.
+  Symbol_table_type&
+  table(Stringpool::Key name_key)
+  { return this->tables_[this->shard(name_key)]; }
+
+  const Symbol_table_type&
+  table(Stringpool::Key name_key) const
+  { return this->tables_[this->shard(name_key)]; }
+
   // Make FROM a forwarder symbol to TO.
   void
   make_forwarder(Symbol* from, Symbol* to);
 
-  // Add a symbol.
+  // Add a symbol.  If SHARD is not NULL, we are running in parallel
+  // with the other shards.
   template<int size, bool big_endian>
   Sized_symbol<size>*
   add_from_object(Object*, const char* name, Stringpool::Key name_key,
 		  const char* version, Stringpool::Key version_key,
 		  bool def, const elfcpp::Sym<size, big_endian>& sym,
 		  unsigned int st_shndx, bool is_ordinary,
-		  unsigned int orig_st_shndx);
+		  unsigned int orig_st_shndx, Symbol_shard* shard = NULL);
+
+  // Read external symbol I, at P, from RELOBJ into *RSYM.  This does
+  // the work of add_from_relobj which must be done serially.  Return
+  // false if the symbol should be skipped.
+  template<int size, bool big_endian>
+  bool
+  read_relobj_symbol(Sized_relobj_file<size, big_endian>* relobj,
+		     const unsigned char* p, size_t i, size_t symndx_offset,
+		     const char* sym_names, size_t sym_name_size,
+		     Relobj_symbol<size, big_endian>* rsym, size_t* defined);
+
+  // Add a symbol read by read_relobj_symbol to the symbol table.
+  template<int size, bool big_endian>
+  Sized_symbol<size>*
+  add_relobj_symbol(Sized_relobj_file<size, big_endian>* relobj,
+		    const Relobj_symbol<size, big_endian>& rsym,
+		    Symbol_shard* shard);
+
+  // Return whether the COUNT symbols of an object may be resolved in
+  // shards.
+  bool
+  should_shard_add(size_t count) const;
+
+  // Apply the updates deferred by the shards, in symbol order.
+  void
+  finish_sharded_add(Symbol_shards*);
 
   // Define a default symbol.
   template<int size, bool big_endian>
   void
   define_default_version(Sized_symbol<size>*, bool,
-			 Symbol_table_type::iterator);
+			 Symbol_table_type::iterator, Symbol_shard* shard);
 
   // Resolve symbols.
   template<int size, bool big_endian>
@@ -1788,9 +1911,10 @@ class Symbol_table
   resolve(Sized_symbol<size>* to, const Sized_symbol<size>* from);
 
   // Record that a symbol is forced to be local by a version script or
-  // by visibility.
+  // by visibility.  If SHARD is not NULL, adding the symbol to the
+  // list of forced local symbols is deferred.
   void
-  force_local(Symbol*);
+  force_local(Symbol*, Symbol_shard* shard = NULL);
 
   // Adjust NAME and *NAME_KEY for wrapping.
   const char*
@@ -1981,8 +2105,16 @@ class Symbol_table
   // The number of global dynamic symbols (including forced-local symbols),
   // or 0 if none.
   unsigned int dynamic_count_;
-  // The symbol hash table.
-  Symbol_table_type table_;
+  // The symbol hash table.  This is split into shards by name key,
+  // so that the symbols of an object can be resolved in parallel.
+  std::vector<Symbol_table_type> tables_;
+  // Whether add_from_relobj may leave symbols to be resolved in
+  // shards.
+  bool allow_sharded_add_;
+  // The symbols left to be resolved in shards, if any.
+  Sharded_add* sharded_add_;
+  // The number of objects whose symbols were resolved in shards.
+  size_t sharded_add_count_;
   // A pool of symbol names.  This is used for all global symbols.
   // Entries in the hash table point into this pool.
   Stringpool namepool_;
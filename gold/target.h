@@ -61,6 +61,7 @@ class Output_data_got_base;
 class Output_section;
 class Input_objects;
 class Task;
+class Workqueue;
 struct Symbol_location;
 class Versions;
 
@@ -310,6 +311,12 @@ class Target
   can_check_for_function_pointers() const
   { return this->do_can_check_for_function_pointers(); }
 
+  // Print target specific statistics to stderr.  This is used by
+  // --stats.
+  void
+  print_stats() const
+  { this->do_print_stats(); }
+
   // Return whether a relocation to a merged section can be processed
   // to retrieve the contents.
   bool
@@ -384,15 +391,17 @@ class Target
   }
 
   // Perform a relaxation pass.  Return true if layout may be changed.
+  // WORKQUEUE may be used to run parts of the pass in parallel.
   bool
   relax(int pass, const Input_objects* input_objects, Symbol_table* symtab,
-	Layout* layout, const Task* task)
+	Layout* layout, Workqueue* workqueue, const Task* task)
   {
     // Run the dummy relaxation pass twice if relaxation debugging is enabled.
     if (is_debugging_enabled(DEBUG_RELAXATION))
       return pass < 2;
 
-    return this->do_relax(pass, input_objects, symtab, layout, task);
+    return this->do_relax(pass, input_objects, symtab, layout, workqueue,
+			  task);
   }
 
   // Return the target-specific name of attributes section.  This is
@@ -673,6 +682,11 @@ class Target
 	    && !is_prefix_of(".eh_frame", section_name));
   }
 
+  // Virtual function which may be overridden by the child class.
+  virtual void
+  do_print_stats() const
+  { }
+
   virtual uint64_t
   do_ehframe_datarel_base() const
   { gold_unreachable(); }
@@ -742,7 +756,8 @@ class Target
 
   // Virtual function which may be overridden by the child class.
   virtual bool
-  do_relax(int, const Input_objects*, Symbol_table*, Layout*, const Task*)
+  do_relax(int, const Input_objects*, Symbol_table*, Layout*, Workqueue*,
+	   const Task*)
   { return false; }
 
   // A function for targets to call.  Return whether BYTES/LEN matches
@@ -1093,6 +1108,16 @@ class Sized_target : public Target
   emit_copy_reloc(Symbol_table*, Symbol*, Output_section*, off_t)
   { gold_unreachable(); }
 
+  // Emit a dynamic relocation copied from the base file.  GSYM is
+  // NULL for a relocation with no symbol.
+  // A target needs to implement this to support incremental linking.
+
+  virtual void
+  emit_dynamic_reloc_for_update(Symbol* /* gsym */, unsigned int /* r_type */,
+				Output_section*, off_t,
+				typename elfcpp::Elf_types<size>::Elf_Swxword)
+  { gold_unreachable(); }
+
   // Apply an incremental relocation.
 
   virtual void
@@ -0,0 +1,69 @@
+#!/bin/sh
+
+# aarch64_stub_scan_skip.sh -- test --no-stub-scan-skip for AArch64.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# aarch64_stub_scan_skip.s is linked with sections skipped in later
+# stub relaxation passes.  The bl in .text.b only goes out of range in
+# the second pass, after the .text.c sections have been skipped, so
+# check that it was still given a stub.  Each stub branches to its
+# target with br x16; the stub for the bl in .text.b loads the address
+# of _low_target from the word after its two instructions.
+
+check_stats()
+{
+  if ! grep -q "$1" aarch64_stub_scan_skip.stats; then
+    echo "Did not find \"$1\" in"
+    echo ""
+    cat aarch64_stub_scan_skip.stats
+    exit 1
+  fi
+}
+
+check_stats "stub relaxation passes: 3\$"
+check_stats "stub relaxation pass [23]: .* [1-9][0-9]* skipped"
+
+for sym in _low_target _high_target; do
+  if grep -q "bl	[0-9a-f]* <$sym>" aarch64_stub_scan_skip.stdout; then
+    echo "Found a direct branch to $sym in"
+    echo ""
+    cat aarch64_stub_scan_skip.stdout
+    exit 1
+  fi
+done
+
+count=`grep -c "	d61f0200 	" aarch64_stub_scan_skip.stdout`
+if test "$count" != 2; then
+  echo "Found $count stubs instead of 2 in"
+  echo ""
+  cat aarch64_stub_scan_skip.stdout
+  exit 1
+fi
+
+if ! grep -A2 "	58000050 	" aarch64_stub_scan_skip.stdout \
+     | grep -q "	00001000 	"; then
+  echo "Did not find a stub to _low_target in"
+  echo ""
+  cat aarch64_stub_scan_skip.stdout
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# archive_cache_test.sh -- test --archive-cache.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Link the same program from an archive twice with --archive-cache,
+# and once without.  The first link misses and writes the cache, and
+# the second hits and reads it.  The outputs must be identical.  Then
+# link from another archive, rewrite that archive with its members in
+# a different order, and link again: the second link must miss rather
+# than use the archive map of the old archive.  The system archives
+# in the link are cached too, so only the misses are exact.
+
+check_stats()
+{
+    if ! grep -q "archive cache hits: $2 misses: $3\$" "$1"; then
+	echo "Did not find archive cache hits $2 misses $3 in $1:"
+	echo ""
+	cat "$1"
+	exit 1
+    fi
+}
+
+for f in archive_cache_test_1 archive_cache_test_2; do
+  if ! cmp -s $f archive_cache_test_ref; then
+    echo "$f and archive_cache_test_ref differ"
+    exit 1
+  fi
+done
+
+check_stats archive_cache_test_1.stats "[0-9]*" "[1-9][0-9]*"
+check_stats archive_cache_test_2.stats "[1-9][0-9]*" 0
+check_stats archive_cache_test_3a.stats "[1-9][0-9]*" 1
+check_stats archive_cache_test_3.stats "[1-9][0-9]*" 1
+
+if ! ls archive_cache_test.dir/archive_cache_test.a-*.armap > /dev/null; then
+  echo "Did not find archive cache file"
+  exit 1
+fi
+
+./archive_cache_test_2
+./archive_cache_test_3
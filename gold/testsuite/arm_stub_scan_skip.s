@@ -0,0 +1,95 @@
+# arm_stub_scan_skip.s -- test skipping sections in later stub relaxation passes.
+# See arm_stub_scan_skip.t for the layout.
+	.syntax	unified
+	.arch	armv5te
+	.arm
+	.section	.text.low,"ax",%progbits
+	.align	2
+	.global	_low_target
+_low_target:
+	bx	lr
+
+	.section	.text.a,"ax",%progbits
+	.align	2
+	.global	_start
+_start:
+	bl	_high_target
+# Pad .text.a so that the bl in .text.b is 0x2000000 - 8 bytes past _low_target.
+	.space	0x1000 - 4
+
+	.section	.text.b,"ax",%progbits
+	.align	2
+	.global	_b
+_b:
+	bl	_low_target
+	bx	lr
+
+	.section	.text.c0,"ax",%progbits
+	.align	2
+	.global	_c0
+_c0:
+	bl	_c1
+	bl	_start
+	bx	lr
+
+	.section	.text.c1,"ax",%progbits
+	.align	2
+	.global	_c1
+_c1:
+	bl	_c2
+	bl	_start
+	bx	lr
+
+	.section	.text.c2,"ax",%progbits
+	.align	2
+	.global	_c2
+_c2:
+	bl	_c3
+	bl	_start
+	bx	lr
+
+	.section	.text.c3,"ax",%progbits
+	.align	2
+	.global	_c3
+_c3:
+	bl	_c4
+	bl	_start
+	bx	lr
+
+	.section	.text.c4,"ax",%progbits
+	.align	2
+	.global	_c4
+_c4:
+	bl	_c5
+	bl	_start
+	bx	lr
+
+	.section	.text.c5,"ax",%progbits
+	.align	2
+	.global	_c5
+_c5:
+	bl	_c6
+	bl	_start
+	bx	lr
+
+	.section	.text.c6,"ax",%progbits
+	.align	2
+	.global	_c6
+_c6:
+	bl	_c7
+	bl	_start
+	bx	lr
+
+	.section	.text.c7,"ax",%progbits
+	.align	2
+	.global	_c7
+_c7:
+	bl	_c0
+	bl	_start
+	bx	lr
+
+	.section	.text.high,"ax",%progbits
+	.align	2
+	.global	_high_target
+_high_target:
+	bx	lr
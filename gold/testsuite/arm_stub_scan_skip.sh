@@ -0,0 +1,62 @@
+#!/bin/sh
+
+# arm_stub_scan_skip.sh -- test --no-stub-scan-skip for ARM.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# arm_stub_scan_skip.s is linked with sections skipped in later stub
+# relaxation passes.  The bl in .text.b only goes out of range in the
+# second pass, after the .text.c sections have been skipped, so check
+# that it was still given a stub.  Each stub loads the address of its
+# target into pc.
+
+check_stats()
+{
+  if ! grep -q "$1" arm_stub_scan_skip.stats; then
+    echo "Did not find \"$1\" in"
+    echo ""
+    cat arm_stub_scan_skip.stats
+    exit 1
+  fi
+}
+
+check_stats "stub relaxation passes: 3\$"
+check_stats "stub relaxation pass [23]: .* [1-9][0-9]* skipped"
+
+for sym in _low_target _high_target; do
+  if grep -q "bl	[0-9a-f]* <$sym>" arm_stub_scan_skip.stdout; then
+    echo "Found a direct branch to $sym in"
+    echo ""
+    cat arm_stub_scan_skip.stdout
+    exit 1
+  fi
+done
+
+for addr in 00001000 04100000; do
+  if ! grep -A1 "	e51ff004 	" arm_stub_scan_skip.stdout \
+       | grep -q "	$addr 	"; then
+    echo "Did not find a stub to 0x$addr in"
+    echo ""
+    cat arm_stub_scan_skip.stdout
+    exit 1
+  fi
+done
+
+exit 0
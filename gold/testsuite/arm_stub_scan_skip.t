@@ -0,0 +1,39 @@
+/* arm_stub_scan_skip.t -- linker script to test ARM stub scan skipping.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* The bl in .text.b starts out just in range of _low_target.  The
+   stub for the bl in .text.a, which is out of range of _high_target,
+   moves it out of range, so that it needs a stub in the second pass.
+   The .text.c sections only branch within .text, and can be skipped
+   once they have been scanned.  */
+
+SECTIONS
+{
+  . = 0x1000;
+  .text.low : { *(.text.low) }
+  . = 0x1fffff8;
+  .text : { *(.text.a) *(.text.b) *(.text.c*) }
+  . = 0x4100000;
+  .text.high : { *(.text.high) }
+  .data : { *(.data) }
+  .bss : { *(.bss) }
+  .ARM.attributes : { *(.ARM.attributes) }
+}
@@ -0,0 +1,94 @@
+#!/bin/sh
+
+# batch_relocs_bench.sh -- measure relocations per second with and
+# without --batch-relocs.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This is a benchmark, not a test, and is not run by "make check".
+# Run it with "make bench-batch-relocs".
+
+# Usage: batch_relocs_bench.sh LD AS [COUNT [RUNS]]
+
+# Generate an object with COUNT each of R_X86_64_64, R_X86_64_PC32
+# and R_X86_64_PLT32 relocations against 1024 global symbols, link
+# it RUNS times with and without --batch-relocs, and report the
+# relocations per second of the fastest link of each kind.  The
+# links do little besides applying relocations, but the time
+# includes reading the input and writing the output.
+
+ld=$1
+as=$2
+count=${3:-200000}
+runs=${4:-5}
+
+if test -z "$ld" || test -z "$as"; then
+  echo "usage: $0 LD AS [COUNT [RUNS]]" 1>&2
+  exit 1
+fi
+
+awk -v count=$count 'BEGIN {
+  print "\t.text"
+  print "\t.globl _start"
+  print "_start:"
+  for (i = 0; i < count; ++i)
+    printf "\tcall g%d@PLT\n", i % 1024
+  print "\tret"
+  for (i = 0; i < 1024; ++i)
+    printf "\t.globl g%d\ng%d:\n\tret\n", i, i
+  print "\t.data"
+  for (i = 0; i < count; ++i)
+    printf "\t.quad g%d+%d\n\t.long g%d-.\n", i % 1024, i % 64, i % 1024
+}' > batch_relocs_bench.s || exit 1
+
+$as --64 -o batch_relocs_bench.o batch_relocs_bench.s || exit 1
+
+relocs=`expr $count \* 3`
+
+# Print the wall clock time in nanoseconds of the fastest of RUNS
+# links with the options in $1.
+
+best_time()
+{
+  best=
+  i=0
+  while test $i -lt $runs; do
+    start=`date +%s%N`
+    $ld $1 -o batch_relocs_bench batch_relocs_bench.o || exit 1
+    end=`date +%s%N`
+    t=`expr $end - $start`
+    if test -z "$best" || test $t -lt $best; then
+      best=$t
+    fi
+    i=`expr $i + 1`
+  done
+  echo $best
+}
+
+for opt in --no-batch-relocs --batch-relocs; do
+  ns=`best_time $opt` || exit 1
+  awk -v opt=$opt -v relocs=$relocs -v ns=$ns 'BEGIN {
+    printf "%s: %d relocations in %.3f ms, %.0f relocations per second\n",
+      opt, relocs, ns / 1e6, relocs * 1e9 / ns
+  }'
+done
+
+rm -f batch_relocs_bench batch_relocs_bench.o batch_relocs_bench.s
+exit 0
@@ -0,0 +1,73 @@
+// batch_relocs_test.c -- a test case for --batch-relocs.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This source file defines 512 functions, each with its own static
+// counter, and a table of pointers to them, so that the object has
+// many R_X86_64_64, R_X86_64_PC32 and R_X86_64_PLT32 relocations.
+// The test links it with and without --batch-relocs and compares
+// the outputs.
+
+#include <stdio.h>
+
+#define DEF(n) \
+  static int d##n; \
+  int f##n (void); \
+  int f##n (void) { return ++d##n; }
+
+#define DEF8(n) \
+  DEF(n##0) DEF(n##1) DEF(n##2) DEF(n##3) \
+  DEF(n##4) DEF(n##5) DEF(n##6) DEF(n##7)
+
+#define DEF64(n) \
+  DEF8(n##0) DEF8(n##1) DEF8(n##2) DEF8(n##3) \
+  DEF8(n##4) DEF8(n##5) DEF8(n##6) DEF8(n##7)
+
+DEF64(0) DEF64(1) DEF64(2) DEF64(3) DEF64(4) DEF64(5) DEF64(6) DEF64(7)
+
+#define REF(n) f##n,
+
+#define REF8(n) \
+  REF(n##0) REF(n##1) REF(n##2) REF(n##3) \
+  REF(n##4) REF(n##5) REF(n##6) REF(n##7)
+
+#define REF64(n) \
+  REF8(n##0) REF8(n##1) REF8(n##2) REF8(n##3) \
+  REF8(n##4) REF8(n##5) REF8(n##6) REF8(n##7)
+
+int (*table[])(void) =
+{
+  REF64(0) REF64(1) REF64(2) REF64(3) REF64(4) REF64(5) REF64(6) REF64(7)
+};
+
+int
+main(void)
+{
+  int sum = 0;
+  int pass;
+  unsigned int i;
+
+  for (pass = 0; pass < 2; ++pass)
+    for (i = 0; i < sizeof table / sizeof table[0]; ++i)
+      sum += table[i]();
+  sum += f000() + f777();
+  printf("%d\n", sum);
+  return 0;
+}
@@ -0,0 +1,80 @@
+#!/bin/sh
+
+# batch_relocs_test.sh -- test --batch-relocs.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Link the same program with and without --batch-relocs.  The
+# outputs must be identical, and the batched link must have applied
+# some of the relocations in batches.  batch_relocs_test_2 has each
+# type of relocation which may be batched, against local and global
+# symbols and with positive and negative addends, mixed with
+# R_X86_64_REX_GOTPCRELX relocations which are not batched.
+
+if ! cmp -s batch_relocs_test batch_relocs_test_ref; then
+  echo "batch_relocs_test and batch_relocs_test_ref differ"
+  exit 1
+fi
+
+if ! grep -q "relocations applied in batches: [1-9][0-9]* of" \
+     batch_relocs_test.stats; then
+  echo "Did not find batched relocations in"
+  echo ""
+  cat batch_relocs_test.stats
+  exit 1
+fi
+
+if grep -q "relocations applied in batches" batch_relocs_test_ref.stats; then
+  echo "Found batched relocations with --no-batch-relocs in"
+  echo ""
+  cat batch_relocs_test_ref.stats
+  exit 1
+fi
+
+if test "`cat batch_relocs_test.stdout`" != "1542"; then
+  echo "Unexpected output from batch_relocs_test:"
+  cat batch_relocs_test.stdout
+  exit 1
+fi
+
+if ! cmp -s batch_relocs_test_2 batch_relocs_test_2_ref; then
+  echo "batch_relocs_test_2 and batch_relocs_test_2_ref differ"
+  exit 1
+fi
+
+for r in R_X86_64_64 R_X86_64_32 R_X86_64_32S R_X86_64_PC32 \
+	 R_X86_64_PLT32 R_X86_64_REX_GOTPCRELX; do
+  if ! grep -q " $r " batch_relocs_test_2.relocs; then
+    echo "Did not find $r in"
+    echo ""
+    cat batch_relocs_test_2.relocs
+    exit 1
+  fi
+done
+
+if ! grep -q "relocations applied in batches: 18 of 20" \
+     batch_relocs_test_2.stats; then
+  echo "Did not find 18 of 20 relocations applied in batches in"
+  echo ""
+  cat batch_relocs_test_2.stats
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,45 @@
+	.text
+	.globl	global_fn
+	.type	global_fn, @function
+global_fn:
+	ret
+	.size	global_fn, .-global_fn
+	.type	local_fn, @function
+local_fn:
+	ret
+	.size	local_fn, .-local_fn
+	.globl	_start
+	.type	_start, @function
+_start:
+	call	global_fn
+	call	local_fn
+	jmp	global_fn@PLT
+	leaq	global_data(%rip), %rax
+	leaq	local_data(%rip), %rax
+	leaq	global_data+8(%rip), %rax
+	leaq	local_data-8(%rip), %rax
+	movl	$global_data, %eax
+	movl	$local_data+4, %eax
+	movq	$global_data, %rax
+	movq	$local_data-4, %rax
+	movq	global_fn@GOTPCREL(%rip), %rax
+	movq	global_data@GOTPCREL(%rip), %rax
+	call	global_fn
+	.size	_start, .-_start
+
+	.data
+	.globl	global_data
+	.type	global_data, @object
+global_data:
+	.quad	global_fn
+	.quad	local_fn
+	.quad	global_data+16
+	.quad	local_data-16
+	.long	global_data
+	.long	local_data
+	.size	global_data, .-global_data
+	.type	local_data, @object
+local_data:
+	.quad	_start
+	.long	0
+	.size	local_data, .-local_data
@@ -0,0 +1,56 @@
+#!/bin/sh
+
+# build_id_fast_test.sh -- test --build-id=fast.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# build_id_fast_test is linked with --build-id=fast, hashing 4096-byte
+# chunks of the output file in parallel, once with and once without
+# threads.  The build ID must be 64 bits, and must not depend on the
+# number of threads.  build_id_fast_test_flat hashes the whole file
+# at once.
+
+check_build_id()
+{
+    if ! grep -q "Build ID: [0-9a-f]\{16\}$" "$1"; then
+	echo "Did not find a 64-bit build ID in $1"
+	echo ""
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_build_id build_id_fast_test.stdout
+check_build_id build_id_fast_test_threads.stdout
+check_build_id build_id_fast_test_flat.stdout
+
+if ! cmp -s build_id_fast_test build_id_fast_test_threads; then
+  echo "build_id_fast_test and build_id_fast_test_threads differ"
+  exit 1
+fi
+
+# The file contents apart from the build ID itself are the same, so
+# the tree hash of the chunks must differ from the flat hash.
+if cmp -s build_id_fast_test.stdout build_id_fast_test_flat.stdout; then
+  echo "build_id_fast_test and build_id_fast_test_flat have the same build ID"
+  exit 1
+fi
+
+./build_id_fast_test
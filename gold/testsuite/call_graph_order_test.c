@@ -0,0 +1,69 @@
+// call_graph_order_test.c -- a test case for --call-graph-ordering-file.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This is compiled with -ffunction-sections and linked with a call
+// graph in which main calls a, a calls d, and b calls c.  The
+// functions are defined in a different order, so that the test can
+// check that gold moved them.
+
+int c (void) __attribute__ ((noinline));
+int b (void) __attribute__ ((noinline));
+int e (void) __attribute__ ((noinline));
+int d (void) __attribute__ ((noinline));
+int a (void) __attribute__ ((noinline));
+
+int
+c (void)
+{
+  return 3;
+}
+
+int
+b (void)
+{
+  return c () - 1;
+}
+
+int
+e (void)
+{
+  return 5;
+}
+
+int
+d (void)
+{
+  return 4;
+}
+
+int
+a (void)
+{
+  return d () - 3;
+}
+
+int
+main (void)
+{
+  if (a () != 1 || b () != 2 || e () != 5)
+    return 1;
+  return 0;
+}
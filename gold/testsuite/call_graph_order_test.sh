@@ -0,0 +1,51 @@
+#!/bin/sh
+
+# call_graph_order_test.sh -- test --call-graph-ordering-file.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The call graph has main -> a -> d as the hot path, and b -> c as a
+# colder one.  Check that gold placed the functions in that order.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check call_graph_order_test.stats "call graph sections ordered: 5 in 2 clusters"
+
+order=`grep ' T \(main\|a\|b\|c\|d\)$' call_graph_order_test.syms | awk '{ print $3 }' | tr '\n' ' '`
+if test "$order" != "main a d b c "; then
+    echo "unexpected function order: $order"
+    echo ""
+    echo "Actual output below:"
+    cat call_graph_order_test.syms
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# compress_debug_sections_blocks_test.sh -- test compressing debug
+# sections in blocks.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The debug sections of these programs are compressed in 256-byte
+# blocks, which are concatenated into a single zlib stream.  readelf
+# must be able to decompress them, and the debug info must be the same
+# as when it is not compressed.  The output must not depend on the
+# number of threads.
+
+check_cmp()
+{
+    if ! cmp -s "$1" "$2"; then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+}
+
+check_cmp compress_debug_sections_blocks_test.stdout \
+	  flagstest_compress_debug_sections_none.stdout
+check_cmp compress_debug_sections_blocks_test_gnu.stdout \
+	  flagstest_compress_debug_sections_none.stdout
+check_cmp compress_debug_sections_blocks_test \
+	  compress_debug_sections_blocks_test_threads
+
+if ! grep -q "COMPRESSED" compress_debug_sections_blocks_test.sections; then
+  echo "Did not find compressed sections in"
+  echo ""
+  cat compress_debug_sections_blocks_test.sections
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# compress_debug_sections_zstd_test.sh -- test zstd compressed debug
+# sections.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# compress_debug_sections_zstd_test is linked with
+# --compress-debug-sections=zstd, and compress_debug_sections_zstd_test_blocks
+# also compresses in 256-byte blocks, each of which is a zstd frame.
+# readelf must be able to decompress their debug sections, as must
+# objcopy.  compress_debug_sections_zstd_test_input is linked from an
+# object file which gold wrote with zstd compressed debug sections.
+# The debug info must be the same as when it is not compressed.
+
+check_cmp()
+{
+    if ! cmp -s "$1" "$2"; then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+}
+
+check_cmp compress_debug_sections_zstd_test.stdout \
+	  flagstest_compress_debug_sections_none.stdout
+check_cmp compress_debug_sections_zstd_test_blocks.stdout \
+	  flagstest_compress_debug_sections_none.stdout
+check_cmp compress_debug_sections_zstd_test_unzstd.stdout \
+	  flagstest_compress_debug_sections_none.stdout
+check_cmp compress_debug_sections_zstd_test_input.stdout \
+	  flagstest_compress_debug_sections_none.stdout
+
+for f in compress_debug_sections_zstd_test.sections \
+	 compress_debug_sections_zstd_test_r.sections; do
+  if ! grep -q "ZSTD, " $f; then
+    echo "Did not find zstd compressed sections in $f"
+    echo ""
+    cat $f
+    exit 1
+  fi
+done
+
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/sh
+
+# dwp_test_3.sh -- Test the dwp tool with several jobs and a small
+# memory limit.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The input files are read in parallel, and the section contents are
+# moved to temporary files as soon as they are added.  The output must
+# be the same as when the files are read one at a time.
+
+check_cmp()
+{
+    if ! cmp -s "$1" "$2"; then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+}
+
+check_cmp dwp_test_1.dwp dwp_test_3.dwp
+check_cmp dwp_test_2.dwp dwp_test_3b.dwp
+
+exit 0
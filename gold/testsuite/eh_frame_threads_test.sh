@@ -0,0 +1,62 @@
+#!/bin/sh
+
+# eh_frame_threads_test.sh -- test reading .eh_frame sections in parallel.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Link the same program with and without threads.  With threads the
+# .eh_frame sections are parsed while the input files are read, and
+# the .eh_frame_hdr lookup table is sorted in separate tasks.  The
+# outputs must be identical, and exceptions must still work.
+
+# eh_frame_threads_test_large has 40000 FDEs, which is enough for the
+# lookup table to be sorted in two parts, each by its own task.  The
+# merged table must be the same as the one sorted without threads.
+# eh_frame_threads_test_large_compress also compresses its debug
+# sections, so the sort tasks and the compression tasks release the
+# same blocker.
+
+if ! cmp -s eh_frame_threads_test eh_frame_threads_test_ref; then
+  echo "eh_frame_threads_test and eh_frame_threads_test_ref differ"
+  exit 1
+fi
+
+for f in eh_frame_threads_test_large eh_frame_threads_test_large_compress; do
+  if ! cmp -s $f ${f}_ref; then
+    echo "$f and ${f}_ref differ"
+    exit 1
+  fi
+
+  count=`grep -c '"name": "Eh_frame_hdr_sort_task"' $f.json`
+  if test "$count" -lt 2; then
+    echo "The .eh_frame_hdr table of $f was not sorted in parts"
+    exit 1
+  fi
+done
+
+if ! grep -q '"name": "Compress_block_task' \
+     eh_frame_threads_test_large_compress.json; then
+  echo "The debug sections of eh_frame_threads_test_large_compress were not compressed"
+  exit 1
+fi
+
+./eh_frame_threads_test
+./eh_frame_threads_test_large
+./eh_frame_threads_test_large_compress
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# gc_threads_test.sh -- test --gc-sections with threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# gc_threads_test is linked from the same objects as gc_comdat_test,
+# but with several threads.  The sections collected must not depend
+# on the number of threads, so the programs must be the same.
+
+# gc_threads_test_large has levels of 10000 sections, which are large
+# enough to be marked by several tasks.  It is linked with and without
+# threads, and the programs must be the same.
+
+if ! cmp -s gc_comdat_test gc_threads_test; then
+  echo "gc_comdat_test and gc_threads_test differ"
+  exit 1
+fi
+
+if ! grep -q "removing unused section from '.text._Z3barv' in file 'gc_comdat_test_1.o'" gc_threads_test.stderr; then
+  echo "Did not find expected section in"
+  echo ""
+  cat gc_threads_test.stderr
+  exit 1
+fi
+
+if ! cmp -s gc_threads_test_large gc_threads_test_large_1; then
+  echo "gc_threads_test_large and gc_threads_test_large_1 differ"
+  exit 1
+fi
+
+if ! grep -q '"name": "Gc_mark_part_task"' gc_threads_test_large.json; then
+  echo "The sections of gc_threads_test_large were not marked in parts"
+  exit 1
+fi
+
+for sym in live_1 live_10000 leaf_1 leaf_5000 leaf_10000 gc_table; do
+  if ! grep -q " $sym\$" gc_threads_test_large.stdout; then
+    echo "$sym was removed from gc_threads_test_large"
+    exit 1
+  fi
+done
+
+if grep -q " dead_" gc_threads_test_large.stdout; then
+  echo "dead_* functions were not removed from gc_threads_test_large:"
+  grep " dead_" gc_threads_test_large.stdout | head
+  exit 1
+fi
+
+exit 0
@@ -0,0 +1,39 @@
+// gdb_index_test_5.c -- a test case for the --gdb-index option.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This source file is linked with gdb_index_test_3.c, so that the
+// index covers the compilation units of two objects, which gold
+// scans in parallel.  Some of the names are in both units.
+
+struct point
+{
+  int x;
+  int y;
+};
+
+enum color { RED, GREEN, BLUE };
+
+struct point origin;
+enum color background = GREEN;
+
+int
+check_point (struct point *p)
+{ return p->x == origin.x && p->y == origin.y; }
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# gdb_index_test_5.sh -- a test case for the --gdb-index option.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The objects of gdb_index_test_5 are scanned in parallel.  The index
+# must include the symbols of both objects, and must not depend on the
+# number of threads.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT=gdb_index_test_5.stdout
+
+check $STDOUT "^Version [4-7]"
+
+# Look for the symbols we know should be in the symbol table.
+
+check $STDOUT "^\[ *[0-9]*\] main:"
+check $STDOUT "^\[ *[0-9]*\] check_int:"
+check $STDOUT "^\[ *[0-9]*\] check_point:"
+check $STDOUT "^\[ *[0-9]*\] point:"
+check $STDOUT "^\[ *[0-9]*\] origin:"
+check $STDOUT "^\[ *[0-9]*\] GREEN:"
+check $STDOUT "^\[ *[0-9]*\] int:"
+
+if ! cmp -s gdb_index_test_5 gdb_index_test_5_threads; then
+    echo "gdb_index_test_5 and gdb_index_test_5_threads differ"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,61 @@
+#!/bin/sh
+
+# hash_bloom_test.sh -- test --hash-bloom-words and --hash-bloom-shift.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The shared library was linked with a 64 word bloom filter and a
+# shift count of 11.  These are the third and fourth words of the
+# .gnu.hash section.  The program linked against it must still find
+# its symbols.
+
+if ! grep -q "00000040 0000000b\|40000000 0b000000" hash_bloom_test.stdout
+then
+  echo "Did not find bloom filter size and shift in hash_bloom_test.so"
+  echo ""
+  cat hash_bloom_test.stdout
+  exit 1
+fi
+
+./hash_bloom_test
+
+# hash_bloom_test_max.so was linked with the largest bloom filter
+# allowed, 1 << 25 words.  With 8 byte words the filter alone is
+# 0x10000000 bytes.
+
+size=`sed -n -e 's/.* \.gnu\.hash *GNU_HASH *[0-9a-f]* [0-9a-f]* \([0-9a-f]*\) .*/\1/p' hash_bloom_test_max.stdout`
+if test -z "$size" || test $((0x$size)) -lt $((0x10000000)); then
+  echo "Wrong .gnu.hash size in hash_bloom_test_max.so"
+  echo ""
+  cat hash_bloom_test_max.stdout
+  exit 1
+fi
+
+./hash_bloom_test_max
+
+# Twice as many words must be rejected.
+
+if ! grep -q "hash-bloom-words value 67108864" hash_bloom_test_too_large.err
+then
+  echo "Did not find expected error in hash_bloom_test_too_large.err"
+  echo ""
+  cat hash_bloom_test_too_large.err
+  exit 1
+fi
@@ -0,0 +1,60 @@
+// hot_segment_test.c -- a test case for the --hot-segment option.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This is compiled with -ffunction-sections and -fdata-sections and
+// linked with --hot-symbols-file naming hot_function, hot_caller and
+// hot_table.  The test checks that gold placed them in a separate
+// segment aligned for huge pages, and that the program still runs.
+
+int hot_function (int) __attribute__ ((noinline));
+int hot_caller (int) __attribute__ ((noinline));
+int cold_function (int) __attribute__ ((noinline));
+
+const int hot_table[4] = { 1, 2, 3, 4 };
+const int cold_table[4] = { 5, 6, 7, 8 };
+
+int
+hot_function (int i)
+{
+  return hot_table[i & 3];
+}
+
+int
+hot_caller (int i)
+{
+  return hot_function (i) + hot_function (i + 1);
+}
+
+int
+cold_function (int i)
+{
+  return cold_table[i & 3];
+}
+
+int
+main (void)
+{
+  if (hot_caller (0) != 3)
+    return 1;
+  if (cold_function (1) != 6)
+    return 1;
+  return 0;
+}
@@ -0,0 +1,80 @@
+#!/bin/sh
+
+# hot_segment_test.sh -- test --hot-segment.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# hot_segment_test.c is linked with --hot-symbols-file.  Check that
+# the hot functions and data were placed in a segment aligned to a
+# huge page, without padding the file to that alignment, and that the
+# map file reports the coverage.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check hot_segment_test.map "^Hot segment"
+check hot_segment_test.map "^Huge page size   0x200000"
+check hot_segment_test.map "^Huge pages       1"
+check hot_segment_test.map "^Hot symbols      3 of 4 found"
+
+addr=`grep '^Address  ' hot_segment_test.map | awk '{ print $2 }'`
+size=`grep '^Size  ' hot_segment_test.map | awk '{ print $2 }'`
+pad=`grep '^File padding  ' hot_segment_test.map | awk '{ print $3 }'`
+if test $((addr % 0x200000)) -ne 0; then
+    echo "hot segment address $addr is not aligned"
+    exit 1
+fi
+if test $((pad)) -ge 4096; then
+    echo "hot segment file padding $pad is too large"
+    exit 1
+fi
+
+in_hot_segment()
+{
+    sym=`grep " $1\$" hot_segment_test.syms | awk '{ print $1 }'`
+    test $((0x$sym)) -ge $((addr)) && test $((0x$sym)) -lt $((addr + size))
+}
+
+for sym in hot_function hot_caller hot_table; do
+    if ! in_hot_segment $sym; then
+	echo "$sym is not in the hot segment"
+	cat hot_segment_test.syms
+	exit 1
+    fi
+done
+for sym in main cold_function cold_table; do
+    if in_hot_segment $sym; then
+	echo "$sym is in the hot segment"
+	cat hot_segment_test.syms
+	exit 1
+    fi
+done
+
+exit 0
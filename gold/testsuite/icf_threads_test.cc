@@ -0,0 +1,52 @@
+// icf_threads_test.cc -- a test case for gold
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// Many functions for identical code folding with several threads.
+// The leaf_* functions are identical.  The call_* functions each call
+// a different leaf_* function, so they are only identical once the
+// leaf_* functions are folded.  The unique_* functions must not be
+// folded.  There are enough sections that they are spread over all
+// the partitions used to group them.
+
+#define FUNCS4(m, p) m(p##0) m(p##1) m(p##2) m(p##3)
+#define FUNCS16(m, p) \
+  FUNCS4(m, p##0) FUNCS4(m, p##1) FUNCS4(m, p##2) FUNCS4(m, p##3)
+#define FUNCS64(m, p) \
+  FUNCS16(m, p##0) FUNCS16(m, p##1) FUNCS16(m, p##2) FUNCS16(m, p##3)
+#define FUNCS256(m) \
+  FUNCS64(m, 0) FUNCS64(m, 1) FUNCS64(m, 2) FUNCS64(m, 3)
+
+#define LEAF(n) \
+  extern "C" int leaf_##n(int x) { return x * 3 + 7; }
+#define CALL(n) \
+  extern "C" int call_##n(int x) { return leaf_##n(x) + 1; }
+#define UNIQUE(n) \
+  extern "C" int unique_##n(int x) { return x - 0##n; }
+
+FUNCS256(LEAF)
+FUNCS256(CALL)
+FUNCS256(UNIQUE)
+
+int
+main()
+{
+  return 0;
+}
@@ -0,0 +1,83 @@
+#!/bin/sh
+
+# icf_threads_test.sh -- test --icf with threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# icf_threads_test is linked from many identical functions with
+# several threads, and icf_threads_test_1 from the same object without
+# threads.  The sections folded must not depend on the number of
+# threads, so the programs must be the same.
+
+check_same()
+{
+  addr1=`grep " $1\$" icf_threads_test.stdout | awk '{print $1}'`
+  addr2=`grep " $2\$" icf_threads_test.stdout | awk '{print $1}'`
+  if test -z "$addr1" || test "$addr1" != "$addr2"; then
+    echo "$1 and $2 are not folded"
+    exit 1
+  fi
+}
+
+check_different()
+{
+  addr1=`grep " $1\$" icf_threads_test.stdout | awk '{print $1}'`
+  addr2=`grep " $2\$" icf_threads_test.stdout | awk '{print $1}'`
+  if test -z "$addr1" || test "$addr1" = "$addr2"; then
+    echo "$1 and $2 are folded"
+    exit 1
+  fi
+}
+
+if ! cmp -s icf_threads_test icf_threads_test_1; then
+  echo "icf_threads_test and icf_threads_test_1 differ"
+  exit 1
+fi
+
+check_same leaf_0000 leaf_3333
+check_same leaf_0000 leaf_2103
+check_same call_0000 call_3333
+check_same call_0000 call_1230
+check_different leaf_0000 call_0000
+check_different unique_0001 unique_0002
+check_different unique_0000 unique_3333
+
+# Each unique_* function has its own address.
+count=`grep " unique_" icf_threads_test.stdout | awk '{print $1}' | sort -u | wc -l`
+if test "$count" -ne 256; then
+  echo "Found $count unique_* functions instead of 256"
+  exit 1
+fi
+
+if ! grep -q "ICF iteration 1: .* [1-9][0-9]* sections folded" icf_threads_test.stderr; then
+  echo "Did not find ICF iteration statistics in"
+  echo ""
+  cat icf_threads_test.stderr
+  exit 1
+fi
+
+if ! grep -q "ICF converged after" icf_threads_test.stderr; then
+  echo "Did not find ICF convergence in"
+  echo ""
+  cat icf_threads_test.stderr
+  exit 1
+fi
+
+exit 0
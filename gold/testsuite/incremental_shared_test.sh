@@ -0,0 +1,50 @@
+#!/bin/sh
+
+# incremental_shared_test.sh -- test incremental updates of a shared library.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The library was linked with --incremental-full, then updated with
+# a replaced object which adds an exported function, and an input
+# script which was rewritten to name the same files.  The update
+# must not fall back to a full link.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check incremental_shared_test.stats "incremental link: update$"
+check incremental_shared_test.stats "input files changed: 1$"
+check incremental_shared_test.stats "input scripts changed compatibly: 1$"
+
+# The program calls the new function, and the unchanged object's
+# function pointers must still be relocated.
+check incremental_shared_test.stdout "^13 6$"
+
+exit 0
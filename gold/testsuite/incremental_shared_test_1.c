@@ -0,0 +1,56 @@
+// incremental_shared_test_1.c -- a test case for incremental updates
+// of a shared library.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This file is replaced by the incremental update.  The second
+// version adds a new exported function, so that .dynsym, .dynstr,
+// and the hash tables grow.
+
+int lib_1(int);
+#ifdef VERSION2
+int lib_1_new(int);
+#endif
+
+static int
+lib_1_local(int x)
+{
+#ifdef VERSION2
+  return x + 2;
+#else
+  return x + 1;
+#endif
+}
+
+int (*lib_1_ptr)(int) = lib_1_local;
+
+int
+lib_1(int x)
+{
+  return lib_1_ptr(x);
+}
+
+#ifdef VERSION2
+int
+lib_1_new(int x)
+{
+  return x * 3;
+}
+#endif
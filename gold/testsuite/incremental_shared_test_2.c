@@ -0,0 +1,42 @@
+// incremental_shared_test_2.c -- a test case for incremental updates
+// of a shared library.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This file is unchanged by the incremental update.  Its data needs
+// dynamic relocations, which must be kept in the updated library.
+
+extern int lib_1(int);
+int lib_2(int);
+
+static int
+lib_2_local(int x)
+{
+  return x * 10;
+}
+
+int (*lib_2_local_ptr)(int) = lib_2_local;
+int (*lib_2_global_ptr)(int) = lib_1;
+
+int
+lib_2(int x)
+{
+  return lib_2_local_ptr(x) + lib_2_global_ptr(x);
+}
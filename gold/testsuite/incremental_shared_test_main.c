@@ -0,0 +1,36 @@
+// incremental_shared_test_main.c -- a test case for incremental updates
+// of a shared library.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This program is linked against the updated library, and calls the
+// function which the update added.
+
+#include <stdio.h>
+
+extern int lib_1_new(int);
+extern int lib_2(int);
+
+int
+main(void)
+{
+  printf("%d %d\n", lib_2(1), lib_1_new(2));
+  return 0;
+}
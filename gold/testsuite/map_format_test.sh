@@ -0,0 +1,70 @@
+#!/bin/sh
+
+# map_format_test.sh -- test --Map-format.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# map_format_test is linked twice, writing the map file as JSON and
+# as CSV.  Check the records for the input sections, the symbols they
+# define, the archive member which was included, and the padding
+# before an aligned section.  In the JSON file, a name which is not
+# UTF-8 must be escaped, and a name which is UTF-8 must be copied.
+
+check()
+{
+    if ! grep -q -- "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check map_format_test.json '^{"records": \[$'
+check map_format_test.json '^\]}$'
+check map_format_test.json '{"kind": "archive_member", "name": "map_test_lib_function", "object": "map_format_test.a(map_format_test_2.o)", "archive": "map_format_test.a", "member": "map_format_test_2.o", "reason": "map_format_test_1.o"}'
+check map_format_test.json '{"kind": "output_section", "name": ".text", "address": [0-9]*, "size": [0-9]*, "alignment": [0-9]*}'
+check map_format_test.json '{"kind": "input_section", "output_section": ".text", "name": ".text.map_test_function", "address": [0-9]*, "size": [0-9]*, "alignment": [0-9]*, "padding": [0-9]*, "object": "map_format_test_1.o", "symbols": \[{"name": "map_test_function", "address": [0-9]*, "size": [0-9]*}\]}'
+check map_format_test.json '"name": ".text.map_test_lib_function", .*"object": "map_format_test.a(map_format_test_2.o)", "archive": "map_format_test.a", "member": "map_format_test_2.o", "symbols": \[{"name": "map_test_lib_function"'
+check map_format_test.json '"name": ".data.map_test_aligned", .*"alignment": 64, "padding": [1-9]'
+check map_format_test.json '"symbols": \[{"name": "map_test_latin1_\\u00e9", '
+utf8_name=`printf 'map_test_utf8_\303\251'`
+check map_format_test.json "\"symbols\": \\[{\"name\": \"$utf8_name\", "
+
+check map_format_test.csv '^kind,output_section,name,address,size,alignment,padding,object,archive,member,reason$'
+check map_format_test.csv '^archive_member,,map_test_lib_function,,,,,map_format_test.a(map_format_test_2.o),map_format_test.a,map_format_test_2.o,map_format_test_1.o$'
+check map_format_test.csv '^input_section,.text,.text.map_test_function,[0-9]*,[0-9]*,[0-9]*,[0-9]*,map_format_test_1.o,,,$'
+check map_format_test.csv '^symbol,.text,map_test_function,[0-9]*,[0-9]*,,,map_format_test_1.o,,,$'
+check map_format_test.csv '^input_section,.data,.data.map_test_small,[0-9]*,3,1,[0-9]*,map_format_test_1.o,,,$'
+check map_format_test.csv '^input_section,.data,.data.map_test_aligned,[0-9]*,16,64,[1-9][0-9]*,map_format_test.a(map_format_test_2.o),map_format_test.a,map_format_test_2.o,$'
+check map_format_test.csv '^symbol,.data,map_test_aligned,[0-9]*,16,,,map_format_test.a(map_format_test_2.o),map_format_test.a,map_format_test_2.o,$'
+
+# Both map files describe the same input sections.
+json_count=`grep -c '"kind": "input_section"' map_format_test.json`
+csv_count=`grep -c '^input_section,' map_format_test.csv`
+if test "$json_count" != "$csv_count"; then
+    echo "JSON map has $json_count input sections, CSV map has $csv_count"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,59 @@
+// map_format_test_1.c -- a test case for the --Map-format option.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+
+// This is compiled with -ffunction-sections and -fdata-sections and
+// linked with map_format_test.a, which holds map_format_test_2.o, and
+// with --Map-format=json and --Map-format=csv.  The test checks the
+// records which the map files hold for the sections of both objects.
+// The names of map_test_latin1 and map_test_utf8 end with the Latin-1
+// and the UTF-8 encodings of e with an acute accent.
+
+extern int map_test_lib_function (int);
+
+int map_test_function (int) __attribute__ ((noinline));
+
+char map_test_small[3] = { 1, 2, 3 };
+
+int map_test_latin1 (void) __asm__ ("map_test_latin1_\xe9");
+int map_test_utf8 (void) __asm__ ("map_test_utf8_\xc3\xa9");
+
+int
+map_test_latin1 (void)
+{
+  return 1;
+}
+
+int
+map_test_utf8 (void)
+{
+  return 2;
+}
+
+int
+map_test_function (int i)
+{
+  return map_test_small[i & 1] + map_test_lib_function (i);
+}
+
+int
+main (void)
+{
+  return map_test_function (0) == 2 ? 0 : 1;
+}
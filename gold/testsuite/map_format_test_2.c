@@ -0,0 +1,33 @@
+// map_format_test_2.c -- a test case for the --Map-format option.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+
+// This is put in an archive, and pulled in by map_format_test_1.c.
+// The alignment of map_test_aligned leaves a gap after the data of
+// map_format_test_1.o, which the map file reports as padding.
+
+int map_test_lib_function (int);
+
+int map_test_aligned[4] __attribute__ ((aligned (64))) = { 1 };
+
+int
+map_test_lib_function (int i)
+{
+  return map_test_aligned[i & 1];
+}
@@ -0,0 +1,69 @@
+#!/bin/sh
+
+# merge_string_parallel_test.sh -- test --parallel-merge-strings.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The merged string sections of merge_string_parallel_test_1.o and
+# merge_string_parallel_test_2.o share many strings, in .rodata and in
+# .debug_str, and many strings are suffixes of others.  Adding the
+# strings in parallel, with and without threads and with and without
+# tail merging, must give the same output as adding them in input
+# order.  Tail merging must make .rodata smaller.
+
+check_same()
+{
+  if ! cmp -s "$1" "$2"; then
+    echo "$1 and $2 differ"
+    exit 1
+  fi
+}
+
+check_same merge_string_parallel_test merge_string_parallel_test_ref
+check_same merge_string_parallel_test_threads merge_string_parallel_test_ref
+check_same merge_string_parallel_test_opt merge_string_parallel_test_opt_ref
+check_same merge_string_parallel_test_tail merge_string_parallel_test_tail_ref
+
+section_size()
+{
+  sed -n -e "s/.* $2 *PROGBITS *[0-9a-f]* [0-9a-f]* \([0-9a-f]*\) .*/\1/p" "$1"
+}
+
+ref_size=`section_size merge_string_parallel_test_ref.stdout .rodata`
+tail_size=`section_size merge_string_parallel_test_tail.stdout .rodata`
+if test -z "$ref_size" || test -z "$tail_size" \
+   || test $((0x$tail_size)) -ge $((0x$ref_size)); then
+  echo ".rodata was not made smaller by --tail-merge-strings"
+  echo "size without: $ref_size; size with: $tail_size"
+  exit 1
+fi
+
+for phase in "add tasks:" "add time:" "set offsets time:" "map time:" \
+	     "write time:"; do
+  if ! grep -q "\.debug_str merged strings $phase" \
+       merge_string_parallel_test.stats; then
+    echo "Did not find \"$phase\" in"
+    echo ""
+    cat merge_string_parallel_test.stats
+    exit 1
+  fi
+done
+
+./merge_string_parallel_test
@@ -0,0 +1,61 @@
+#!/bin/sh
+
+# prefetch_inputs_test.sh -- test --prefetch-inputs.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Link the same program with and without reading ahead the input
+# files.  The outputs must be identical.  With --prefetch-inputs=2,
+# --stats must report that the objects after the first were read
+# ahead; with --prefetch-inputs=0, that nothing was.
+
+check()
+{
+    if ! grep -q -- "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+if ! cmp -s prefetch_inputs_test prefetch_inputs_test_ref; then
+  echo "prefetch_inputs_test and prefetch_inputs_test_ref differ"
+  exit 1
+fi
+
+check prefetch_inputs_test.stats "input file reads: [1-9][0-9]*, waited [0-9.]*"
+check prefetch_inputs_test_ref.stats "input files read ahead: 0 (0 bytes)"
+
+# two_file_test_1b.o, two_file_test_2.o and two_file_test_main.o, at
+# least, are read ahead.
+count=`sed -n -e 's/.*input files read ahead: \([0-9]*\) ([0-9]* bytes)/\1/p' prefetch_inputs_test.stats`
+if test -z "$count" || test "$count" -lt 3; then
+  echo "Expected at least 3 files to be read ahead in"
+  echo ""
+  cat prefetch_inputs_test.stats
+  exit 1
+fi
+check prefetch_inputs_test.stats "input files read ahead: [0-9]* ([1-9][0-9]* bytes)"
+
+./prefetch_inputs_test
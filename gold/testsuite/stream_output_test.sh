@@ -0,0 +1,46 @@
+#!/bin/sh
+
+# stream_output_test.sh -- test --stream-output.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Link the same program with --stream-output, with and without
+# --threads, and once with the output file mapped into memory.  The
+# outputs must be identical.  The links use --build-id, which reads
+# the output file back.  Do the same for a relocatable link, a link
+# with --compress-debug-sections, and a shared library, whose PLT
+# view overlaps the view of the start of .got.plt.
+
+check_same()
+{
+  if ! cmp -s "$1" "$2"; then
+    echo "$1 and $2 differ"
+    exit 1
+  fi
+}
+
+check_same stream_output_test stream_output_test_ref
+check_same stream_output_test_threads stream_output_test_ref
+check_same stream_output_test_r.o stream_output_test_r_ref.o
+check_same stream_output_test_compress stream_output_test_compress_ref
+check_same stream_output_test_shared.so stream_output_test_shared_ref.so
+
+./stream_output_test
+./stream_output_test_compress
@@ -0,0 +1,176 @@
+// stringpool_unittest.cc -- test Concurrent_stringpool_template.
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "stringpool.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// Strings to add, with duplicates, suffixes, and the empty string.
+
+static const char* const strings[] =
+{
+  "abcd", "main", "cd", "", "printf", "d", "abcd", "xmain", "cd",
+  "__libc_start_main", "start_main", "main", "x", "printf"
+};
+
+static const size_t string_count = sizeof(strings) / sizeof(strings[0]);
+
+// Add the strings to a Stringpool in order, and to a
+// Concurrent_stringpool in reverse order but with their original
+// positions as the order.  The string tables must be identical.
+
+static bool
+compare_stringpools(bool zero_null, bool optimize, uint64_t addralign)
+{
+  Stringpool_template<char> sp(addralign);
+  Concurrent_stringpool_template<char> cp(addralign);
+  if (!zero_null)
+    {
+      sp.set_no_zero_null();
+      cp.set_no_zero_null();
+    }
+  if (optimize)
+    {
+      sp.set_optimize();
+      cp.set_optimize();
+    }
+
+  for (size_t i = 0; i < string_count; ++i)
+    sp.add(strings[i], true, NULL);
+
+  std::vector<Concurrent_stringpool_template<char>::Key> keys(string_count);
+  for (size_t i = string_count; i > 0; --i)
+    {
+      std::string s(strings[i - 1]);
+      const char* p = cp.add(s.c_str(), true, i - 1, &keys[i - 1]);
+      CHECK(p != s.c_str());
+      CHECK(strcmp(p, strings[i - 1]) == 0);
+    }
+
+  sp.set_string_offsets();
+  cp.set_string_offsets();
+
+  CHECK(sp.get_strtab_size() == cp.get_strtab_size());
+  for (size_t i = 0; i < string_count; ++i)
+    {
+      CHECK(sp.get_offset(strings[i]) == cp.get_offset(strings[i]));
+      CHECK(cp.get_offset_from_key(keys[i]) == cp.get_offset(strings[i]));
+    }
+
+  section_size_type size = sp.get_strtab_size();
+  std::vector<unsigned char> b1(size, 0xff);
+  std::vector<unsigned char> b2(size, 0xff);
+  sp.write_to_buffer(&b1[0], size);
+  cp.write_to_buffer(&b2[0], size);
+  CHECK(b1 == b2);
+
+  return true;
+}
+
+// Build enough strings to be radix sorted, sharing suffixes and
+// including characters with the high bit set.  With optimization
+// every string must be found at its offset, and every string which
+// is a suffix of another must share its bytes.
+
+static bool
+check_suffix_sharing()
+{
+  static const char* const stems[] =
+  {
+    "", "a", "ab", "_main", "\xe9t\xe9", "z\xff", "long_common_suffix"
+  };
+  const size_t stem_count = sizeof(stems) / sizeof(stems[0]);
+
+  std::vector<std::string> v;
+  for (int i = 0; i < 40; ++i)
+    for (size_t j = 0; j < stem_count; ++j)
+      {
+	std::string s(stems[j]);
+	for (int k = i; k > 0; k /= 3)
+	  s.insert(s.begin(), static_cast<char>("x\x80q"[k % 3]));
+	v.push_back(s);
+      }
+
+  Stringpool_template<char> sp;
+  sp.set_optimize();
+  for (size_t i = 0; i < v.size(); ++i)
+    sp.add(v[i].c_str(), true, NULL);
+  sp.set_string_offsets();
+
+  section_size_type size = sp.get_strtab_size();
+  std::vector<char> b(size);
+  sp.write_to_buffer(reinterpret_cast<unsigned char*>(&b[0]), size);
+
+  // Offset 0 holds the empty string, and each string which is not a
+  // suffix of another string is stored once.
+  section_size_type expected = 1;
+  for (size_t i = 0; i < v.size(); ++i)
+    {
+      section_offset_type offset = sp.get_offset(v[i].c_str());
+      CHECK(offset >= 0
+	    && static_cast<section_size_type>(offset) + v[i].length() < size);
+      CHECK(strcmp(&b[offset], v[i].c_str()) == 0);
+
+      bool is_suffix = v[i].empty();
+      bool is_duplicate = false;
+      for (size_t j = 0; j < v.size() && !is_suffix && !is_duplicate; ++j)
+	{
+	  if (v[j] == v[i])
+	    is_duplicate = j < i;
+	  else if (v[j].length() > v[i].length()
+		   && v[j].compare(v[j].length() - v[i].length(),
+				   v[i].length(), v[i]) == 0)
+	    is_suffix = true;
+	}
+      if (!is_suffix && !is_duplicate)
+	expected += v[i].length() + 1;
+    }
+  CHECK(size == expected);
+
+  return true;
+}
+
+bool
+Stringpool_test(Test_report*)
+{
+  CHECK(compare_stringpools(true, false, 1));
+  CHECK(compare_stringpools(false, false, 1));
+  CHECK(compare_stringpools(true, true, 1));
+  CHECK(compare_stringpools(false, true, 1));
+  CHECK(compare_stringpools(true, false, 4));
+  CHECK(check_suffix_sharing());
+  return true;
+}
+
+Register_test stringpool_register("Stringpool", Stringpool_test);
+
+} // End namespace gold_testsuite.
@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# symbol_shards_test.sh -- test --symbol-shards.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# symbol_shards_test.o has enough global, hidden and common symbols
+# to be resolved in shards.  Resolving the shards with and without
+# threads must give identical output, and the symbols must have the
+# same values as when the symbol table is not split at all.  The
+# table must be split into the number of shards asked for, whatever
+# that number is, and --gc-sections, which looks at other symbols
+# while resolving one, must keep the object from being resolved in
+# shards.
+
+if ! cmp -s symbol_shards_test symbol_shards_test_threads; then
+  echo "symbol_shards_test and symbol_shards_test_threads differ"
+  exit 1
+fi
+
+check_stats()
+{
+  if ! grep -q "symbol table shards: $2; objects resolved in shards: $3\$" \
+       $1; then
+    echo "Did not find $2 symbol table shards with $3 objects resolved in"
+    echo ""
+    cat $1
+    exit 1
+  fi
+}
+
+check_stats symbol_shards_test.stats 4 1
+check_stats symbol_shards_test_16.stats 16 1
+check_stats symbol_shards_test_gc.stats 4 0
+
+nm symbol_shards_test_ref | sort > symbol_shards_test_ref.syms
+for f in symbol_shards_test symbol_shards_test_16; do
+  nm $f | sort > $f.syms
+  if ! cmp -s $f.syms symbol_shards_test_ref.syms; then
+    echo "$f and symbol_shards_test_ref have different symbols"
+    echo ""
+    diff $f.syms symbol_shards_test_ref.syms
+    exit 1
+  fi
+done
+
+./symbol_shards_test
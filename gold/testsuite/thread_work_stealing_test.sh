@@ -0,0 +1,66 @@
+#!/bin/sh
+
+# thread_work_stealing_test.sh -- test --thread-work-stealing.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Link the same program using the shared run queue and using
+# per-thread run queues with work stealing.  The outputs must be
+# identical, and --stats must report the per-thread counters.  With
+# --thread-count=1 there are still two run queues, so the only thread
+# must steal every task which was queued on the second one.
+
+for f in thread_work_stealing_test thread_work_stealing_test_1; do
+  if ! cmp -s $f thread_work_stealing_test_ref; then
+    echo "$f and thread_work_stealing_test_ref differ"
+    exit 1
+  fi
+done
+
+# Without thread support there is only the single-threaded workqueue.
+if grep -q "ignoring --threads" thread_work_stealing_test.stats; then
+  exit 0
+fi
+
+if ! grep -q "workqueue thread 0: [0-9]* tasks run, [0-9]* stolen" \
+     thread_work_stealing_test.stats; then
+  echo "Did not find workqueue thread statistics in"
+  echo ""
+  cat thread_work_stealing_test.stats
+  exit 1
+fi
+
+if ! grep -q "workqueue thread 0: [1-9][0-9]* tasks run, [1-9][0-9]* stolen" \
+     thread_work_stealing_test_1.stats; then
+  echo "Did not find stolen tasks in"
+  echo ""
+  cat thread_work_stealing_test_1.stats
+  exit 1
+fi
+
+if ! grep -q "workqueue thread 1: 0 tasks run, 0 stolen" \
+     thread_work_stealing_test_1.stats; then
+  echo "Did not find an idle second run queue in"
+  echo ""
+  cat thread_work_stealing_test_1.stats
+  exit 1
+fi
+
+./thread_work_stealing_test
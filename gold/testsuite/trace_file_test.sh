@@ -0,0 +1,70 @@
+#!/bin/sh
+
+# trace_file_test.sh -- test --trace-file.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# trace_file_test links basic_test.o with --trace-file.  Check that
+# the trace has the three phases of the link, the Tasks which worked
+# on basic_test.o, the open of basic_test.o, and an end for each
+# wait which began.  trace_file_test_fatal.json is written by a link
+# whose output file cannot be opened; the trace must still be complete.
+
+check()
+{
+    if ! grep -q -- "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check trace_file_test.json '^{"displayTimeUnit": "ms", "traceEvents": \[$'
+check trace_file_test.json '^\]}$'
+check trace_file_test.json '{"name": "initial tasks", "cat": "phase", "ph": "X", "ts": [0-9]*, "dur": [0-9]*, "pid": 1, "tid": 0}'
+check trace_file_test.json '{"name": "middle tasks", "cat": "phase", "ph": "X", "ts": [0-9]*, "dur": [0-9]*, "pid": 1, "tid": 0}'
+check trace_file_test.json '{"name": "final tasks", "cat": "phase", "ph": "X", "ts": [0-9]*, "dur": [0-9]*, "pid": 1, "tid": 0}'
+check trace_file_test.json '{"name": "Read_symbols", "cat": "task", "ph": "X", "ts": [0-9]*, "dur": [0-9]*, "pid": 1, "tid": [1-9][0-9]*, "args": {"detail": "basic_test.o"}}'
+check trace_file_test.json '{"name": "Relocate_task", "cat": "task", "ph": "X", .*"args": {"detail": "basic_test.o"}}'
+check trace_file_test.json '{"name": "open", "cat": "io", "ph": "X", .*"args": {"detail": "basic_test.o"}}'
+check trace_file_test.json '{"name": "blocker", "cat": "wait", "ph": "b", "ts": [0-9]*, "id": "0x[0-9a-f]*", "pid": 1, "tid": [1-9][0-9]*, "args": {"detail": "[^"]*"}}'
+
+begin_count=`grep -c '"cat": "wait", "ph": "b"' trace_file_test.json`
+end_count=`grep -c '"cat": "wait", "ph": "e"' trace_file_test.json`
+if test "$begin_count" != "$end_count"; then
+    echo "$begin_count waits began but $end_count ended"
+    exit 1
+fi
+
+check trace_file_test_fatal.err 'fatal error: trace_file_test_dir/trace_file_test.o: open'
+check trace_file_test_fatal.json '^{"displayTimeUnit": "ms", "traceEvents": \[$'
+check trace_file_test_fatal.json '{"name": "Read_symbols", "cat": "task", .*"args": {"detail": "basic_test.o"}}'
+if test "`tail -n 1 trace_file_test_fatal.json`" != ']}'; then
+    echo "trace_file_test_fatal.json is not complete:"
+    echo ""
+    tail trace_file_test_fatal.json
+    exit 1
+fi
+
+exit 0
@@ -60,6 +60,12 @@ class Timer
   void
   stamp(int n);
 
+  // Return the current wall clock time in microseconds.  This is
+  // more precise than the times in TimeStats, and is used to add up
+  // many short waits.
+  static long long
+  wall_usec();
+
  private:
   // This class cannot be copied.
   Timer(const Timer&);
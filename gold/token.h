@@ -177,25 +177,44 @@ class Task_token
   // Add T to the list of tasks waiting for this token to be released.
   void
   add_waiting(Task* t)
-  { this->waiting_.push_back(t); }
+  {
+    this->waiting_.push_back(t);
+    this->trace_begin_wait(t);
+  }
 
   // Add T to the front of the list of tasks waiting for this token to
   // be released.
   void
   add_waiting_front(Task* t)
-  { this->waiting_.push_front(t); }
+  {
+    this->waiting_.push_front(t);
+    this->trace_begin_wait(t);
+  }
 
   // Remove the first Task waiting for this token to be released, and
   // return it.  Return NULL if no Tasks are waiting.
   Task*
   remove_first_waiting()
-  { return this->waiting_.pop_front(); }
+  {
+    Task* t = this->waiting_.pop_front();
+    if (t != NULL)
+      this->trace_end_wait(t);
+    return t;
+  }
 
  private:
   // It makes no sense to copy these.
   Task_token(const Task_token&);
   Task_token& operator=(const Task_token&);
 
+  // Record in the --trace-file that T started or stopped waiting for
+  // this token.  These do nothing if there is no trace file.
+  void
+  trace_begin_wait(Task* t);
+
+  void
+  trace_end_wait(Task* t);
+
   // Whether this is a blocker token.
   bool is_blocker_;
   // The number of blockers.
@@ -0,0 +1,405 @@
+// trace.cc -- trace event output for gold
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
+
+#include "parameters.h"
+#include "options.h"
+#include "gold-threads.h"
+#include "mapfile.h"
+#include "token.h"
+#include "workqueue.h"
+#include "trace.h"
+
+namespace gold
+{
+
+// An event recorded by a thread.  The phases are those of the Chrome
+// trace event format: 'X' for a complete event with a duration, 'b'
+// and 'e' for the beginning and end of an asynchronous event with an
+// ID.
+
+struct Trace_event
+{
+  char phase;
+  // The thread which the event is shown on.
+  int tid;
+  // The category, which is a string constant.
+  const char* category;
+  // The name of the event.
+  std::string name;
+  // Further detail about the event, such as the object which a Task
+  // works on, or the empty string.
+  std::string detail;
+  // The start time, and the duration for a complete event.
+  long long ts;
+  long long dur;
+  // The ID of an asynchronous event, or the byte count of a read.
+  unsigned long long id;
+};
+
+// The events recorded by a thread.  This is only touched by its
+// thread, except when the trace file is closed.
+
+class Trace_buffer
+{
+ public:
+  // The number of events at which the buffer is written out.
+  static const size_t flush_count = 4096;
+
+  Trace_buffer(int tid)
+    : tid_(tid), events_()
+  { this->events_.reserve(flush_count); }
+
+  // The thread ID used in the trace file.
+  int
+  tid() const
+  { return this->tid_; }
+
+  // Add an event, and return it to be filled in.
+  Trace_event*
+  add(char phase, const char* category)
+  {
+    this->events_.push_back(Trace_event());
+    Trace_event* e = &this->events_.back();
+    e->phase = phase;
+    e->tid = this->tid_;
+    e->category = category;
+    e->ts = 0;
+    e->dur = 0;
+    e->id = 0;
+    return e;
+  }
+
+  // Whether the buffer should be written out.
+  bool
+  is_full() const
+  { return this->events_.size() >= flush_count; }
+
+  std::vector<Trace_event>&
+  events()
+  { return this->events_; }
+
+ private:
+  int tid_;
+  std::vector<Trace_event> events_;
+};
+
+#ifdef ENABLE_THREADS
+// The key which finds the buffer of the current thread.
+static pthread_key_t trace_buffer_key;
+#endif
+
+// The thread ID used for the phases of the link.  The threads which
+// run tasks are numbered from 1.
+
+static const int phase_tid = 0;
+
+// Class Trace.
+
+Trace::Trace()
+  : file_(NULL), start_time_(0), lock_(NULL), buffers_(),
+    single_buffer_(NULL), use_thread_key_(false), wrote_event_(false),
+    phase_name_(NULL), phase_start_(0)
+{
+}
+
+Trace::~Trace()
+{
+  if (this->file_ != NULL)
+    this->close();
+#ifdef ENABLE_THREADS
+  if (this->use_thread_key_)
+    pthread_key_delete(trace_buffer_key);
+#endif
+  for (std::vector<Trace_buffer*>::iterator p = this->buffers_.begin();
+       p != this->buffers_.end();
+       ++p)
+    delete *p;
+  delete this->lock_;
+}
+
+// Open the trace file.
+
+bool
+Trace::open(const char* filename)
+{
+  this->file_ = ::fopen(filename, "w");
+  if (this->file_ == NULL)
+    {
+      gold_error(_("cannot open trace file %s: %s"), filename,
+		 strerror(errno));
+      return false;
+    }
+
+  this->lock_ = new Lock();
+#ifdef ENABLE_THREADS
+  if (parameters->options().threads())
+    {
+      int err = pthread_key_create(&trace_buffer_key, NULL);
+      if (err != 0)
+	gold_fatal(_("pthread_key_create failed: %s"), strerror(err));
+      this->use_thread_key_ = true;
+    }
+#endif
+
+  this->start_time_ = Timer::wall_usec();
+
+  fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", this->file_);
+  fputs("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+	"\"args\": {\"name\": \"phases\"}}", this->file_);
+  this->wrote_event_ = true;
+
+  this->start_phase("initial tasks");
+  return true;
+}
+
+// Close the trace file.
+
+void
+Trace::close()
+{
+  if (this->file_ == NULL)
+    return;
+
+  this->end_phase();
+
+  Hold_lock hl(*this->lock_);
+
+  for (std::vector<Trace_buffer*>::iterator p = this->buffers_.begin();
+       p != this->buffers_.end();
+       ++p)
+    this->write_events(*p);
+
+  fputs("\n]}\n", this->file_);
+  if (fclose(this->file_) != 0)
+    gold_error(_("cannot close trace file: %s"), strerror(errno));
+  this->file_ = NULL;
+}
+
+// Return the buffer for the current thread, creating it if this
+// thread has not recorded an event before.
+
+Trace_buffer*
+Trace::buffer()
+{
+  Trace_buffer* buf;
+#ifdef ENABLE_THREADS
+  if (this->use_thread_key_)
+    {
+      buf = static_cast<Trace_buffer*>(pthread_getspecific(trace_buffer_key));
+      if (buf != NULL)
+	return buf;
+    }
+  else
+#endif
+    {
+      if (this->single_buffer_ != NULL)
+	return this->single_buffer_;
+    }
+
+  {
+    Hold_lock hl(*this->lock_);
+    int tid = static_cast<int>(this->buffers_.size()) + 1;
+    buf = new Trace_buffer(tid);
+    this->buffers_.push_back(buf);
+
+    if (this->file_ != NULL)
+      fprintf(this->file_,
+	      ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+	      "\"tid\": %d, \"args\": {\"name\": \"thread %d\"}}",
+	      tid, tid);
+  }
+
+#ifdef ENABLE_THREADS
+  if (this->use_thread_key_)
+    {
+      int err = pthread_setspecific(trace_buffer_key, buf);
+      if (err != 0)
+	gold_fatal(_("pthread_setspecific failed: %s"), strerror(err));
+    }
+  else
+#endif
+    this->single_buffer_ = buf;
+
+  return buf;
+}
+
+// Write the events in BUF to the file.  This is called with the lock
+// held.  If the file was closed, the events are dropped.
+
+void
+Trace::write_events(Trace_buffer* buf)
+{
+  FILE* f = this->file_;
+  std::vector<Trace_event>& events(buf->events());
+  if (f == NULL)
+    {
+      events.clear();
+      return;
+    }
+  for (std::vector<Trace_event>::const_iterator p = events.begin();
+       p != events.end();
+       ++p)
+    {
+      fputs(this->wrote_event_ ? ",\n{\"name\": " : "{\"name\": ", f);
+      this->wrote_event_ = true;
+      write_json_string(f, p->name);
+      fprintf(f, ", \"cat\": \"%s\", \"ph\": \"%c\", \"ts\": %lld",
+	      p->category, p->phase, p->ts);
+      if (p->phase == 'X')
+	fprintf(f, ", \"dur\": %lld", p->dur);
+      else
+	fprintf(f, ", \"id\": \"0x%llx\"", p->id);
+      fprintf(f, ", \"pid\": 1, \"tid\": %d", p->tid);
+      if (!p->detail.empty())
+	{
+	  fputs(", \"args\": {\"detail\": ", f);
+	  write_json_string(f, p->detail);
+	  if (p->phase == 'X' && p->id != 0)
+	    fprintf(f, ", \"bytes\": %llu", p->id);
+	  putc('}', f);
+	}
+      putc('}', f);
+    }
+  events.clear();
+}
+
+// End the current phase.
+
+void
+Trace::end_phase()
+{
+  if (this->phase_name_ == NULL)
+    return;
+  long long now = this->now();
+  Trace_buffer* buf = this->buffer();
+  Trace_event* e = buf->add('X', "phase");
+  e->tid = phase_tid;
+  e->name = this->phase_name_;
+  e->ts = this->phase_start_;
+  e->dur = now - this->phase_start_;
+  this->phase_name_ = NULL;
+}
+
+// Start a new phase.  The phases follow each other, so they are only
+// started by one thread at a time.
+
+void
+Trace::start_phase(const char* name)
+{
+  this->end_phase();
+  this->phase_name_ = name;
+  this->phase_start_ = this->now();
+}
+
+// Record a Task.  By convention the name of a Task is its kind,
+// followed by the object or file which it works on, if any; we use
+// the kind as the event name so that similar Tasks may be grouped.
+
+void
+Trace::task(Task* t, long long start)
+{
+  long long now = this->now();
+  Trace_buffer* buf = this->buffer();
+  Trace_event* e = buf->add('X', "task");
+  const std::string& name(t->name());
+  size_t space = name.find(' ');
+  if (space == std::string::npos)
+    e->name = name;
+  else
+    {
+      e->name = name.substr(0, space);
+      e->detail = name.substr(space + 1);
+    }
+  e->ts = start;
+  e->dur = now - start;
+
+  if (buf->is_full())
+    {
+      Hold_lock hl(*this->lock_);
+      this->write_events(buf);
+    }
+}
+
+// Record that a Task is waiting for a Task_token.  This is called
+// with the Workqueue lock held.  The wait is an asynchronous event,
+// since it is not done by any thread; its ID is the Task.
+
+void
+Trace::begin_wait(Task* t, const Task_token* token)
+{
+  Trace_buffer* buf = this->buffer();
+  Trace_event* e = buf->add('b', "wait");
+  e->name = token->is_blocker() ? "blocker" : "lock";
+  e->detail = t->name();
+  e->ts = this->now();
+  e->id = reinterpret_cast<uintptr_t>(t);
+}
+
+// Record that a Task is no longer waiting for a Task_token.
+
+void
+Trace::end_wait(Task* t, const Task_token* token)
+{
+  Trace_buffer* buf = this->buffer();
+  Trace_event* e = buf->add('e', "wait");
+  e->name = token->is_blocker() ? "blocker" : "lock";
+  e->ts = this->now();
+  e->id = reinterpret_cast<uintptr_t>(t);
+
+  if (buf->is_full())
+    {
+      Hold_lock hl(*this->lock_);
+      this->write_events(buf);
+    }
+}
+
+// Record a wait for an input file.
+
+void
+Trace::io_wait(const char* what, const std::string& filename,
+	       long long start, long long bytes)
+{
+  long long now = this->now();
+  Trace_buffer* buf = this->buffer();
+  Trace_event* e = buf->add('X', "io");
+  e->name = what;
+  e->detail = filename;
+  e->ts = start;
+  e->dur = now - start;
+  e->id = bytes;
+
+  if (buf->is_full())
+    {
+      Hold_lock hl(*this->lock_);
+      this->write_events(buf);
+    }
+}
+
+} // End namespace gold.
@@ -0,0 +1,138 @@
+// trace.h -- trace event output for gold   -*- C++ -*-
+
+// Copyright (C) 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_TRACE_H
+#define GOLD_TRACE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+
+namespace gold
+{
+
+class Lock;
+class Task;
+class Task_token;
+class Trace_buffer;
+
+// This class writes the file named by --trace-file.  It records the
+// three phases of the link, each Task which a thread runs, the time
+// Tasks spend waiting for a Task_token, and the time threads spend
+// waiting to open or read input files.  The file is in the Chrome
+// trace event JSON format, which chrome://tracing and Perfetto can
+// display.
+
+// Each thread records its events in its own buffer, without taking a
+// lock.  When a buffer fills up, it is written to the file while
+// holding a lock.
+
+class Trace
+{
+ public:
+  Trace();
+
+  ~Trace();
+
+  // Open the trace file.  Return whether the open succeeded.  This
+  // starts the first phase of the link.
+  bool
+  open(const char* filename);
+
+  // Write the buffered events and close the trace file.  This is
+  // called by gold_exit, so that the file is complete even if the link
+  // fails.  After a fatal error other threads may still be running;
+  // the events they record after this are dropped.
+  void
+  close();
+
+  // Return the current time, in microseconds since the trace file
+  // was opened.
+  long long
+  now() const
+  { return Timer::wall_usec() - this->start_time_; }
+
+  // End the current phase of the link, and start the phase NAME.
+  void
+  start_phase(const char* name);
+
+  // Record that the current thread ran TASK, from START until now.
+  void
+  task(Task*, long long start);
+
+  // Record that TASK started waiting for TOKEN.
+  void
+  begin_wait(Task*, const Task_token*);
+
+  // Record that TASK stopped waiting for TOKEN.
+  void
+  end_wait(Task*, const Task_token*);
+
+  // Record that the current thread waited to do WHAT, which is "open"
+  // or "read", to the input file FILENAME, from START until now.
+  // BYTES is the number of bytes read.
+  void
+  io_wait(const char* what, const std::string& filename, long long start,
+	  long long bytes);
+
+ private:
+  // This class cannot be copied.
+  Trace(const Trace&);
+  Trace& operator=(const Trace&);
+
+  // Return the buffer for the current thread.
+  Trace_buffer*
+  buffer();
+
+  // Write the events in a buffer to the file, and empty it.  This
+  // must be called with the lock held.
+  void
+  write_events(Trace_buffer*);
+
+  // Write the end of the current phase.
+  void
+  end_phase();
+
+  // The trace file.
+  FILE* file_;
+  // The time at which the trace file was opened.
+  long long start_time_;
+  // The lock for writing to the file and for the list of buffers.
+  Lock* lock_;
+  // The buffers for each thread.  These are owned by this class.
+  std::vector<Trace_buffer*> buffers_;
+  // The buffer used when we are not using threads.
+  Trace_buffer* single_buffer_;
+  // Whether the buffer of each thread is found using a thread key.
+  bool use_thread_key_;
+  // Whether we have written an event to the file.
+  bool wrote_event_;
+  // The name of the current phase.
+  const char* phase_name_;
+  // The time at which the current phase started.
+  long long phase_start_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_TRACE_H)
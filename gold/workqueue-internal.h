@@ -37,6 +37,123 @@ namespace gold
 
 class Workqueue_thread;
 
+// A run queue used with --thread-work-stealing.  Each thread takes
+// Tasks from its own run queue, and steals from the run queues of
+// other threads when its own is empty.  Like the Task_tokens, the run
+// queues are only manipulated with the Workqueue lock held; having
+// one per thread lets us wake up the thread which owns newly runnable
+// work rather than an arbitrary one, and lets a thread keep running
+// the Tasks which its own Tasks unblocked.
+
+class Workqueue_run_queue
+{
+ public:
+  Workqueue_run_queue(Lock& lock)
+    : first_tasks_(), tasks_(), condvar_(lock), sleeping_(0),
+      tasks_run_(0), tasks_stolen_(0), idle_time_(0)
+  { }
+
+  // Add a runnable Task.  If FRONT is true, it goes ahead of the
+  // other Tasks of the same kind.
+  void
+  push(Task* t, bool front)
+  {
+    Task_list* list = (t->should_run_soon()
+		       ? &this->first_tasks_
+		       : &this->tasks_);
+    if (front)
+      list->push_front(t);
+    else
+      list->push_back(t);
+  }
+
+  // Remove and return the next Task, or NULL if the queue is empty.
+  Task*
+  pop()
+  {
+    Task* t = this->first_tasks_.pop_front();
+    if (t == NULL)
+      t = this->tasks_.pop_front();
+    return t;
+  }
+
+  // Return whether the queue is empty.
+  bool
+  empty() const
+  { return this->first_tasks_.empty() && this->tasks_.empty(); }
+
+  // Wait for work.  The Workqueue lock must be held.
+  void
+  wait()
+  {
+    ++this->sleeping_;
+    this->condvar_.wait();
+    --this->sleeping_;
+  }
+
+  // Wake up a thread waiting on this queue, if there is one.  Return
+  // whether we did.
+  bool
+  wake_one()
+  {
+    if (this->sleeping_ == 0)
+      return false;
+    this->condvar_.signal();
+    return true;
+  }
+
+  // Wake up all threads waiting on this queue.
+  void
+  wake_all()
+  { this->condvar_.broadcast(); }
+
+  // Statistics.
+
+  void
+  add_task_run(bool stolen)
+  {
+    ++this->tasks_run_;
+    if (stolen)
+      ++this->tasks_stolen_;
+  }
+
+  void
+  add_idle_time(long ms)
+  { this->idle_time_ += ms; }
+
+  unsigned int
+  tasks_run() const
+  { return this->tasks_run_; }
+
+  unsigned int
+  tasks_stolen() const
+  { return this->tasks_stolen_; }
+
+  long
+  idle_time() const
+  { return this->idle_time_; }
+
+ private:
+  Workqueue_run_queue(const Workqueue_run_queue&);
+  Workqueue_run_queue& operator=(const Workqueue_run_queue&);
+
+  // Tasks which should run soon.
+  Task_list first_tasks_;
+  // Other runnable Tasks.
+  Task_list tasks_;
+  // Signalled when a Task is added to this queue.  This is
+  // associated with the Workqueue lock.
+  Condvar condvar_;
+  // Number of threads waiting on condvar_.
+  int sleeping_;
+  // Number of Tasks run by the threads using this queue.
+  unsigned int tasks_run_;
+  // Number of those Tasks which were taken from another queue.
+  unsigned int tasks_stolen_;
+  // Wall clock time, in milliseconds, spent waiting for work.
+  long idle_time_;
+};
+
 // The Workqueue_threader abstract class.  This is the interface used
 // by the general workqueue code to manage threads.
 
@@ -58,6 +175,17 @@ class Workqueue_threader
   virtual bool
   should_cancel_thread(int thread_number) = 0;
 
+  // Return the number of per-thread run queues to use, or 0 if all
+  // threads should share the Workqueue's run lists.
+  virtual int
+  run_queue_count() const
+  { return 0; }
+
+  // Return the number of threads we want to run.
+  virtual int
+  thread_count() const
+  { return 1; }
+
  protected:
   // Get the Workqueue.
   Workqueue*
@@ -74,7 +202,7 @@ class Workqueue_threader
 class Workqueue_threader_threadpool : public Workqueue_threader
 {
  public:
-  Workqueue_threader_threadpool(Workqueue*);
+  Workqueue_threader_threadpool(Workqueue*, int run_queue_count);
 
   ~Workqueue_threader_threadpool();
 
@@ -86,12 +214,25 @@ class Workqueue_threader_threadpool : public Workqueue_threader
   bool
   should_cancel_thread(int thread_number);
 
+  // Return the number of run queues.
+  int
+  run_queue_count() const
+  { return this->run_queue_count_; }
+
+  // Return the number of threads we want to run.
+  int
+  thread_count() const
+  { return this->desired_thread_count_; }
+
   // Process all tasks.  This keeps running until told to cancel.
   void
   process(int thread_number)
   { this->get_workqueue()->process(thread_number); }
 
  private:
+  // The number of per-thread run queues, or 0 to use the shared
+  // run lists.
+  int run_queue_count_;
   // This is set if we need to check the thread count.
   volatile sig_atomic_t check_thread_count_;
 
@@ -127,8 +127,10 @@ Workqueue_thread::thread_body(void* arg)
 // Constructor.
 
 Workqueue_threader_threadpool::Workqueue_threader_threadpool(
-    Workqueue* workqueue)
+    Workqueue* workqueue,
+    int run_queue_count)
   : Workqueue_threader(workqueue),
+    run_queue_count_(run_queue_count),
     check_thread_count_(0),
     lock_(),
     desired_thread_count_(1),
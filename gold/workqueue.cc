@@ -22,9 +22,13 @@
 
 #include "gold.h"
 
+#include <algorithm>
+#include <unistd.h>
+
 #include "debug.h"
 #include "options.h"
 #include "timer.h"
+#include "trace.h"
 #include "workqueue.h"
 #include "workqueue-internal.h"
 
@@ -94,6 +98,28 @@ Task_list::pop_front()
   return ret;
 }
 
+// Class Task_token.
+
+// Record that T is waiting for this token.
+
+void
+Task_token::trace_begin_wait(Task* t)
+{
+  Trace* trace = parameters->trace();
+  if (trace != NULL)
+    trace->begin_wait(t, this);
+}
+
+// Record that T is no longer waiting for this token.
+
+void
+Task_token::trace_end_wait(Task* t)
+{
+  Trace* trace = parameters->trace();
+  if (trace != NULL)
+    trace->end_wait(t, this);
+}
+
 // The simple single-threaded implementation of Workqueue_threader.
 
 class Workqueue_threader_single : public Workqueue_threader
@@ -116,6 +142,32 @@ class Workqueue_threader_single : public Workqueue_threader
 
 // Workqueue methods.
 
+#ifdef ENABLE_THREADS
+
+// Return the number of run queues to use with --thread-work-stealing.
+// We want one per thread.  Threads beyond that share run queues.
+
+static int
+work_stealing_run_queue_count(const General_options& options)
+{
+  int count = std::max(options.thread_count_initial(),
+		       std::max(options.thread_count_middle(),
+				options.thread_count_final()));
+  if (options.thread_count_initial() == 0
+      || options.thread_count_middle() == 0
+      || options.thread_count_final() == 0)
+    {
+      // The number of threads depends on the number of input files,
+      // which can be large; one run queue per processor is enough.
+#ifdef _SC_NPROCESSORS_ONLN
+      count = std::max(count, static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN)));
+#endif
+    }
+  return std::max(count, 2);
+}
+
+#endif // defined(ENABLE_THREADS)
+
 Workqueue::Workqueue(const General_options& options)
   : lock_(),
     first_tasks_(),
@@ -123,6 +175,10 @@ Workqueue::Workqueue(const General_options& options)
     running_(0),
     waiting_(0),
     condvar_(this->lock_),
+    run_queues_(),
+    run_queued_(0),
+    next_run_queue_(0),
+    record_idle_time_(options.stats()),
     threader_(NULL)
 {
   bool threads = options.threads();
@@ -134,15 +190,28 @@ Workqueue::Workqueue(const General_options& options)
   else
     {
 #ifdef ENABLE_THREADS
-      this->threader_ = new Workqueue_threader_threadpool(this);
+      int run_queue_count = 0;
+      if (options.thread_work_stealing())
+	run_queue_count = work_stealing_run_queue_count(options);
+      this->threader_ = new Workqueue_threader_threadpool(this,
+							  run_queue_count);
 #else
       gold_unreachable();
 #endif
     }
+
+  int run_queue_count = this->threader_->run_queue_count();
+  for (int i = 0; i < run_queue_count; ++i)
+    this->run_queues_.push_back(new Workqueue_run_queue(this->lock_));
 }
 
 Workqueue::~Workqueue()
 {
+  for (std::vector<Workqueue_run_queue*>::iterator p =
+	 this->run_queues_.begin();
+       p != this->run_queues_.end();
+       ++p)
+    delete *p;
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -162,6 +231,13 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 	token->add_waiting(t);
       ++this->waiting_;
     }
+  else if (!this->run_queues_.empty())
+    {
+      // We don't know which thread is queueing the task, so spread
+      // the tasks over the run queues.
+      int thread_number = this->next_run_queue_++ % this->run_queues_.size();
+      this->push_run_queue(t, thread_number, front);
+    }
   else
     {
       if (front)
@@ -173,6 +249,42 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
     }
 }
 
+// Add T, which is runnable, to the run queue used by THREAD_NUMBER.
+// Wake up a thread waiting on that queue; if there is none, wake up
+// some other waiting thread, which will steal T.  This must be called
+// with the Workqueue lock held.
+
+void
+Workqueue::push_run_queue(Task* t, int thread_number, bool front)
+{
+  Workqueue_run_queue* rq = this->run_queue(thread_number);
+  rq->push(t, front);
+  ++this->run_queued_;
+
+  if (rq->wake_one())
+    return;
+  for (std::vector<Workqueue_run_queue*>::iterator p =
+	 this->run_queues_.begin();
+       p != this->run_queues_.end();
+       ++p)
+    if ((*p)->wake_one())
+      return;
+}
+
+// Wake up all threads which are waiting for work.  This must be
+// called with the Workqueue lock held.
+
+void
+Workqueue::wake_all()
+{
+  this->condvar_.broadcast();
+  for (std::vector<Workqueue_run_queue*>::iterator p =
+	 this->run_queues_.begin();
+       p != this->run_queues_.end();
+       ++p)
+    (*p)->wake_all();
+}
+
 // Add a task to the queue.
 
 void
@@ -230,15 +342,52 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
   return NULL;
 }
 
+// Find a runnable task in the run queue of THREAD_NUMBER, or failing
+// that steal one from the run queue of another thread.  Set *STOLEN
+// if we stole it.  Return NULL if none could be found.  The workqueue
+// lock must be held when this is called.
+
+Task*
+Workqueue::find_runnable_in_run_queues(int thread_number, bool* stolen)
+{
+  size_t count = this->run_queues_.size();
+  size_t own = thread_number % count;
+  for (size_t i = 0; i < count; ++i)
+    {
+      Workqueue_run_queue* rq = this->run_queues_[(own + i) % count];
+      Task* t;
+      while ((t = rq->pop()) != NULL)
+	{
+	  --this->run_queued_;
+
+	  // A task which was runnable when it was queued may since
+	  // have been blocked by a task which took a lock.
+	  Task_token* token = t->is_runnable();
+	  if (token == NULL)
+	    {
+	      *stolen = i != 0;
+	      return t;
+	    }
+
+	  token->add_waiting(t);
+	  ++this->waiting_;
+	}
+    }
+  return NULL;
+}
+
 // Find a runnable task.  Return NULL if none could be found.  The
 // workqueue lock must be held when this is called.
 
 Task*
-Workqueue::find_runnable()
+Workqueue::find_runnable(int thread_number, bool* stolen)
 {
+  *stolen = false;
   Task* t = this->find_runnable_in_list(&this->first_tasks_);
   if (t == NULL)
     t = this->find_runnable_in_list(&this->tasks_);
+  if (t == NULL && !this->run_queues_.empty())
+    t = this->find_runnable_in_run_queues(thread_number, stolen);
   return t;
 }
 
@@ -247,18 +396,19 @@ Workqueue::find_runnable()
 // called.
 
 Task*
-Workqueue::find_runnable_or_wait(int thread_number)
+Workqueue::find_runnable_or_wait(int thread_number, bool* stolen)
 {
-  Task* t = this->find_runnable();
+  Task* t = this->find_runnable(thread_number, stolen);
 
   while (t == NULL)
     {
       if (this->running_ == 0
 	  && this->first_tasks_.empty()
-	  && this->tasks_.empty())
+	  && this->tasks_.empty()
+	  && this->run_queued_ == 0)
 	{
 	  // Kick all the threads to make them exit.
-	  this->condvar_.broadcast();
+	  this->wake_all();
 
 	  gold_assert(this->waiting_ == 0);
 	  return NULL;
@@ -269,11 +419,25 @@ Workqueue::find_runnable_or_wait(int thread_number)
 
       gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
 
-      this->condvar_.wait();
+      if (this->run_queues_.empty())
+	this->condvar_.wait();
+      else
+	{
+	  Workqueue_run_queue* rq = this->run_queue(thread_number);
+	  if (!this->record_idle_time_)
+	    rq->wait();
+	  else
+	    {
+	      Timer timer;
+	      timer.start();
+	      rq->wait();
+	      rq->add_idle_time(timer.get_elapsed_time().wall);
+	    }
+	}
 
       gold_debug(DEBUG_TASK, "%3d awake", thread_number);
 
-      t = this->find_runnable();
+      t = this->find_runnable(thread_number, stolen);
     }
 
   return t;
@@ -290,12 +454,13 @@ Workqueue::find_and_run_task(int thread_number)
 {
   Task* t;
   Task_locker tl;
+  bool stolen;
 
   {
     Hold_lock hl(this->lock_);
 
     // Find a runnable task.
-    t = this->find_runnable_or_wait(thread_number);
+    t = this->find_runnable_or_wait(thread_number, &stolen);
 
     if (t == NULL)
       return false;
@@ -316,8 +481,21 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      // The name of a Task may refer to data which the Task frees
+      // when it runs, so get the name before running it.
+      Trace* trace = parameters->trace();
+      long long trace_start = 0;
+      if (trace != NULL)
+	{
+	  t->name();
+	  trace_start = trace->now();
+	}
+
       t->run(this);
 
+      if (trace != NULL)
+	trace->task(t, trace_start);
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -337,12 +515,16 @@ Workqueue::find_and_run_task(int thread_number)
 
 	--this->running_;
 
+	if (!this->run_queues_.empty())
+	  this->run_queue(thread_number)->add_task_run(stolen);
+	stolen = false;
+
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
-	next = this->release_locks(t, &tl);
+	next = this->release_locks(t, &tl, thread_number);
 
 	if (next == NULL)
-	  next = this->find_runnable();
+	  next = this->find_runnable(thread_number, &stolen);
 
 	// If we have another Task to run, get the Locks.  This must
 	// be called while we are still holding the Workqueue lock.
@@ -389,12 +571,16 @@ Workqueue::find_and_run_task(int thread_number)
 // 6) Otherwise, there are no other tasks to run, so we might as well
 // run this one now.
 
+// When using per-thread run queues, tasks which we queue go on the
+// run queue of THREAD_NUMBER, the thread which unblocked them.
+
 // This function must be called with the Workqueue lock held.
 
 // Return true if we set *PRET to T, false otherwise.
 
 bool
-Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
+Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret,
+			   int thread_number)
 {
   Task_token* token = t->is_runnable();
 
@@ -414,7 +600,9 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     should_return = true;
   else if (t->should_run_soon())
     should_return = true;
-  else if (!this->first_tasks_.empty() || !this->tasks_.empty())
+  else if (!this->first_tasks_.empty()
+	   || !this->tasks_.empty()
+	   || this->run_queued_ > 0)
     should_queue = true;
   else
     should_return = true;
@@ -427,6 +615,11 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     }
   else if (should_queue)
     {
+      if (!this->run_queues_.empty())
+	{
+	  this->push_run_queue(t, thread_number, false);
+	  return false;
+	}
       if (t->should_run_soon())
 	this->first_tasks_.push_back(t);
       else
@@ -444,7 +637,7 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 // called with the Workqueue lock held.
 
 Task*
-Workqueue::release_locks(Task* t, Task_locker* tl)
+Workqueue::release_locks(Task* t, Task_locker* tl, int thread_number)
 {
   Task* ret = NULL;
   for (Task_locker::iterator p = tl->begin(); p != tl->end(); ++p)
@@ -460,7 +653,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	      while ((t = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  this->return_or_queue(t, true, &ret, thread_number);
 		}
 	    }
 	}
@@ -477,7 +670,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  while ((t = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      if (this->return_or_queue(t, false, &ret, thread_number))
 		break;
 	    }
 	}
@@ -496,6 +689,170 @@ Workqueue::process(int thread_number)
     ;
 }
 
+// The state shared by the calling thread and the helper tasks of
+// Workqueue::run_parallel.  Helper tasks may start running after
+// run_parallel has returned, so this is reference counted and deleted
+// by the last user.
+
+class Parallel_run_state
+{
+ public:
+  Parallel_run_state(Task_parallel_runner* runner, unsigned int count,
+		     int refs)
+    : lock_(), condvar_(this->lock_), runner_(runner), count_(count),
+      next_(0), done_(0), refs_(refs)
+  { }
+
+  // Run items until there are none left to claim.
+  void
+  run_items();
+
+  // Wait until all the items have been run.
+  void
+  wait();
+
+  // Drop a reference, and delete this if it was the last one.
+  void
+  release();
+
+ private:
+  Lock lock_;
+  // Signalled when the last item is done.
+  Condvar condvar_;
+  // The runner.  This is not used after all the items are claimed.
+  Task_parallel_runner* runner_;
+  // The number of items.
+  unsigned int count_;
+  // The next item to claim.
+  unsigned int next_;
+  // The number of items which are done.
+  unsigned int done_;
+  // The number of references.
+  int refs_;
+};
+
+void
+Parallel_run_state::run_items()
+{
+  while (true)
+    {
+      unsigned int i;
+      {
+	Hold_lock hl(this->lock_);
+	if (this->next_ >= this->count_)
+	  return;
+	i = this->next_;
+	++this->next_;
+      }
+
+      this->runner_->run(i);
+
+      {
+	Hold_lock hl(this->lock_);
+	++this->done_;
+	if (this->done_ == this->count_)
+	  this->condvar_.broadcast();
+      }
+    }
+}
+
+void
+Parallel_run_state::wait()
+{
+  Hold_lock hl(this->lock_);
+  while (this->done_ < this->count_)
+    this->condvar_.wait();
+}
+
+void
+Parallel_run_state::release()
+{
+  bool last;
+  {
+    Hold_lock hl(this->lock_);
+    --this->refs_;
+    last = this->refs_ == 0;
+  }
+  if (last)
+    delete this;
+}
+
+// A helper task for Workqueue::run_parallel.
+
+class Parallel_run_task : public Task
+{
+ public:
+  Parallel_run_task(Parallel_run_state* state)
+    : state_(state)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->state_->run_items();
+    this->state_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Parallel_run_task"; }
+
+ private:
+  Parallel_run_state* state_;
+};
+
+// Run RUNNER for the items 0 to COUNT - 1, using the calling thread
+// and up to one helper task for each other thread.
+
+void
+Workqueue::run_parallel(Task_parallel_runner* runner, unsigned int count)
+{
+  unsigned int helpers = 0;
+  if (count > 1 && parameters->options().threads())
+    {
+      int threads = this->thread_count();
+#ifdef _SC_NPROCESSORS_ONLN
+      threads = std::min(threads,
+			 static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN)));
+#endif
+      if (threads > 1)
+	helpers = std::min(count, static_cast<unsigned int>(threads)) - 1;
+    }
+
+  if (helpers == 0)
+    {
+      for (unsigned int i = 0; i < count; ++i)
+	runner->run(i);
+      return;
+    }
+
+  Parallel_run_state* state = new Parallel_run_state(runner, count,
+						     helpers + 1);
+  for (unsigned int i = 0; i < helpers; ++i)
+    this->queue_next(new Parallel_run_task(state));
+
+  state->run_items();
+  state->wait();
+  state->release();
+}
+
+// Return the number of threads which are running tasks.
+
+int
+Workqueue::thread_count()
+{
+  Hold_lock hl(this->lock_);
+  return std::max(this->threader_->thread_count(), 1);
+}
+
 // Set the number of threads to use for the workqueue, if we are using
 // threads.
 
@@ -506,7 +863,7 @@ Workqueue::set_thread_count(int threads)
 
   this->threader_->set_thread_count(threads);
   // Wake up all the threads, since something has changed.
-  this->condvar_.broadcast();
+  this->wake_all();
 }
 
 // Add a new blocker to an existing Task_token.
@@ -518,4 +875,23 @@ Workqueue::add_blocker(Task_token* token)
   token->add_blocker();
 }
 
+// Print statistics about the per-thread run queues.
+
+void
+Workqueue::print_stats()
+{
+  Hold_lock hl(this->lock_);
+
+  for (size_t i = 0; i < this->run_queues_.size(); ++i)
+    {
+      const Workqueue_run_queue* rq = this->run_queues_[i];
+      long idle = rq->idle_time();
+      fprintf(stderr,
+	      _("%s: workqueue thread %u: %u tasks run, %u stolen, "
+		"idle %ld.%06ld\n"),
+	      program_name, static_cast<unsigned int>(i), rq->tasks_run(),
+	      rq->tasks_stolen(), idle / 1000, (idle % 1000) * 1000);
+    }
+}
+
 } // End namespace gold.
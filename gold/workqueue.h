@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -191,9 +192,25 @@ class Task_function : public Task
   const char* name_;
 };
 
+// An interface for Workqueue::run_parallel.  This is used by a
+// running Task which needs the results of some parallel work before it
+// can continue.
+
+class Task_parallel_runner
+{
+ public:
+  virtual ~Task_parallel_runner()
+  { }
+
+  // Run item I.  This may be called in parallel for different items.
+  virtual void
+  run(unsigned int i) = 0;
+};
+
 // The workqueue itself.
 
 class Workqueue_threader;
+class Workqueue_run_queue;
 
 class Workqueue
 {
@@ -227,12 +244,29 @@ class Workqueue
   void
   set_thread_count(int);
 
+  // Run RUNNER for the items 0 to COUNT - 1, and return when all of
+  // them are done.  This may be called from a running Task.  The items
+  // are run by the calling thread and by helper Tasks, which take no
+  // locks and do not wait for any blockers.  Without threads, the
+  // items are simply run in order.
+  void
+  run_parallel(Task_parallel_runner*, unsigned int count);
+
+  // Return the number of threads which are running tasks.  This is 1
+  // when not using threads.
+  int
+  thread_count();
+
   // Add a new blocker to an existing Task_token. This must be done
   // with the workqueue lock held.  This should not be done routinely,
   // only in special circumstances.
   void
   add_blocker(Task_token*);
 
+  // Print statistics about the per-thread run queues to stderr.
+  void
+  print_stats();
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
@@ -244,27 +278,45 @@ class Workqueue
 
   // Find a runnable task, or wait for one.
   Task*
-  find_runnable_or_wait(int thread_number);
+  find_runnable_or_wait(int thread_number, bool* stolen);
 
   // Find a runnable task.
   Task*
-  find_runnable();
+  find_runnable(int thread_number, bool* stolen);
 
   // Find a runnable task in a list.
   Task*
   find_runnable_in_list(Task_list*);
 
+  // Find a runnable task in the per-thread run queues.
+  Task*
+  find_runnable_in_run_queues(int thread_number, bool* stolen);
+
+  // Return the run queue used by a thread.
+  Workqueue_run_queue*
+  run_queue(int thread_number) const
+  { return this->run_queues_[thread_number % this->run_queues_.size()]; }
+
+  // Add a runnable task to the run queue of a thread, and wake up a
+  // thread to run it.
+  void
+  push_run_queue(Task*, int thread_number, bool front);
+
+  // Wake up all waiting threads.
+  void
+  wake_all();
+
   // Find an run a task.
   bool
   find_and_run_task(int);
 
   // Release the locks for a Task.  Return the next Task to run.
   Task*
-  release_locks(Task*, Task_locker*);
+  release_locks(Task*, Task_locker*, int thread_number);
 
   // Store T into *PRET, or queue it as appropriate.
   bool
-  return_or_queue(Task* t, bool is_blocker, Task** pret);
+  return_or_queue(Task* t, bool is_blocker, Task** pret, int thread_number);
 
   // Return whether to cancel this thread.
   bool
@@ -284,6 +336,16 @@ class Workqueue
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
+  // The per-thread run queues used with --thread-work-stealing.  When
+  // this is empty, all threads use first_tasks_ and tasks_.
+  std::vector<Workqueue_run_queue*> run_queues_;
+  // Number of tasks on the run queues.
+  int run_queued_;
+  // The run queue which gets the next task queued from outside a
+  // running Task.
+  unsigned int next_run_queue_;
+  // Whether to record the time threads spend waiting for work.
+  bool record_idle_time_;
 
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
@@ -741,6 +741,10 @@ class Target_x86_64 : public Sized_target<size, false>
   uint64_t
   do_ehframe_datarel_base() const;
 
+  // Print statistics about relocation processing.
+  void
+  do_print_stats() const;
+
   // Adjust -fsplit-stack code which calls non-split-stack code.
   void
   do_calls_non_split(Relobj* object, unsigned int shndx,
@@ -813,6 +817,13 @@ class Target_x86_64 : public Sized_target<size, false>
   void
   emit_copy_reloc(Symbol_table*, Symbol*, Output_section*, off_t);
 
+  // Emit a dynamic relocation copied from the base file.
+  void
+  emit_dynamic_reloc_for_update(Symbol* gsym, unsigned int r_type,
+				Output_section* os, off_t offset,
+				typename elfcpp::Elf_types<size>::Elf_Swxword
+				  addend);
+
   // Apply an incremental relocation.
   void
   apply_relocation(const Relocate_info<size, false>* relinfo,
@@ -1139,6 +1150,27 @@ class Target_x86_64 : public Sized_target<size, false>
 			     Sized_relobj_file<size, false>* relobj,
 			     unsigned int local_sym_index);
 
+  // Apply the relocations for a section, writing the common ones in
+  // batches.
+  void
+  relocate_section_batched(const Relocate_info<size, false>*,
+			   const unsigned char* prelocs,
+			   size_t reloc_count,
+			   Output_section* output_section,
+			   unsigned char* view,
+			   typename elfcpp::Elf_types<size>::Elf_Addr view_address,
+			   section_size_type view_size);
+
+  // Compute the value of a relocation which can be applied in a
+  // batch.  Return false if it must go through Relocate.
+  bool
+  batched_reloc_value(const Sized_relobj_file<size, false>* object,
+		      unsigned int local_count, unsigned int r_type,
+		      unsigned int r_sym,
+		      typename elfcpp::Elf_types<size>::Elf_Swxword addend,
+		      typename elfcpp::Elf_types<size>::Elf_Addr address,
+		      uint64_t* value) const;
+
   // Define the _TLS_MODULE_BASE_ symbol in the TLS segment.
   void
   define_tls_base_symbol(Symbol_table*, Layout*);
@@ -1192,6 +1224,11 @@ class Target_x86_64 : public Sized_target<size, false>
   // general Target structure.
   static const Target::Target_info x86_64_info;
 
+  // The number of relocations applied in batches, and the total
+  // number of relocations applied, for --stats.
+  static size_t batched_relocs;
+  static size_t total_relocs;
+
   // The types of GOT entries needed for this platform.
   // These values are exposed to the ABI in an incremental link.
   // Do not renumber existing values without changing the version
@@ -1247,6 +1284,12 @@ class Target_x86_64 : public Sized_target<size, false>
   bool tls_base_symbol_defined_;
 };
 
+template<int size>
+size_t Target_x86_64<size>::batched_relocs;
+
+template<int size>
+size_t Target_x86_64<size>::total_relocs;
+
 template<>
 const Target::Target_info Target_x86_64<64>::x86_64_info =
 {
@@ -2604,6 +2647,21 @@ Target_x86_64<size>::emit_copy_reloc(
 				     this->rela_dyn_section(NULL));
 }
 
+// Emit a dynamic relocation copied from the base file.
+
+template<int size>
+void
+Target_x86_64<size>::emit_dynamic_reloc_for_update(
+    Symbol* gsym, unsigned int r_type, Output_section* os, off_t offset,
+    typename elfcpp::Elf_types<size>::Elf_Swxword addend)
+{
+  Reloc_section* rela_dyn = this->rela_dyn_section(NULL);
+  if (gsym == NULL)
+    rela_dyn->add_absolute(r_type, os, offset, addend);
+  else
+    rela_dyn->add_global(gsym, r_type, os, offset, addend);
+}
+
 // Define the _TLS_MODULE_BASE_ symbol in the TLS segment.
 
 template<int size>
@@ -5052,6 +5110,17 @@ Target_x86_64<size>::relocate_section(
 
   gold_assert(sh_type == elfcpp::SHT_RELA);
 
+  if (size == 64
+      && parameters->options().batch_relocs()
+      && !needs_special_offset_handling
+      && reloc_symbol_changes == NULL)
+    {
+      this->relocate_section_batched(relinfo, prelocs, reloc_count,
+				     output_section, view, address,
+				     view_size);
+      return;
+    }
+
   gold::relocate_section<size, false, Target_x86_64<size>, Relocate,
 			 gold::Default_comdat_behavior, Classify_reloc>(
     relinfo,
@@ -5066,6 +5135,256 @@ Target_x86_64<size>::relocate_section(
     reloc_symbol_changes);
 }
 
+// The number of relocations collected before they are written out by
+// relocate_section_batched, and how far ahead in the relocations it
+// prefetches the symbol.
+
+const size_t x86_64_reloc_batch_size = 256;
+const size_t x86_64_reloc_prefetch_distance = 8;
+
+// A relocation whose value has been computed, waiting to be written.
+
+struct X86_64_batched_reloc
+{
+  section_size_type offset;
+  uint64_t value;
+};
+
+// Write out a batch of relocations of VALSIZE bits.
+
+template<int valsize>
+inline void
+x86_64_write_reloc_batch(unsigned char* view,
+			 const X86_64_batched_reloc* batch, size_t count)
+{
+  typedef typename elfcpp::Swap<valsize, false>::Valtype Valtype;
+  for (size_t i = 0; i < count; ++i)
+    elfcpp::Swap<valsize, false>::writeval(
+	reinterpret_cast<Valtype*>(view + batch[i].offset),
+	batch[i].value);
+}
+
+// Compute the value of a relocation of type R_TYPE against symbol
+// R_SYM at ADDRESS, if it is one of the common relocations against a
+// symbol whose value is already final: an absolute or PC relative
+// reference to a symbol defined in a regular object, which is not
+// TLS, IFUNC, or in the PLT.  This mirrors what Relocate::relocate
+// computes for these cases.  Return false if the relocation has to
+// go through Relocate, including when the value overflows, so that
+// the error is reported there.
+
+template<int size>
+bool
+Target_x86_64<size>::batched_reloc_value(
+    const Sized_relobj_file<size, false>* object,
+    unsigned int local_count,
+    unsigned int r_type,
+    unsigned int r_sym,
+    typename elfcpp::Elf_types<size>::Elf_Swxword addend,
+    typename elfcpp::Elf_types<size>::Elf_Addr address,
+    uint64_t* value) const
+{
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_64:
+    case elfcpp::R_X86_64_32:
+    case elfcpp::R_X86_64_32S:
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PLT32:
+      break;
+    default:
+      return false;
+    }
+
+  typename elfcpp::Elf_types<64>::Elf_Addr val;
+  if (r_sym < local_count)
+    {
+      const Symbol_value<size>* psymval = object->local_symbol(r_sym);
+      if (psymval->is_tls_symbol() || psymval->is_ifunc_symbol())
+	return false;
+      bool is_ordinary;
+      unsigned int shndx = psymval->input_shndx(&is_ordinary);
+      if (is_ordinary
+	  && shndx != elfcpp::SHN_UNDEF
+	  && !object->is_section_included(shndx))
+	return false;
+      if ((r_type == elfcpp::R_X86_64_PC32
+	   || r_type == elfcpp::R_X86_64_PLT32)
+	  && addend < 0)
+	val = psymval->value(object, 0) + addend;
+      else
+	val = psymval->value(object, addend);
+    }
+  else
+    {
+      const Symbol* gsym = object->global_symbol(r_sym);
+      gold_assert(gsym != NULL);
+      if (gsym->is_forwarder()
+	  || !gsym->is_defined()
+	  || gsym->is_placeholder()
+	  || gsym->is_from_dynobj()
+	  || gsym->type() == elfcpp::STT_TLS
+	  || gsym->type() == elfcpp::STT_GNU_IFUNC
+	  || gsym->has_warning()
+	  || gsym->use_plt_offset(Scan::get_reference_flags(r_type)))
+	return false;
+      if (r_type == elfcpp::R_X86_64_PLT32
+	  && !gsym->final_value_is_known()
+	  && gsym->is_preemptible())
+	return false;
+      const Sized_symbol<size>* ssym =
+	static_cast<const Sized_symbol<size>*>(gsym);
+      val = ssym->value() + addend;
+    }
+
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_32:
+      if (Bits<32>::has_unsigned_overflow(val))
+	return false;
+      break;
+    case elfcpp::R_X86_64_32S:
+      if (Bits<32>::has_overflow(val))
+	return false;
+      break;
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PLT32:
+      val -= address;
+      if (Bits<32>::has_overflow(val))
+	return false;
+      break;
+    default:
+      break;
+    }
+
+  *value = val;
+  return true;
+}
+
+// Relocate section data, writing the relocations which
+// batched_reloc_value can compute in batches grouped by the size of
+// the field, with the symbol table entries prefetched ahead of use.
+// The other relocations are collected, in order, and passed to the
+// generic relocate_section together.  A relocation which follows
+// R_X86_64_TLSGD or R_X86_64_TLSLD is always left to Relocate, since
+// it may be the call to __tls_get_addr which Relocate skips after
+// optimizing the TLS sequence.
+
+template<int size>
+void
+Target_x86_64<size>::relocate_section_batched(
+    const Relocate_info<size, false>* relinfo,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    unsigned char* view,
+    typename elfcpp::Elf_types<size>::Elf_Addr address,
+    section_size_type view_size)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, size, false>
+      Classify_reloc;
+  const int reloc_size = elfcpp::Elf_sizes<size>::rela_size;
+
+  const Sized_relobj_file<size, false>* object = relinfo->object;
+  const unsigned int local_count = object->local_symbol_count();
+
+  X86_64_batched_reloc batch32[x86_64_reloc_batch_size];
+  X86_64_batched_reloc batch64[x86_64_reloc_batch_size];
+  size_t count32 = 0;
+  size_t count64 = 0;
+  size_t batched = 0;
+
+  std::vector<unsigned char> generic;
+  bool follows_tls_call = false;
+
+  const unsigned char* p = prelocs;
+  for (size_t i = 0; i < reloc_count; ++i, p += reloc_size)
+    {
+      if (i + x86_64_reloc_prefetch_distance < reloc_count)
+	{
+	  const elfcpp::Rela<size, false> ahead(
+	      p + x86_64_reloc_prefetch_distance * reloc_size);
+	  unsigned int ahead_sym = elfcpp::elf_r_sym<size>(ahead.get_r_info());
+	  if (ahead_sym < local_count)
+	    __builtin_prefetch(object->local_symbol(ahead_sym));
+	  else
+	    __builtin_prefetch(object->global_symbol(ahead_sym));
+	}
+
+      const elfcpp::Rela<size, false> rela(p);
+      typename elfcpp::Elf_types<size>::Elf_WXword r_info = rela.get_r_info();
+      unsigned int r_type = elfcpp::elf_r_type<size>(r_info);
+      unsigned int r_sym = elfcpp::elf_r_sym<size>(r_info);
+      typename elfcpp::Elf_types<size>::Elf_Addr offset = rela.get_r_offset();
+      section_size_type field_size = (r_type == elfcpp::R_X86_64_64 ? 8 : 4);
+
+      uint64_t value;
+      bool is_batched = (!follows_tls_call
+			 && offset <= view_size
+			 && field_size <= view_size - offset
+			 && this->batched_reloc_value(object, local_count,
+						      r_type, r_sym,
+						      rela.get_r_addend(),
+						      address + offset,
+						      &value));
+      follows_tls_call = (r_type == elfcpp::R_X86_64_TLSGD
+			  || r_type == elfcpp::R_X86_64_TLSLD);
+
+      if (!is_batched)
+	{
+	  generic.insert(generic.end(), p, p + reloc_size);
+	  continue;
+	}
+
+      ++batched;
+      if (r_type == elfcpp::R_X86_64_64)
+	{
+	  batch64[count64].offset = offset;
+	  batch64[count64].value = value;
+	  if (++count64 == x86_64_reloc_batch_size)
+	    {
+	      x86_64_write_reloc_batch<64>(view, batch64, count64);
+	      count64 = 0;
+	    }
+	}
+      else
+	{
+	  batch32[count32].offset = offset;
+	  batch32[count32].value = value;
+	  if (++count32 == x86_64_reloc_batch_size)
+	    {
+	      x86_64_write_reloc_batch<32>(view, batch32, count32);
+	      count32 = 0;
+	    }
+	}
+    }
+  x86_64_write_reloc_batch<64>(view, batch64, count64);
+  x86_64_write_reloc_batch<32>(view, batch32, count32);
+
+  if (batched < reloc_count)
+    {
+      // If nothing was batched the copy is the same as the input.
+      const unsigned char* generic_relocs = (batched == 0
+					     ? prelocs
+					     : &generic[0]);
+      gold::relocate_section<size, false, Target_x86_64<size>, Relocate,
+			     gold::Default_comdat_behavior, Classify_reloc>(
+	relinfo,
+	this,
+	generic_relocs,
+	reloc_count - batched,
+	output_section,
+	false,
+	view,
+	address,
+	view_size,
+	NULL);
+    }
+
+  __sync_fetch_and_add(&Target_x86_64<size>::batched_relocs, batched);
+  __sync_fetch_and_add(&Target_x86_64<size>::total_relocs, reloc_count);
+}
+
 // Apply an incremental relocation.  Incremental relocations always refer
 // to global symbols.
 
@@ -5329,6 +5648,18 @@ Target_x86_64<size>::do_ehframe_datarel_base() const
   return ssym->value();
 }
 
+// Print statistics about relocation processing.
+
+template<int size>
+void
+Target_x86_64<size>::do_print_stats() const
+{
+  if (parameters->options().batch_relocs())
+    fprintf(stderr, _("%s: relocations applied in batches: %zu of %zu\n"),
+	    program_name, Target_x86_64<size>::batched_relocs,
+	    Target_x86_64<size>::total_relocs);
+}
+
 // FNOFFSET in section SHNDX in OBJECT is the start of a function
 // compiled with -fsplit-stack.  The function calls non-split-stack
 // code.  We have to change the function so that it always ensures
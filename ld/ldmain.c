@@ -449,6 +449,8 @@ main (int argc, char **argv)
       link_info.output_bfd->flags |= BFD_COMPRESS;
       if (link_info.compress_debug == COMPRESS_DEBUG_GABI_ZLIB)
 	link_info.output_bfd->flags |= BFD_COMPRESS_GABI;
+      else if (link_info.compress_debug == COMPRESS_DEBUG_GABI_ZSTD)
+	link_info.output_bfd->flags |= BFD_COMPRESS_GABI | BFD_COMPRESS_ZSTD;
     }
 
   ldwrite ();